@@ -0,0 +1,15 @@
+# bench.mk - Provides the "bench" target
+#
+# List benchmark programs in `BENCHMARKS`. They are not built by `all` nor run
+# by `check`; `make bench` builds and runs them one after another.
+
+EXTRA_PROGRAMS = $(BENCHMARKS)
+CLEANFILES = $(BENCHMARKS)
+
+bench: $(BENCHMARKS)
+	@for prog in $(BENCHMARKS); do \
+		echo "==> $$prog"; \
+		./$$prog || exit 1; \
+	done
+
+.PHONY: bench
@@ -182,6 +182,8 @@ make_list(tree_node_t* tree)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -227,3 +229,5 @@ main()
   printf("\n");
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
@@ -317,6 +317,8 @@ check_tree(tree_node_t* tr, int depth, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -417,3 +419,5 @@ main()
          nodes_taken, nodes_returned );
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
@@ -212,7 +212,7 @@ insert(tree_node_t* tree, key_t new_key, object_t* new_object)
 
       while ( !insert_done) {
 
-        if ( insert_key < current_node->key[i] && i >= start ) {
+        if ( i >= start && insert_key < current_node->key[i] ) {
           current_node->next[i + 1] = current_node->next[i];
           current_node->key[i + 1]  = current_node->key[i];
           i -= 1;
@@ -516,6 +516,8 @@ check_tree(tree_node_t* tree, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -579,3 +581,5 @@ main()
 
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
@@ -385,6 +385,8 @@ check_tree(tree_node_t* tr, int depth, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -449,3 +451,5 @@ main()
 
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
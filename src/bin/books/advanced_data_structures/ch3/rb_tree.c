@@ -109,11 +109,6 @@ find(tree_node_t* tree, key_t query_key)
     tmp_node = tree;
     while ( tmp_node->right != NULL ) {
 
-      if ( tmp_node->color == red )
-      { printf("r"); }
-      else
-      { printf("b"); }
-
       if ( query_key < tmp_node->key )
       { tmp_node = tmp_node->left; }
 
@@ -121,12 +116,6 @@ find(tree_node_t* tree, key_t query_key)
       { tmp_node = tmp_node->right; }
     }
 
-    if ( tmp_node->color == red )
-    { printf("r\n"); }
-
-    else
-    { printf("b\n"); }
-
     if ( tmp_node->key == query_key )
     { return ( (object_t*) tmp_node->left ); }
 
@@ -341,7 +330,7 @@ delete (tree_node_t* tree, key_t delete_key)
         finished = 1;
 
       } else { /* black node, black-deficient, and not root */
-        upper = path_stack[--path_st_p];
+        upper = path_stack[path_st_p - 1];   /* parent is the next to rebalance */
         if ( tmp_node == upper->left ) {
           other = upper->right;
 
@@ -508,6 +497,8 @@ check_tree(tree_node_t* tr, int count, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -572,3 +563,5 @@ main()
 
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
@@ -202,6 +202,8 @@ delete (tree_node_t* tree, key_t delete_key)
 // _____________________________________________________________________________
 //                                                                 Simple test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -270,3 +272,5 @@ main()
 
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
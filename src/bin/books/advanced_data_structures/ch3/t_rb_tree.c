@@ -107,10 +107,6 @@ find(tree_node_t* tree, key_t query_key)
     tmp_node = tree;
 
     while ( tmp_node->right != NULL ) {
-      if ( tmp_node->color == red ) { printf("r"); }
-
-      else { printf("b"); }
-
       if ( query_key < tmp_node->key )
       { tmp_node = tmp_node->left; }
 
@@ -118,10 +114,6 @@ find(tree_node_t* tree, key_t query_key)
       { tmp_node = tmp_node->right; }
     }
 
-    if ( tmp_node->color == red ) { printf("r\n"); }
-
-    else { printf("b\n"); }
-
     if ( tmp_node->key == query_key )
     { return ( (object_t*) tmp_node->left ); }
 
@@ -336,7 +328,7 @@ delete (tree_node_t* tree, key_t delete_key)
 
       } else { /* delete_key >= upper->key */
 
-        if ( upper->right->left == NULL ) {
+        if ( upper->right->right == NULL ) {  /* right is a leaf */
 
           if ( upper->left->right == NULL ) {
             upper->left->color  = red;
@@ -711,6 +703,8 @@ check_tree(tree_node_t* tr, int count, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Sample test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -775,3 +769,5 @@ main()
 
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
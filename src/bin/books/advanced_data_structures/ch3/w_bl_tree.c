@@ -379,6 +379,8 @@ check_tree(tree_node_t* tr, int depth, int lower, int upper)
 // _____________________________________________________________________________
 //                                                                 Sample test
 
+#if !defined(NO_DEMO_MAIN)
+
 int
 main()
 {
@@ -443,3 +445,5 @@ main()
   }
   return (0);
 }
+
+#endif  /* NO_DEMO_MAIN */
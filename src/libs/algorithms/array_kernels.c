@@ -0,0 +1,809 @@
+/**
+ * @file     array_kernels.c
+ * @brief    Vectorized reductions and prefix sums.
+ *
+ * Every kernel has a plain loop and, on x86 with GCC or Clang, SSE2 and
+ * AVX2 versions compiled with `target` attributes, so the library runs on
+ * any x86 processor and picks the best version at run time. SSE2 has no
+ * 64-bit integer compare, `int64_t` minimum and maximum use AVX2 or loops.
+ *
+ * `argmin` finds the first block of `BLOCK` elements with the smallest
+ * minimum using the min kernels and then looks for its first position in
+ * that block only, so it reads the array once.
+ *
+ * Prefix sums add shifted copies of a vector to itself (log of its length
+ * times) and then the last sum of the previous vector.
+ */
+#include "algorithms/array.h"
+
+#include <stdatomic.h>   /* atomic_* */
+#include <stdbool.h>     /* bool     */
+#include "lang/assert.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define X86_KERNELS
+#  include <immintrin.h>
+#  define TARGET_SSE2  __attribute__((target("sse2")))
+#  define TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+#define BLOCK      4096
+#define NOT_KNOWN  (-1)
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+static _Atomic int supported = NOT_KNOWN;
+static _Atomic int limit = SIMD_AVX2;
+
+static simd_et
+__level(void)
+{
+  int level = atomic_load_explicit(&supported, memory_order_relaxed);
+
+  if (level == NOT_KNOWN) {
+    level = SIMD_NONE;
+
+#if defined(X86_KERNELS)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+      level = SIMD_AVX2;
+
+    } else if (__builtin_cpu_supports("sse2")) {
+      level = SIMD_SSE2;
+    }
+#endif
+
+    atomic_store_explicit(&supported, level, memory_order_relaxed);
+  }
+
+  const int max = atomic_load_explicit(&limit, memory_order_relaxed);
+  return (simd_et)((level < max) ? level : max);
+}
+
+/* Plain loops. */
+
+#define SCALAR_MINMAX(T, S)                                                  \
+  static void                                                                \
+  __minmax_##S##_scalar(const T* values, size_t n, T* p_min__, T* p_max__)   \
+  {                                                                          \
+    T lo = values[0];                                                        \
+    T hi = values[0];                                                        \
+                                                                             \
+    for (size_t i = 1; i < n; ++i) {                                         \
+      lo = (values[i] < lo) ? values[i] : lo;                                \
+      hi = (values[i] > hi) ? values[i] : hi;                                \
+    }                                                                        \
+                                                                             \
+    *p_min__ = lo;                                                           \
+    *p_max__ = hi;                                                           \
+  }
+
+SCALAR_MINMAX(int, int)
+SCALAR_MINMAX(int64_t, int64)
+SCALAR_MINMAX(double, double)
+
+static int64_t
+__sum_int_scalar(const int* values, size_t n)
+{
+  int64_t sum = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += values[i];
+  }
+
+  return sum;
+}
+
+/* Integers are added as unsigned, so overflow wraps around. */
+static int64_t
+__sum_int64_scalar(const int64_t* values, size_t n)
+{
+  uint64_t sum = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += (uint64_t)values[i];
+  }
+
+  return (int64_t)sum;
+}
+
+static double
+__sum_double_scalar(const double* values, size_t n)
+{
+  double sum = 0.0;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += values[i];
+  }
+
+  return sum;
+}
+
+static void
+__prefix_sum_int_scalar(const int* values, size_t n, int* sums__, int carry)
+{
+  unsigned sum = (unsigned)carry;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += (unsigned)values[i];
+    sums__[i] = (int)sum;
+  }
+}
+
+static void
+__prefix_sum_int64_scalar(const int64_t* values, size_t n, int64_t* sums__, int64_t carry)
+{
+  uint64_t sum = (uint64_t)carry;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += (uint64_t)values[i];
+    sums__[i] = (int64_t)sum;
+  }
+}
+
+static void
+__prefix_sum_double_scalar(const double* values, size_t n, double* sums__, double carry)
+{
+  double sum = carry;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += values[i];
+    sums__[i] = sum;
+  }
+}
+
+#if defined(X86_KERNELS)
+
+/* SSE2. */
+
+/* SSE2 has no `min_epi32`, take the smaller with a mask. */
+TARGET_SSE2 static inline __m128i
+__min_epi32_sse2(__m128i a, __m128i b)
+{
+  const __m128i less = _mm_cmplt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(less, a), _mm_andnot_si128(less, b));
+}
+
+TARGET_SSE2 static inline __m128i
+__max_epi32_sse2(__m128i a, __m128i b)
+{
+  const __m128i greater = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+
+TARGET_SSE2 static void
+__minmax_int_sse2(const int* values, size_t n, int* p_min__, int* p_max__)
+{
+  if (n < 4) {
+    __minmax_int_scalar(values, n, p_min__, p_max__);
+    return;
+  }
+
+  __m128i lo = _mm_loadu_si128((const __m128i*)values);
+  __m128i hi = lo;
+  size_t i = 4;
+
+  for (; i + 4 <= n; i += 4) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&values[i]);
+
+    lo = __min_epi32_sse2(lo, x);
+    hi = __max_epi32_sse2(hi, x);
+  }
+
+  int lanes_lo[4], lanes_hi[4];
+  _mm_storeu_si128((__m128i*)lanes_lo, lo);
+  _mm_storeu_si128((__m128i*)lanes_hi, hi);
+
+  int min = lanes_lo[0], max = lanes_hi[0];
+
+  for (int k = 1; k < 4; ++k) {
+    min = (lanes_lo[k] < min) ? lanes_lo[k] : min;
+    max = (lanes_hi[k] > max) ? lanes_hi[k] : max;
+  }
+
+  for (; i < n; ++i) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+
+  *p_min__ = min;
+  *p_max__ = max;
+}
+
+TARGET_SSE2 static void
+__minmax_double_sse2(const double* values, size_t n, double* p_min__, double* p_max__)
+{
+  if (n < 4) {
+    __minmax_double_scalar(values, n, p_min__, p_max__);
+    return;
+  }
+
+  __m128d lo0 = _mm_loadu_pd(values);
+  __m128d lo1 = _mm_loadu_pd(&values[2]);
+  __m128d hi0 = lo0, hi1 = lo1;
+  size_t i = 4;
+
+  for (; i + 4 <= n; i += 4) {
+    const __m128d x0 = _mm_loadu_pd(&values[i]);
+    const __m128d x1 = _mm_loadu_pd(&values[i + 2]);
+
+    lo0 = _mm_min_pd(lo0, x0);
+    lo1 = _mm_min_pd(lo1, x1);
+    hi0 = _mm_max_pd(hi0, x0);
+    hi1 = _mm_max_pd(hi1, x1);
+  }
+
+  double lanes_lo[2], lanes_hi[2];
+  _mm_storeu_pd(lanes_lo, _mm_min_pd(lo0, lo1));
+  _mm_storeu_pd(lanes_hi, _mm_max_pd(hi0, hi1));
+
+  double min = (lanes_lo[0] < lanes_lo[1]) ? lanes_lo[0] : lanes_lo[1];
+  double max = (lanes_hi[0] > lanes_hi[1]) ? lanes_hi[0] : lanes_hi[1];
+
+  for (; i < n; ++i) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+
+  *p_min__ = min;
+  *p_max__ = max;
+}
+
+TARGET_SSE2 static int64_t
+__sum_int_sse2(const int* values, size_t n)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum0 = zero, sum1 = zero;
+  size_t i = 0;
+
+  /* Sign extended to 64 bits by pairing with the sign mask. */
+  for (; i + 4 <= n; i += 4) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&values[i]);
+    const __m128i sign = _mm_cmpgt_epi32(zero, x);
+
+    sum0 = _mm_add_epi64(sum0, _mm_unpacklo_epi32(x, sign));
+    sum1 = _mm_add_epi64(sum1, _mm_unpackhi_epi32(x, sign));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(sum0, sum1));
+
+  return lanes[0] + lanes[1] + __sum_int_scalar(&values[i], n - i);
+}
+
+TARGET_SSE2 static int64_t
+__sum_int64_sse2(const int64_t* values, size_t n)
+{
+  __m128i sum0 = _mm_setzero_si128(), sum1 = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    sum0 = _mm_add_epi64(sum0, _mm_loadu_si128((const __m128i*)&values[i]));
+    sum1 = _mm_add_epi64(sum1, _mm_loadu_si128((const __m128i*)&values[i + 2]));
+  }
+
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(sum0, sum1));
+
+  return (int64_t)(lanes[0] + lanes[1] + (uint64_t)__sum_int64_scalar(&values[i], n - i));
+}
+
+TARGET_SSE2 static double
+__sum_double_sse2(const double* values, size_t n)
+{
+  __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    sum0 = _mm_add_pd(sum0, _mm_loadu_pd(&values[i]));
+    sum1 = _mm_add_pd(sum1, _mm_loadu_pd(&values[i + 2]));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+
+  return lanes[0] + lanes[1] + __sum_double_scalar(&values[i], n - i);
+}
+
+TARGET_SSE2 static void
+__prefix_sum_int_sse2(const int* values, size_t n, int* sums__)
+{
+  __m128i carry = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&values[i]);
+
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, carry);
+
+    _mm_storeu_si128((__m128i*)&sums__[i], x);
+    carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  __prefix_sum_int_scalar(&values[i], n - i, &sums__[i], _mm_cvtsi128_si32(carry));
+}
+
+TARGET_SSE2 static void
+__prefix_sum_int64_sse2(const int64_t* values, size_t n, int64_t* sums__)
+{
+  __m128i carry = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&values[i]);
+
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, carry);
+
+    _mm_storeu_si128((__m128i*)&sums__[i], x);
+    carry = _mm_unpackhi_epi64(x, x);
+  }
+
+  int64_t last[2];
+  _mm_storeu_si128((__m128i*)last, carry);
+
+  __prefix_sum_int64_scalar(&values[i], n - i, &sums__[i], last[0]);
+}
+
+TARGET_SSE2 static void
+__prefix_sum_double_sse2(const double* values, size_t n, double* sums__)
+{
+  __m128d carry = _mm_setzero_pd();
+  size_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(&values[i]);
+
+    x = _mm_add_pd(x, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(x), 8)));
+    x = _mm_add_pd(x, carry);
+
+    _mm_storeu_pd(&sums__[i], x);
+    carry = _mm_unpackhi_pd(x, x);
+  }
+
+  __prefix_sum_double_scalar(&values[i], n - i, &sums__[i], _mm_cvtsd_f64(carry));
+}
+
+/* AVX2. */
+
+TARGET_AVX2 static void
+__minmax_int_avx2(const int* values, size_t n, int* p_min__, int* p_max__)
+{
+  if (n < 16) {
+    __minmax_int_scalar(values, n, p_min__, p_max__);
+    return;
+  }
+
+  __m256i lo0 = _mm256_loadu_si256((const __m256i*)values);
+  __m256i lo1 = _mm256_loadu_si256((const __m256i*)&values[8]);
+  __m256i hi0 = lo0, hi1 = lo1;
+  size_t i = 16;
+
+  for (; i + 16 <= n; i += 16) {
+    const __m256i x0 = _mm256_loadu_si256((const __m256i*)&values[i]);
+    const __m256i x1 = _mm256_loadu_si256((const __m256i*)&values[i + 8]);
+
+    lo0 = _mm256_min_epi32(lo0, x0);
+    lo1 = _mm256_min_epi32(lo1, x1);
+    hi0 = _mm256_max_epi32(hi0, x0);
+    hi1 = _mm256_max_epi32(hi1, x1);
+  }
+
+  int lanes_lo[8], lanes_hi[8];
+  _mm256_storeu_si256((__m256i*)lanes_lo, _mm256_min_epi32(lo0, lo1));
+  _mm256_storeu_si256((__m256i*)lanes_hi, _mm256_max_epi32(hi0, hi1));
+
+  int min = lanes_lo[0], max = lanes_hi[0];
+
+  for (int k = 1; k < 8; ++k) {
+    min = (lanes_lo[k] < min) ? lanes_lo[k] : min;
+    max = (lanes_hi[k] > max) ? lanes_hi[k] : max;
+  }
+
+  for (; i < n; ++i) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+
+  *p_min__ = min;
+  *p_max__ = max;
+}
+
+TARGET_AVX2 static void
+__minmax_int64_avx2(const int64_t* values, size_t n, int64_t* p_min__, int64_t* p_max__)
+{
+  if (n < 8) {
+    __minmax_int64_scalar(values, n, p_min__, p_max__);
+    return;
+  }
+
+  __m256i lo0 = _mm256_loadu_si256((const __m256i*)values);
+  __m256i lo1 = _mm256_loadu_si256((const __m256i*)&values[4]);
+  __m256i hi0 = lo0, hi1 = lo1;
+  size_t i = 8;
+
+  /* No 64-bit min and max, blend by compare. */
+  for (; i + 8 <= n; i += 8) {
+    const __m256i x0 = _mm256_loadu_si256((const __m256i*)&values[i]);
+    const __m256i x1 = _mm256_loadu_si256((const __m256i*)&values[i + 4]);
+
+    lo0 = _mm256_blendv_epi8(lo0, x0, _mm256_cmpgt_epi64(lo0, x0));
+    lo1 = _mm256_blendv_epi8(lo1, x1, _mm256_cmpgt_epi64(lo1, x1));
+    hi0 = _mm256_blendv_epi8(hi0, x0, _mm256_cmpgt_epi64(x0, hi0));
+    hi1 = _mm256_blendv_epi8(hi1, x1, _mm256_cmpgt_epi64(x1, hi1));
+  }
+
+  int64_t lanes_lo[8], lanes_hi[8];
+  _mm256_storeu_si256((__m256i*)lanes_lo, lo0);
+  _mm256_storeu_si256((__m256i*)&lanes_lo[4], lo1);
+  _mm256_storeu_si256((__m256i*)lanes_hi, hi0);
+  _mm256_storeu_si256((__m256i*)&lanes_hi[4], hi1);
+
+  int64_t min = lanes_lo[0], max = lanes_hi[0];
+
+  for (int k = 1; k < 8; ++k) {
+    min = (lanes_lo[k] < min) ? lanes_lo[k] : min;
+    max = (lanes_hi[k] > max) ? lanes_hi[k] : max;
+  }
+
+  for (; i < n; ++i) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+
+  *p_min__ = min;
+  *p_max__ = max;
+}
+
+TARGET_AVX2 static void
+__minmax_double_avx2(const double* values, size_t n, double* p_min__, double* p_max__)
+{
+  if (n < 8) {
+    __minmax_double_scalar(values, n, p_min__, p_max__);
+    return;
+  }
+
+  __m256d lo0 = _mm256_loadu_pd(values);
+  __m256d lo1 = _mm256_loadu_pd(&values[4]);
+  __m256d hi0 = lo0, hi1 = lo1;
+  size_t i = 8;
+
+  for (; i + 8 <= n; i += 8) {
+    const __m256d x0 = _mm256_loadu_pd(&values[i]);
+    const __m256d x1 = _mm256_loadu_pd(&values[i + 4]);
+
+    lo0 = _mm256_min_pd(lo0, x0);
+    lo1 = _mm256_min_pd(lo1, x1);
+    hi0 = _mm256_max_pd(hi0, x0);
+    hi1 = _mm256_max_pd(hi1, x1);
+  }
+
+  double lanes_lo[4], lanes_hi[4];
+  _mm256_storeu_pd(lanes_lo, _mm256_min_pd(lo0, lo1));
+  _mm256_storeu_pd(lanes_hi, _mm256_max_pd(hi0, hi1));
+
+  double min = lanes_lo[0], max = lanes_hi[0];
+
+  for (int k = 1; k < 4; ++k) {
+    min = (lanes_lo[k] < min) ? lanes_lo[k] : min;
+    max = (lanes_hi[k] > max) ? lanes_hi[k] : max;
+  }
+
+  for (; i < n; ++i) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+
+  *p_min__ = min;
+  *p_max__ = max;
+}
+
+TARGET_AVX2 static int64_t
+__sum_int_avx2(const int* values, size_t n)
+{
+  __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    sum0 = _mm256_add_epi64(sum0, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&values[i])));
+    sum1 = _mm256_add_epi64(sum1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&values[i + 4])));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sum0, sum1));
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + __sum_int_scalar(&values[i], n - i);
+}
+
+TARGET_AVX2 static int64_t
+__sum_int64_avx2(const int64_t* values, size_t n)
+{
+  __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    sum0 = _mm256_add_epi64(sum0, _mm256_loadu_si256((const __m256i*)&values[i]));
+    sum1 = _mm256_add_epi64(sum1, _mm256_loadu_si256((const __m256i*)&values[i + 4]));
+  }
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sum0, sum1));
+
+  return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]
+                   + (uint64_t)__sum_int64_scalar(&values[i], n - i));
+}
+
+TARGET_AVX2 static double
+__sum_double_avx2(const double* values, size_t n)
+{
+  __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    sum0 = _mm256_add_pd(sum0, _mm256_loadu_pd(&values[i]));
+    sum1 = _mm256_add_pd(sum1, _mm256_loadu_pd(&values[i + 4]));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + __sum_double_scalar(&values[i], n - i);
+}
+
+TARGET_AVX2 static void
+__prefix_sum_int_avx2(const int* values, size_t n, int* sums__)
+{
+  const __m256i last = _mm256_set1_epi32(7);
+  __m256i carry = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&values[i]);
+
+    /* Within 128-bit lanes, then the low lane's total to the high lane. */
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+
+    const __m256i low = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    x = _mm256_add_epi32(x, _mm256_permute2x128_si256(low, low, 0x08));
+    x = _mm256_add_epi32(x, carry);
+
+    _mm256_storeu_si256((__m256i*)&sums__[i], x);
+    carry = _mm256_permutevar8x32_epi32(x, last);
+  }
+
+  __prefix_sum_int_scalar(&values[i], n - i, &sums__[i],
+                          _mm_cvtsi128_si32(_mm256_castsi256_si128(carry)));
+}
+
+TARGET_AVX2 static void
+__prefix_sum_int64_avx2(const int64_t* values, size_t n, int64_t* sums__)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i carry = zero;
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&values[i]);
+
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+
+    const __m256i low = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 1, 1));
+    x = _mm256_add_epi64(x, _mm256_blend_epi32(zero, low, 0xF0));
+    x = _mm256_add_epi64(x, carry);
+
+    _mm256_storeu_si256((__m256i*)&sums__[i], x);
+    carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, carry);
+
+  __prefix_sum_int64_scalar(&values[i], n - i, &sums__[i], lanes[0]);
+}
+
+TARGET_AVX2 static void
+__prefix_sum_double_avx2(const double* values, size_t n, double* sums__)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  __m256d carry = zero;
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(&values[i]);
+
+    x = _mm256_add_pd(x, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(x), 8)));
+
+    const __m256d low = _mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 1, 1, 1));
+    x = _mm256_add_pd(x, _mm256_blend_pd(zero, low, 0xC));
+    x = _mm256_add_pd(x, carry);
+
+    _mm256_storeu_pd(&sums__[i], x);
+    carry = _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  __prefix_sum_double_scalar(&values[i], n - i, &sums__[i],
+                             _mm_cvtsd_f64(_mm256_castpd256_pd128(carry)));
+}
+
+#endif  /* X86_KERNELS */
+
+/* ______________________________________________________________________________ */
+
+simd_et
+Array_simd(void)
+{
+  return __level();
+}
+
+void
+Array_set_simd(simd_et simd)
+{
+  atomic_store_explicit(&limit, (int)simd, memory_order_relaxed);
+}
+
+/* Calls the kernel of the best instruction set allowed. */
+#if defined(X86_KERNELS)
+#  define DISPATCH(level, avx2_call, sse2_call, scalar_call)  \
+  do {                                                        \
+    if ((level) >= SIMD_AVX2) { avx2_call; }                  \
+    else if ((level) >= SIMD_SSE2) { sse2_call; }             \
+    else { scalar_call; }                                     \
+  } while (0)
+#else
+#  define DISPATCH(level, avx2_call, sse2_call, scalar_call)  \
+  do { (void)(level); scalar_call; } while (0)
+#endif
+
+void
+Array_minmax_int(const int* values, size_t n, int* p_min__, int* p_max__)
+{
+  Require(values);
+  Require(n > 0);
+
+  DISPATCH(__level(), __minmax_int_avx2(values, n, p_min__, p_max__),
+                      __minmax_int_sse2(values, n, p_min__, p_max__),
+                      __minmax_int_scalar(values, n, p_min__, p_max__));
+}
+
+void
+Array_minmax_int64(const int64_t* values, size_t n, int64_t* p_min__, int64_t* p_max__)
+{
+  Require(values);
+  Require(n > 0);
+
+  DISPATCH(__level(), __minmax_int64_avx2(values, n, p_min__, p_max__),
+                      __minmax_int64_scalar(values, n, p_min__, p_max__),
+                      __minmax_int64_scalar(values, n, p_min__, p_max__));
+}
+
+void
+Array_minmax_double(const double* values, size_t n, double* p_min__, double* p_max__)
+{
+  Require(values);
+  Require(n > 0);
+
+  DISPATCH(__level(), __minmax_double_avx2(values, n, p_min__, p_max__),
+                      __minmax_double_sse2(values, n, p_min__, p_max__),
+                      __minmax_double_scalar(values, n, p_min__, p_max__));
+}
+
+/* Min and max alone cost as much as both, the array is read once anyway. */
+#define MIN_MAX(T, S)                                                        \
+  T                                                                          \
+  Array_min_##S(const T* values, size_t n)                                   \
+  {                                                                          \
+    T min, max;                                                              \
+    Array_minmax_##S(values, n, &min, &max);                                 \
+    return min;                                                              \
+  }                                                                          \
+                                                                             \
+  T                                                                          \
+  Array_max_##S(const T* values, size_t n)                                   \
+  {                                                                          \
+    T min, max;                                                              \
+    Array_minmax_##S(values, n, &min, &max);                                 \
+    return max;                                                              \
+  }
+
+MIN_MAX(int, int)
+MIN_MAX(int64_t, int64)
+MIN_MAX(double, double)
+
+/* With NaN the min is not in the array, the scan stops at the block end. */
+#define ARGMIN(T, S)                                                         \
+  size_t                                                                     \
+  Array_argmin_##S(const T* values, size_t n)                                \
+  {                                                                          \
+    Require(values);                                                         \
+    Require(n > 0);                                                          \
+                                                                             \
+    size_t block = 0;                                                        \
+    T min = Array_min_##S(values, (n < BLOCK) ? n : BLOCK);                  \
+                                                                             \
+    for (size_t first = BLOCK; first < n; first += BLOCK) {                  \
+      const T block_min = Array_min_##S(&values[first],                      \
+                                        (n - first < BLOCK) ? n - first : BLOCK); \
+      if (block_min < min) {                                                 \
+        min = block_min;                                                     \
+        block = first;                                                       \
+      }                                                                      \
+    }                                                                        \
+                                                                             \
+    const size_t end = (n - block < BLOCK) ? n : block + BLOCK;              \
+    size_t i = block;                                                        \
+                                                                             \
+    while (i < end && values[i] != min) {                                    \
+      ++i;                                                                   \
+    }                                                                        \
+                                                                             \
+    return (i < end) ? i : block;                                            \
+  }
+
+ARGMIN(int, int)
+ARGMIN(int64_t, int64)
+ARGMIN(double, double)
+
+int64_t
+Array_sum_int(const int* values, size_t n)
+{
+  Require(values || n == 0);
+
+  DISPATCH(__level(), return __sum_int_avx2(values, n),
+                      return __sum_int_sse2(values, n),
+                      return __sum_int_scalar(values, n));
+}
+
+int64_t
+Array_sum_int64(const int64_t* values, size_t n)
+{
+  Require(values || n == 0);
+
+  DISPATCH(__level(), return __sum_int64_avx2(values, n),
+                      return __sum_int64_sse2(values, n),
+                      return __sum_int64_scalar(values, n));
+}
+
+double
+Array_sum_double(const double* values, size_t n)
+{
+  Require(values || n == 0);
+
+  DISPATCH(__level(), return __sum_double_avx2(values, n),
+                      return __sum_double_sse2(values, n),
+                      return __sum_double_scalar(values, n));
+}
+
+void
+Array_prefix_sum_int(const int* values, size_t n, int* sums__)
+{
+  Require((values && sums__) || n == 0);
+
+  DISPATCH(__level(), __prefix_sum_int_avx2(values, n, sums__),
+                      __prefix_sum_int_sse2(values, n, sums__),
+                      __prefix_sum_int_scalar(values, n, sums__, 0));
+}
+
+void
+Array_prefix_sum_int64(const int64_t* values, size_t n, int64_t* sums__)
+{
+  Require((values && sums__) || n == 0);
+
+  DISPATCH(__level(), __prefix_sum_int64_avx2(values, n, sums__),
+                      __prefix_sum_int64_sse2(values, n, sums__),
+                      __prefix_sum_int64_scalar(values, n, sums__, 0));
+}
+
+void
+Array_prefix_sum_double(const double* values, size_t n, double* sums__)
+{
+  Require((values && sums__) || n == 0);
+
+  DISPATCH(__level(), __prefix_sum_double_avx2(values, n, sums__),
+                      __prefix_sum_double_sse2(values, n, sums__),
+                      __prefix_sum_double_scalar(values, n, sums__, 0.0));
+}
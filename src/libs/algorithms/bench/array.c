@@ -0,0 +1,93 @@
+/*
+ * Min and max with the recursive `minmax`, and then every kernel over
+ * `int`, `int64_t` and `double` arrays with plain loops, SSE2 and AVX2
+ * as far as the processor has them. Timed in bytes read per second.
+ *
+ * Usage: array.run [elements] [rounds]
+ */
+#include "algorithms/array.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_N       4000000UL
+#define DEFAULT_ROUNDS  20
+
+static const char* names[] = { "none", "sse2", "avx2" };
+
+#define BENCH_CASE(label, type, call)                                          \
+  do {                                                                         \
+    char name[64];                                                             \
+    snprintf(name, sizeof (name), "%s %s", label, names[level]);               \
+                                                                               \
+    const double start = Bench_now();                                          \
+                                                                               \
+    for (size_t r = 0; r < rounds; ++r) {                                      \
+      call;                                                                    \
+    }                                                                          \
+                                                                               \
+    Bench_report_bytes(name, n * rounds * sizeof (type), Bench_now() - start); \
+  } while (0)
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_N);
+  const size_t rounds = Bench_arg(argc, argv, 2, DEFAULT_ROUNDS);
+
+  int* ints = ALLOC(n * sizeof (int));
+  int64_t* longs = ALLOC(n * sizeof (int64_t));
+  double* doubles = ALLOC(n * sizeof (double));
+  double* sums = ALLOC(n * sizeof (double));
+  uint64_t seed = 88172645463325252ULL;
+
+  for (size_t i = 0; i < n; ++i) {
+    ints[i] = (int)(uint32_t)Bench_rand(&seed);
+    longs[i] = (int64_t)Bench_rand(&seed);
+    doubles[i] = (double)(Bench_rand(&seed) % 1000000) / 7.0;
+  }
+
+  int min, max;
+  int64_t min64, max64;
+  double mind, maxd;
+  int64_t total = 0;
+  double totald = 0.0;
+  size_t index = 0;
+
+  const simd_et supported = Array_simd();
+  simd_et level = SIMD_NONE;
+
+  BENCH_CASE("minmax recursive", int, minmax(ints, (int)n, &min, &max));
+
+  for (int l = SIMD_NONE; l <= (int)supported; ++l) {
+    level = (simd_et)l;
+    Array_set_simd(level);
+
+    BENCH_CASE("minmax int", int, Array_minmax_int(ints, n, &min, &max));
+    BENCH_CASE("minmax int64", int64_t, Array_minmax_int64(longs, n, &min64, &max64));
+    BENCH_CASE("minmax double", double, Array_minmax_double(doubles, n, &mind, &maxd));
+    BENCH_CASE("argmin int", int, index += Array_argmin_int(ints, n));
+    BENCH_CASE("argmin double", double, index += Array_argmin_double(doubles, n));
+    BENCH_CASE("sum int", int, total += Array_sum_int(ints, n));
+    BENCH_CASE("sum int64", int64_t, total += Array_sum_int64(longs, n));
+    BENCH_CASE("sum double", double, totald += Array_sum_double(doubles, n));
+    BENCH_CASE("prefix sum double", double, Array_prefix_sum_double(doubles, n, sums));
+  }
+
+  Bench_use(&min);
+  Bench_use(&min64);
+  Bench_use(&mind);
+  Bench_use(&total);
+  Bench_use(&totald);
+  Bench_use(&index);
+  Bench_use(sums);
+
+  FREE(sums);
+  FREE(doubles);
+  FREE(longs);
+  FREE(ints);
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Naive Fibonacci, where every call is a task, and sum of a hundred million
+ * numbers split in halves down to 4096 of them. Serial and then on 1 ... N
+ * threads, doubling. Fibonacci is timed per call, sum per number.
+ *
+ * Usage: fork_join.run [fibonacci n] [threads]
+ */
+#include "algorithms/fork_join.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_N        30
+#define DEFAULT_THREADS  4
+#define NUMBERS          100000000UL
+#define GRAIN            4096
+
+typedef struct {
+  unsigned n;
+  unsigned long result;
+} fib_t;
+
+static unsigned long
+__fib_serial(unsigned n)
+{
+  return (n < 2) ? n : __fib_serial(n - 1) + __fib_serial(n - 2);
+}
+
+static void
+__fib(void* arg)
+{
+  fib_t* fib = arg;
+
+  if (fib->n < 2) {
+    fib->result = fib->n;
+    return;
+  }
+
+  fib_t first = { fib->n - 1, 0 };
+  fib_t second = { fib->n - 2, 0 };
+
+  ForkJoin_join(__fib, &first, __fib, &second);
+  fib->result = first.result + second.result;
+}
+
+typedef struct {
+  const unsigned* values;
+  size_t begin;
+  size_t end;
+  unsigned long sum;
+} range_t;
+
+static unsigned long
+__sum_serial(const unsigned* values, size_t begin, size_t end)
+{
+  unsigned long sum = 0;
+
+  for (size_t i = begin; i < end; ++i) {
+    sum += values[i];
+  }
+
+  return sum;
+}
+
+static void
+__sum(void* arg)
+{
+  range_t* range = arg;
+
+  if (range->end - range->begin <= GRAIN) {
+    range->sum = __sum_serial(range->values, range->begin, range->end);
+    return;
+  }
+
+  const size_t middle = range->begin + (range->end - range->begin) / 2;
+  range_t left = { range->values, range->begin, middle, 0 };
+  range_t right = { range->values, middle, range->end, 0 };
+
+  ForkJoin_join(__sum, &left, __sum, &right);
+  range->sum = left.sum + right.sum;
+}
+
+static void
+__report(const char* name, size_t threads, size_t ops, double start, bool right)
+{
+  char title[64];
+
+  if (threads == 0) {
+    snprintf(title, sizeof(title), "%s, serial", name);
+  } else {
+    snprintf(title, sizeof(title), "%s, %zu threads%s", name, threads, right ? "" : " (WRONG)");
+  }
+
+  Bench_report(title, ops, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const unsigned n = (unsigned)Bench_arg(argc, argv, 1, DEFAULT_N);
+  const size_t max_threads = Bench_arg(argc, argv, 2, DEFAULT_THREADS);
+
+  double start = Bench_now();
+  const unsigned long fib = __fib_serial(n);
+  const size_t calls = 2 * __fib_serial(n + 1) - 1;
+
+  __report("fib", 0, calls, start, true);
+
+  unsigned* values = ALLOC(NUMBERS * sizeof (unsigned));
+  uint64_t seed = 88172645463325252ULL;
+
+  for (size_t i = 0; i < NUMBERS; ++i) {
+    values[i] = (unsigned)(Bench_rand(&seed) % 1000);
+  }
+
+  start = Bench_now();
+  const unsigned long sum = __sum_serial(values, 0, NUMBERS);
+  __report("sum", 0, NUMBERS, start, true);
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    ForkJoin_T pool = ForkJoin_new(threads);
+
+    fib_t task = { n, 0 };
+    start = Bench_now();
+    ForkJoin_run(pool, __fib, &task);
+    __report("fib", threads, calls, start, task.result == fib);
+
+    range_t range = { values, 0, NUMBERS, 0 };
+    start = Bench_now();
+    ForkJoin_run(pool, __sum, &range);
+    __report("sum", threads, NUMBERS, start, range.sum == sum);
+
+    ForkJoin_free(&pool);
+  }
+
+  FREE(values);
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * Synthetic directed graphs of sixteen edges per vertex: R-MAT (skewed
+ * degrees, as in Graph500) and uniform random. Direction optimizing BFS,
+ * delta-stepping and connected components on all threads, a plain queue
+ * BFS for comparison. Times are per edge of the graph.
+ *
+ * Usage: graph_algorithms.run [max edges] [threads] [rounds]
+ *
+ * Graphs of 10^6 edges and ten times more up to `max edges`, 10^7 by
+ * default. 10^8 edges need about 5 GB. With 0 threads, as many as
+ * processors.
+ */
+#include "algorithms/graph_algorithms.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_MAX_EDGES  10000000UL
+#define DEFAULT_THREADS    0
+#define DEFAULT_ROUNDS     3
+
+#define MIN_EDGES          1000000UL
+#define DEGREE             16
+#define MAX_WEIGHT         255
+#define DELTA              64
+
+typedef enum { RMAT, UNIFORM } kind_et;
+
+static uint64_t seed = 88172645463325252ULL;
+
+/* Quadrant probabilities a = 0.57, b = c = 0.19 of Graph500, in 1/100. */
+static vertex
+__rmat_edge(unsigned scale, vertex* p_to__)
+{
+  vertex from = 0, to = 0;
+
+  for (unsigned bit = 0; bit < scale; ++bit) {
+    const uint64_t r = Bench_rand(&seed) % 100;
+
+    from = (from << 1) | (r >= 76);
+    to = (to << 1) | (r >= 57 && r < 76) | (r >= 95);
+  }
+
+  /* Odd multiplier permutes `0 ... 2^scale - 1`, hubs are not the first vertices. */
+  const vertex mask = ((vertex)1 << scale) - 1;
+
+  *p_to__ = (to * 0x9E3779B97F4A7C15ULL) & mask;
+  return (from * 0x9E3779B97F4A7C15ULL) & mask;
+}
+
+static CSRGraph_T
+__generate(kind_et kind, size_t edges, size_t* p_vertices__)
+{
+  unsigned scale = 1;
+
+  while (((size_t)1 << (scale + 1)) * DEGREE <= edges) {
+    scale++;
+  }
+
+  const size_t vertices = (size_t)1 << scale;
+  csr_edge_t* list = ALLOC(edges * sizeof (csr_edge_t));
+
+  for (size_t i = 0; i < edges; ++i) {
+    if (kind == RMAT) {
+      list[i].from = __rmat_edge(scale, &list[i].to);
+    } else {
+      list[i].from = Bench_rand(&seed) % vertices;
+      list[i].to = Bench_rand(&seed) % vertices;
+    }
+
+    list[i].weight = (int16_t)(1 + Bench_rand(&seed) % MAX_WEIGHT);
+  }
+
+  CSRGraph_T graph = CSRGraph_from_edges(vertices, DIRECTED, list, edges);
+  FREE(list);
+
+  *p_vertices__ = vertices;
+  return graph;
+}
+
+/* Vertex with edges out, so a search does not stop at once. */
+static vertex
+__source(CSRGraph_T graph, size_t vertices)
+{
+  const vertex* targets;
+  const int16_t* weights;
+
+  for (;;) {
+    const vertex v = Bench_rand(&seed) % vertices;
+
+    if (CSRGraph_edges(graph, v, &targets, &weights) > 0)
+    { return v; }
+  }
+}
+
+static size_t
+__serial_bfs(CSRGraph_T graph, vertex source, vertex* queue, bool* seen, size_t vertices)
+{
+  size_t head = 0, tail = 0;
+  const vertex* targets;
+  const int16_t* weights;
+
+  memset(seen, 0, vertices * sizeof (bool));
+  queue[tail++] = source;
+  seen[source] = true;
+
+  while (head < tail) {
+    const size_t degree = CSRGraph_edges(graph, queue[head++], &targets, &weights);
+
+    for (size_t i = 0; i < degree; ++i) {
+      if (!seen[targets[i]]) {
+        seen[targets[i]] = true;
+        queue[tail++] = targets[i];
+      }
+    }
+  }
+
+  return tail;
+}
+
+static void
+__run(ThreadPool_T pool, kind_et kind, size_t edges, size_t rounds)
+{
+  const char* kind_name = (kind == RMAT) ? "rmat" : "uniform";
+  char name[64];
+  size_t vertices;
+
+  CSRGraph_T graph = __generate(kind, edges, &vertices);
+  CSRGraph_T reverse = CSRGraph_transpose(graph);
+
+  vertex* sources = ALLOC(rounds * sizeof (vertex));
+  size_t* levels = ALLOC(vertices * sizeof (size_t));
+  int64_t* distances = ALLOC(vertices * sizeof (int64_t));
+  vertex* labels = ALLOC(vertices * sizeof (vertex));
+  vertex* queue = ALLOC(vertices * sizeof (vertex));
+  bool* seen = ALLOC(vertices * sizeof (bool));
+
+  for (size_t r = 0; r < rounds; ++r) {
+    sources[r] = __source(graph, vertices);
+  }
+
+  size_t reached = 0;
+  double start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    reached += __serial_bfs(graph, sources[r], queue, seen, vertices);
+  }
+
+  snprintf(name, sizeof (name), "%s %zu bfs serial", kind_name, edges);
+  Bench_report(name, edges * rounds, Bench_now() - start);
+
+  size_t parallel_reached = 0;
+  start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    parallel_reached += Graph_bfs(graph, reverse, sources[r], pool, levels);
+  }
+
+  snprintf(name, sizeof (name), "%s %zu bfs", kind_name, edges);
+  Bench_report(name, edges * rounds, Bench_now() - start);
+
+  if (parallel_reached != reached)
+  { printf("BFS reached %zu vertices, expected %zu\n", parallel_reached, reached); }
+
+  start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    Graph_shortest_paths(graph, sources[r], DELTA, pool, distances);
+  }
+
+  snprintf(name, sizeof (name), "%s %zu sssp", kind_name, edges);
+  Bench_report(name, edges * rounds, Bench_now() - start);
+
+  size_t count = 0;
+  start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    count = Graph_components(graph, pool, labels);
+  }
+
+  snprintf(name, sizeof (name), "%s %zu components", kind_name, edges);
+  Bench_report(name, edges * rounds, Bench_now() - start);
+  Bench_use(&count);
+
+  FREE(seen);
+  FREE(queue);
+  FREE(labels);
+  FREE(distances);
+  FREE(levels);
+  FREE(sources);
+  CSRGraph_free(&reverse);
+  CSRGraph_free(&graph);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t max_edges = Bench_arg(argc, argv, 1, DEFAULT_MAX_EDGES);
+  const size_t threads = Bench_arg(argc, argv, 2, DEFAULT_THREADS);
+  const size_t rounds = Bench_arg(argc, argv, 3, DEFAULT_ROUNDS);
+
+  ThreadPool_T pool = ThreadPool_new(threads);
+
+  printf("%zu threads, %d edges per vertex, %zu rounds\n", ThreadPool_threads(pool), DEGREE,
+         rounds);
+
+  for (size_t edges = MIN_EDGES; edges <= max_edges; edges *= 10) {
+    __run(pool, RMAT, edges, rounds);
+    __run(pool, UNIFORM, edges, rounds);
+  }
+
+  ThreadPool_free(&pool);
+
+  return 0;
+}
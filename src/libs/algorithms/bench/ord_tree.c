@@ -0,0 +1,164 @@
+/*
+ * Ordered trees of both balance schemes. Order statistics and split with
+ * join back are timed per operation on one tree of all keys. Then two trees
+ * of half the keys each, overlapping at random, are merged by union,
+ * intersection and difference: serial and then on 1 ... N threads, doubling,
+ * timed per key of the inputs. Inputs are built again for every case and
+ * that is not timed.
+ *
+ * Usage: ord_tree.run [keys] [max threads]
+ */
+#include "algorithms/tree_algorithms.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>      /* sysconf */
+#include "bench.h"
+#include "lang/macros.h"
+#include "lang/memory.h"
+
+#define DEFAULT_KEYS     10000000UL
+#define DEFAULT_THREADS  4
+#define QUERIES          1000000UL
+#define SPLITS           100000UL
+
+typedef void (*set_FN)(ForkJoin_T, OrdTree_T, OrdTree_T*);
+
+static const char* const balance_names[] = { "height balanced", "red-black" };
+
+/* Increasing keys with gaps of 1 ... 4, so two of them overlap by a half. */
+static void
+__keys(int64_t* keys__, size_t n, uint64_t seed)
+{
+  int64_t key = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    key += 1 + (int64_t)(Bench_rand(&seed) % 4);
+    keys__[i] = key;
+  }
+}
+
+static void
+__statistics(balance_et balance, const int64_t* keys, size_t n)
+{
+  char title[64];
+  uint64_t seed = 1;
+  size_t check = 0;
+
+  OrdTree_T tree = OrdTree_load(balance, keys, NULL, n);
+  const int64_t last = keys[n - 1];
+
+  double start = Bench_now();
+
+  for (size_t i = 0; i < QUERIES; ++i) {
+    check += OrdTree_rank(tree, (int64_t)(Bench_rand(&seed) % (uint64_t)last));
+  }
+
+  snprintf(title, sizeof (title), "%s: rank", balance_names[balance]);
+  Bench_report(title, QUERIES, Bench_now() - start);
+  start = Bench_now();
+
+  for (size_t i = 0; i < QUERIES; ++i) {
+    int64_t key;
+    OrdTree_select(tree, Bench_rand(&seed) % n, &key, NULL);
+    check += (size_t)key;
+  }
+
+  snprintf(title, sizeof (title), "%s: select", balance_names[balance]);
+  Bench_report(title, QUERIES, Bench_now() - start);
+  start = Bench_now();
+
+  for (size_t i = 0; i < QUERIES; ++i) {
+    const int64_t low = (int64_t)(Bench_rand(&seed) % (uint64_t)last);
+    check += OrdTree_count(tree, low, low + (int64_t)(Bench_rand(&seed) % 1000));
+  }
+
+  snprintf(title, sizeof (title), "%s: count", balance_names[balance]);
+  Bench_report(title, QUERIES, Bench_now() - start);
+  start = Bench_now();
+
+  for (size_t i = 0; i < SPLITS; ++i) {
+    OrdTree_T greater = OrdTree_split(tree, (int64_t)(Bench_rand(&seed) % (uint64_t)last));
+    OrdTree_join(tree, &greater);
+  }
+
+  snprintf(title, sizeof (title), "%s: split+join", balance_names[balance]);
+  Bench_report(title, SPLITS, Bench_now() - start);
+
+  if (OrdTree_length(tree) != n || check == 0)
+  { printf("%s: WRONG\n", balance_names[balance]); }
+
+  OrdTree_free(&tree);
+}
+
+static void
+__set(balance_et balance, const char* name, set_FN set_fn, size_t threads,
+      const int64_t* first, const int64_t* second, size_t half)
+{
+  char title[64];
+  ForkJoin_T pool = (threads == 0) ? NULL : ForkJoin_new(threads);
+
+  OrdTree_T tree = OrdTree_load(balance, first, NULL, half);
+  OrdTree_T other = OrdTree_load(balance, second, NULL, half);
+
+  const double start = Bench_now();
+  set_fn(pool, tree, &other);
+  const double seconds = Bench_now() - start;
+
+  if (threads == 0) {
+    snprintf(title, sizeof (title), "%s: %s, serial", balance_names[balance], name);
+  } else {
+    snprintf(title, sizeof (title), "%s: %s x%zu", balance_names[balance], name, threads);
+  }
+
+  Bench_report(title, 2 * half, seconds);
+
+  OrdTree_free(&tree);
+
+  if (pool != NULL)
+  { ForkJoin_free(&pool); }
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_KEYS);
+  const long online = sysconf(_SC_NPROCESSORS_ONLN);
+  const size_t max_threads = Bench_arg(argc, argv, 2, (online > 0) ? (size_t)online : DEFAULT_THREADS);
+  const size_t half = n / 2;
+
+  int64_t* keys = ALLOC(n * sizeof (int64_t));
+  int64_t* second = ALLOC(half * sizeof (int64_t));
+
+  static const struct {
+    const char* name;
+    set_FN set_fn;
+  } ops[] = {
+    { "union", OrdTree_parallel_union },
+    { "intersection", OrdTree_parallel_intersection },
+    { "difference", OrdTree_parallel_difference },
+  };
+
+  for (int b = HEIGHT_BALANCED; b <= RED_BLACK; ++b) {
+    const balance_et balance = (balance_et)b;
+
+    __keys(keys, n, 1);
+    __statistics(balance, keys, n);
+
+    __keys(keys, half, 2);
+    __keys(second, half, 3);
+
+    for (size_t op = 0; op < ARRAY_SIZE(ops); ++op) {
+      __set(balance, ops[op].name, ops[op].set_fn, 0, keys, second, half);
+
+      for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        __set(balance, ops[op].name, ops[op].set_fn, threads, keys, second, half);
+      }
+    }
+  }
+
+  FREE(second);
+  FREE(keys);
+
+  return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * @file     fork_join.c
+ * @brief    Fork-join tasks on work-stealing threads.
+ *
+ * Worker 0 is the thread in `ForkJoin_run`, the others sleep on `start`
+ * until `generation` changes and then steal while `running` is set. A task
+ * pushed by `ForkJoin_join` lives in the frame of the join, which does not
+ * return before `done` is set, so nothing is allocated per task.
+ *
+ * Joins are nested, so the half a join pushed is on top of the deque when
+ * it waits: it is popped back unless it was stolen, and then everything
+ * under it was stolen as well.
+ */
+#define _POSIX_C_SOURCE 200809L  /* sysconf */
+
+#include "algorithms/fork_join.h"
+
+#include <pthread.h>     /* pthread_*   */
+#include <sched.h>       /* sched_yield */
+#include <stdatomic.h>   /* atomic_*    */
+#include <stdbool.h>     /* bool        */
+#include <stdint.h>      /* uint64_t    */
+#include <unistd.h>      /* sysconf     */
+#include "data_structs/ws_deque.h"
+#include "lang/assert.h"
+#include "lang/memory.h"
+#include "logger/log.h"
+
+const Except_T ForkJoin_Failed = { "Fork-join pool creation failed" };
+
+#define CACHE_LINE     64
+#define DEQUE_SIZE     64
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+struct task {
+  task_FN task_fn;
+  void* arg;
+  atomic_bool done;
+};
+
+struct worker {
+  ForkJoin_T pool;
+  WSDeque_T deque;
+  uint64_t seed;          /* Picks victims. */
+  pthread_t thread;
+};
+
+struct fork_join {
+  size_t threads;
+  struct worker* workers;
+
+  pthread_mutex_t run_lock;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  size_t generation;
+  bool stopping;
+
+  /* Read by idle threads all the time, keep it away from the rest. */
+  _Alignas(CACHE_LINE) atomic_bool running;
+};
+
+/* Worker of the calling thread, NULL outside of the pool. */
+static _Thread_local struct worker* current = NULL;
+
+static void
+__execute(struct task* task)
+{
+  task->task_fn(task->arg);
+  atomic_store_explicit(&task->done, true, memory_order_release);
+}
+
+static size_t
+__victim(struct worker* worker)
+{
+  uint64_t x = worker->seed;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  worker->seed = x;
+
+  return (size_t)(x % worker->pool->threads);
+}
+
+/* Try every other worker once, from a random one. Return whether a task was run. */
+static bool
+__steal_one(struct worker* worker)
+{
+  ForkJoin_T pool = worker->pool;
+  const size_t first = __victim(worker);
+  Object_T data;
+
+  for (size_t i = 0; i < pool->threads; ++i) {
+    struct worker* victim = &pool->workers[(first + i) % pool->threads];
+
+    if (victim != worker && WSDeque_steal(victim->deque, &data)) {
+      __execute((struct task*)data);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void*
+__worker_loop(void* arg)
+{
+  struct worker* worker = arg;
+  ForkJoin_T pool = worker->pool;
+  size_t seen = 0;
+
+  current = worker;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->generation == seen && !pool->stopping) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+
+    if (pool->stopping) {
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    while (atomic_load_explicit(&pool->running, memory_order_acquire)) {
+      if (!__steal_one(worker))
+      { sched_yield(); }
+    }
+  }
+
+  return NULL;
+}
+
+static size_t
+__online_processors(void)
+{
+  const long online = sysconf(_SC_NPROCESSORS_ONLN);
+  return (online > 0) ? (size_t)online : 1;
+}
+
+/* Stops threads of workers `1 ... started`. */
+static void
+__stop(ForkJoin_T pool, size_t started)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (size_t i = 1; i <= started; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+}
+
+/* Everything but threads. */
+static void
+__release(ForkJoin_T pool)
+{
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_mutex_destroy(&pool->run_lock);
+
+  for (size_t i = 0; i < pool->threads; ++i) {
+    WSDeque_free(&pool->workers[i].deque);
+  }
+
+  FREE(pool->workers);
+  FREE_ALIGNED(pool);
+}
+
+/* __________________________________________________________________________ */
+
+ForkJoin_T
+ForkJoin_new(size_t threads)
+{
+  if (threads == 0)
+  { threads = __online_processors(); }
+
+  ForkJoin_T pool = ALLOC_ALIGNED(CACHE_LINE, sizeof (*pool));
+
+  pool->threads = threads;
+  pool->workers = ALLOC(threads * sizeof (struct worker));
+
+  pthread_mutex_init(&pool->run_lock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pool->generation = 0;
+  pool->stopping = false;
+  atomic_init(&pool->running, false);
+
+  for (size_t i = 0; i < threads; ++i) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].deque = WSDeque_new(DEQUE_SIZE);
+    pool->workers[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+
+  for (size_t i = 1; i < threads; ++i) {
+    if (pthread_create(&pool->workers[i].thread, NULL, __worker_loop, &pool->workers[i]) != 0) {
+      Log_error("Can't start thread %zu of %zu.", i, threads);
+
+      __stop(pool, i - 1);
+      __release(pool);
+
+      THROW(ForkJoin_Failed);
+    }
+  }
+
+  return pool;
+}
+
+size_t
+ForkJoin_threads(ForkJoin_T pool)
+{
+  return (pool != NULL) ? pool->threads : 1;
+}
+
+void
+ForkJoin_run(ForkJoin_T pool, task_FN task_fn, void* arg)
+{
+  Require(task_fn);
+
+  if (pool == NULL || current != NULL) {
+    task_fn(arg);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->run_lock);
+
+  current = &pool->workers[0];
+  atomic_store_explicit(&pool->running, true, memory_order_release);
+
+  if (pool->threads > 1) {
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  task_fn(arg);
+
+  /* All joins are done, so no task is left in any deque. */
+  atomic_store_explicit(&pool->running, false, memory_order_release);
+  current = NULL;
+
+  pthread_mutex_unlock(&pool->run_lock);
+}
+
+void
+ForkJoin_join(task_FN first_fn, void* first_arg, task_FN second_fn, void* second_arg)
+{
+  Require(first_fn);
+  Require(second_fn);
+
+  struct worker* worker = current;
+
+  if (worker == NULL || worker->pool->threads == 1) {
+    first_fn(first_arg);
+    second_fn(second_arg);
+    return;
+  }
+
+  struct task task;
+  task.task_fn = second_fn;
+  task.arg = second_arg;
+  atomic_init(&task.done, false);
+
+  WSDeque_push(worker->deque, (Object_T)&task);
+  first_fn(first_arg);
+
+  Object_T data;
+
+  while (!atomic_load_explicit(&task.done, memory_order_acquire)) {
+    if (WSDeque_pop(worker->deque, &data)) {
+      __execute((struct task*)data);
+
+    } else if (!__steal_one(worker)) {
+      sched_yield();
+    }
+  }
+}
+
+void
+ForkJoin_free(ForkJoin_T* p_pool)
+{
+  Require(p_pool);
+
+  ForkJoin_T pool = *p_pool;
+
+  if (pool == NULL)
+  { return; }
+
+  if (pool->threads > 1)
+  { __stop(pool, pool->threads - 1); }
+
+  __release(pool);
+  *p_pool = NULL;
+}
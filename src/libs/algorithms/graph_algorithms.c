@@ -0,0 +1,712 @@
+/**
+ * @file     graph_algorithms.c
+ * @brief    Parallel BFS, delta-stepping and connected components.
+ *
+ * Visited vertices are bits of a bitmap that are set with atomic OR, the
+ * thread that sets the bit owns the vertex. Found vertices are collected in
+ * a small buffer per range and copied to the shared array with one atomic
+ * add, so threads seldom write to the same cache line.
+ *
+ * Bottom-up BFS steps and loops over all vertices take ranges of whole
+ * bitmap words.
+ */
+#include "algorithms/graph_algorithms.h"
+
+#include <stdatomic.h>   /* atomic_* */
+#include <stdbool.h>     /* bool     */
+#include <string.h>      /* memcpy   */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+/* Tuned as in "Direction-Optimizing Breadth-First Search" (Beamer). */
+#define BFS_ALPHA      15
+#define BFS_BETA       18
+
+/* Vertices of a range in loops over all vertices, multiple of 64. */
+#define VERTEX_GRAIN   1024
+
+/* Frontier vertices of a range. */
+#define FRONTIER_GRAIN 64
+
+/* Found vertices kept by a range before they are copied. */
+#define LOCAL_QUEUE    256
+
+#define CACHE_LINE     64
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+#define WORD(v)  ((v) >> 6)
+#define BIT(v)   ((uint64_t)1 << ((v) & 63))
+#define WORDS(n) (((n) + 63) >> 6)
+
+typedef _Atomic uint64_t bitmap_t;
+
+static bitmap_t*
+__bitmap_new(size_t n)
+{
+  bitmap_t* bits = ALLOC(WORDS(n) * sizeof (bitmap_t));
+
+  for (size_t i = 0; i < WORDS(n); ++i) {
+    atomic_init(&bits[i], 0);
+  }
+
+  return bits;
+}
+
+static inline bool
+__is_set(bitmap_t* bits, size_t v)
+{
+  return (atomic_load_explicit(&bits[WORD(v)], memory_order_relaxed) & BIT(v)) != 0;
+}
+
+/* Return TRUE if the bit was not set before. */
+static inline bool
+__set(bitmap_t* bits, size_t v)
+{
+  if (__is_set(bits, v))
+  { return false; }
+
+  return (atomic_fetch_or_explicit(&bits[WORD(v)], BIT(v), memory_order_relaxed) & BIT(v)) == 0;
+}
+
+/* Number of edges out of all vertices, mirrors included. */
+static size_t
+__arcs(CSRGraph_T graph)
+{
+  size_t vertices, edges;
+  CSRGraph_size(graph, &vertices, &edges);
+
+  return (CSRGraph_type(graph) == UNDIRECTED) ? 2 * edges : edges;
+}
+
+/* __________________________________________________________________________ */
+/*                                                                       BFS  */
+
+struct bfs {
+  CSRGraph_T graph;
+  CSRGraph_T reverse;
+  size_t vertices;
+  size_t* levels;
+  size_t level;
+
+  bitmap_t* visited;
+  bitmap_t* front;
+
+  vertex* queue;
+  size_t queue_size;
+
+  vertex* next;
+  _Atomic size_t next_size;
+
+  /* Edges out of the next frontier. */
+  _Atomic size_t scout;
+};
+
+static void
+__flush(struct bfs* bfs, const vertex* local, size_t count, size_t scout)
+{
+  const size_t at = atomic_fetch_add_explicit(&bfs->next_size, count, memory_order_relaxed);
+
+  memcpy(&bfs->next[at], local, count * sizeof (vertex));
+  atomic_fetch_add_explicit(&bfs->scout, scout, memory_order_relaxed);
+}
+
+static void
+__bfs_init(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct bfs* bfs = arg;
+  (void)worker;
+
+  for (size_t v = begin; v < end; ++v) {
+    bfs->levels[v] = GRAPH_UNREACHED;
+  }
+}
+
+static void
+__top_down(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct bfs* bfs = arg;
+  vertex local[LOCAL_QUEUE];
+  size_t count = 0, scout = 0;
+  const vertex* targets;
+  const vertex* unused_targets;
+  const int16_t* weights;
+  (void)worker;
+
+  for (size_t i = begin; i < end; ++i) {
+    const size_t degree = CSRGraph_edges(bfs->graph, bfs->queue[i], &targets, &weights);
+
+    for (size_t j = 0; j < degree; ++j) {
+      const vertex to = targets[j];
+
+      if (!__set(bfs->visited, to))
+      { continue; }
+
+      bfs->levels[to] = bfs->level + 1;
+      scout += CSRGraph_edges(bfs->graph, to, &unused_targets, &weights);
+      local[count++] = to;
+
+      if (count == LOCAL_QUEUE) {
+        __flush(bfs, local, count, scout);
+        count = scout = 0;
+      }
+    }
+  }
+
+  __flush(bfs, local, count, scout);
+}
+
+static void
+__bottom_up(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct bfs* bfs = arg;
+  vertex local[LOCAL_QUEUE];
+  size_t count = 0;
+  const vertex* parents;
+  const int16_t* weights;
+  (void)worker;
+
+  for (vertex v = begin; v < end; ++v) {
+    if (__is_set(bfs->visited, v))
+    { continue; }
+
+    const size_t degree = CSRGraph_edges(bfs->reverse, v, &parents, &weights);
+
+    for (size_t j = 0; j < degree; ++j) {
+      if (!__is_set(bfs->front, parents[j]))
+      { continue; }
+
+      /* Range has whole words, nobody else sets this bit. */
+      atomic_fetch_or_explicit(&bfs->visited[WORD(v)], BIT(v), memory_order_relaxed);
+      bfs->levels[v] = bfs->level + 1;
+      local[count++] = v;
+
+      if (count == LOCAL_QUEUE) {
+        __flush(bfs, local, count, 0);
+        count = 0;
+      }
+      break;
+    }
+  }
+
+  __flush(bfs, local, count, 0);
+}
+
+static void
+__clear_front(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct bfs* bfs = arg;
+  (void)worker;
+
+  for (size_t i = begin; i < end; ++i) {
+    atomic_store_explicit(&bfs->front[i], 0, memory_order_relaxed);
+  }
+}
+
+static void
+__fill_front(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct bfs* bfs = arg;
+  (void)worker;
+
+  for (size_t i = begin; i < end; ++i) {
+    const vertex v = bfs->queue[i];
+    atomic_fetch_or_explicit(&bfs->front[WORD(v)], BIT(v), memory_order_relaxed);
+  }
+}
+
+/* Next frontier becomes the frontier. */
+static void
+__bfs_swap(struct bfs* bfs)
+{
+  vertex* tmp = bfs->queue;
+
+  bfs->queue = bfs->next;
+  bfs->queue_size = atomic_load_explicit(&bfs->next_size, memory_order_relaxed);
+  bfs->next = tmp;
+
+  atomic_store_explicit(&bfs->next_size, 0, memory_order_relaxed);
+  atomic_store_explicit(&bfs->scout, 0, memory_order_relaxed);
+  bfs->level++;
+}
+
+/* Return number of edges out of the new frontier, top-down only. */
+static size_t
+__bfs_step(ThreadPool_T pool, struct bfs* bfs, bool bottom_up)
+{
+  if (bottom_up) {
+    ThreadPool_for(pool, WORDS(bfs->vertices), VERTEX_GRAIN / 64, __clear_front, bfs);
+    ThreadPool_for(pool, bfs->queue_size, VERTEX_GRAIN, __fill_front, bfs);
+    ThreadPool_for(pool, bfs->vertices, VERTEX_GRAIN, __bottom_up, bfs);
+  } else {
+    ThreadPool_for(pool, bfs->queue_size, FRONTIER_GRAIN, __top_down, bfs);
+  }
+
+  const size_t scout = atomic_load_explicit(&bfs->scout, memory_order_relaxed);
+  __bfs_swap(bfs);
+
+  return scout;
+}
+
+/* __________________________________________________________________________ */
+/*                                                            Delta-stepping  */
+
+/* Vertices of one bucket found by one thread. */
+struct bin {
+  vertex* items;
+  size_t count;
+  size_t size;
+};
+
+/* Buckets of one thread. */
+struct bins {
+  _Alignas(CACHE_LINE) struct bin* bins;
+  size_t count;
+};
+
+struct sssp {
+  CSRGraph_T graph;
+  _Atomic int64_t* distances;
+  int64_t delta;
+  size_t bucket;
+
+  vertex* frontier;
+  size_t frontier_size;
+  size_t frontier_capacity;
+
+  struct bins* locals;
+};
+
+static void
+__push(struct bins* local, size_t bucket, vertex v)
+{
+  if (bucket >= local->count) {
+    size_t count = (local->count > 0) ? local->count : 8;
+
+    while (count <= bucket) {
+      count *= 2;
+    }
+
+    if (local->bins == NULL)
+    { local->bins = ALLOC(count * sizeof (struct bin)); }
+    else
+    { RESIZE(local->bins, count * sizeof (struct bin)); }
+
+    for (size_t i = local->count; i < count; ++i) {
+      local->bins[i].items = NULL;
+      local->bins[i].count = local->bins[i].size = 0;
+    }
+
+    local->count = count;
+  }
+
+  struct bin* bin = &local->bins[bucket];
+
+  if (bin->count == bin->size) {
+    if (bin->items == NULL) {
+      bin->size = 64;
+      bin->items = ALLOC(bin->size * sizeof (vertex));
+    } else {
+      bin->size *= 2;
+      RESIZE(bin->items, bin->size * sizeof (vertex));
+    }
+  }
+
+  bin->items[bin->count++] = v;
+}
+
+static void
+__relax(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct sssp* sssp = arg;
+  const int64_t low = sssp->delta * (int64_t)sssp->bucket;
+  const vertex* targets;
+  const int16_t* weights;
+
+  for (size_t i = begin; i < end; ++i) {
+    const vertex v = sssp->frontier[i];
+    const int64_t distance = atomic_load_explicit(&sssp->distances[v], memory_order_relaxed);
+
+    /* Settled in a lower bucket already. */
+    if (distance < low)
+    { continue; }
+
+    const size_t degree = CSRGraph_edges(sssp->graph, v, &targets, &weights);
+
+    for (size_t j = 0; j < degree; ++j) {
+      Require(weights[j] >= 0);
+
+      const int64_t candidate = distance + weights[j];
+      int64_t current = atomic_load_explicit(&sssp->distances[targets[j]], memory_order_relaxed);
+
+      while (candidate < current) {
+        if (atomic_compare_exchange_weak_explicit(&sssp->distances[targets[j]], &current,
+                                                  candidate, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+          __push(&sssp->locals[worker], (size_t)(candidate / sssp->delta), targets[j]);
+          break;
+        }
+      }
+    }
+  }
+}
+
+/* Lowest bucket that is not empty or SIZE_MAX. */
+static size_t
+__next_bucket(struct sssp* sssp, size_t threads)
+{
+  size_t next = SIZE_MAX;
+
+  for (size_t t = 0; t < threads; ++t) {
+    const struct bins* local = &sssp->locals[t];
+
+    for (size_t b = sssp->bucket; b < local->count && b < next; ++b) {
+      if (local->bins[b].count > 0) {
+        next = b;
+        break;
+      }
+    }
+  }
+
+  return next;
+}
+
+/* Moves vertices of the bucket of all threads to the frontier. */
+static void
+__gather(struct sssp* sssp, size_t threads)
+{
+  size_t size = 0;
+
+  for (size_t t = 0; t < threads; ++t) {
+    if (sssp->bucket < sssp->locals[t].count)
+    { size += sssp->locals[t].bins[sssp->bucket].count; }
+  }
+
+  if (size > sssp->frontier_capacity) {
+    sssp->frontier_capacity = 2 * size;
+    RESIZE(sssp->frontier, sssp->frontier_capacity * sizeof (vertex));
+  }
+
+  sssp->frontier_size = 0;
+
+  for (size_t t = 0; t < threads; ++t) {
+    if (sssp->bucket >= sssp->locals[t].count)
+    { continue; }
+
+    struct bin* bin = &sssp->locals[t].bins[sssp->bucket];
+
+    /* Bin that got no vertex has no items. */
+    if (bin->count == 0)
+    { continue; }
+
+    memcpy(&sssp->frontier[sssp->frontier_size], bin->items, bin->count * sizeof (vertex));
+    sssp->frontier_size += bin->count;
+    bin->count = 0;
+  }
+}
+
+/* Also after an exception, what is not allocated yet is NULL. */
+static void
+__sssp_free(struct sssp* sssp, size_t threads)
+{
+  for (size_t t = 0; sssp->locals != NULL && t < threads; ++t) {
+    for (size_t b = 0; b < sssp->locals[t].count; ++b) {
+      if (sssp->locals[t].bins[b].items != NULL)
+      { FREE(sssp->locals[t].bins[b].items); }
+    }
+
+    if (sssp->locals[t].bins != NULL)
+    { FREE(sssp->locals[t].bins); }
+  }
+
+  FREE_ALIGNED(sssp->locals);
+  FREE(sssp->frontier);
+}
+
+/* __________________________________________________________________________ */
+/*                                                     Connected components  */
+
+struct components {
+  CSRGraph_T graph;
+  _Atomic vertex* parents;
+  vertex* labels;
+  _Atomic size_t roots;
+};
+
+/* Root of `v`. Halves the path on the way, parents only get lower. */
+static vertex
+__find(_Atomic vertex* parents, vertex v)
+{
+  for (;;) {
+    vertex parent = atomic_load_explicit(&parents[v], memory_order_relaxed);
+
+    if (parent == v)
+    { return v; }
+
+    const vertex grandparent = atomic_load_explicit(&parents[parent], memory_order_relaxed);
+
+    if (grandparent != parent) {
+      atomic_compare_exchange_weak_explicit(&parents[v], &parent, grandparent,
+                                            memory_order_relaxed, memory_order_relaxed);
+    }
+
+    v = grandparent;
+  }
+}
+
+/* Higher root is linked under the lower one, so roots are lowest vertices. */
+static void
+__link(_Atomic vertex* parents, vertex u, vertex v)
+{
+  for (;;) {
+    u = __find(parents, u);
+    v = __find(parents, v);
+
+    if (u == v)
+    { return; }
+
+    if (u < v) {
+      const vertex tmp = u;
+      u = v;
+      v = tmp;
+    }
+
+    vertex expected = u;
+
+    if (atomic_compare_exchange_strong_explicit(&parents[u], &expected, v,
+                                                memory_order_relaxed, memory_order_relaxed))
+    { return; }
+  }
+}
+
+static void
+__components_init(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct components* components = arg;
+  (void)worker;
+
+  for (vertex v = begin; v < end; ++v) {
+    atomic_init(&components->parents[v], v);
+  }
+}
+
+static void
+__components_link(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct components* components = arg;
+  const bool undirected = (CSRGraph_type(components->graph) == UNDIRECTED);
+  const vertex* targets;
+  const int16_t* weights;
+  (void)worker;
+
+  for (vertex v = begin; v < end; ++v) {
+    const size_t degree = CSRGraph_edges(components->graph, v, &targets, &weights);
+
+    for (size_t j = 0; j < degree; ++j) {
+
+      /* Mirror is linked from the other side. */
+      if (undirected && targets[j] > v)
+      { break; }
+
+      __link(components->parents, v, targets[j]);
+    }
+  }
+}
+
+static void
+__components_label(void* arg, size_t begin, size_t end, size_t worker)
+{
+  struct components* components = arg;
+  size_t roots = 0;
+  (void)worker;
+
+  for (vertex v = begin; v < end; ++v) {
+    components->labels[v] = __find(components->parents, v);
+
+    if (components->labels[v] == v)
+    { roots++; }
+  }
+
+  atomic_fetch_add_explicit(&components->roots, roots, memory_order_relaxed);
+}
+
+/* __________________________________________________________________________ */
+
+size_t
+Graph_bfs(CSRGraph_T graph, CSRGraph_T reverse, vertex source, ThreadPool_T pool,
+          size_t* levels__)
+{
+  Require(graph);
+  Require(levels__);
+
+  struct bfs bfs;
+  size_t edges;
+
+  CSRGraph_size(graph, &bfs.vertices, &edges);
+  Require(source < bfs.vertices);
+
+  bfs.graph = graph;
+  bfs.reverse = (CSRGraph_type(graph) == UNDIRECTED) ? graph : reverse;
+  bfs.levels = levels__;
+  bfs.level = 0;
+
+  bfs.visited = __bitmap_new(bfs.vertices);
+  bfs.front = (bfs.reverse != NULL) ? __bitmap_new(bfs.vertices) : NULL;
+  bfs.queue = ALLOC(bfs.vertices * sizeof (vertex));
+  bfs.next = ALLOC(bfs.vertices * sizeof (vertex));
+  atomic_init(&bfs.next_size, 0);
+  atomic_init(&bfs.scout, 0);
+
+  ThreadPool_for(pool, bfs.vertices, VERTEX_GRAIN, __bfs_init, &bfs);
+
+  const vertex* targets;
+  const int16_t* weights;
+
+  __set(bfs.visited, source);
+  levels__[source] = 0;
+  bfs.queue[0] = source;
+  bfs.queue_size = 1;
+
+  size_t reached = 1;
+  size_t edges_to_check = __arcs(graph);
+  size_t scout = CSRGraph_edges(graph, source, &targets, &weights);
+
+  while (bfs.queue_size > 0) {
+
+    if (bfs.reverse != NULL && scout > edges_to_check / BFS_ALPHA) {
+      size_t awake = bfs.queue_size;
+      size_t old_awake;
+
+      /* Bottom-up while the frontier grows or is large. */
+      do {
+        old_awake = awake;
+
+        __bfs_step(pool, &bfs, true);
+        awake = bfs.queue_size;
+        reached += awake;
+
+      } while (awake > 0 && (awake >= old_awake || awake > bfs.vertices / BFS_BETA));
+
+      scout = 1;
+
+    } else {
+      edges_to_check -= (scout < edges_to_check) ? scout : edges_to_check;
+
+      scout = __bfs_step(pool, &bfs, false);
+      reached += bfs.queue_size;
+    }
+  }
+
+  FREE(bfs.next);
+  FREE(bfs.queue);
+
+  if (bfs.front != NULL)
+  { FREE(bfs.front); }
+
+  FREE(bfs.visited);
+
+  return reached;
+}
+
+size_t
+Graph_shortest_paths(CSRGraph_T graph, vertex source, int64_t delta, ThreadPool_T pool,
+                     int64_t* distances__)
+{
+  Require(graph);
+  Require(delta > 0);
+  Require(distances__);
+
+  const size_t threads = ThreadPool_threads(pool);
+
+  struct sssp sssp;
+  size_t vertices, edges;
+
+  CSRGraph_size(graph, &vertices, &edges);
+  Require(source < vertices);
+
+  sssp.graph = graph;
+  sssp.delta = delta;
+  sssp.bucket = 0;
+
+  sssp.distances = ALLOC(vertices * sizeof (_Atomic int64_t));
+  sssp.frontier = NULL;
+  sssp.locals = NULL;
+
+  TRY
+    for (vertex v = 0; v < vertices; ++v) {
+      atomic_init(&sssp.distances[v], GRAPH_INFINITY);
+    }
+
+    sssp.frontier_capacity = 64;
+    sssp.frontier = ALLOC(sssp.frontier_capacity * sizeof (vertex));
+    sssp.frontier[0] = source;
+    sssp.frontier_size = 1;
+
+    sssp.locals = ALLOC_ALIGNED(CACHE_LINE, threads * sizeof (struct bins));
+
+    for (size_t t = 0; t < threads; ++t) {
+      sssp.locals[t].bins = NULL;
+      sssp.locals[t].count = 0;
+    }
+
+    atomic_store_explicit(&sssp.distances[source], 0, memory_order_relaxed);
+
+    for (;;) {
+      ThreadPool_for(pool, sssp.frontier_size, FRONTIER_GRAIN, __relax, &sssp);
+
+      sssp.bucket = __next_bucket(&sssp, threads);
+
+      if (sssp.bucket == SIZE_MAX)
+      { break; }
+
+      __gather(&sssp, threads);
+    }
+
+  ELSE
+    /* Bins grow in the loop, they are not lost if that fails. */
+    __sssp_free(&sssp, threads);
+    FREE(sssp.distances);
+    RETHROW;
+  END_TRY;
+
+  __sssp_free(&sssp, threads);
+
+  size_t reached = 0;
+
+  for (vertex v = 0; v < vertices; ++v) {
+    distances__[v] = atomic_load_explicit(&sssp.distances[v], memory_order_relaxed);
+
+    if (distances__[v] != GRAPH_INFINITY)
+    { reached++; }
+  }
+
+  FREE(sssp.distances);
+
+  return reached;
+}
+
+size_t
+Graph_components(CSRGraph_T graph, ThreadPool_T pool, vertex* labels__)
+{
+  Require(graph);
+  Require(labels__);
+
+  struct components components;
+  size_t vertices, edges;
+
+  CSRGraph_size(graph, &vertices, &edges);
+
+  components.graph = graph;
+  components.parents = ALLOC((vertices > 0 ? vertices : 1) * sizeof (_Atomic vertex));
+  components.labels = labels__;
+  atomic_init(&components.roots, 0);
+
+  ThreadPool_for(pool, vertices, VERTEX_GRAIN, __components_init, &components);
+  ThreadPool_for(pool, vertices, VERTEX_GRAIN, __components_link, &components);
+  ThreadPool_for(pool, vertices, VERTEX_GRAIN, __components_label, &components);
+
+  FREE(components.parents);
+
+  return atomic_load_explicit(&components.roots, memory_order_relaxed);
+}
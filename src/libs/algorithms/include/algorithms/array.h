@@ -1,16 +1,89 @@
 /**
  * @file    array.h
  * @brief   Contains array algorithms.
+ *
+ * Reductions and prefix sums over `int`, `int64_t` and `double` arrays use
+ * SSE2 or AVX2 when the processor has them, checked at run time, and plain
+ * loops otherwise. Results do not depend on the instruction set, except for
+ * sums of doubles, which are added in a different order, and the sign of a
+ * zero minimum or maximum of doubles when the array has both -0.0 and 0.0.
+ * For doubles NaN gives unspecified results.
  */
 #if !defined(ALGORITHMS_ARRAY_H)
 #define ALGORITHMS_ARRAY_H
 
+#include <stddef.h>      /* size_t  */
+#include <stdint.h>      /* int64_t */
+
 #ifdef __cplusplus
 extern "C" {
 #endif        /* __cplusplus */
 
 void minmax(int numlist[], int n, int* p_min_, int* p_max_);
 
+/* Instruction sets, each includes the ones before. */
+typedef enum { SIMD_NONE, SIMD_SSE2, SIMD_AVX2 } simd_et;
+
+/**
+ * Return the instruction set the kernels use.
+ */
+extern simd_et Array_simd(void);
+
+/**
+ * @brief    Use at most `simd`, for tests and benchmarks.
+ *
+ * Instruction sets the processor does not have are never used. Call it
+ * before other threads use the kernels.
+ */
+extern void Array_set_simd(simd_et simd);
+
+/**
+ * @brief    Smallest, largest or both of `n` elements.
+ *
+ * It is checked runtime error if `n` is 0.
+ */
+extern int Array_min_int(const int* values, size_t n);
+extern int64_t Array_min_int64(const int64_t* values, size_t n);
+extern double Array_min_double(const double* values, size_t n);
+
+extern int Array_max_int(const int* values, size_t n);
+extern int64_t Array_max_int64(const int64_t* values, size_t n);
+extern double Array_max_double(const double* values, size_t n);
+
+extern void Array_minmax_int(const int* values, size_t n, int* p_min__, int* p_max__);
+extern void Array_minmax_int64(const int64_t* values, size_t n, int64_t* p_min__, int64_t* p_max__);
+extern void Array_minmax_double(const double* values, size_t n, double* p_min__, double* p_max__);
+
+/**
+ * @brief    Index of the first smallest of `n` elements.
+ *
+ * Elements are compared with `<` and `==`, so -0.0 and 0.0 are equal.
+ *
+ * It is checked runtime error if `n` is 0.
+ */
+extern size_t Array_argmin_int(const int* values, size_t n);
+extern size_t Array_argmin_int64(const int64_t* values, size_t n);
+extern size_t Array_argmin_double(const double* values, size_t n);
+
+/**
+ * @brief    Sum of `n` elements, 0 if there are none.
+ *
+ * `int` elements are added as `int64_t`, `int64_t` ones wrap around on
+ * overflow.
+ */
+extern int64_t Array_sum_int(const int* values, size_t n);
+extern int64_t Array_sum_int64(const int64_t* values, size_t n);
+extern double Array_sum_double(const double* values, size_t n);
+
+/**
+ * @brief    Store in `sums__[i]` the sum of `values[0] ... values[i]`.
+ *
+ * `sums__` could be `values`. Integer sums wrap around on overflow.
+ */
+extern void Array_prefix_sum_int(const int* values, size_t n, int* sums__);
+extern void Array_prefix_sum_int64(const int64_t* values, size_t n, int64_t* sums__);
+extern void Array_prefix_sum_double(const double* values, size_t n, double* sums__);
+
 #ifdef __cplusplus
 }
 #endif        /* __cplusplus */
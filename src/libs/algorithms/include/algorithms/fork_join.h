@@ -0,0 +1,85 @@
+/**
+ * @file    fork_join.h
+ * @brief   Fork-join tasks on work-stealing threads.
+ *
+ * `ForkJoin_run` runs a task on the pool. A task splits its work with
+ * `ForkJoin_join`, which could run the two halves on different threads and
+ * returns when both are done, so divide and conquer code keeps its shape:
+ *
+ *     static void sum(void* arg)
+ *     {
+ *       ...
+ *       ForkJoin_join(sum, &left, sum, &right);
+ *       range->sum = left.sum + right.sum;
+ *     }
+ *
+ * Every thread has a deque of tasks (`ws_deque.h`). The second half of a
+ * join is pushed there and the first half is run at once; if no other
+ * thread stole the second half meanwhile it is popped and run too, which
+ * costs about as much as a function call. Threads without work steal the
+ * oldest, usually the biggest, tasks of others. A thread waiting on a
+ * stolen half runs other tasks in the meantime.
+ *
+ * Threads look for work until the task given to `ForkJoin_run` returns and
+ * sleep between runs. Tasks must not throw out of themselves; exceptions do
+ * not cross threads. One pool runs one task at a time.
+ */
+#if !defined(ALGORITHMS_FORK_JOIN_H)
+#define ALGORITHMS_FORK_JOIN_H
+
+#include <stddef.h>      /* size_t */
+#include "lang/except.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif        /* __cplusplus */
+
+typedef struct fork_join* ForkJoin_T;
+
+extern const Except_T ForkJoin_Failed;
+
+typedef void (*task_FN)(void* arg);
+
+/**
+ * @brief    Start `threads - 1` threads.
+ *
+ * If `threads` is 0 as many threads as processors are online.
+ */
+extern ForkJoin_T ForkJoin_new(size_t threads);
+
+/**
+ * Return number of threads that run tasks, caller included. It is 1 for
+ * NULL pool.
+ */
+extern size_t ForkJoin_threads(ForkJoin_T pool);
+
+/**
+ * @brief    Call `task_fn` with `arg` on the pool and wait for it.
+ *
+ * The calling thread is one of the pool threads until it returns. With
+ * NULL pool, or when called from a task of the pool, `task_fn` is simply
+ * called.
+ */
+extern void ForkJoin_run(ForkJoin_T pool, task_FN task_fn, void* arg);
+
+/**
+ * @brief    Call `first_fn` with `first_arg` and `second_fn` with
+ *           `second_arg`, maybe in parallel, and return when both are done.
+ *
+ * Outside of `ForkJoin_run` both are called one after the other.
+ */
+extern void ForkJoin_join(task_FN first_fn, void* first_arg,
+                          task_FN second_fn, void* second_arg);
+
+/**
+ * @brief    Stop the threads and free the pool.
+ *
+ * Waits for the threads to finish.
+ */
+extern void ForkJoin_free(ForkJoin_T* p_pool);
+
+#ifdef __cplusplus
+}
+#endif        /* __cplusplus */
+
+#endif  /* ALGORITHMS_FORK_JOIN_H */
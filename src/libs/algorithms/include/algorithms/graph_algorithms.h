@@ -0,0 +1,74 @@
+/**
+ * @file    graph_algorithms.h
+ * @brief   Parallel traversals of CSR graphs.
+ *
+ * Algorithms run on `CSRGraph_T`, build it from `Graph_T` with
+ * `CSRGraph_from_graph` first. Loops run on the given thread pool; with NULL
+ * pool they run in the calling thread. Results do not depend on the number
+ * of threads.
+ */
+#if !defined(ALGORITHMS_GRAPH_ALGORITHMS_H)
+#define ALGORITHMS_GRAPH_ALGORITHMS_H
+
+#include <stddef.h>      /* size_t            */
+#include <stdint.h>      /* int64_t, SIZE_MAX */
+#include "data_structs/graph_csr.h"
+#include "algorithms/thread_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif        /* __cplusplus */
+
+/* Level of a vertex that is not reached. */
+#define GRAPH_UNREACHED  SIZE_MAX
+
+/* Distance to a vertex that is not reached. */
+#define GRAPH_INFINITY   INT64_MAX
+
+/**
+ * @brief    Breadth first search from `source`.
+ *
+ * Stores in `levels__` (one per vertex) number of edges on the shortest
+ * path from `source`. Returns number of reached vertices, `source`
+ * included.
+ *
+ * Direction optimizing: while the frontier is small its edges are followed
+ * (top-down). When edges out of the frontier outnumber edges left to check,
+ * every vertex that is not reached looks for a parent in the frontier
+ * instead and stops at the first one (bottom-up). That needs edges into a
+ * vertex, so for directed graph pass `CSRGraph_transpose(graph)` as
+ * `reverse`. With NULL `reverse` directed graph is searched top-down only.
+ * `reverse` is not used for undirected graph.
+ */
+extern size_t Graph_bfs(CSRGraph_T graph, CSRGraph_T reverse, vertex source,
+                        ThreadPool_T pool, size_t* levels__);
+
+/**
+ * @brief    Shortest paths from `source` (delta-stepping).
+ *
+ * Weights must not be negative. Stores in `distances__` (one per vertex)
+ * sum of weights on the shortest path from `source`. Returns number of
+ * reached vertices, `source` included.
+ *
+ * Vertices are kept in buckets of distances `[i * delta, (i + 1) * delta)`
+ * and the lowest bucket is relaxed in parallel until it stays empty. Small
+ * `delta` does less useless work but has less parallelism; a few times the
+ * average weight is a good start.
+ */
+extern size_t Graph_shortest_paths(CSRGraph_T graph, vertex source, int64_t delta,
+                                   ThreadPool_T pool, int64_t* distances__);
+
+/**
+ * @brief    Connected components.
+ *
+ * Stores in `labels__` (one per vertex) the lowest vertex of its component.
+ * For directed graph components are weakly connected. Returns number of
+ * components.
+ */
+extern size_t Graph_components(CSRGraph_T graph, ThreadPool_T pool, vertex* labels__);
+
+#ifdef __cplusplus
+}
+#endif        /* __cplusplus */
+
+#endif  /* ALGORITHMS_GRAPH_ALGORITHMS_H */
@@ -0,0 +1,67 @@
+/**
+ * @file    thread_pool.h
+ * @brief   Fixed set of threads that run parallel loops.
+ *
+ * `ThreadPool_for` splits `0 ... n - 1` into ranges of `grain` indexes.
+ * Threads take the next range from a shared counter until none is left, so
+ * a slow range does not hold the others. The calling thread works too and
+ * the call returns when all ranges are done.
+ *
+ * Loops are not nested: a range function must not call `ThreadPool_for` of
+ * the same pool. One pool is used by one thread at a time.
+ */
+#if !defined(ALGORITHMS_THREAD_POOL_H)
+#define ALGORITHMS_THREAD_POOL_H
+
+#include <stddef.h>      /* size_t */
+#include "lang/except.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif        /* __cplusplus */
+
+typedef struct thread_pool* ThreadPool_T;
+
+extern const Except_T ThreadPool_Failed;
+
+/*
+ * Called for indexes `begin ... end - 1`. `worker` is below the number of
+ * pool threads and is the same for all ranges run by one thread, so it
+ * could index per thread buffers. The caller is worker 0.
+ */
+typedef void (*range_FN)(void* arg, size_t begin, size_t end, size_t worker);
+
+/**
+ * @brief    Start `threads - 1` threads.
+ *
+ * If `threads` is 0 as many threads as processors are online.
+ */
+extern ThreadPool_T ThreadPool_new(size_t threads);
+
+/**
+ * Return number of threads that run a loop, caller included. It is 1 for
+ * NULL pool.
+ */
+extern size_t ThreadPool_threads(ThreadPool_T pool);
+
+/**
+ * @brief    Call `range_fn` for all ranges of `0 ... n - 1`.
+ *
+ * With NULL pool or when there is only one range, `range_fn` is called
+ * once, from the caller, with the whole loop.
+ */
+extern void ThreadPool_for(ThreadPool_T pool, size_t n, size_t grain,
+                           range_FN range_fn, void* arg);
+
+/**
+ * @brief    Stop the threads and free the pool.
+ *
+ * Waits for the threads to finish.
+ */
+extern void ThreadPool_free(ThreadPool_T* p_pool);
+
+#ifdef __cplusplus
+}
+#endif        /* __cplusplus */
+
+#endif  /* ALGORITHMS_THREAD_POOL_H */
@@ -0,0 +1,55 @@
+/**
+ * @file    tree_algorithms.h
+ * @brief   Parallel traversal of binary trees and set operations of
+ *          ordered trees.
+ *
+ * Tasks run on the given fork-join pool; with NULL pool they run in the
+ * calling thread.
+ */
+#if !defined(ALGORITHMS_TREE_ALGORITHMS_H)
+#define ALGORITHMS_TREE_ALGORITHMS_H
+
+#include "data_structs/binary_tree.h"
+#include "data_structs/ord_tree.h"
+#include "algorithms/fork_join.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif        /* __cplusplus */
+
+/**
+ * @brief    Call `apply_fn` for every element of `btree`, from all threads.
+ *
+ * Near the root every node is a task that runs its two subtrees with
+ * `ForkJoin_join`; deeper, a subtree is traversed in preorder by one thread
+ * with `BinTree_traverse_batch`. So elements come in no particular order
+ * and `apply_fn` should be safe to call from several threads at once.
+ *
+ * When `apply_fn` returns `false` no new elements are passed, calls that
+ * already started finish, and `false` is returned.
+ */
+extern bool BinTree_parallel_traverse(ForkJoin_T pool, BinTree_T btree,
+                                      bool (*apply_fn)(Object_T));
+
+/**
+ * @brief    `OrdTree_union` with halves of big trees joined on `pool`.
+ *
+ * Calling thread waits for the result, the other tree is freed.
+ */
+extern void OrdTree_parallel_union(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other);
+
+/**
+ * @brief    `OrdTree_intersection` with halves of big trees joined on `pool`.
+ */
+extern void OrdTree_parallel_intersection(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other);
+
+/**
+ * @brief    `OrdTree_difference` with halves of big trees joined on `pool`.
+ */
+extern void OrdTree_parallel_difference(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other);
+
+#ifdef __cplusplus
+}
+#endif        /* __cplusplus */
+
+#endif  /* ALGORITHMS_TREE_ALGORITHMS_H */
@@ -0,0 +1,309 @@
+#include "algorithms/array.h"
+
+#include <math.h>      /* NAN */
+#include <stdbool.h>
+#include <stdint.h>
+#include <greatest.h>
+
+#define MAX_LENGTH  10000
+
+static const simd_et levels[] = { SIMD_NONE, SIMD_SSE2, SIMD_AVX2 };
+static const size_t lengths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 100, 4095,
+                                  4096, 4097, 8200, MAX_LENGTH };
+
+static int ints[MAX_LENGTH];
+static int64_t longs[MAX_LENGTH];
+static double doubles[MAX_LENGTH];
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t
+__rand(void)
+{
+  seed ^= seed >> 12;
+  seed ^= seed << 25;
+  seed ^= seed >> 27;
+
+  return seed * 0x2545F4914F6CDD1DULL;
+}
+
+/* Whole numbers, so sums of doubles are exact in any order. */
+static void
+__fill(void)
+{
+  for (size_t i = 0; i < MAX_LENGTH; ++i) {
+    ints[i] = (int)(uint32_t)__rand();
+    longs[i] = (int64_t)__rand();
+    doubles[i] = (double)((int64_t)(__rand() % 2000001) - 1000000);
+  }
+}
+
+/* Plain loops to compare with. */
+static bool
+__check_minmax(size_t n)
+{
+  int min = ints[0], max = ints[0];
+  int64_t min64 = longs[0], max64 = longs[0];
+  double mind = doubles[0], maxd = doubles[0];
+  size_t argmin = 0, argmin64 = 0, argmind = 0;
+
+  for (size_t i = 1; i < n; ++i) {
+    if (ints[i] < min) { min = ints[i]; argmin = i; }
+    if (ints[i] > max) { max = ints[i]; }
+    if (longs[i] < min64) { min64 = longs[i]; argmin64 = i; }
+    if (longs[i] > max64) { max64 = longs[i]; }
+    if (doubles[i] < mind) { mind = doubles[i]; argmind = i; }
+    if (doubles[i] > maxd) { maxd = doubles[i]; }
+  }
+
+  int lo, hi;
+  int64_t lo64, hi64;
+  double lod, hid;
+
+  Array_minmax_int(ints, n, &lo, &hi);
+  Array_minmax_int64(longs, n, &lo64, &hi64);
+  Array_minmax_double(doubles, n, &lod, &hid);
+
+  return lo == min && hi == max && lo64 == min64 && hi64 == max64 && lod == mind && hid == maxd
+         && Array_min_int(ints, n) == min && Array_max_int(ints, n) == max
+         && Array_min_int64(longs, n) == min64 && Array_max_int64(longs, n) == max64
+         && Array_min_double(doubles, n) == mind && Array_max_double(doubles, n) == maxd
+         && Array_argmin_int(ints, n) == argmin
+         && Array_argmin_int64(longs, n) == argmin64
+         && Array_argmin_double(doubles, n) == argmind;
+}
+
+static bool
+__check_sums(size_t n)
+{
+  int64_t sum = 0;
+  uint64_t sum64 = 0;
+  double sumd = 0.0;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += ints[i];
+    sum64 += (uint64_t)longs[i];
+    sumd += doubles[i];
+  }
+
+  return Array_sum_int(ints, n) == sum
+         && Array_sum_int64(longs, n) == (int64_t)sum64
+         && Array_sum_double(doubles, n) == sumd;
+}
+
+static bool
+__check_prefix_sums(size_t n)
+{
+  static int sums[MAX_LENGTH];
+  static int64_t sums64[MAX_LENGTH];
+  static double sumsd[MAX_LENGTH];
+
+  Array_prefix_sum_int(ints, n, sums);
+  Array_prefix_sum_int64(longs, n, sums64);
+  Array_prefix_sum_double(doubles, n, sumsd);
+
+  unsigned sum = 0;
+  uint64_t sum64 = 0;
+  double sumd = 0.0;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += (unsigned)ints[i];
+    sum64 += (uint64_t)longs[i];
+    sumd += doubles[i];
+
+    if (sums[i] != (int)sum || sums64[i] != (int64_t)sum64 || sumsd[i] != sumd)
+    { return false; }
+  }
+
+  return true;
+}
+
+TEST level(void)
+{
+  const simd_et supported = Array_simd();
+
+  Array_set_simd(SIMD_NONE);
+  ASSERT_EQ(SIMD_NONE, Array_simd());
+
+  Array_set_simd(SIMD_AVX2);
+  ASSERT_EQ(supported, Array_simd());
+  PASS();
+}
+
+TEST reductions(void)
+{
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    for (size_t k = 0; k < sizeof (lengths) / sizeof (lengths[0]); ++k) {
+      __fill();
+
+      ASSERT(__check_minmax(lengths[k]));
+      ASSERT(__check_sums(lengths[k]));
+      ASSERT(__check_prefix_sums(lengths[k]));
+    }
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+TEST extremes(void)
+{
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    for (size_t i = 0; i < 100; ++i) {
+      ints[i] = INT32_MAX;
+      longs[i] = INT64_MAX;
+    }
+
+    /* Sum of `int` does not overflow, of `int64_t` wraps. */
+    ASSERT_EQ((int64_t)INT32_MAX * 100, Array_sum_int(ints, 100));
+    ASSERT_EQ((int64_t)((uint64_t)INT64_MAX * 100), Array_sum_int64(longs, 100));
+
+    ints[50] = INT32_MIN;
+    longs[99] = INT64_MIN;
+
+    ASSERT_EQ(INT32_MIN, Array_min_int(ints, 100));
+    ASSERT_EQ(INT64_MIN, Array_min_int64(longs, 100));
+    ASSERT_EQ(INT64_MAX, Array_max_int64(longs, 100));
+
+    ASSERT_EQ(0, Array_sum_int(ints, 0));
+    ASSERT_EQ(0.0, Array_sum_double(doubles, 0));
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+/* First of equal ones, also when they are in different blocks. */
+TEST argmin(void)
+{
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    for (size_t i = 0; i < MAX_LENGTH; ++i) {
+      ints[i] = (int)(i % 7);
+      longs[i] = 5;
+      doubles[i] = 1.5;
+    }
+
+    longs[5000] = -1;
+    longs[9000] = -1;
+    doubles[4096] = -2.0;
+    doubles[4095] = -2.0;
+
+    ASSERT_EQ(0, Array_argmin_int(ints, MAX_LENGTH));
+    ASSERT_EQ(7, Array_argmin_int(&ints[1], MAX_LENGTH - 1) + 1);
+    ASSERT_EQ(5000, Array_argmin_int64(longs, MAX_LENGTH));
+    ASSERT_EQ(4095, Array_argmin_double(doubles, MAX_LENGTH));
+    ASSERT_EQ(0, Array_argmin_double(doubles, 1));
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+/* Sign of a zero extreme depends on the version, its index does not. */
+TEST signed_zeros(void)
+{
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    for (size_t i = 0; i < 100; ++i) {
+      doubles[i] = (double)(i + 1);
+    }
+
+    doubles[3] = 0.0;
+    doubles[10] = -0.0;
+    doubles[51] = 0.0;
+
+    ASSERT_EQ(3, Array_argmin_double(doubles, 100));
+    ASSERT_EQ(10, Array_argmin_double(&doubles[4], 96) + 4);
+    ASSERT_EQ(0.0, Array_min_double(doubles, 100));
+
+    for (size_t i = 0; i < 100; ++i) {
+      doubles[i] = -doubles[i];
+    }
+
+    ASSERT_EQ(0.0, Array_max_double(doubles, 100));
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+TEST in_place(void)
+{
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    for (size_t i = 0; i < 1000; ++i) {
+      ints[i] = 1;
+      doubles[i] = 2.0;
+    }
+
+    Array_prefix_sum_int(ints, 1000, ints);
+    Array_prefix_sum_double(doubles, 1000, doubles);
+
+    for (size_t i = 0; i < 1000; ++i) {
+      ASSERT_EQ((int)i + 1, ints[i]);
+      ASSERT_EQ(2.0 * (double)(i + 1), doubles[i]);
+    }
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+TEST old_minmax(void)
+{
+  int numlist[] = { 4, -3, 9, 0, 12, -7, 5 };
+  int min, max;
+
+  minmax(numlist, 7, &min, &max);
+  ASSERT_EQ(-7, min);
+  ASSERT_EQ(12, max);
+  PASS();
+}
+
+/* Result is unspecified with NaN, but it is an index of the array. */
+TEST argmin_nan(void)
+{
+  const double leading[] = { NAN, 3, 1, 2, 5 };
+
+  for (size_t l = 0; l < sizeof (levels) / sizeof (levels[0]); ++l) {
+    Array_set_simd(levels[l]);
+
+    ASSERT(Array_argmin_double(leading, 5) < 5);
+    ASSERT(Array_argmin_double(leading, 1) < 1);
+
+    for (size_t i = 0; i < MAX_LENGTH; ++i) {
+      doubles[i] = (double)(MAX_LENGTH - i);
+    }
+
+    doubles[0] = NAN;
+    doubles[4096] = NAN;
+    ASSERT(Array_argmin_double(doubles, MAX_LENGTH) < MAX_LENGTH);
+    ASSERT(Array_argmin_double(doubles, 4097) < 4097);
+  }
+
+  Array_set_simd(SIMD_AVX2);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(level);
+  RUN_TEST(reductions);
+  RUN_TEST(extremes);
+  RUN_TEST(argmin);
+  RUN_TEST(argmin_nan);
+  RUN_TEST(signed_zeros);
+  RUN_TEST(in_place);
+  RUN_TEST(old_minmax);
+  GREATEST_MAIN_END();
+}
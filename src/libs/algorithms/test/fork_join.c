@@ -0,0 +1,147 @@
+#include "algorithms/fork_join.h"
+
+#include <greatest.h>
+
+#define THREADS  4
+
+typedef struct {
+  unsigned n;
+  unsigned long result;
+} fib_t;
+
+static void
+__fib(void* arg)
+{
+  fib_t* fib = arg;
+
+  if (fib->n < 2) {
+    fib->result = fib->n;
+    return;
+  }
+
+  fib_t first = { fib->n - 1, 0 };
+  fib_t second = { fib->n - 2, 0 };
+
+  ForkJoin_join(__fib, &first, __fib, &second);
+  fib->result = first.result + second.result;
+}
+
+typedef struct {
+  const unsigned* values;
+  size_t begin;
+  size_t end;
+  unsigned long sum;
+} range_t;
+
+static void
+__sum(void* arg)
+{
+  range_t* range = arg;
+
+  if (range->end - range->begin <= 16) {
+    range->sum = 0;
+
+    for (size_t i = range->begin; i < range->end; ++i) {
+      range->sum += range->values[i];
+    }
+
+    return;
+  }
+
+  const size_t middle = range->begin + (range->end - range->begin) / 2;
+  range_t left = { range->values, range->begin, middle, 0 };
+  range_t right = { range->values, middle, range->end, 0 };
+
+  ForkJoin_join(__sum, &left, __sum, &right);
+  range->sum = left.sum + right.sum;
+}
+
+TEST fib(void)
+{
+  ForkJoin_T pool = ForkJoin_new(THREADS);
+  ASSERT_EQ(THREADS, ForkJoin_threads(pool));
+
+  /* Pool is reused. */
+  for (int round = 0; round < 10; ++round) {
+    fib_t fib = { 20, 0 };
+    ForkJoin_run(pool, __fib, &fib);
+    ASSERT_EQ(6765, fib.result);
+  }
+
+  ForkJoin_free(&pool);
+  ASSERT_EQ(NULL, pool);
+  PASS();
+}
+
+TEST sum(void)
+{
+  static unsigned values[100000];
+  unsigned long expected = 0;
+
+  for (size_t i = 0; i < 100000; ++i) {
+    values[i] = (unsigned)(i * 7 % 1000);
+    expected += values[i];
+  }
+
+  for (size_t threads = 1; threads <= THREADS; ++threads) {
+    ForkJoin_T pool = ForkJoin_new(threads);
+    range_t range = { values, 0, 100000, 0 };
+
+    ForkJoin_run(pool, __sum, &range);
+    ASSERT_EQ(expected, range.sum);
+
+    ForkJoin_free(&pool);
+  }
+
+  PASS();
+}
+
+typedef struct {
+  ForkJoin_T pool;
+  fib_t fib;
+} nested_t;
+
+/* Runs on the pool it is already in. */
+static void
+__nested(void* arg)
+{
+  nested_t* nested = arg;
+  ForkJoin_run(nested->pool, __fib, &nested->fib);
+}
+
+TEST serial(void)
+{
+  fib_t fib = { 15, 0 };
+
+  /* No pool. */
+  __fib(&fib);
+  ASSERT_EQ(610, fib.result);
+
+  fib.result = 0;
+  ForkJoin_run(NULL, __fib, &fib);
+  ASSERT_EQ(610, fib.result);
+  ASSERT_EQ(1, ForkJoin_threads(NULL));
+
+  ForkJoin_T pool = ForkJoin_new(2);
+  nested_t nested = { pool, { 15, 0 } };
+
+  ForkJoin_run(pool, __nested, &nested);
+  ASSERT_EQ(610, nested.fib.result);
+
+  fib.result = 0;
+  ForkJoin_run(pool, __fib, &fib);
+  ASSERT_EQ(610, fib.result);
+
+  ForkJoin_free(&pool);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(fib);
+  RUN_TEST(sum);
+  RUN_TEST(serial);
+  GREATEST_MAIN_END();
+}
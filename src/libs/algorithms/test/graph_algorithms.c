@@ -0,0 +1,327 @@
+#include "algorithms/graph_algorithms.h"
+
+#include <string.h>
+#include <greatest.h>
+#include "lang/memory.h"
+
+#define THREADS  4
+
+/* Same graph every run. */
+static size_t
+__rand(uint64_t* p_state)
+{
+  *p_state = *p_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (size_t)(*p_state >> 33);
+}
+
+/* `degree` random edges per vertex, weights 1 ... 100. */
+static CSRGraph_T
+__random_graph(size_t vertices, size_t degree, graph_type_et type, uint64_t seed)
+{
+  const size_t n = vertices * degree;
+  csr_edge_t* edges = ALLOC(n * sizeof (csr_edge_t));
+
+  for (size_t i = 0; i < n; ++i) {
+    edges[i].from = i / degree;
+    edges[i].to = __rand(&seed) % vertices;
+    edges[i].weight = (int16_t)(1 + __rand(&seed) % 100);
+  }
+
+  CSRGraph_T graph = CSRGraph_from_edges(vertices, type, edges, n);
+  FREE(edges);
+
+  return graph;
+}
+
+static void
+__reference_bfs(CSRGraph_T graph, size_t vertices, vertex source, size_t* levels__)
+{
+  vertex* queue = ALLOC(vertices * sizeof (vertex));
+  size_t head = 0, tail = 0;
+  const vertex* targets;
+  const int16_t* weights;
+
+  for (vertex v = 0; v < vertices; ++v) {
+    levels__[v] = GRAPH_UNREACHED;
+  }
+
+  levels__[source] = 0;
+  queue[tail++] = source;
+
+  while (head < tail) {
+    const vertex v = queue[head++];
+    const size_t degree = CSRGraph_edges(graph, v, &targets, &weights);
+
+    for (size_t i = 0; i < degree; ++i) {
+      if (levels__[targets[i]] == GRAPH_UNREACHED) {
+        levels__[targets[i]] = levels__[v] + 1;
+        queue[tail++] = targets[i];
+      }
+    }
+  }
+
+  FREE(queue);
+}
+
+/* Dijkstra without a heap, O(V^2). */
+static void
+__reference_sssp(CSRGraph_T graph, size_t vertices, vertex source, int64_t* distances__)
+{
+  bool* done = CALLOC(vertices, sizeof (bool));
+  const vertex* targets;
+  const int16_t* weights;
+
+  for (vertex v = 0; v < vertices; ++v) {
+    distances__[v] = GRAPH_INFINITY;
+  }
+
+  distances__[source] = 0;
+
+  for (;;) {
+    vertex v = vertices;
+
+    for (vertex u = 0; u < vertices; ++u) {
+      if (!done[u] && distances__[u] != GRAPH_INFINITY && (v == vertices || distances__[u] < distances__[v]))
+      { v = u; }
+    }
+
+    if (v == vertices)
+    { break; }
+
+    done[v] = true;
+
+    const size_t degree = CSRGraph_edges(graph, v, &targets, &weights);
+
+    for (size_t i = 0; i < degree; ++i) {
+      if (distances__[v] + weights[i] < distances__[targets[i]])
+      { distances__[targets[i]] = distances__[v] + weights[i]; }
+    }
+  }
+
+  FREE(done);
+}
+
+static size_t
+__count_reached(const size_t* levels, size_t vertices)
+{
+  size_t reached = 0;
+
+  for (vertex v = 0; v < vertices; ++v) {
+    if (levels[v] != GRAPH_UNREACHED)
+    { reached++; }
+  }
+
+  return reached;
+}
+
+/* Levels of BFS on `graph` equal the reference ones. */
+static bool
+__same_bfs(CSRGraph_T graph, CSRGraph_T reverse, ThreadPool_T pool, vertex source)
+{
+  size_t vertices, edges;
+  CSRGraph_size(graph, &vertices, &edges);
+
+  size_t* expected = ALLOC(vertices * sizeof (size_t));
+  size_t* levels = ALLOC(vertices * sizeof (size_t));
+
+  __reference_bfs(graph, vertices, source, expected);
+
+  const size_t reached = Graph_bfs(graph, reverse, source, pool, levels);
+  const bool same = reached == __count_reached(expected, vertices)
+                    && memcmp(expected, levels, vertices * sizeof (size_t)) == 0;
+
+  FREE(levels);
+  FREE(expected);
+
+  return same;
+}
+
+static bool
+__same_sssp(CSRGraph_T graph, ThreadPool_T pool, vertex source, int64_t delta)
+{
+  size_t vertices, edges;
+  CSRGraph_size(graph, &vertices, &edges);
+
+  int64_t* expected = ALLOC(vertices * sizeof (int64_t));
+  int64_t* distances = ALLOC(vertices * sizeof (int64_t));
+
+  __reference_sssp(graph, vertices, source, expected);
+
+  size_t reached = 0;
+
+  for (vertex v = 0; v < vertices; ++v) {
+    if (expected[v] != GRAPH_INFINITY)
+    { reached++; }
+  }
+
+  const bool same = Graph_shortest_paths(graph, source, delta, pool, distances) == reached
+                    && memcmp(expected, distances, vertices * sizeof (int64_t)) == 0;
+
+  FREE(distances);
+  FREE(expected);
+
+  return same;
+}
+
+TEST bfs(void)
+{
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+
+  /* Dense enough to switch to bottom-up. */
+  CSRGraph_T graph = __random_graph(5000, 8, UNDIRECTED, 1);
+
+  ASSERT(__same_bfs(graph, NULL, NULL, 0));
+  ASSERT(__same_bfs(graph, NULL, pool, 0));
+  ASSERT(__same_bfs(graph, NULL, pool, 4999));
+  CSRGraph_free(&graph);
+
+  /* Some vertices are not reached. */
+  graph = __random_graph(5000, 2, DIRECTED, 2);
+  CSRGraph_T reverse = CSRGraph_transpose(graph);
+
+  ASSERT(__same_bfs(graph, reverse, pool, 7));
+  ASSERT(__same_bfs(graph, reverse, NULL, 7));
+  ASSERT(__same_bfs(graph, NULL, pool, 7));
+
+  CSRGraph_free(&reverse);
+  CSRGraph_free(&graph);
+  ThreadPool_free(&pool);
+  PASS();
+}
+
+TEST bfs_path(void)
+{
+  enum { VERTICES = 1000 };
+
+  csr_edge_t edges[VERTICES - 1];
+
+  for (vertex v = 0; v < VERTICES - 1; ++v) {
+    edges[v].from = v;
+    edges[v].to = v + 1;
+    edges[v].weight = 1;
+  }
+
+  CSRGraph_T graph = CSRGraph_from_edges(VERTICES, DIRECTED, edges, VERTICES - 1);
+  CSRGraph_T reverse = CSRGraph_transpose(graph);
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+  size_t levels[VERTICES];
+
+  ASSERT_EQ(VERTICES - 500, Graph_bfs(graph, reverse, 500, pool, levels));
+  ASSERT_EQ(GRAPH_UNREACHED, levels[0]);
+  ASSERT_EQ(0, levels[500]);
+  ASSERT_EQ(VERTICES - 1 - 500, levels[VERTICES - 1]);
+
+  ASSERT_EQ(VERTICES, Graph_bfs(reverse, graph, VERTICES - 1, pool, levels));
+  ASSERT_EQ(VERTICES - 1, levels[0]);
+
+  ThreadPool_free(&pool);
+  CSRGraph_free(&reverse);
+  CSRGraph_free(&graph);
+  PASS();
+}
+
+TEST shortest_paths(void)
+{
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+  CSRGraph_T graph = __random_graph(2000, 6, UNDIRECTED, 3);
+
+  ASSERT(__same_sssp(graph, NULL, 0, 1));
+  ASSERT(__same_sssp(graph, pool, 0, 1));
+  ASSERT(__same_sssp(graph, pool, 0, 50));
+  ASSERT(__same_sssp(graph, pool, 1999, 1000000));
+  CSRGraph_free(&graph);
+
+  graph = __random_graph(2000, 2, DIRECTED, 4);
+
+  ASSERT(__same_sssp(graph, pool, 3, 25));
+  ASSERT(__same_sssp(graph, NULL, 3, 25));
+
+  CSRGraph_free(&graph);
+  ThreadPool_free(&pool);
+  PASS();
+}
+
+TEST components(void)
+{
+  /*
+   *   0 -- 1    2    3 <- 4    5 -- 6 -- 7
+   *                           \________/
+   */
+  static const csr_edge_t k_edges[] = {
+    { 1, 0, 1 }, { 4, 3, 1 }, { 5, 6, 1 }, { 6, 7, 1 }, { 7, 5, 1 }
+  };
+
+  vertex labels[8];
+  const vertex expected[8] = { 0, 0, 2, 3, 3, 5, 5, 5 };
+
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+  CSRGraph_T graph = CSRGraph_from_edges(8, UNDIRECTED, k_edges, 5);
+
+  ASSERT_EQ(4, Graph_components(graph, pool, labels));
+  ASSERT_EQ(0, memcmp(expected, labels, sizeof (labels)));
+  CSRGraph_free(&graph);
+
+  /* Weakly connected. */
+  graph = CSRGraph_from_edges(8, DIRECTED, k_edges, 5);
+
+  ASSERT_EQ(4, Graph_components(graph, NULL, labels));
+  ASSERT_EQ(0, memcmp(expected, labels, sizeof (labels)));
+  CSRGraph_free(&graph);
+
+  ThreadPool_free(&pool);
+  PASS();
+}
+
+/* Vertices of a component have the same label and BFS reaches them all. */
+TEST components_random(void)
+{
+  enum { VERTICES = 20000 };
+
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+  CSRGraph_T graph = __random_graph(VERTICES, 1, UNDIRECTED, 5);
+
+  vertex* labels = ALLOC(VERTICES * sizeof (vertex));
+  vertex* serial = ALLOC(VERTICES * sizeof (vertex));
+  size_t* levels = ALLOC(VERTICES * sizeof (size_t));
+
+  const size_t count = Graph_components(graph, pool, labels);
+
+  ASSERT_EQ(count, Graph_components(graph, NULL, serial));
+  ASSERT_EQ(0, memcmp(serial, labels, VERTICES * sizeof (vertex)));
+
+  size_t roots = 0;
+
+  for (vertex v = 0; v < VERTICES; ++v) {
+    if (labels[v] != v)
+    { continue; }
+
+    roots++;
+    Graph_bfs(graph, NULL, v, NULL, levels);
+
+    for (vertex u = 0; u < VERTICES; ++u) {
+      ASSERT_EQ(levels[u] != GRAPH_UNREACHED, labels[u] == v);
+    }
+
+    if (roots == 20)
+    { break; }
+  }
+
+  FREE(levels);
+  FREE(serial);
+  FREE(labels);
+  CSRGraph_free(&graph);
+  ThreadPool_free(&pool);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(bfs);
+  RUN_TEST(bfs_path);
+  RUN_TEST(shortest_paths);
+  RUN_TEST(components);
+  RUN_TEST(components_random);
+  GREATEST_MAIN_END();
+}
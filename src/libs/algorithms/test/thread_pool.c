@@ -0,0 +1,98 @@
+#include "algorithms/thread_pool.h"
+
+#include <stdatomic.h>
+#include <greatest.h>
+
+#define THREADS  4
+
+typedef struct {
+  _Atomic size_t sum;
+  _Atomic size_t calls;
+  _Atomic size_t bad_worker;
+  size_t threads;
+} loop_t;
+
+static void
+__sum(void* arg, size_t begin, size_t end, size_t worker)
+{
+  loop_t* loop = arg;
+  size_t sum = 0;
+
+  for (size_t i = begin; i < end; ++i) {
+    sum += i;
+  }
+
+  atomic_fetch_add(&loop->sum, sum);
+  atomic_fetch_add(&loop->calls, 1);
+
+  if (worker >= loop->threads)
+  { atomic_fetch_add(&loop->bad_worker, 1); }
+}
+
+static size_t
+__run(ThreadPool_T pool, size_t n, size_t grain, size_t* p_calls__)
+{
+  loop_t loop;
+
+  atomic_init(&loop.sum, 0);
+  atomic_init(&loop.calls, 0);
+  atomic_init(&loop.bad_worker, 0);
+  loop.threads = ThreadPool_threads(pool);
+
+  ThreadPool_for(pool, n, grain, __sum, &loop);
+
+  *p_calls__ = atomic_load(&loop.calls) + atomic_load(&loop.bad_worker) * n;
+  return atomic_load(&loop.sum);
+}
+
+TEST every_index_once(void)
+{
+  ThreadPool_T pool = ThreadPool_new(THREADS);
+  size_t calls;
+
+  ASSERT_EQ(THREADS, ThreadPool_threads(pool));
+
+  /* Many loops, the pool is reused. */
+  for (size_t n = 0; n < 3000; n += 7) {
+    ASSERT_EQ(n * (n - 1) / 2, __run(pool, n, 16, &calls));
+    ASSERT_EQ((n + 15) / 16, calls);
+  }
+
+  ThreadPool_free(&pool);
+  ASSERT_EQ(NULL, pool);
+  PASS();
+}
+
+TEST without_threads(void)
+{
+  size_t calls;
+
+  ASSERT_EQ(1, ThreadPool_threads(NULL));
+  ASSERT_EQ(4950, __run(NULL, 100, 8, &calls));
+  ASSERT_EQ(1, calls);
+
+  ThreadPool_T pool = ThreadPool_new(1);
+
+  ASSERT_EQ(4950, __run(pool, 100, 8, &calls));
+  ASSERT_EQ(1, calls);
+
+  ThreadPool_free(&pool);
+
+  /* One range is run by the caller. */
+  pool = ThreadPool_new(THREADS);
+
+  ASSERT_EQ(4950, __run(pool, 100, 100, &calls));
+  ASSERT_EQ(1, calls);
+
+  ThreadPool_free(&pool);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(every_index_once);
+  RUN_TEST(without_threads);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,195 @@
+#include "algorithms/tree_algorithms.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <greatest.h>
+
+#define THREADS  4
+#define NODES    ((1U << 14) - 1)
+#define KEYS     100000
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+#define NUMBER(e)   ((size_t)(uintptr_t)(e) - 1)
+
+static atomic_uint seen[NODES];
+static _Atomic size_t visits;
+
+static bool
+__visit(Object_T data)
+{
+  atomic_fetch_add(&seen[NUMBER(data)], 1);
+  atomic_fetch_add(&visits, 1);
+  return true;
+}
+
+static bool
+__stop(Object_T data)
+{
+  return __visit(data) && NUMBER(data) != NODES / 2;
+}
+
+/* Complete tree of numbers `first ... last - 1`, in order. */
+static BinTree_T
+__complete(size_t first, size_t last)
+{
+  BinTree_T btree = BinTree_new();
+
+  if (first == last)
+  { return btree; }
+
+  const size_t middle = first + (last - first) / 2;
+  BinTree_make_root(&btree, ELEMENT(middle), __complete(first, middle), __complete(middle + 1, last));
+
+  return btree;
+}
+
+static void
+__reset(void)
+{
+  for (size_t i = 0; i < NODES; ++i) {
+    atomic_store(&seen[i], 0);
+  }
+
+  atomic_store(&visits, 0);
+}
+
+static bool
+__all_once(void)
+{
+  for (size_t i = 0; i < NODES; ++i) {
+    if (atomic_load(&seen[i]) != 1)
+    { return false; }
+  }
+
+  return atomic_load(&visits) == NODES;
+}
+
+TEST traverse(void)
+{
+  BinTree_T complete = __complete(0, NODES);
+  ForkJoin_T pool = ForkJoin_new(THREADS);
+
+  __reset();
+  ASSERT(BinTree_parallel_traverse(pool, complete, __visit));
+  ASSERT(__all_once());
+
+  __reset();
+  ASSERT(BinTree_parallel_traverse(NULL, complete, __visit));
+  ASSERT(__all_once());
+
+  /* Chain. */
+  BinTree_T chain = BinTree_new();
+
+  for (size_t i = 0; i < NODES; ++i) {
+    BinTree_T node = BinTree_new();
+    BinTree_make_root(&node, ELEMENT(i), NULL, chain);
+    chain = node;
+  }
+
+  __reset();
+  ASSERT(BinTree_parallel_traverse(pool, chain, __visit));
+  ASSERT(__all_once());
+
+  ASSERT(BinTree_parallel_traverse(pool, BinTree_new(), __visit));
+
+  ForkJoin_free(&pool);
+  BinTree_free(&chain);
+  BinTree_free(&complete);
+  PASS();
+}
+
+TEST stop(void)
+{
+  BinTree_T complete = __complete(0, NODES);
+  ForkJoin_T pool = ForkJoin_new(THREADS);
+
+  __reset();
+  ASSERT_FALSE(BinTree_parallel_traverse(pool, complete, __stop));
+  ASSERT(atomic_load(&seen[NODES / 2]) == 1);
+
+  ForkJoin_free(&pool);
+  BinTree_free(&complete);
+  PASS();
+}
+
+/* Every third key of the first tree, every fifth of the second from 1000 on. */
+static void
+__trees(balance_et balance, OrdTree_T* p_tree__, OrdTree_T* p_other__)
+{
+  *p_tree__ = OrdTree_new(balance);
+  *p_other__ = OrdTree_new(balance);
+
+  for (int64_t key = 0; key < KEYS; key += 3) {
+    OrdTree_put(*p_tree__, key, ELEMENT(key));
+  }
+
+  for (int64_t key = 1000; key < KEYS; key += 5) {
+    OrdTree_put(*p_other__, key, ELEMENT(key));
+  }
+}
+
+static bool
+__keys(OrdTree_T tree, bool (*member_fn)(int64_t))
+{
+  size_t index = 0;
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    if (!member_fn(key))
+    { continue; }
+
+    int64_t found = -1;
+    Object_T value = NULL;
+
+    if (!OrdTree_select(tree, index++, &found, &value) || found != key || value != ELEMENT(key))
+    { return false; }
+  }
+
+  return OrdTree_length(tree) == index;
+}
+
+static bool __first(int64_t key)  { return key % 3 == 0; }
+static bool __second(int64_t key) { return key >= 1000 && key % 5 == 0; }
+
+static bool __union(int64_t key)        { return __first(key) || __second(key); }
+static bool __intersection(int64_t key) { return __first(key) && __second(key); }
+static bool __difference(int64_t key)   { return __first(key) && !__second(key); }
+
+TEST sets(balance_et balance)
+{
+  ForkJoin_T pools[] = { NULL, ForkJoin_new(THREADS) };
+
+  for (size_t p = 0; p < 2; ++p) {
+    OrdTree_T tree;
+    OrdTree_T other;
+
+    __trees(balance, &tree, &other);
+    OrdTree_parallel_union(pools[p], tree, &other);
+    ASSERT_EQ(NULL, other);
+    ASSERT(__keys(tree, __union));
+    OrdTree_free(&tree);
+
+    __trees(balance, &tree, &other);
+    OrdTree_parallel_intersection(pools[p], tree, &other);
+    ASSERT(__keys(tree, __intersection));
+    OrdTree_free(&tree);
+
+    __trees(balance, &tree, &other);
+    OrdTree_parallel_difference(pools[p], tree, &other);
+    ASSERT(__keys(tree, __difference));
+    OrdTree_free(&tree);
+  }
+
+  ForkJoin_free(&pools[1]);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(traverse);
+  RUN_TEST(stop);
+  RUN_TEST1(sets, HEIGHT_BALANCED);
+  RUN_TEST1(sets, RED_BLACK);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file     thread_pool.c
+ * @brief    Threads that run parallel loops.
+ *
+ * Threads sleep on `start` until `generation` changes. The loop is then
+ * described by `range_fn`, `arg`, `n` and `grain`, which are written under
+ * `lock` before `generation` is increased. Ranges are taken with one atomic
+ * add on `next`. The last thread that finishes wakes the caller.
+ */
+#define _POSIX_C_SOURCE 200809L  /* sysconf */
+
+#include "algorithms/thread_pool.h"
+
+#include <pthread.h>     /* pthread_*   */
+#include <stdatomic.h>   /* atomic_*    */
+#include <stdbool.h>     /* bool        */
+#include <unistd.h>      /* sysconf     */
+#include "lang/assert.h"
+#include "lang/memory.h"
+#include "logger/log.h"
+
+const Except_T ThreadPool_Failed = { "Thread pool creation failed" };
+
+#define CACHE_LINE  64
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+struct worker {
+  ThreadPool_T pool;
+  size_t id;
+  pthread_t thread;
+};
+
+struct thread_pool {
+  size_t threads;
+  struct worker* workers;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  size_t generation;
+  size_t running;
+  bool stopping;
+
+  range_FN range_fn;
+  void* arg;
+  size_t n;
+  size_t grain;
+
+  /* Taken by all threads at once, keep it away from the rest. */
+  _Alignas(CACHE_LINE) _Atomic size_t next;
+};
+
+static void
+__run(ThreadPool_T pool, size_t worker)
+{
+  const size_t n = pool->n;
+  const size_t grain = pool->grain;
+
+  for (;;) {
+    const size_t begin = atomic_fetch_add_explicit(&pool->next, grain, memory_order_relaxed);
+
+    if (begin >= n)
+    { break; }
+
+    pool->range_fn(pool->arg, begin, (n - begin > grain) ? begin + grain : n, worker);
+  }
+}
+
+static void*
+__worker_loop(void* arg)
+{
+  struct worker* worker = arg;
+  ThreadPool_T pool = worker->pool;
+  size_t seen = 0;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->generation == seen && !pool->stopping) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+
+    if (pool->stopping) {
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    __run(pool, worker->id);
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (--pool->running == 0)
+    { pthread_cond_signal(&pool->done); }
+
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  return NULL;
+}
+
+static size_t
+__online_processors(void)
+{
+  const long online = sysconf(_SC_NPROCESSORS_ONLN);
+  return (online > 0) ? (size_t)online : 1;
+}
+
+/* Stops first `started` threads. */
+static void
+__stop(ThreadPool_T pool, size_t started)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (size_t i = 0; i < started; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+}
+
+/* __________________________________________________________________________ */
+
+ThreadPool_T
+ThreadPool_new(size_t threads)
+{
+  if (threads == 0)
+  { threads = __online_processors(); }
+
+  ThreadPool_T pool = ALLOC_ALIGNED(CACHE_LINE, sizeof (*pool));
+
+  pool->threads = threads;
+  pool->workers = (threads > 1) ? ALLOC((threads - 1) * sizeof (struct worker)) : NULL;
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->generation = 0;
+  pool->running = 0;
+  pool->stopping = false;
+
+  pool->range_fn = NULL;
+  pool->arg = NULL;
+  pool->n = 0;
+  pool->grain = 1;
+  atomic_init(&pool->next, 0);
+
+  for (size_t i = 0; i < threads - 1; ++i) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i + 1;
+
+    if (pthread_create(&pool->workers[i].thread, NULL, __worker_loop, &pool->workers[i]) != 0) {
+      Log_error("Can't start thread %zu of %zu.", i + 1, threads);
+
+      __stop(pool, i);
+      pool->threads = 0;
+      ThreadPool_free(&pool);
+
+      THROW(ThreadPool_Failed);
+    }
+  }
+
+  return pool;
+}
+
+size_t
+ThreadPool_threads(ThreadPool_T pool)
+{
+  return (pool != NULL) ? pool->threads : 1;
+}
+
+void
+ThreadPool_for(ThreadPool_T pool, size_t n, size_t grain, range_FN range_fn, void* arg)
+{
+  Require(grain > 0);
+  Require(range_fn);
+
+  if (n == 0)
+  { return; }
+
+  if (pool == NULL || pool->threads == 1 || n <= grain) {
+    range_fn(arg, 0, n, 0);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+
+  pool->range_fn = range_fn;
+  pool->arg = arg;
+  pool->n = n;
+  pool->grain = grain;
+  atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+
+  pool->running = pool->threads - 1;
+  pool->generation++;
+
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  __run(pool, 0);
+
+  pthread_mutex_lock(&pool->lock);
+
+  while (pool->running > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+
+  pthread_mutex_unlock(&pool->lock);
+}
+
+void
+ThreadPool_free(ThreadPool_T* p_pool)
+{
+  Require(p_pool);
+
+  ThreadPool_T pool = *p_pool;
+
+  if (pool == NULL)
+  { return; }
+
+  if (pool->threads > 1)
+  { __stop(pool, pool->threads - 1); }
+
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+
+  if (pool->workers != NULL)
+  { FREE(pool->workers); }
+
+  FREE_ALIGNED(pool);
+  *p_pool = NULL;
+}
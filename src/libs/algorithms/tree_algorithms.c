@@ -0,0 +1,145 @@
+/**
+ * @file     tree_algorithms.c
+ * @brief    Parallel traversal of binary trees and set operations of
+ *           ordered trees.
+ *
+ * Traversal: nodes are split down to `SPLIT_LEVELS` levels below a depth where there
+ * is one subtree per thread, so a pool of 4 threads makes up to 64 tasks
+ * of balanced tree. Unbalanced trees make fewer, but no task goes deeper
+ * than that, so degenerate trees do not nest joins.
+ *
+ * Set operations split themselves, they are given `ForkJoin_join` to run
+ * the halves and stop forking on small trees.
+ */
+#include "algorithms/tree_algorithms.h"
+
+#include <stdatomic.h>   /* atomic_* */
+#include "lang/assert.h"
+
+#define SPLIT_LEVELS  4
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+struct traverse {
+  bool (*apply_fn)(Object_T);
+  unsigned split_depth;
+  atomic_bool stopped;
+};
+
+struct subtree {
+  struct traverse* traverse;
+  BinTree_T btree;
+  unsigned depth;
+};
+
+static bool
+__apply_batch(void* arg, const Object_T* items, size_t n)
+{
+  struct traverse* traverse = arg;
+
+  if (atomic_load_explicit(&traverse->stopped, memory_order_relaxed))
+  { return false; }
+
+  for (size_t i = 0; i < n; ++i) {
+    if (!traverse->apply_fn(items[i])) {
+      atomic_store_explicit(&traverse->stopped, true, memory_order_relaxed);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void
+__subtree(void* arg)
+{
+  struct subtree* subtree = arg;
+  struct traverse* traverse = subtree->traverse;
+
+  if (BinTree_is_empty(subtree->btree))
+  { return; }
+
+  if (subtree->depth >= traverse->split_depth) {
+    BinTree_traverse_batch(subtree->btree, __apply_batch, traverse, PRE_ORDER);
+    return;
+  }
+
+  const Object_T data = BinTree_data(subtree->btree);
+
+  if (!__apply_batch(traverse, &data, 1))
+  { return; }
+
+  struct subtree left = { traverse, BinTree_left(subtree->btree), subtree->depth + 1 };
+  struct subtree right = { traverse, BinTree_right(subtree->btree), subtree->depth + 1 };
+
+  ForkJoin_join(__subtree, &left, __subtree, &right);
+}
+
+struct set_op {
+  void (*set_fn)(OrdTree_T, OrdTree_T*, fork_FN);
+  OrdTree_T tree;
+  OrdTree_T* p_other;
+};
+
+static void
+__set_op(void* arg)
+{
+  struct set_op* op = arg;
+  op->set_fn(op->tree, op->p_other, ForkJoin_join);
+}
+
+static void
+__parallel_set(ForkJoin_T pool, void (*set_fn)(OrdTree_T, OrdTree_T*, fork_FN),
+               OrdTree_T tree, OrdTree_T* p_other)
+{
+  Require(tree);
+  Require(p_other && *p_other);
+
+  struct set_op op = { set_fn, tree, p_other };
+  ForkJoin_run(pool, __set_op, &op);
+}
+
+/* __________________________________________________________________________ */
+
+bool
+BinTree_parallel_traverse(ForkJoin_T pool, BinTree_T btree, bool (*apply_fn)(Object_T))
+{
+  Require(apply_fn);
+
+  struct traverse traverse;
+  traverse.apply_fn = apply_fn;
+  traverse.split_depth = 0;
+  atomic_init(&traverse.stopped, false);
+
+  if (ForkJoin_threads(pool) > 1) {
+    for (size_t span = 1; span < ForkJoin_threads(pool); span *= 2) {
+      traverse.split_depth++;
+    }
+
+    traverse.split_depth += SPLIT_LEVELS;
+  }
+
+  struct subtree root = { &traverse, btree, 0 };
+  ForkJoin_run(pool, __subtree, &root);
+
+  return !atomic_load(&traverse.stopped);
+}
+
+void
+OrdTree_parallel_union(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other)
+{
+  __parallel_set(pool, OrdTree_union, tree, p_other);
+}
+
+void
+OrdTree_parallel_intersection(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other)
+{
+  __parallel_set(pool, OrdTree_intersection, tree, p_other);
+}
+
+void
+OrdTree_parallel_difference(ForkJoin_T pool, OrdTree_T tree, OrdTree_T* p_other)
+{
+  __parallel_set(pool, OrdTree_difference, tree, p_other);
+}
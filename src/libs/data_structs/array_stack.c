@@ -7,8 +7,6 @@
 /* __________________________________________________________________________ */
 /*                                                                     Local  */
 
-#define RESIZE_STEP 100
-
 const unsigned int k_initial_size = 50;
 
 struct stack {
@@ -57,14 +55,14 @@ Stack_push(Stack_T stack, Object_T data)
 {
   Require(stack);
 
+  /* Doubles, so pushes are amortized O(1) however deep the stack gets. */
   if (CURRENT_SIZE(stack) == stack->size) {
-    Object_T* p_newstack = RESIZE(stack->storage,
-                                  (stack->size + RESIZE_STEP) * sizeof(Object_T*));
+    Object_T* p_newstack = RESIZE(stack->storage, 2 * stack->size * sizeof(Object_T));
 
     stack->storage = p_newstack;
     stack->top = stack->storage + stack->size;
 
-    stack->size += RESIZE_STEP;
+    stack->size *= 2;
   }
   *stack->top = data;
   stack->top++;
@@ -0,0 +1,141 @@
+/*
+ * Complete tree of two million elements whose nodes are allocated in random
+ * order, as after many inserts and deletes. Traversals in every order, one
+ * element per call and in batches, then the same after `BinTree_compact`.
+ * Times are per element.
+ *
+ * Usage: binary_tree.run [levels] [rounds]
+ */
+#include "data_structs/binary_tree.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_LEVELS  21
+#define DEFAULT_ROUNDS  5
+
+static uintptr_t sum;
+
+static bool
+__add(Object_T data)
+{
+  sum += (uintptr_t)data;
+  return true;
+}
+
+static bool
+__add_batch(void* arg, const Object_T* items, size_t n)
+{
+  (void)arg;
+
+  for (size_t i = 0; i < n; ++i) {
+    sum += (uintptr_t)items[i];
+  }
+
+  return true;
+}
+
+/* Level by level from the leaves, nodes of a level made in random order. */
+static BinTree_T
+__scattered(unsigned levels)
+{
+  uint64_t seed = 88172645463325252ULL;
+  size_t width = (size_t)1 << (levels - 1);
+
+  BinTree_T* below = NULL;
+  BinTree_T* level = ALLOC(width * sizeof (BinTree_T));
+  size_t* shuffled = ALLOC(width * sizeof (size_t));
+  uintptr_t element = 1;
+
+  for (;;) {
+    for (size_t i = 0; i < width; ++i) {
+      shuffled[i] = i;
+    }
+
+    for (size_t i = width; i > 1; --i) {
+      const size_t j = Bench_rand(&seed) % i;
+      const size_t tmp = shuffled[i - 1];
+      shuffled[i - 1] = shuffled[j];
+      shuffled[j] = tmp;
+    }
+
+    for (size_t i = 0; i < width; ++i) {
+      const size_t at = shuffled[i];
+
+      level[at] = BinTree_new();
+      BinTree_make_root(&level[at], (Object_T)element++,
+                        (below != NULL) ? below[2 * at] : NULL,
+                        (below != NULL) ? below[2 * at + 1] : NULL);
+    }
+
+    if (width == 1)
+    { break; }
+
+    FREE(below);
+    below = level;
+    width /= 2;
+    level = ALLOC(width * sizeof (BinTree_T));
+  }
+
+  BinTree_T btree = level[0];
+
+  FREE(shuffled);
+  FREE(level);
+  FREE(below);
+
+  return btree;
+}
+
+static void
+__traverse_all(BinTree_T btree, size_t n, size_t rounds, const char* layout)
+{
+  static const order_et orders[4] = { PRE_ORDER, IN_ORDER, POST_ORDER, LEVEL_ORDER };
+  static const char* names[4] = { "preorder", "inorder", "postorder", "level order" };
+
+  char title[64];
+
+  for (int o = 0; o < 4; ++o) {
+    double start = Bench_now();
+
+    for (size_t r = 0; r < rounds; ++r) {
+      BinTree_traverse(btree, __add, orders[o]);
+    }
+
+    snprintf(title, sizeof(title), "%s: %s", layout, names[o]);
+    Bench_report(title, n * rounds, Bench_now() - start);
+
+    start = Bench_now();
+
+    for (size_t r = 0; r < rounds; ++r) {
+      BinTree_traverse_batch(btree, __add_batch, NULL, orders[o]);
+    }
+
+    snprintf(title, sizeof(title), "%s: %s, batch", layout, names[o]);
+    Bench_report(title, n * rounds, Bench_now() - start);
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  const unsigned levels = (unsigned)Bench_arg(argc, argv, 1, DEFAULT_LEVELS);
+  const size_t rounds = Bench_arg(argc, argv, 2, DEFAULT_ROUNDS);
+
+  BinTree_T btree = __scattered(levels);
+  const size_t n = BinTree_size(btree);
+
+  __traverse_all(btree, n, rounds, "scattered");
+
+  const double start = Bench_now();
+  BinTree_compact(&btree);
+  Bench_report("compact", n, Bench_now() - start);
+
+  __traverse_all(btree, n, rounds, "compacted");
+
+  Bench_use(&sum);
+  BinTree_free(&btree);
+
+  return 0;
+}
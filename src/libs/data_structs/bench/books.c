@@ -0,0 +1,365 @@
+/*
+ * Book trees compiled with prefixed names, see `books.h`. They are written
+ * in the book's style, so warnings are not checked.
+ *
+ * Books take nodes from blocks of `malloc`, here it is replaced to count and
+ * later free the blocks.
+ */
+#include "books.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wstrict-prototypes"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+typedef union block {
+  union block* next;
+  max_align_t align;
+} block_t;
+
+static block_t* blocks;
+static size_t allocated;
+
+static void*
+__block(size_t size)
+{
+  block_t* block = malloc(sizeof (block_t) + size);
+
+  if (block == NULL)
+  { return NULL; }
+
+  block->next = blocks;
+  blocks = block;
+  allocated += size;
+
+  return block + 1;
+}
+
+/* Nodes on the way down, see `BINARY_HEIGHT`. */
+typedef struct {
+  const void* node;
+  int depth;
+} step_t;
+
+static step_t* path;
+static size_t path_capacity;
+
+static void
+__path_push(size_t* p_top, const void* node, int depth)
+{
+  if (*p_top == path_capacity) {
+    path_capacity = (path_capacity == 0) ? 64 : 2 * path_capacity;
+    path = realloc(path, path_capacity * sizeof (step_t));
+  }
+
+  path[(*p_top)++] = (step_t) { node, depth };
+}
+
+#define malloc(size)  __block(size)
+
+#define NO_DEMO_MAIN
+
+#define JOIN_(prefix, name)  prefix ## _ ## name
+#define JOIN(prefix, name)   JOIN_(prefix, name)
+#define PREFIXED(name)       JOIN(TREE, name)
+
+#define tr_n_t          PREFIXED(tr_n_t)
+#define tree_node_t     PREFIXED(tree_node_t)
+#define node_t          PREFIXED(node_t)
+#define currentblock    PREFIXED(currentblock)
+#define size_left       PREFIXED(size_left)
+#define free_list       PREFIXED(free_list)
+#define nodes_taken     PREFIXED(nodes_taken)
+#define nodes_returned  PREFIXED(nodes_returned)
+#define get_node        PREFIXED(get_node)
+#define return_node     PREFIXED(return_node)
+#define create_tree     PREFIXED(create_tree)
+#define remove_tree     PREFIXED(remove_tree)
+#define make_tree       PREFIXED(make_tree)
+#define make_list       PREFIXED(make_list)
+#define list_node       PREFIXED(list_node)
+#define left_rotation   PREFIXED(left_rotation)
+#define right_rotation  PREFIXED(right_rotation)
+#define find            PREFIXED(find)
+#define find_iterative  PREFIXED(find_iterative)
+#define find_recursive  PREFIXED(find_recursive)
+#define interval_find   PREFIXED(interval_find)
+#define insert          PREFIXED(insert)
+#define delete          PREFIXED(delete)
+#define check_tree      PREFIXED(check_tree)
+#define red             PREFIXED(red)
+#define black           PREFIXED(black)
+
+/* Untyped operations of `book_t`, trivial tree has no `find` but two others. */
+#define DYNAMIC_BOOK(search)                                               \
+  static void*                                                             \
+  PREFIXED(book_create)(void)                                              \
+  {                                                                        \
+    return create_tree();                                                  \
+  }                                                                        \
+                                                                           \
+  static int                                                               \
+  PREFIXED(book_insert)(void* tree, int key, int* object)                  \
+  {                                                                        \
+    return insert(tree, key, object);                                      \
+  }                                                                        \
+                                                                           \
+  static int*                                                              \
+  PREFIXED(book_delete)(void* tree, int key)                               \
+  {                                                                        \
+    return delete(tree, key);                                              \
+  }                                                                        \
+                                                                           \
+  static int*                                                              \
+  PREFIXED(book_find)(void* tree, int key)                                 \
+  {                                                                        \
+    return search(tree, key);                                              \
+  }
+
+/* Optimal trees are made from a list of leaves, searched as the trivial tree. */
+#define STATIC_BOOK                                                        \
+  static void*                                                             \
+  PREFIXED(book_build)(const int* keys, int n, int* object)                \
+  {                                                                        \
+    tree_node_t* list = NULL;                                              \
+                                                                           \
+    for (int i = n - 1; i >= 0; --i) {                                     \
+      tree_node_t* leaf = get_node();                                      \
+      leaf->key = keys[i];                                                 \
+      leaf->left = (tree_node_t*)object;                                   \
+      leaf->right = list;                                                  \
+      list = leaf;                                                         \
+    }                                                                      \
+                                                                           \
+    return make_tree(list);                                                \
+  }                                                                        \
+                                                                           \
+  static int*                                                              \
+  PREFIXED(book_find)(void* tree, int key)                                 \
+  {                                                                        \
+    const tree_node_t* node = tree;                                        \
+                                                                           \
+    if (node->left == NULL)                                                \
+    { return NULL; }                                                       \
+                                                                           \
+    while (node->right != NULL) {                                          \
+      node = (key < node->key) ? node->left : node->right;                 \
+    }                                                                      \
+                                                                           \
+    return (node->key == key) ? (int*)node->left : NULL;                   \
+  }
+
+/*
+ * Longest path from the root, without recursion since unbalanced trees could
+ * be lists. Leaves of leaf trees have no right child and an object on the left.
+ */
+#define BINARY_HEIGHT(leaf_tree)                                           \
+  static int                                                               \
+  PREFIXED(book_height)(void* tree)                                        \
+  {                                                                        \
+    const tree_node_t* root = tree;                                        \
+    size_t top = 0;                                                        \
+    int height = 0;                                                        \
+                                                                           \
+    if ((leaf_tree) && root->left == NULL)                                 \
+    { return 0; }                                                          \
+                                                                           \
+    __path_push(&top, root, 0);                                            \
+                                                                           \
+    while (top > 0) {                                                      \
+      const step_t step = path[--top];                                     \
+      const tree_node_t* node = step.node;                                 \
+                                                                           \
+      if (step.depth > height)                                             \
+      { height = step.depth; }                                             \
+                                                                           \
+      if ((leaf_tree) && node->right == NULL)                              \
+      { continue; }                                                        \
+                                                                           \
+      if (node->left != NULL)                                              \
+      { __path_push(&top, node->left, step.depth + 1); }                   \
+                                                                           \
+      if (node->right != NULL)                                             \
+      { __path_push(&top, node->right, step.depth + 1); }                  \
+    }                                                                      \
+                                                                           \
+    return height;                                                         \
+  }
+
+/* Node blocks are freed by `Books_release`. */
+#define RESET_BOOK                                                         \
+  static void                                                              \
+  PREFIXED(book_reset)(void)                                               \
+  {                                                                        \
+    currentblock = NULL;                                                   \
+    size_left = 0;                                                         \
+    free_list = NULL;                                                      \
+  }
+
+/* ______________________________________________________________________________ */
+/*                                                                      Chapter 2 */
+
+#define TREE  triv
+#include "ch2/triv_tree.c"
+DYNAMIC_BOOK(find_iterative)
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+#define TREE  b_op
+#include "ch2/b_op_tree.c"
+STATIC_BOOK
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+#define TREE  t_op
+#include "ch2/t_op_tree.c"
+STATIC_BOOK
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+/* ______________________________________________________________________________ */
+/*                                                                      Chapter 3 */
+
+#define TREE  a_b
+#include "ch3/a_b_tree.c"
+DYNAMIC_BOOK(find)
+RESET_BOOK
+
+/* Leaves are blocks of height 0. */
+static int
+a_b_book_height(void* tree)
+{
+  return ((tree_node_t*)tree)->height;
+}
+
+#undef TREE
+#undef BLOCKSIZE
+#undef A
+#undef B
+
+#define TREE  h_bl
+#include "ch3/h_bl_tree.c"
+DYNAMIC_BOOK(find)
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+#define TREE  w_bl
+#include "ch3/w_bl_tree.c"
+DYNAMIC_BOOK(find)
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+#undef ALPHA
+#undef EPSILON
+
+#define TREE  rb
+#include "ch3/rb_tree.c"
+DYNAMIC_BOOK(find)
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+#define TREE  t_rb
+#include "ch3/t_rb_tree.c"
+DYNAMIC_BOOK(find)
+BINARY_HEIGHT(true)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+/* Splay tree has objects in every node, it is not a leaf tree. */
+#define TREE  spla
+#include "ch3/spla_tree.c"
+DYNAMIC_BOOK(find)
+BINARY_HEIGHT(false)
+RESET_BOOK
+#undef TREE
+#undef BLOCKSIZE
+
+#define TREE  skip
+#include "ch3/skip_list.c"
+DYNAMIC_BOOK(find)
+RESET_BOOK
+
+static int
+skip_book_height(void* tree)
+{
+  int levels = 0;
+
+  for (const tree_node_t* node = tree; node->down != NULL; node = node->down) {
+    levels++;
+  }
+
+  return levels;
+}
+
+#undef TREE
+#undef BLOCKSIZE
+
+/* ______________________________________________________________________________ */
+
+#define DYNAMIC(name, balanced)                                            \
+  { #name, name##_book_create, NULL, name##_book_insert, name##_book_delete, \
+    name##_book_find, name##_book_height, balanced }
+
+#define STATIC(name)                                                       \
+  { #name, NULL, name##_book_build, NULL, NULL, name##_book_find, name##_book_height, true }
+
+const book_t books[] = {
+  DYNAMIC(triv, false),
+  STATIC(b_op),
+  STATIC(t_op),
+  DYNAMIC(a_b, true),
+  DYNAMIC(h_bl, true),
+  DYNAMIC(w_bl, true),
+  DYNAMIC(rb, true),
+  DYNAMIC(t_rb, true),
+  DYNAMIC(spla, false),
+  DYNAMIC(skip, true)
+};
+
+const size_t books_length = sizeof (books) / sizeof (books[0]);
+
+size_t
+Books_allocated(void)
+{
+  return allocated;
+}
+
+void
+Books_release(void)
+{
+  triv_book_reset();
+  b_op_book_reset();
+  t_op_book_reset();
+  a_b_book_reset();
+  h_bl_book_reset();
+  w_bl_book_reset();
+  rb_book_reset();
+  t_rb_book_reset();
+  spla_book_reset();
+  skip_book_reset();
+
+  while (blocks != NULL) {
+    block_t* next = blocks->next;
+    free(blocks);
+    blocks = next;
+  }
+
+  allocated = 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file    books.h
+ * @brief   Search trees from `src/bin/books/advanced_data_structures`.
+ *
+ * Book trees map `int` keys to `int*` objects and all use the same names,
+ * so `books.c` compiles each of them with its own prefix. Find and delete
+ * return NULL if the key is not there, insert returns 0 if the key is new.
+ * Skip list insert does not look for the key, it is always added.
+ *
+ * Every tree is also in `books`, behind the same untyped operations, so one
+ * benchmark could run them all.
+ */
+#if !defined(BENCH_BOOKS_H)
+#define BENCH_BOOKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define BOOK_TREE(name)                                                    \
+  struct name##_tr_n_t;                                                    \
+  extern struct name##_tr_n_t* name##_create_tree(void);                   \
+  extern int name##_insert(struct name##_tr_n_t* tree, int key, int* object); \
+  extern int* name##_find(struct name##_tr_n_t* tree, int key);            \
+  extern int* name##_delete(struct name##_tr_n_t* tree, int key)
+
+BOOK_TREE(rb);
+BOOK_TREE(h_bl);
+BOOK_TREE(skip);
+
+typedef struct {
+  const char* name;
+  void* (*create)(void);
+
+  /* Optimal trees of chapter 2 are built once from sorted keys, they have no
+     create, insert and delete. Others have no build. */
+  void* (*build)(const int* keys, int n, int* object);
+  int (*insert)(void* tree, int key, int* object);
+  int* (*delete)(void* tree, int key);
+
+  int* (*find)(void* tree, int key);
+
+  /* Edges on the longest path from the root, levels of a skip list. */
+  int (*height)(void* tree);
+
+  /* Sorted keys make it a list. */
+  bool balanced;
+} book_t;
+
+extern const book_t books[];
+extern const size_t books_length;
+
+/**
+ * Bytes of node blocks taken by book trees, free or not.
+ */
+extern size_t Books_allocated(void);
+
+/**
+ * Free node blocks of all book trees. Trees made before could not be used
+ * any more.
+ */
+extern void Books_release(void);
+
+#endif  /* BENCH_BOOKS_H */
@@ -0,0 +1,144 @@
+/*
+ * B+-tree against the red-black and height-balanced trees of the book
+ * (chapter 3) on the same random `int` keys: insert, find and delete of
+ * every key. Then loading sorted keys, which the book trees do not have,
+ * and reading all elements in order. Timed per key.
+ *
+ * Usage: bplus_tree.run [keys]
+ */
+#include "data_structs/bplus_tree.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "books.h"
+#include "lang/memory.h"
+
+#define DEFAULT_N  10000000UL
+#define BATCH      256
+
+static bool
+__count(int64_t key, Object_T value, void* arg)
+{
+  (void)key;
+  (void)value;
+  (*(size_t*)arg)++;
+
+  return true;
+}
+
+/* Same cases for both book trees. */
+#define BENCH_BOOK(name, label)                                                \
+  do {                                                                         \
+    struct name##_tr_n_t* book = name##_create_tree();                         \
+    double begin = Bench_now();                                                \
+                                                                               \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      name##_insert(book, keys[i], &dummy);                                    \
+    }                                                                          \
+                                                                               \
+    Bench_report(label " insert", n, Bench_now() - begin);                     \
+    begin = Bench_now();                                                       \
+                                                                               \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      found += name##_find(book, keys[i]) != NULL;                             \
+    }                                                                          \
+                                                                               \
+    Bench_report(label " find", n, Bench_now() - begin);                       \
+    begin = Bench_now();                                                       \
+                                                                               \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      found += name##_delete(book, keys[i]) != NULL;                           \
+    }                                                                          \
+                                                                               \
+    Bench_report(label " delete", n, Bench_now() - begin);                     \
+  } while (0)
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_N);
+
+  int* keys = ALLOC(n * sizeof (int));
+  int64_t* sorted = ALLOC(n * sizeof (int64_t));
+  Object_T* values = ALLOC(n * sizeof (Object_T));
+  uint64_t seed = 88172645463325252ULL;
+  int dummy = 42;
+  size_t found = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = (int)(Bench_rand(&seed) % INT32_MAX);
+    sorted[i] = (int64_t)i;
+    values[i] = (Object_T)&dummy;
+  }
+
+  BPTree_T tree = BPTree_new();
+  double start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    BPTree_put(tree, keys[i], (Object_T)&dummy);
+  }
+
+  Bench_report("bplus insert", n, Bench_now() - start);
+  printf("%-36s %12zu levels\n", "bplus height", BPTree_height(tree));
+
+  Object_T value;
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    found += BPTree_get(tree, keys[i], &value);
+  }
+
+  Bench_report("bplus find", n, Bench_now() - start);
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    found += BPTree_remove(tree, keys[i], NULL);
+  }
+
+  Bench_report("bplus delete", n, Bench_now() - start);
+  BPTree_free(&tree);
+
+  BENCH_BOOK(rb, "ch3 red-black");
+  BENCH_BOOK(h_bl, "ch3 height-balanced");
+
+  start = Bench_now();
+  tree = BPTree_load(sorted, values, n);
+  Bench_report("bplus load sorted", n, Bench_now() - start);
+
+  size_t visited = 0;
+  start = Bench_now();
+  BPTree_range(tree, INT64_MIN, INT64_MAX, __count, &visited);
+  Bench_report("bplus range", visited, Bench_now() - start);
+
+  int64_t batch_keys[BATCH];
+  Object_T batch_values[BATCH];
+  int64_t from = INT64_MIN;
+  size_t copied;
+  visited = 0;
+  start = Bench_now();
+
+  while ((copied = BPTree_scan(tree, from, batch_keys, batch_values, BATCH)) > 0) {
+    visited += copied;
+    from = batch_keys[copied - 1] + 1;
+  }
+
+  Bench_report("bplus scan", visited, Bench_now() - start);
+
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    found += BPTree_get(tree, keys[i] % (int64_t)n, &value);
+  }
+
+  Bench_report("bplus find loaded", n, Bench_now() - start);
+  Bench_use(&found);
+
+  BPTree_free(&tree);
+
+  FREE(values);
+  FREE(sorted);
+  FREE(keys);
+
+  return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Random directed graph of half a million vertices and eight edges per
+ * vertex: breadth and depth first search from vertex 0 and adjacency tests,
+ * on the adjacency list graph and on its CSR copy.
+ *
+ * Usage: graph.run [vertices] [edges per vertex] [rounds]
+ */
+#include "data_structs/graph_adj_list.h"
+#include "data_structs/graph_csr.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_VERTICES  500000UL
+#define DEFAULT_DEGREE    8
+#define DEFAULT_ROUNDS    5
+
+#define QUERIES           1000000UL
+
+static vertex* queue;
+static bool* seen;
+
+/* Returns number of edges looked at. */
+static size_t
+__bfs_list(Graph_T graph, size_t n)
+{
+  size_t head = 0, tail = 0, scanned = 0;
+
+  memset(seen, 0, n * sizeof (bool));
+  queue[tail++] = 0;
+  seen[0] = true;
+
+  while (head < tail) {
+    const vertex v = queue[head++];
+    edge_t* p_edge = NULL;
+
+    while ((p_edge = Graph_edge_iterator(graph, v, p_edge)) != NULL) {
+      const vertex to = ((const edge_data*)DATA(p_edge))->vertex_number;
+
+      if (!seen[to]) {
+        seen[to] = true;
+        queue[tail++] = to;
+      }
+      scanned++;
+    }
+  }
+
+  return scanned;
+}
+
+static size_t
+__bfs_csr(CSRGraph_T graph, size_t n)
+{
+  size_t head = 0, tail = 0, scanned = 0;
+  const vertex* targets;
+  const int16_t* weights;
+
+  memset(seen, 0, n * sizeof (bool));
+  queue[tail++] = 0;
+  seen[0] = true;
+
+  while (head < tail) {
+    const size_t degree = CSRGraph_edges(graph, queue[head++], &targets, &weights);
+
+    for (size_t i = 0; i < degree; ++i) {
+      if (!seen[targets[i]]) {
+        seen[targets[i]] = true;
+        queue[tail++] = targets[i];
+      }
+    }
+    scanned += degree;
+  }
+
+  return scanned;
+}
+
+/* `queue` is the stack, a vertex could be there more than once. */
+static size_t
+__dfs_list(Graph_T graph, size_t n)
+{
+  size_t top = 0, scanned = 0;
+
+  memset(seen, 0, n * sizeof (bool));
+  queue[top++] = 0;
+
+  while (top > 0) {
+    const vertex v = queue[--top];
+
+    if (seen[v])
+    { continue; }
+
+    seen[v] = true;
+    edge_t* p_edge = NULL;
+
+    while ((p_edge = Graph_edge_iterator(graph, v, p_edge)) != NULL) {
+      const vertex to = ((const edge_data*)DATA(p_edge))->vertex_number;
+
+      if (!seen[to])
+      { queue[top++] = to; }
+
+      scanned++;
+    }
+  }
+
+  return scanned;
+}
+
+static size_t
+__dfs_csr(CSRGraph_T graph, size_t n)
+{
+  size_t top = 0, scanned = 0;
+  const vertex* targets;
+  const int16_t* weights;
+
+  memset(seen, 0, n * sizeof (bool));
+  queue[top++] = 0;
+
+  while (top > 0) {
+    const vertex v = queue[--top];
+
+    if (seen[v])
+    { continue; }
+
+    seen[v] = true;
+    const size_t degree = CSRGraph_edges(graph, v, &targets, &weights);
+
+    for (size_t i = 0; i < degree; ++i) {
+      if (!seen[targets[i]])
+      { queue[top++] = targets[i]; }
+    }
+    scanned += degree;
+  }
+
+  return scanned;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_VERTICES);
+  const size_t degree = Bench_arg(argc, argv, 2, DEFAULT_DEGREE);
+  const size_t rounds = Bench_arg(argc, argv, 3, DEFAULT_ROUNDS);
+
+  const size_t m = n * degree;
+  csr_edge_t* edges = ALLOC(m * sizeof (csr_edge_t));
+  uint64_t seed = 42;
+  double start;
+
+  for (size_t i = 0; i < m; ++i) {
+    edges[i].from = i / degree;
+    edges[i].to = Bench_rand(&seed) % n;
+    edges[i].weight = (int16_t)(1 + Bench_rand(&seed) % 100);
+  }
+
+  Graph_T list_graph = Graph_new(n, DIRECTED);
+
+  start = Bench_now();
+  for (size_t i = 0; i < m; ++i) {
+    Graph_add_edge(list_graph, edges[i].from, edges[i].to, edges[i].weight);
+  }
+  Bench_report("graph (list): Graph_add_edge", m, Bench_now() - start);
+
+  start = Bench_now();
+  CSRGraph_T csr = CSRGraph_from_graph(list_graph);
+  Bench_report("graph (csr): CSRGraph_from_graph", m, Bench_now() - start);
+
+  CSRGraph_free(&csr);
+
+  start = Bench_now();
+  csr = CSRGraph_from_edges(n, DIRECTED, edges, m);
+  Bench_report("graph (csr): CSRGraph_from_edges", m, Bench_now() - start);
+
+  queue = ALLOC((m + 1) * sizeof (vertex));
+  seen = ALLOC(n * sizeof (bool));
+
+  size_t scanned = 0;
+
+  /* Edges looked at per second. */
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    scanned += __bfs_list(list_graph, n);
+  }
+  Bench_report("graph (list): BFS", scanned, Bench_now() - start);
+
+  scanned = 0;
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    scanned += __bfs_csr(csr, n);
+  }
+  Bench_report("graph (csr): BFS", scanned, Bench_now() - start);
+
+  scanned = 0;
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    scanned += __dfs_list(list_graph, n);
+  }
+  Bench_report("graph (list): DFS", scanned, Bench_now() - start);
+
+  scanned = 0;
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    scanned += __dfs_csr(csr, n);
+  }
+  Bench_report("graph (csr): DFS", scanned, Bench_now() - start);
+
+  size_t found = 0;
+
+  start = Bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    found += Graph_is_adjacent(list_graph, edges[i % m].from, (vertex)(Bench_rand(&seed) % n));
+  }
+  Bench_report("graph (list): Graph_is_adjacent", QUERIES, Bench_now() - start);
+
+  start = Bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    found += CSRGraph_is_adjacent(csr, edges[i % m].from, (vertex)(Bench_rand(&seed) % n));
+  }
+  Bench_report("graph (csr): CSRGraph_is_adjacent", QUERIES, Bench_now() - start);
+
+  Bench_use((void*)found);
+
+  FREE(seen);
+  FREE(queue);
+  CSRGraph_free(&csr);
+  Graph_free(&list_graph);
+  FREE(edges);
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Ten million random keys: pushed one by one and popped, built at once with
+ * `Heap_build` and popped, and a heap of a million keys where every pop is
+ * followed by a push (as in event scheduling), also with an indexed heap where
+ * random keys are decreased (as in Dijkstra). Built once with the default
+ * four children per node and once as a binary heap (`HEAP_ARITY=2`).
+ *
+ * Usage: heap.run [keys] [held keys]
+ */
+#include "data_structs/heap.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_KEYS  10000000UL
+#define DEFAULT_HELD  1000000UL
+
+#define KEY(data)     ((uintptr_t)(data))
+
+static int
+__cmp(Object_T a, Object_T b)
+{
+  return (KEY(a) > KEY(b)) - (KEY(a) < KEY(b));
+}
+
+static void
+__report(const char* name, size_t ops, double start)
+{
+  char title[64];
+
+  snprintf(title, sizeof(title), "heap (%d-ary): %s", HEAP_ARITY, name);
+  Bench_report(title, ops, Bench_now() - start);
+}
+
+/* Pops everything, checks the order. */
+static void
+__pop_all(Heap_T heap, size_t n, const char* name)
+{
+  Object_T data = NULL;
+  uintptr_t last = 0;
+  size_t wrong = 0;
+
+  const double start = Bench_now();
+  while (!Heap_is_empty(heap)) {
+    Heap_delete(heap, 0, __cmp, &data);
+    wrong += (KEY(data) < last);
+    last = KEY(data);
+  }
+  __report(name, n, start);
+
+  if (wrong > 0)
+  { printf("!!! %zu keys out of order\n", wrong); }
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_KEYS);
+  const size_t held = Bench_arg(argc, argv, 2, DEFAULT_HELD);
+
+  Object_T* keys = ALLOC(n * sizeof (Object_T));
+  uint64_t seed = 42;
+  double start;
+
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = (Object_T)(uintptr_t)(Bench_rand(&seed) >> 1);
+  }
+
+  Heap_T heap = Heap_new();
+
+  start = Bench_now();
+  for (size_t i = 0; i < n; ++i) {
+    Heap_insert(heap, keys[i], __cmp);
+  }
+  __report("Heap_insert", n, start);
+
+  __pop_all(heap, n, "Heap_delete (min)");
+  Heap_free(&heap);
+
+  start = Bench_now();
+  heap = Heap_build(keys, n, __cmp);
+  __report("Heap_build", n, start);
+
+  __pop_all(heap, n, "Heap_delete (min, built)");
+  Heap_free(&heap);
+
+  /* Pop the minimum and push a later key. */
+  heap = Heap_build(keys, (held < n) ? held : n, __cmp);
+
+  start = Bench_now();
+  for (size_t i = 0; i < n; ++i) {
+    Object_T data;
+
+    Heap_delete(heap, 0, __cmp, &data);
+    Heap_insert(heap, (Object_T)(KEY(data) + KEY(keys[i]) % 1000000), __cmp);
+  }
+  __report("Heap_delete + Heap_insert", n, start);
+
+  Heap_free(&heap);
+
+  /* The same with handles. */
+  const size_t count = (held < n) ? held : n;
+  heap_handle_t* handles = ALLOC(count * sizeof (heap_handle_t));
+
+  heap = Heap_new_indexed();
+
+  for (size_t i = 0; i < count; ++i) {
+    handles[i] = Heap_insert_handle(heap, keys[i], __cmp);
+  }
+
+  start = Bench_now();
+  for (size_t i = 0; i < n; ++i) {
+    Object_T data;
+
+    Heap_delete(heap, 0, __cmp, &data);
+    Heap_insert_handle(heap, (Object_T)(KEY(data) + KEY(keys[i]) % 1000000), __cmp);
+  }
+  __report("Heap_delete + Heap_insert (indexed)", n, start);
+
+  start = Bench_now();
+  for (size_t i = 0; i < n; ++i) {
+    const heap_handle_t handle = handles[KEY(keys[i]) % count];
+    const uintptr_t key = KEY(Heap_handle_data(heap, handle));
+
+    Heap_decrease_key(heap, handle, (Object_T)(key - key / 64), __cmp);
+  }
+  __report("Heap_decrease_key", n, start);
+
+  Heap_free(&heap);
+  FREE(handles);
+  FREE(keys);
+
+  return 0;
+}
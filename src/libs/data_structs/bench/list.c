@@ -0,0 +1,185 @@
+/*
+ * Lists of a million elements: build, traverse, count, search and iterate.
+ * Bulk append is measured for single and circular lists.
+ * Built once with node per element lists and once with unrolled ones
+ * (`LIST_UNROLLED_MODE`). Elements are numbers, nothing is allocated for
+ * them.
+ *
+ * Usage: list.run [elements] [rounds]
+ */
+#include "data_structs/list.h"
+#include "data_structs/circ_list.h"
+#include "data_structs/double_list.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+
+#define DEFAULT_ELEMENTS  1000000UL
+#define DEFAULT_ROUNDS    10
+
+#if defined(LIST_UNROLLED_MODE)
+#  define MODE  "unrolled"
+#else
+#  define MODE  "nodes"
+#endif
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+
+static uintptr_t sum;
+
+static bool
+__add(Object_T data)
+{
+  sum += (uintptr_t)data;
+  return true;
+}
+
+static bool
+__same(Object_T key, Object_T data)
+{
+  return key == data;
+}
+
+static void
+__report(const char* name, size_t ops, double start)
+{
+  char title[64];
+
+  snprintf(title, sizeof(title), "list (%s): %s", MODE, name);
+  Bench_report(title, ops, Bench_now() - start);
+}
+
+static void
+single(size_t n, size_t rounds)
+{
+  List_T list = List_new();
+  node_t* found;
+  double start;
+
+  start = Bench_now();
+  for (size_t i = n; i > 0; --i) {
+    List_insert(&list, ELEMENT(i - 1));
+  }
+  __report("List_insert", n, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    List_traverse(list, __add);
+  }
+  __report("List_traverse", n * rounds, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    sum += List_length(list);
+  }
+  __report("List_length (calls)", rounds, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    sum += List_find_key(list, __same, ELEMENT(n), &found);
+  }
+  __report("List_find_key (miss)", n * rounds, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    node_t* p_node = NULL;
+
+    while ((p_node = List_iterator(list, p_node)) != NULL) {
+      sum += (uintptr_t)DATA(p_node);
+    }
+  }
+  __report("List_iterator", n * rounds, start);
+
+  start = Bench_now();
+  List_free(&list);
+  __report("List_free", n, start);
+}
+
+/* Appending takes constant time, tail is kept in the list header. */
+static void
+bulk(size_t n, size_t rounds)
+{
+  double start;
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    List_T list = List_new();
+
+    for (size_t i = 0; i < n; ++i) {
+      List_append(&list, ELEMENT(i));
+    }
+
+    sum += List_length(list);
+    List_free(&list);
+  }
+  __report("List_append (bulk)", n * rounds, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    CircList_T circlist = CircList_new();
+
+    for (size_t i = 0; i < n; ++i) {
+      CircList_append(&circlist, ELEMENT(i));
+    }
+
+    sum += CircList_length(circlist);
+    CircList_free(&circlist);
+  }
+  __report("CircList_append (bulk)", n * rounds, start);
+}
+
+static void
+dual(size_t n, size_t rounds)
+{
+  DoubleList_T list = DoubleList_new();
+  double start;
+
+  start = Bench_now();
+  for (size_t i = n; i > 0; --i) {
+    DoubleList_insert(&list, ELEMENT(i - 1));
+  }
+  __report("DoubleList_insert", n, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    DoubleList_traverse(list, __add);
+  }
+  __report("DoubleList_traverse", n * rounds, start);
+
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    Bench_use(DoubleList_nth(list, (int)(n - r)));
+  }
+  __report("DoubleList_nth (end)", n * rounds, start);
+
+  /* Middle third out and back after the first element. */
+  start = Bench_now();
+  for (size_t r = 0; r < rounds; ++r) {
+    doublenode_t* from = DoubleList_nth(list, (int)(n / 3));
+    doublenode_t* to = DoubleList_nth(list, (int)(2 * n / 3));
+
+    DoubleList_cut(&list, &from, &to);
+    DoubleList_paste(&list, &from);
+  }
+  __report("DoubleList_cut/paste", n * rounds, start);
+
+  start = Bench_now();
+  DoubleList_free(&list);
+  __report("DoubleList_free", n, start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_ELEMENTS);
+  const size_t rounds = Bench_arg(argc, argv, 2, DEFAULT_ROUNDS);
+
+  single(n, rounds);
+  bulk(n, rounds);
+  dual(n, rounds);
+
+  Bench_use((void*)sum);
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Producers and consumers in pairs, from one pair to the given number of
+ * pairs, pass ten million elements through a queue of 1024 elements: lock-free
+ * queue one element and a batch at a time, and `Queue_T` behind a mutex.
+ * Throughput is for all threads together.
+ *
+ * Usage: mpmc_queue.run [elements] [pairs]
+ */
+#include "data_structs/mpmc_queue.h"
+#include "data_structs/queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/assert.h"
+
+#define DEFAULT_ELEMENTS  10000000UL
+#define DEFAULT_PAIRS     4
+#define CAPACITY          1024
+#define BATCH             32
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+
+typedef enum { SINGLE, BULK, LOCKED } kind_et;
+
+static const char* kind_names[] = { "lock-free", "lock-free bulk", "mutex" };
+
+typedef struct {
+  kind_et kind;
+  MPMCQueue_T mpmc;
+  Queue_T queue;
+  pthread_mutex_t lock;
+  size_t per_thread;
+  _Atomic size_t sum;
+} shared_t;
+
+static bool
+__locked_add(shared_t* shared, Object_T data)
+{
+  pthread_mutex_lock(&shared->lock);
+
+  const bool added = Queue_length(shared->queue) < CAPACITY;
+
+  if (added)
+  { Queue_add(shared->queue, data); }
+
+  pthread_mutex_unlock(&shared->lock);
+  return added;
+}
+
+static bool
+__locked_remove(shared_t* shared, Object_T* p_data__)
+{
+  pthread_mutex_lock(&shared->lock);
+  const bool removed = Queue_remove(shared->queue, p_data__);
+  pthread_mutex_unlock(&shared->lock);
+
+  return removed;
+}
+
+static void*
+__produce(void* arg)
+{
+  shared_t* shared = arg;
+  Object_T batch[BATCH];
+  size_t i = 0;
+
+  while (i < shared->per_thread) {
+    size_t added = 0;
+
+    switch (shared->kind) {
+    case SINGLE:
+      added = MPMCQueue_add(shared->mpmc, ELEMENT(i));
+      break;
+
+    case BULK: {
+      const size_t n = (shared->per_thread - i < BATCH) ? shared->per_thread - i : BATCH;
+
+      for (size_t k = 0; k < n; ++k) {
+        batch[k] = ELEMENT(i + k);
+      }
+
+      added = MPMCQueue_add_bulk(shared->mpmc, batch, n);
+      break;
+    }
+
+    case LOCKED:
+      added = __locked_add(shared, ELEMENT(i));
+      break;
+
+    default:
+      Require(0 && "Unknown kind.");
+    }
+
+    if (added == 0)
+    { sched_yield(); }
+
+    i += added;
+  }
+
+  return NULL;
+}
+
+static void*
+__consume(void* arg)
+{
+  shared_t* shared = arg;
+  Object_T batch[BATCH];
+  uintptr_t sum = 0;
+  size_t i = 0;
+
+  while (i < shared->per_thread) {
+    size_t removed = 0;
+
+    switch (shared->kind) {
+    case SINGLE:
+      removed = MPMCQueue_remove(shared->mpmc, batch);
+      break;
+
+    case BULK: {
+      const size_t n = (shared->per_thread - i < BATCH) ? shared->per_thread - i : BATCH;
+      removed = MPMCQueue_remove_bulk(shared->mpmc, batch, n);
+      break;
+    }
+
+    case LOCKED:
+      removed = __locked_remove(shared, batch);
+      break;
+
+    default:
+      Require(0 && "Unknown kind.");
+    }
+
+    if (removed == 0)
+    { sched_yield(); }
+
+    for (size_t k = 0; k < removed; ++k) {
+      sum += (uintptr_t)batch[k];
+    }
+
+    i += removed;
+  }
+
+  atomic_fetch_add(&shared->sum, sum);
+  return NULL;
+}
+
+static void
+__run(kind_et kind, size_t pairs, size_t n)
+{
+  shared_t shared;
+  pthread_t threads[2 * pairs];
+
+  shared.kind = kind;
+  shared.mpmc = MPMCQueue_new(CAPACITY);
+  shared.queue = Queue_new();
+  shared.per_thread = n / pairs;
+  pthread_mutex_init(&shared.lock, NULL);
+  atomic_init(&shared.sum, 0);
+
+  const double start = Bench_now();
+
+  for (size_t t = 0; t < pairs; ++t) {
+    pthread_create(&threads[2 * t], NULL, __consume, &shared);
+    pthread_create(&threads[2 * t + 1], NULL, __produce, &shared);
+  }
+
+  for (size_t t = 0; t < 2 * pairs; ++t) {
+    pthread_join(threads[t], NULL);
+  }
+
+  const double seconds = Bench_now() - start;
+  const size_t expected = pairs * shared.per_thread * (shared.per_thread + 1) / 2;
+
+  char title[64];
+  snprintf(title, sizeof(title), "%s, %zu+%zu threads%s", kind_names[kind], pairs, pairs,
+           (atomic_load(&shared.sum) == expected) ? "" : " (WRONG SUM)");
+  Bench_report(title, pairs * shared.per_thread, seconds);
+
+  pthread_mutex_destroy(&shared.lock);
+  Queue_free(shared.queue);
+  MPMCQueue_free(&shared.mpmc);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_ELEMENTS);
+  const size_t pairs = Bench_arg(argc, argv, 2, DEFAULT_PAIRS);
+
+  for (size_t p = 1; p <= pairs; p *= 2) {
+    __run(SINGLE, p, n);
+    __run(BULK, p, n);
+    __run(LOCKED, p, n);
+  }
+
+  return 0;
+}
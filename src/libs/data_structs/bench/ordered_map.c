@@ -0,0 +1,299 @@
+/*
+ * Every search tree of the book (chapters 2 and 3) on the same key streams,
+ * through `books` of `books.h`:
+ *
+ *   uniform     distinct keys in random order, lookups of random keys
+ *   zipfian     same keys, lookups where the key of rank r is taken with
+ *               probability proportional to 1/r (Zipf's law)
+ *   sequential  keys in increasing order, lookups in the same order
+ *   zigzag      smallest and largest key not yet put, in turn, lookups in the
+ *               same order: worst for unbalanced trees, many rebalances for
+ *               the others
+ *
+ * Keys are put, looked up and deleted. Per operation kind it reports
+ * throughput and latency percentiles of every 16th operation, timed alone.
+ * After the puts it reports height and bytes of node blocks per key. Optimal
+ * trees of chapter 2 are built from sorted keys instead and only searched.
+ * Trivial and splay trees are skipped on ordered streams, their puts make a
+ * list there.
+ *
+ * Usage: ordered_map.run [keys] [tree]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "books.h"
+
+#define DEFAULT_KEYS  1000000UL
+
+/* Every SAMPLE-th operation is timed alone. */
+#define SAMPLE   16
+
+#define STREAMS  4
+
+typedef enum { PUT, FIND, DELETE } op_et;
+
+static const char* op_names[] = { "put", "find", "delete" };
+
+typedef struct {
+  const char* name;
+  int* puts;
+  int* finds;
+  bool ordered;
+} stream_t;
+
+static int dummy;
+
+/* ______________________________________________________________________________ */
+/*                                                                       Streams  */
+
+/* Distinct keys below 2^31, multiplying by an odd number is a permutation
+   modulo 2^31. They are shuffled since consecutive multiples are close to
+   recent ones. */
+static void
+__uniform(int* keys__, size_t n)
+{
+  uint64_t seed = 3;
+
+  for (size_t i = 0; i < n; ++i) {
+    keys__[i] = (int)((uint32_t)i * 2654435761u & 0x7FFFFFFFu);
+  }
+
+  for (size_t i = n - 1; i > 0; --i) {
+    const size_t j = Bench_rand(&seed) % (i + 1);
+    const int key = keys__[i];
+
+    keys__[i] = keys__[j];
+    keys__[j] = key;
+  }
+}
+
+static void
+__zigzag(int* keys__, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    keys__[i] = (int)((i % 2 == 0) ? i / 2 : n - 1 - i / 2);
+  }
+}
+
+/* Key of rank r is taken with probability proportional to 1/(r + 1). */
+static void
+__zipfian(int* finds__, const int* keys, size_t n)
+{
+  double* cdf = malloc(n * sizeof (double));
+  double total = 0.0;
+
+  for (size_t r = 0; r < n; ++r) {
+    total += 1.0 / (double)(r + 1);
+    cdf[r] = total;
+  }
+
+  uint64_t seed = 7;
+
+  for (size_t i = 0; i < n; ++i) {
+    const double u = (double)(Bench_rand(&seed) >> 11) * 0x1p-53 * total;
+    size_t low = 0;
+    size_t high = n - 1;
+
+    while (low < high) {
+      const size_t middle = low + (high - low) / 2;
+
+      if (cdf[middle] < u)
+      { low = middle + 1; }
+
+      else
+      { high = middle; }
+    }
+
+    finds__[i] = keys[low];
+  }
+
+  free(cdf);
+}
+
+static stream_t
+__stream(const char* name, bool ordered, size_t n)
+{
+  return (stream_t) { name, malloc(n * sizeof (int)), malloc(n * sizeof (int)), ordered };
+}
+
+static void
+__streams(stream_t* streams__, size_t n)
+{
+  uint64_t seed = 1;
+
+  streams__[0] = __stream("uniform", false, n);
+  __uniform(streams__[0].puts, n);
+
+  for (size_t i = 0; i < n; ++i) {
+    streams__[0].finds[i] = streams__[0].puts[Bench_rand(&seed) % n];
+  }
+
+  streams__[1] = __stream("zipfian", false, n);
+  __uniform(streams__[1].puts, n);
+  __zipfian(streams__[1].finds, streams__[1].puts, n);
+
+  streams__[2] = __stream("sequential", true, n);
+
+  for (size_t i = 0; i < n; ++i) {
+    streams__[2].puts[i] = streams__[2].finds[i] = (int)i;
+  }
+
+  streams__[3] = __stream("zigzag", true, n);
+  __zigzag(streams__[3].puts, n);
+  __zigzag(streams__[3].finds, n);
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                          Runs  */
+
+static int
+__compare_float(const void* a, const void* b)
+{
+  const float x = *(const float*)a;
+  const float y = *(const float*)b;
+
+  return (x > y) - (x < y);
+}
+
+static int
+__compare_int(const void* a, const void* b)
+{
+  const int x = *(const int*)a;
+  const int y = *(const int*)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Returns `true` if `key` was not there for put, was there for find and delete. */
+static bool
+__op(const book_t* book, void* tree, op_et op, int key)
+{
+  switch (op) {
+  case PUT:
+    return book->insert(tree, key, &dummy) == 0;
+
+  case FIND:
+    return book->find(tree, key) != NULL;
+
+  case DELETE:
+    return book->delete(tree, key) != NULL;
+
+  default:
+    return false;
+  }
+}
+
+static void
+__phase(const book_t* book, void* tree, const stream_t* stream, op_et op, size_t n,
+        float* samples)
+{
+  const int* keys = (op == FIND) ? stream->finds : stream->puts;
+  size_t failed = 0;
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (i % SAMPLE == 0) {
+      const double begin = Bench_now();
+      failed += !__op(book, tree, op, keys[i]);
+      samples[i / SAMPLE] = (float)((Bench_now() - begin) * 1e9);
+
+    } else {
+      failed += !__op(book, tree, op, keys[i]);
+    }
+  }
+
+  const double seconds = Bench_now() - start;
+  const size_t m = (n + SAMPLE - 1) / SAMPLE;
+
+  qsort(samples, m, sizeof (float), __compare_float);
+
+  printf("%-5s %-11s %-7s %9.2f %9.0f %9.0f", book->name, stream->name, op_names[op],
+         (double)n / seconds * 1e-6, (double)samples[m / 2], (double)samples[m * 99 / 100]);
+
+  if (op == PUT) {
+    printf(" %7d %9.1f", book->height(tree), (double)Books_allocated() / (double)n);
+  }
+
+  if (failed > 0) {
+    printf("  (%zu FAILED)", failed);
+  }
+
+  printf("\n");
+}
+
+/* Optimal trees are built at once, latency is not known. */
+static void
+__build(const book_t* book, const stream_t* stream, size_t n, float* samples)
+{
+  int* sorted = malloc(n * sizeof (int));
+  memcpy(sorted, stream->puts, n * sizeof (int));
+  qsort(sorted, n, sizeof (int), __compare_int);
+
+  const double start = Bench_now();
+  void* tree = book->build(sorted, (int)n, &dummy);
+  const double seconds = Bench_now() - start;
+
+  printf("%-5s %-11s %-7s %9.2f %9s %9s %7d %9.1f\n", book->name, stream->name, "build",
+         (double)n / seconds * 1e-6, "-", "-", book->height(tree),
+         (double)Books_allocated() / (double)n);
+
+  __phase(book, tree, stream, FIND, n, samples);
+  free(sorted);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_KEYS);
+  const char* only = (argc > 2) ? argv[2] : NULL;
+
+  stream_t streams[STREAMS];
+  __streams(streams, n);
+
+  float* samples = malloc((n / SAMPLE + 1) * sizeof (float));
+
+  printf("%-5s %-11s %-7s %9s %9s %9s %7s %9s\n", "tree", "stream", "op", "Mops/s",
+         "p50 ns", "p99 ns", "height", "B/key");
+
+  for (size_t b = 0; b < books_length; ++b) {
+    const book_t* book = &books[b];
+
+    if (only != NULL && strcmp(only, book->name) != 0)
+    { continue; }
+
+    for (size_t s = 0; s < STREAMS; ++s) {
+      const stream_t* stream = &streams[s];
+
+      if (!book->balanced && stream->ordered) {
+        printf("%-5s %-11s skipped, puts make a list\n", book->name, stream->name);
+        continue;
+      }
+
+      if (book->build != NULL) {
+        __build(book, stream, n, samples);
+
+      } else {
+        void* tree = book->create();
+
+        __phase(book, tree, stream, PUT, n, samples);
+        __phase(book, tree, stream, FIND, n, samples);
+        __phase(book, tree, stream, DELETE, n, samples);
+      }
+
+      Books_release();
+    }
+  }
+
+  for (size_t s = 0; s < STREAMS; ++s) {
+    free(streams[s].puts);
+    free(streams[s].finds);
+  }
+
+  free(samples);
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Ten million elements go through a queue that holds about a thousand of
+ * them, then the queue is filled and emptied at once. Built once with node
+ * per element and once in a ring (`QUEUE_RING_MODE`).
+ *
+ * Usage: queue.run [elements] [held elements]
+ */
+#include "data_structs/queue.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+
+#define DEFAULT_ELEMENTS  10000000UL
+#define DEFAULT_HELD      1000UL
+
+#if defined(QUEUE_RING_MODE)
+# define MODE  "ring"
+#else
+# define MODE  "nodes"
+#endif
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+
+static void
+__keep(void* data)
+{
+  (void)data;
+}
+
+static void
+__report(const char* name, size_t ops, double start)
+{
+  char title[64];
+
+  snprintf(title, sizeof(title), "queue (%s): %s", MODE, name);
+  Bench_report(title, ops, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_ELEMENTS);
+  const size_t held = Bench_arg(argc, argv, 2, DEFAULT_HELD);
+
+  Queue_T queue = Queue_new();
+  Object_T data = NULL;
+  uintptr_t sum = 0;
+
+  for (size_t i = 0; i < held; ++i) {
+    Queue_add(queue, ELEMENT(i));
+  }
+
+  double start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    Queue_add(queue, ELEMENT(i));
+    Queue_remove(queue, &data);
+    sum += (uintptr_t)data;
+  }
+
+  __report("add and remove", n, start);
+
+  while (Queue_remove(queue, &data)) {
+    sum += (uintptr_t)data;
+  }
+
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    Queue_add(queue, ELEMENT(i));
+  }
+
+  __report("add all", n, start);
+
+  start = Bench_now();
+
+  while (Queue_remove(queue, &data)) {
+    sum += (uintptr_t)data;
+  }
+
+  __report("remove all", n, start);
+  Bench_use(&sum);
+
+  /* Elements are not allocated. */
+  Queue_destroy(queue, __keep);
+
+  return 0;
+}
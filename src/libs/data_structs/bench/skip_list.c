@@ -0,0 +1,165 @@
+/*
+ * Threads from one to the given number (all online processors by default) on
+ * one list of a million keys, half of them present: nine gets to one put or
+ * remove, then half and half. Lock-free skip list against the book's skip
+ * list (chapter 3) behind a mutex. Throughput is for all threads together.
+ *
+ * Usage: skip_list.run [operations] [threads] [keys]
+ */
+#include "data_structs/skip_list.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "bench.h"
+#include "books.h"
+
+#define DEFAULT_OPERATIONS  4000000UL
+#define DEFAULT_KEYS        1000000UL
+
+typedef enum { LOCK_FREE, LOCKED } kind_et;
+
+static const char* kind_names[] = { "lock-free", "book + mutex" };
+
+static int dummy;
+
+typedef struct {
+  kind_et kind;
+  SkipList_T list;
+  struct skip_tr_n_t* book;
+  pthread_mutex_t lock;
+  size_t keys;
+  size_t per_thread;
+  unsigned writes;          /* Of ten operations. */
+} shared_t;
+
+typedef struct {
+  shared_t* shared;
+  uint64_t seed;
+  size_t found;
+} worker_t;
+
+/* Book insert does not look for the key. */
+static void
+__book_put(struct skip_tr_n_t* book, int key)
+{
+  if (skip_find(book, key) == NULL)
+  { skip_insert(book, key, &dummy); }
+}
+
+static void*
+__work(void* arg)
+{
+  worker_t* worker = arg;
+  shared_t* shared = worker->shared;
+  Object_T value = NULL;
+
+  for (size_t i = 0; i < shared->per_thread; ++i) {
+    const uint64_t r = Bench_rand(&worker->seed);
+    const int64_t key = (int64_t)((r >> 16) % shared->keys);
+    const unsigned op = (unsigned)(r % 20);
+
+    if (shared->kind == LOCK_FREE) {
+      if (op >= 2 * shared->writes)
+      { worker->found += SkipList_get(shared->list, key, &value); }
+
+      else if (op % 2 == 0)
+      { SkipList_put(shared->list, key, (Object_T)&dummy); }
+
+      else
+      { SkipList_remove(shared->list, key, NULL); }
+
+    } else {
+      pthread_mutex_lock(&shared->lock);
+
+      if (op >= 2 * shared->writes)
+      { worker->found += (skip_find(shared->book, (int)key) != NULL); }
+
+      else if (op % 2 == 0)
+      { __book_put(shared->book, (int)key); }
+
+      else
+      { skip_delete(shared->book, (int)key); }
+
+      pthread_mutex_unlock(&shared->lock);
+    }
+  }
+
+  return NULL;
+}
+
+static void
+__run(shared_t* shared, size_t threads, size_t n)
+{
+  pthread_t ids[threads];
+  worker_t workers[threads];
+
+  shared->per_thread = n / threads;
+
+  const double start = Bench_now();
+
+  for (size_t t = 0; t < threads; ++t) {
+    workers[t] = (worker_t) { shared, 0x9E3779B97F4A7C15ULL * (t + 1), 0 };
+    pthread_create(&ids[t], NULL, __work, &workers[t]);
+  }
+
+  size_t found = 0;
+
+  for (size_t t = 0; t < threads; ++t) {
+    pthread_join(ids[t], NULL);
+    found += workers[t].found;
+  }
+
+  const double seconds = Bench_now() - start;
+
+  char title[64];
+  snprintf(title, sizeof(title), "%s, %u%% writes, %zu threads", kind_names[shared->kind],
+           10 * shared->writes, threads);
+  Bench_report(title, threads * shared->per_thread, seconds);
+  Bench_use(&found);
+}
+
+int
+main(int argc, char** argv)
+{
+  const long online = sysconf(_SC_NPROCESSORS_ONLN);
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_OPERATIONS);
+  const size_t threads = Bench_arg(argc, argv, 2, (online > 0) ? (size_t)online : 1);
+  const size_t keys = Bench_arg(argc, argv, 3, DEFAULT_KEYS);
+
+  shared_t shared;
+  pthread_mutex_init(&shared.lock, NULL);
+  shared.keys = keys;
+  shared.list = SkipList_new();
+  shared.book = skip_create_tree();
+
+  /* Every other key, in random order. */
+  uint64_t seed = 1;
+
+  for (size_t i = 0; i < keys / 2; ++i) {
+    const int64_t key = (int64_t)(2 * (Bench_rand(&seed) % (keys / 2)));
+
+    SkipList_put(shared.list, key, (Object_T)&dummy);
+    __book_put(shared.book, (int)key);
+  }
+
+  const unsigned writes[] = { 1, 5 };
+
+  for (size_t w = 0; w < sizeof(writes) / sizeof(writes[0]); ++w) {
+    shared.writes = writes[w];
+
+    for (size_t t = 1; t <= threads; t = (t < threads && 2 * t > threads) ? threads : 2 * t) {
+      shared.kind = LOCK_FREE;
+      __run(&shared, t, n);
+
+      shared.kind = LOCKED;
+      __run(&shared, t, n);
+    }
+  }
+
+  SkipList_free(&shared.list);
+  pthread_mutex_destroy(&shared.lock);
+
+  return 0;
+}
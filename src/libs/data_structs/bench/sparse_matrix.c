@@ -0,0 +1,133 @@
+/*
+ * Random sparse matrix with sixteen elements per row on average: put, get
+ * and clear of all elements, export to CSR and CSC and matrix-vector
+ * multiply over doubles. Multiply is timed per element.
+ *
+ * Usage: sparse_matrix.run [nonzeros] [multiply rounds]
+ */
+#include "data_structs/sparse_matrix.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+#include "lang/memory.h"
+
+#define DEFAULT_NONZEROS  1000000UL
+#define DEFAULT_ROUNDS    20
+#define PER_ROW           16
+
+static double
+__value(Object_T data)
+{
+  return *(double*)data;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_NONZEROS);
+  const size_t rounds = Bench_arg(argc, argv, 2, DEFAULT_ROUNDS);
+  const size_t dimension = (n / PER_ROW > 0) ? n / PER_ROW : 1;
+
+  int* rows = ALLOC(n * sizeof (int));
+  int* cols = ALLOC(n * sizeof (int));
+  double* values = ALLOC(n * sizeof (double));
+  double* x = ALLOC(dimension * sizeof (double));
+  double* y = ALLOC(dimension * sizeof (double));
+  uint64_t seed = 88172645463325252ULL;
+
+  for (size_t i = 0; i < n; ++i) {
+    rows[i] = (int)(Bench_rand(&seed) % dimension);
+    cols[i] = (int)(Bench_rand(&seed) % dimension);
+    values[i] = (double)(Bench_rand(&seed) % 1000) / 10.0;
+  }
+
+  for (size_t i = 0; i < dimension; ++i) {
+    x[i] = (double)(i % 100) / 7.0;
+  }
+
+  Matrix_T matrix = Matrix_new();
+  double start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    Matrix_put(&matrix, rows[i], cols[i], (Object_T)&values[i]);
+  }
+
+  Bench_report("put", n, Bench_now() - start);
+  Matrix_free(&matrix);
+
+  matrix = Matrix_new();
+  Matrix_reserve(&matrix, n);
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    Matrix_put(&matrix, rows[i], cols[i], (Object_T)&values[i]);
+  }
+
+  Bench_report("put reserved", n, Bench_now() - start);
+
+  Object_T data = NULL;
+  size_t found = 0;
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    found += Matrix_get(&matrix, rows[i], cols[i], &data);
+  }
+
+  Bench_report("get", n, Bench_now() - start);
+
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    found += Matrix_get(&matrix, cols[i], (int)dimension + rows[i], &data);
+  }
+
+  Bench_report("get missing", n, Bench_now() - start);
+  Bench_use(&found);
+
+  start = Bench_now();
+  CompressedMatrix_T csr = Matrix_compress(matrix, BY_ROWS, __value);
+  Bench_report("compress by rows", n, Bench_now() - start);
+
+  start = Bench_now();
+  CompressedMatrix_T csc = Matrix_compress(matrix, BY_COLUMNS, __value);
+  Bench_report("compress by columns", n, Bench_now() - start);
+
+  start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    CompressedMatrix_multiply(csr, x, y);
+    Bench_use(y);
+  }
+
+  Bench_report("multiply csr", n * rounds, Bench_now() - start);
+
+  start = Bench_now();
+
+  for (size_t r = 0; r < rounds; ++r) {
+    CompressedMatrix_multiply(csc, x, y);
+    Bench_use(y);
+  }
+
+  Bench_report("multiply csc", n * rounds, Bench_now() - start);
+
+  start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    Matrix_clear(&matrix, rows[i], cols[i]);
+  }
+
+  Bench_report("clear", n, Bench_now() - start);
+
+  CompressedMatrix_free(&csc);
+  CompressedMatrix_free(&csr);
+  Matrix_free(&matrix);
+
+  FREE(y);
+  FREE(x);
+  FREE(values);
+  FREE(cols);
+  FREE(rows);
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Array and list stacks: ten million elements pushed and popped in rounds of
+ * a million, and the same number of pushes and pops around a depth of a
+ * thousand (as when recursion is replaced by a stack). Elements are numbers,
+ * nothing is allocated for them.
+ *
+ * Usage: stack.run [elements] [depth]
+ */
+#include "data_structs/stack.h"
+#include "data_structs/list_stack.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bench.h"
+
+#define DEFAULT_ELEMENTS  10000000UL
+#define DEFAULT_DEPTH     1000UL
+#define ROUND             1000000UL
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+
+typedef struct {
+  const char* name;
+  void (*push)(struct stack*, Object_T);
+  bool (*pop)(struct stack*, Object_T*);
+} stack_kind_t;
+
+static void
+__report(const char* stack, const char* name, size_t ops, double start)
+{
+  char title[64];
+
+  snprintf(title, sizeof(title), "%s: %s", stack, name);
+  Bench_report(title, ops, Bench_now() - start);
+}
+
+static void
+__run(const stack_kind_t* kind, struct stack* stack, size_t n, size_t depth)
+{
+  Object_T data = NULL;
+  uintptr_t sum = 0;
+  double start = Bench_now();
+
+  for (size_t done = 0; done < n; done += ROUND) {
+    for (size_t i = 0; i < ROUND; ++i) {
+      kind->push(stack, ELEMENT(i));
+    }
+
+    while (kind->pop(stack, &data)) {
+      sum += (uintptr_t)data;
+    }
+  }
+
+  __report(kind->name, "push all, pop all", 2 * n, start);
+
+  for (size_t i = 0; i < depth; ++i) {
+    kind->push(stack, ELEMENT(i));
+  }
+
+  start = Bench_now();
+
+  /* Two pushes and two pops around `depth`. */
+  for (size_t i = 0; i < n / 2; ++i) {
+    kind->push(stack, ELEMENT(i));
+    kind->push(stack, ELEMENT(i + 1));
+    kind->pop(stack, &data);
+    sum += (uintptr_t)data;
+    kind->pop(stack, &data);
+    sum += (uintptr_t)data;
+  }
+
+  __report(kind->name, "push and pop", 2 * n, start);
+
+  while (kind->pop(stack, &data)) {
+    sum += (uintptr_t)data;
+  }
+
+  Bench_use(&sum);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_ELEMENTS);
+  const size_t depth = Bench_arg(argc, argv, 2, DEFAULT_DEPTH);
+
+  const stack_kind_t array = { "array stack", Stack_push, Stack_pop };
+  const stack_kind_t list = { "list stack", LStack_push, LStack_pop };
+
+  Stack_T stack = Stack_new_def();
+  __run(&array, stack, n, depth);
+  Stack_free(stack);
+
+  LStack_T lstack = LStack_new();
+  __run(&list, lstack, n, depth);
+  LStack_free(lstack);
+
+  return 0;
+}
@@ -1,18 +1,29 @@
 #include "data_structs/binary_tree.h"
 
+#include <string.h>      /* memcpy, memmove */
 #include "lang/memory.h"
 #include "lang/assert.h"
 
+/* Where a node lives, see `BinTree_compact`. */
+typedef enum { IN_HEAP, IN_ARENA, ARENA_FIRST } storage_et;
+
 struct tree_node {
   Object_T datapointer;
   BinTree_T left;
   BinTree_T right;
+  storage_et storage;
 };
 
 #define DATA(p_btnode)  ((p_btnode)->datapointer)
 #define LEFT(p_btnode)  ((p_btnode)->left)
 #define RIGHT(p_btnode) ((p_btnode)->right)
 
+/* Elements passed to a callback at once. */
+#define BATCH       256
+
+/* Nodes a walk holds without allocating. */
+#define WALK_LOCAL  64
+
 /* ______________________________________________________________________________ */
 /*                                                                         Local  */
 
@@ -30,12 +41,252 @@ __allocate_tree_node(btnode_t** pp_btnode, Object_T data)
   DATA(newnode) = data;
   LEFT(newnode) = NULL;
   RIGHT(newnode) = NULL;
+  newnode->storage = IN_HEAP;
+}
+
+/*
+ * Traversal state. `nodes` is the stack of the depth first orders and the
+ * queue, from `head`, of the level order. It could be stopped after any
+ * node and continued.
+ */
+struct walk {
+  order_et order;
+  btnode_t** nodes;
+  size_t head;
+  size_t size;
+  size_t capacity;
+  btnode_t* current;      /* In and post order: next to go left from. */
+  btnode_t* last;         /* Post order: last visited.                */
+  btnode_t* local[WALK_LOCAL];
+};
+
+static void
+__walk_start(struct walk* walk, BinTree_T btree, order_et order)
+{
+  Require(order == PRE_ORDER || order == IN_ORDER || order == POST_ORDER
+          || order == LEVEL_ORDER);
+
+  walk->order = order;
+  walk->nodes = walk->local;
+  walk->head = 0;
+  walk->size = 0;
+  walk->capacity = WALK_LOCAL;
+  walk->current = NULL;
+  walk->last = NULL;
+
+  if (btree == NULL)
+  { return; }
+
+  if (order == PRE_ORDER || order == LEVEL_ORDER) {
+    walk->nodes[walk->size++] = btree;
+
+  } else {
+    walk->current = btree;
+  }
+}
+
+static void
+__walk_add(struct walk* walk, btnode_t* node)
+{
+  if (walk->size == walk->capacity) {
+    /* Queue could move to the start first. */
+    if (walk->head > 0) {
+      memmove(walk->nodes, &walk->nodes[walk->head], (walk->size - walk->head) * sizeof (btnode_t*));
+      walk->size -= walk->head;
+      walk->head = 0;
+
+    } else if (walk->nodes == walk->local) {
+      walk->nodes = ALLOC(2 * walk->capacity * sizeof (btnode_t*));
+      memcpy(walk->nodes, walk->local, walk->size * sizeof (btnode_t*));
+      walk->capacity *= 2;
+
+    } else {
+      RESIZE(walk->nodes, 2 * walk->capacity * sizeof (btnode_t*));
+      walk->capacity *= 2;
+    }
+  }
+
+  walk->nodes[walk->size++] = node;
+}
+
+/* Put data of the next, at most `max`, nodes to `items__`. Return how many. */
+static size_t
+__walk_next(struct walk* walk, Object_T* items__, size_t max)
+{
+  size_t count = 0;
+
+  switch (walk->order) {
+    case PRE_ORDER:
+      while (count < max && walk->size > 0) {
+        btnode_t* node = walk->nodes[--walk->size];
+        items__[count++] = DATA(node);
+
+        if (RIGHT(node) != NULL)
+        { __walk_add(walk, RIGHT(node)); }
+
+        if (LEFT(node) != NULL)
+        { __walk_add(walk, LEFT(node)); }
+      }
+      break;
+
+    case IN_ORDER:
+      while (count < max) {
+        for (; walk->current != NULL; walk->current = LEFT(walk->current)) {
+          __walk_add(walk, walk->current);
+        }
+
+        if (walk->size == 0)
+        { break; }
+
+        btnode_t* node = walk->nodes[--walk->size];
+        items__[count++] = DATA(node);
+        walk->current = RIGHT(node);
+      }
+      break;
+
+    case POST_ORDER:
+      while (count < max) {
+        if (walk->current != NULL) {
+          __walk_add(walk, walk->current);
+          walk->current = LEFT(walk->current);
+          continue;
+        }
+
+        if (walk->size == 0)
+        { break; }
+
+        btnode_t* node = walk->nodes[walk->size - 1];
+
+        /* Right subtree first, if it was not just done. */
+        if (RIGHT(node) != NULL && RIGHT(node) != walk->last) {
+          walk->current = RIGHT(node);
+
+        } else {
+          items__[count++] = DATA(node);
+          walk->last = node;
+          walk->size--;
+        }
+      }
+      break;
+
+    case LEVEL_ORDER:
+      while (count < max && walk->head < walk->size) {
+        btnode_t* node = walk->nodes[walk->head++];
+        items__[count++] = DATA(node);
+
+        if (LEFT(node) != NULL)
+        { __walk_add(walk, LEFT(node)); }
+
+        if (RIGHT(node) != NULL)
+        { __walk_add(walk, RIGHT(node)); }
+      }
+      break;
+
+    default:
+      Require(0 && "Unknown traverse order.");
+  }
+
+  return count;
 }
 
 static void
-__free_tree_node(btnode_t** pp_btnode)
+__walk_end(struct walk* walk)
+{
+  if (walk->nodes != walk->local)
+  { FREE(walk->nodes); }
+}
+
+/* Node and its depth, for the depth first walks of `BinTree_compact`. */
+struct frame {
+  btnode_t* node;
+  size_t depth;
+};
+
+struct frames {
+  struct frame* items;
+  size_t size;
+  size_t capacity;
+};
+
+static void
+__frames_push(struct frames* frames, btnode_t* node, size_t depth)
+{
+  if (frames->size == frames->capacity) {
+    if (frames->capacity == 0) {
+      frames->capacity = WALK_LOCAL;
+      frames->items = ALLOC(frames->capacity * sizeof (struct frame));
+
+    } else {
+      frames->capacity *= 2;
+      RESIZE(frames->items, frames->capacity * sizeof (struct frame));
+    }
+  }
+
+  frames->items[frames->size].node = node;
+  frames->items[frames->size].depth = depth;
+  frames->size++;
+}
+
+static size_t
+__height(BinTree_T btree, struct frames* frames)
 {
-  FREE(*pp_btnode);
+  size_t height = 0;
+
+  frames->size = 0;
+  __frames_push(frames, btree, 1);
+
+  while (frames->size > 0) {
+    const struct frame frame = frames->items[--frames->size];
+
+    if (frame.depth > height)
+    { height = frame.depth; }
+
+    if (RIGHT(frame.node) != NULL)
+    { __frames_push(frames, RIGHT(frame.node), frame.depth + 1); }
+
+    if (LEFT(frame.node) != NULL)
+    { __frames_push(frames, LEFT(frame.node), frame.depth + 1); }
+  }
+
+  return height;
+}
+
+/*
+ * Append nodes of `btree` that are less than `height` levels below it to
+ * `order__` from `pos`, in van Emde Boas order. Return the next position.
+ * Nested calls share `frames`, each uses what is above the caller's part.
+ */
+static size_t
+__veb(BinTree_T btree, size_t height, struct frames* frames, btnode_t** order__, size_t pos)
+{
+  if (height == 1) {
+    order__[pos++] = btree;
+    return pos;
+  }
+
+  const size_t top = height / 2;
+  pos = __veb(btree, top, frames, order__, pos);
+
+  /* Roots of the bottom subtrees, from left to right. */
+  const size_t base = frames->size;
+  __frames_push(frames, btree, 0);
+
+  while (frames->size > base) {
+    const struct frame frame = frames->items[--frames->size];
+
+    if (frame.depth == top) {
+      pos = __veb(frame.node, height - top, frames, order__, pos);
+      continue;
+    }
+
+    if (RIGHT(frame.node) != NULL)
+    { __frames_push(frames, RIGHT(frame.node), frame.depth + 1); }
+
+    if (LEFT(frame.node) != NULL)
+    { __frames_push(frames, LEFT(frame.node), frame.depth + 1); }
+  }
+
+  return pos;
 }
 
 /* __________________________________________________________________________ */
@@ -67,112 +318,197 @@ BinTree_make_root(BinTree_T* p_btree, Object_T data, BinTree_T left, BinTree_T r
   RIGHT(*p_btree) = right;
 }
 
-static bool
-__preorder_traverse(BinTree_T btree, bool (*apply_fn)(Object_T))
+Object_T
+BinTree_data(BinTree_T btree)
 {
-  Require(apply_fn);
+  Require(btree);
+  return DATA(btree);
+}
+
+BinTree_T
+BinTree_left(BinTree_T btree)
+{
+  Require(btree);
+  return LEFT(btree);
+}
 
-  bool result;
+BinTree_T
+BinTree_right(BinTree_T btree)
+{
+  Require(btree);
+  return RIGHT(btree);
+}
 
-  if (BinTree_is_empty(btree))
-  { return true; }
+bool
+BinTree_traverse(BinTree_T btree, bool (*apply_fn)(Object_T), order_et order)
+{
+  Require(apply_fn);
 
-  /* First process data. */
-  result = apply_fn(DATA(btree));
+  struct walk walk;
+  __walk_start(&walk, btree, order);
 
-  if (result) {
-    result = __preorder_traverse(LEFT(btree), apply_fn);
-  }
+  Object_T items[BATCH];
+  size_t count;
+  bool result = true;
 
-  if (result) {
-    result = __preorder_traverse(RIGHT(btree), apply_fn);
+  while (result && (count = __walk_next(&walk, items, BATCH)) > 0) {
+    for (size_t i = 0; i < count && result; ++i) {
+      result = apply_fn(items[i]);
+    }
   }
 
+  __walk_end(&walk);
   return result;
 }
 
-static bool
-__inorder_traverse(BinTree_T btree, bool (*apply_fn)(Object_T))
+bool
+BinTree_traverse_batch(BinTree_T btree, apply_batch_FN apply_batch_fn, void* arg, order_et order)
 {
-  Require(apply_fn);
+  Require(apply_batch_fn);
 
-  bool result;
+  struct walk walk;
+  __walk_start(&walk, btree, order);
 
-  if (BinTree_is_empty(btree))
-  { return true; }
+  Object_T items[BATCH];
+  size_t count;
+  bool result = true;
 
-  result = __inorder_traverse(LEFT(btree), apply_fn);
-
-  /* Process data between. */
-  if (result) {
-    result = apply_fn(DATA(btree));
+  while (result && (count = __walk_next(&walk, items, BATCH)) > 0) {
+    result = apply_batch_fn(arg, items, count);
   }
 
-  if (result) {
-    result = __inorder_traverse(RIGHT(btree), apply_fn);
+  __walk_end(&walk);
+  return result;
+}
+
+size_t
+BinTree_size(BinTree_T btree)
+{
+  struct walk walk;
+  __walk_start(&walk, btree, PRE_ORDER);
+
+  Object_T items[BATCH];
+  size_t size = 0;
+  size_t count;
+
+  while ((count = __walk_next(&walk, items, BATCH)) > 0) {
+    size += count;
   }
 
-  return result;
+  __walk_end(&walk);
+  return size;
 }
 
-static bool
-__postorder_traverse(BinTree_T btree, bool (*apply_fn)(Object_T))
+/*
+ * Nodes are listed in the new order, then each old node keeps a pointer to
+ * its copy in place of its data, so links are translated in one pass.
+ * `ARENA_FIRST` is the node at the start of an arena, freeing it frees all.
+ */
+void
+BinTree_compact(BinTree_T* p_btree)
 {
-  Require(apply_fn);
+  Require(p_btree);
+
+  if (BinTree_is_empty(*p_btree))
+  { return; }
 
-  bool result;
+  const size_t size = BinTree_size(*p_btree);
 
-  if (BinTree_is_empty(btree))
-  { return true; }
+  struct frames frames = { NULL, 0, 0 };
+  const size_t height = __height(*p_btree, &frames);
 
-  result = __postorder_traverse(LEFT(btree), apply_fn);
+  btnode_t** order = ALLOC(size * sizeof (btnode_t*));
 
-  if (result) {
-    result = __postorder_traverse(RIGHT(btree), apply_fn);
+  frames.size = 0;
+  __veb(*p_btree, height, &frames, order, 0);
+  FREE(frames.items);
+
+  btnode_t* arena = ALLOC(size * sizeof (btnode_t));
+
+  for (size_t i = 0; i < size; ++i) {
+    DATA(&arena[i]) = DATA(order[i]);
+    arena[i].storage = (i == 0) ? ARENA_FIRST : IN_ARENA;
+    DATA(order[i]) = (Object_T)&arena[i];
   }
 
-  /* Process data at last. */
-  if (result) {
-    result = apply_fn(DATA(btree));
+#define COPY_OF(p_btnode)  (((p_btnode) == NULL) ? NULL : (btnode_t*)DATA(p_btnode))
+
+  for (size_t i = 0; i < size; ++i) {
+    LEFT(&arena[i]) = COPY_OF(LEFT(order[i]));
+    RIGHT(&arena[i]) = COPY_OF(RIGHT(order[i]));
   }
 
-  return result;
-}
+#undef COPY_OF
 
-bool
-BinTree_traverse(BinTree_T btree, bool (*apply_fn)(Object_T), order_et order)
-{
-  switch (order) {
-    case PRE_ORDER:
-      return __preorder_traverse(btree, apply_fn);
+  /* Old arenas go last, other nodes could be in them. */
+  btnode_t* arenas = NULL;
 
-    case IN_ORDER:
-      return __inorder_traverse(btree, apply_fn);
+  for (size_t i = 0; i < size; ++i) {
+    if (order[i]->storage == IN_HEAP) {
+      FREE(order[i]);
 
-    case POST_ORDER:
-      return __postorder_traverse(btree, apply_fn);
+    } else if (order[i]->storage == ARENA_FIRST) {
+      RIGHT(order[i]) = arenas;
+      arenas = order[i];
+    }
+  }
 
-    default:
-      Require(0 && "Unknown traverse order.");
+  while (arenas != NULL) {
+    btnode_t* next_tmp = RIGHT(arenas);
+    FREE(arenas);
+    arenas = next_tmp;
   }
 
-  return false;
+  FREE(order);
+  *p_btree = arena;
 }
 
-/* Not tail recursive. */
+/*
+ * Rotates left children up until the root has none, then the root goes and
+ * its right child is next. No stack is needed whatever the shape.
+ */
 void
 BinTree_destroy(BinTree_T* p_btree, free_data_FN free_data_fn)
 {
-  if (!BinTree_is_empty(*p_btree)) {
-    BinTree_destroy(&LEFT(*p_btree), free_data_fn);
-    BinTree_destroy(&RIGHT(*p_btree), free_data_fn);
+  Require(p_btree);
+
+  btnode_t* node = *p_btree;
+  btnode_t* arenas = NULL;
+
+  while (node != NULL) {
+    if (LEFT(node) != NULL) {
+      btnode_t* left = LEFT(node);
+
+      LEFT(node) = RIGHT(left);
+      RIGHT(left) = node;
+      node = left;
+      continue;
+    }
+
+    btnode_t* next_tmp = RIGHT(node);
 
     if (free_data_fn != NULL) {
-      free_data_fn(DATA(*p_btree));
+      free_data_fn(DATA(node));
+    }
+
+    if (node->storage == IN_HEAP) {
+      FREE(node);
+
+    } else if (node->storage == ARENA_FIRST) {
+      RIGHT(node) = arenas;
+      arenas = node;
     }
 
-    __free_tree_node(p_btree);
+    node = next_tmp;
+  }
+
+  while (arenas != NULL) {
+    btnode_t* next_tmp = RIGHT(arenas);
+    FREE(arenas);
+    arenas = next_tmp;
   }
+
+  *p_btree = NULL;
 }
 
 void
@@ -0,0 +1,727 @@
+/**
+ * @file     bplus_tree.c
+ * @brief    B+-tree with nodes of eight cache lines.
+ *
+ * Inner node with `count` keys has `count + 1` children, child `i` has keys
+ * from `keys[i - 1]` (inclusive) to `keys[i]`. Every node except the root
+ * has at least `MIN_KEYS` keys, so after a split or a merge nodes are at
+ * least half full.
+ *
+ * Unused key slots are `NO_KEY`, so a node is searched by counting keys
+ * less than the wanted one over the whole array, without branches that
+ * depend on the keys. Node is a fixed size block from `ALLOC_ALIGNED`.
+ *
+ * Operations go down the tree once, remembering the path, and then split
+ * or merge nodes back up it.
+ */
+#include "data_structs/bplus_tree.h"
+
+#include <string.h>      /* memmove, memcpy */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define X86_SEARCH
+#  include <immintrin.h>
+#endif
+
+#define CACHE_LINE  64
+#define NODE_BYTES  (8 * CACHE_LINE)
+#define ORDER       28            /* Keys in a node, multiple of 4 for AVX2. */
+#define MIN_KEYS    (ORDER / 2)
+#define MAX_HEIGHT  32
+#define NO_KEY      INT64_MAX     /* Never less than a key. */
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct node {
+  int64_t keys[ORDER];
+  unsigned count;
+  bool is_leaf;
+  union {
+    struct {
+      Object_T values[ORDER];
+      struct node* next;          /* Leaf with greater keys. */
+    };
+    struct node* children[ORDER + 1];
+  };
+};
+
+_Static_assert(sizeof (struct node) <= NODE_BYTES, "node should fit in NODE_BYTES");
+
+struct bplus_tree {
+  struct node* root;
+  size_t length;
+  size_t height;
+  bool avx2;
+};
+
+/* Nodes from the root to a leaf and the children taken. */
+typedef struct {
+  struct node* node;
+  unsigned idx;
+} step_t;
+
+static struct node*
+__node_new(bool is_leaf)
+{
+  struct node* node = ALLOC_ALIGNED(CACHE_LINE, NODE_BYTES);
+
+  for (size_t i = 0; i < ORDER; ++i) {
+    node->keys[i] = NO_KEY;
+  }
+
+  node->count = 0;
+  node->is_leaf = is_leaf;
+
+  if (is_leaf)
+  { node->next = NULL; }
+
+  return node;
+}
+
+static void
+__pad(struct node* node)
+{
+  for (size_t i = node->count; i < ORDER; ++i) {
+    node->keys[i] = NO_KEY;
+  }
+}
+
+#if defined(X86_SEARCH)
+
+__attribute__((target("avx2"))) static unsigned
+__count_less_avx2(const int64_t* keys, int64_t key)
+{
+  const __m256i wanted = _mm256_set1_epi64x(key);
+  __m256i count = _mm256_setzero_si256();
+
+  /* Compare gives -1 for every key less. */
+  for (size_t i = 0; i < ORDER; i += 4) {
+    const __m256i less = _mm256_cmpgt_epi64(wanted, _mm256_loadu_si256((const __m256i*)&keys[i]));
+    count = _mm256_sub_epi64(count, less);
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, count);
+
+  return (unsigned)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2"))) static unsigned
+__count_greater_avx2(const int64_t* keys, int64_t key)
+{
+  const __m256i wanted = _mm256_set1_epi64x(key);
+  __m256i count = _mm256_setzero_si256();
+
+  for (size_t i = 0; i < ORDER; i += 4) {
+    const __m256i greater = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)&keys[i]), wanted);
+    count = _mm256_sub_epi64(count, greater);
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, count);
+
+  return (unsigned)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+#endif  /* X86_SEARCH */
+
+static unsigned
+__count_less(BPTree_T tree, const struct node* node, int64_t key)
+{
+#if defined(X86_SEARCH)
+  if (tree->avx2)
+  { return __count_less_avx2(node->keys, key); }
+#else
+  (void)tree;
+#endif
+
+  unsigned count = 0;
+
+  for (size_t i = 0; i < ORDER; ++i) {
+    count += (unsigned)(node->keys[i] < key);
+  }
+
+  return count;
+}
+
+static unsigned
+__count_greater(BPTree_T tree, const struct node* node, int64_t key)
+{
+#if defined(X86_SEARCH)
+  if (tree->avx2)
+  { return __count_greater_avx2(node->keys, key); }
+#else
+  (void)tree;
+#endif
+
+  unsigned count = 0;
+
+  for (size_t i = 0; i < ORDER; ++i) {
+    count += (unsigned)(node->keys[i] > key);
+  }
+
+  return count;
+}
+
+/* Position of `key` in a leaf, or where it should be. */
+static unsigned
+__lower_bound(BPTree_T tree, const struct node* node, int64_t key)
+{
+  return __count_less(tree, node, key);
+}
+
+/* Child of an inner node that could have `key`. */
+static unsigned
+__child(BPTree_T tree, const struct node* node, int64_t key)
+{
+  /* Unused slots are not greater than `NO_KEY` itself. */
+  const unsigned idx = ORDER - __count_greater(tree, node, key);
+  return (idx < node->count) ? idx : node->count;
+}
+
+/* Go down to the leaf that could have `key`, remember the path if asked. */
+static struct node*
+__descend(BPTree_T tree, int64_t key, step_t* path__, size_t* p_depth__)
+{
+  struct node* node = tree->root;
+  size_t depth = 0;
+
+  while (!node->is_leaf) {
+    const unsigned idx = __child(tree, node, key);
+
+    if (path__ != NULL) {
+      path__[depth].node = node;
+      path__[depth].idx = idx;
+    }
+
+    depth++;
+    node = node->children[idx];
+  }
+
+  if (p_depth__ != NULL)
+  { *p_depth__ = depth; }
+
+  return node;
+}
+
+static void
+__leaf_insert(struct node* leaf, unsigned idx, int64_t key, Object_T value)
+{
+  const size_t after = leaf->count - idx;
+
+  memmove(&leaf->keys[idx + 1], &leaf->keys[idx], after * sizeof (int64_t));
+  memmove(&leaf->values[idx + 1], &leaf->values[idx], after * sizeof (Object_T));
+
+  leaf->keys[idx] = key;
+  leaf->values[idx] = value;
+  leaf->count++;
+}
+
+/* Upper half of a full leaf goes to `right`. */
+static void
+__split_leaf(struct node* leaf, struct node* right)
+{
+  const size_t moved = ORDER - MIN_KEYS;
+
+  memcpy(right->keys, &leaf->keys[MIN_KEYS], moved * sizeof (int64_t));
+  memcpy(right->values, &leaf->values[MIN_KEYS], moved * sizeof (Object_T));
+
+  right->count = (unsigned)moved;
+  leaf->count = MIN_KEYS;
+  __pad(leaf);
+
+  right->next = leaf->next;
+  leaf->next = right;
+}
+
+/* `child` has keys from `key` on and goes right of child `idx`. */
+static void
+__inner_insert(struct node* node, unsigned idx, int64_t key, struct node* child)
+{
+  const size_t after = node->count - idx;
+
+  memmove(&node->keys[idx + 1], &node->keys[idx], after * sizeof (int64_t));
+  memmove(&node->children[idx + 2], &node->children[idx + 1], after * sizeof (struct node*));
+
+  node->keys[idx] = key;
+  node->children[idx + 1] = child;
+  node->count++;
+}
+
+/*
+ * Insert to a full inner node, its upper half goes to `right`. Return key
+ * between them, it moves up to the parent.
+ */
+static int64_t
+__split_inner(struct node* node, unsigned idx, int64_t key, struct node* child,
+              struct node* right)
+{
+  int64_t keys[ORDER + 1];
+  struct node* children[ORDER + 2];
+
+  memcpy(keys, node->keys, ORDER * sizeof (int64_t));
+  memcpy(children, node->children, (ORDER + 1) * sizeof (struct node*));
+
+  memmove(&keys[idx + 1], &keys[idx], (ORDER - idx) * sizeof (int64_t));
+  memmove(&children[idx + 2], &children[idx + 1], (ORDER - idx) * sizeof (struct node*));
+  keys[idx] = key;
+  children[idx + 1] = child;
+
+  const size_t left = (ORDER + 1) / 2;
+  const size_t moved = ORDER - left;
+
+  memcpy(node->keys, keys, left * sizeof (int64_t));
+  memcpy(node->children, children, (left + 1) * sizeof (struct node*));
+  node->count = (unsigned)left;
+  __pad(node);
+
+  memcpy(right->keys, &keys[left + 1], moved * sizeof (int64_t));
+  memcpy(right->children, &children[left + 1], (moved + 1) * sizeof (struct node*));
+  right->count = (unsigned)moved;
+
+  return keys[left];
+}
+
+/* Remove key `idx` and the child right of it. */
+static void
+__inner_remove(struct node* node, unsigned idx)
+{
+  const size_t after = node->count - idx - 1;
+
+  memmove(&node->keys[idx], &node->keys[idx + 1], after * sizeof (int64_t));
+  memmove(&node->children[idx + 1], &node->children[idx + 2], after * sizeof (struct node*));
+
+  node->count--;
+  node->keys[node->count] = NO_KEY;
+}
+
+/* Move the first element of `right` to the end of `left`. */
+static void
+__shift_left(struct node* parent, unsigned sep, struct node* left, struct node* right)
+{
+  const size_t after = right->count - 1;
+
+  if (left->is_leaf) {
+    left->keys[left->count] = right->keys[0];
+    left->values[left->count] = right->values[0];
+
+    memmove(right->keys, &right->keys[1], after * sizeof (int64_t));
+    memmove(right->values, &right->values[1], after * sizeof (Object_T));
+
+    parent->keys[sep] = right->keys[0];
+
+  } else {
+    left->keys[left->count] = parent->keys[sep];
+    left->children[left->count + 1] = right->children[0];
+    parent->keys[sep] = right->keys[0];
+
+    memmove(right->keys, &right->keys[1], after * sizeof (int64_t));
+    memmove(right->children, &right->children[1], right->count * sizeof (struct node*));
+  }
+
+  left->count++;
+  right->count--;
+  right->keys[right->count] = NO_KEY;
+}
+
+/* Move the last element of `left` to the start of `right`. */
+static void
+__shift_right(struct node* parent, unsigned sep, struct node* left, struct node* right)
+{
+  const size_t last = left->count - 1;
+
+  memmove(&right->keys[1], right->keys, right->count * sizeof (int64_t));
+
+  if (left->is_leaf) {
+    memmove(&right->values[1], right->values, right->count * sizeof (Object_T));
+
+    right->keys[0] = left->keys[last];
+    right->values[0] = left->values[last];
+    parent->keys[sep] = right->keys[0];
+
+  } else {
+    memmove(&right->children[1], right->children, (right->count + 1) * sizeof (struct node*));
+
+    right->keys[0] = parent->keys[sep];
+    right->children[0] = left->children[last + 1];
+    parent->keys[sep] = left->keys[last];
+  }
+
+  right->count++;
+  left->count--;
+  left->keys[left->count] = NO_KEY;
+}
+
+/* `right` goes into `left` and is freed. */
+static void
+__merge(struct node* parent, unsigned sep, struct node* left, struct node* right)
+{
+  if (left->is_leaf) {
+    memcpy(&left->keys[left->count], right->keys, right->count * sizeof (int64_t));
+    memcpy(&left->values[left->count], right->values, right->count * sizeof (Object_T));
+
+    left->count += right->count;
+    left->next = right->next;
+
+  } else {
+    left->keys[left->count] = parent->keys[sep];
+
+    memcpy(&left->keys[left->count + 1], right->keys, right->count * sizeof (int64_t));
+    memcpy(&left->children[left->count + 1], right->children,
+           (right->count + 1) * sizeof (struct node*));
+
+    left->count += right->count + 1;
+  }
+
+  FREE_ALIGNED(right);
+  __inner_remove(parent, sep);
+}
+
+/* Child `idx` of `parent` has too few keys, take one from a sibling or merge. */
+static void
+__rebalance(struct node* parent, unsigned idx)
+{
+  const unsigned sep = (idx > 0) ? idx - 1 : 0;
+  struct node* left = parent->children[sep];
+  struct node* right = parent->children[sep + 1];
+  const unsigned merged = left->count + right->count + (left->is_leaf ? 0 : 1);
+
+  if (merged <= ORDER) {
+    __merge(parent, sep, left, right);
+
+  } else if (left->count < right->count) {
+    __shift_left(parent, sep, left, right);
+
+  } else {
+    __shift_right(parent, sep, left, right);
+  }
+}
+
+static void
+__free_node(struct node* node, free_data_FN free_data_fn)
+{
+  if (node->is_leaf) {
+    if (free_data_fn != NULL) {
+      for (size_t i = 0; i < node->count; ++i) {
+        free_data_fn(node->values[i]);
+      }
+    }
+
+  } else {
+    for (size_t i = 0; i <= node->count; ++i) {
+      __free_node(node->children[i], free_data_fn);
+    }
+  }
+
+  FREE_ALIGNED(node);
+}
+
+/* ______________________________________________________________________________ */
+
+BPTree_T
+BPTree_new(void)
+{
+  BPTree_T tree;
+  NEW(tree);
+
+  tree->root = __node_new(true);
+  tree->length = 0;
+  tree->height = 1;
+  tree->avx2 = false;
+
+#if defined(X86_SEARCH)
+  __builtin_cpu_init();
+  tree->avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+
+  return tree;
+}
+
+BPTree_T
+BPTree_load(const int64_t* keys, const Object_T* values, size_t n)
+{
+  Require((keys && values) || n == 0);
+
+  BPTree_T tree = BPTree_new();
+
+  if (n == 0)
+  { return tree; }
+
+  for (size_t i = 1; i < n; ++i) {
+    Require(keys[i - 1] < keys[i]);
+  }
+
+  /* Elements are spread evenly, so the last node is not left almost empty. */
+  size_t count = (n + ORDER - 1) / ORDER;
+  struct node** level = ALLOC(count * sizeof (struct node*));
+  int64_t* firsts = ALLOC(count * sizeof (int64_t));
+
+  FREE_ALIGNED(tree->root);
+
+  size_t taken = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    struct node* leaf = __node_new(true);
+    const size_t length = n / count + (i < n % count);
+
+    memcpy(leaf->keys, &keys[taken], length * sizeof (int64_t));
+    memcpy(leaf->values, &values[taken], length * sizeof (Object_T));
+    leaf->count = (unsigned)length;
+
+    if (i > 0)
+    { level[i - 1]->next = leaf; }
+
+    level[i] = leaf;
+    firsts[i] = keys[taken];
+    taken += length;
+  }
+
+  size_t height = 1;
+
+  /* Parents are written over their children, which are already read. */
+  while (count > 1) {
+    const size_t parents = (count + ORDER) / (ORDER + 1);
+    taken = 0;
+
+    for (size_t i = 0; i < parents; ++i) {
+      struct node* parent = __node_new(false);
+      const size_t length = count / parents + (i < count % parents);
+
+      for (size_t k = 0; k < length; ++k) {
+        parent->children[k] = level[taken + k];
+
+        if (k > 0)
+        { parent->keys[k - 1] = firsts[taken + k]; }
+      }
+
+      parent->count = (unsigned)(length - 1);
+
+      level[i] = parent;
+      firsts[i] = firsts[taken];
+      taken += length;
+    }
+
+    count = parents;
+    height++;
+  }
+
+  tree->root = level[0];
+  tree->length = n;
+  tree->height = height;
+
+  FREE(firsts);
+  FREE(level);
+
+  return tree;
+}
+
+bool
+BPTree_put(BPTree_T tree, int64_t key, Object_T value)
+{
+  Require(tree);
+
+  step_t path[MAX_HEIGHT];
+  size_t depth;
+  struct node* leaf = __descend(tree, key, path, &depth);
+  unsigned idx = __lower_bound(tree, leaf, key);
+
+  if (idx < leaf->count && leaf->keys[idx] == key) {
+    leaf->values[idx] = value;
+    return false;
+  }
+
+  tree->length++;
+
+  if (leaf->count < ORDER) {
+    __leaf_insert(leaf, idx, key, value);
+    return true;
+  }
+
+  struct node* right = __node_new(true);
+  __split_leaf(leaf, right);
+
+  if (idx <= leaf->count) {
+    __leaf_insert(leaf, idx, key, value);
+
+  } else {
+    __leaf_insert(right, idx - leaf->count, key, value);
+  }
+
+  int64_t separator = right->keys[0];
+
+  while (depth > 0) {
+    depth--;
+
+    struct node* parent = path[depth].node;
+    idx = path[depth].idx;
+
+    if (parent->count < ORDER) {
+      __inner_insert(parent, idx, separator, right);
+      return true;
+    }
+
+    struct node* sibling = __node_new(false);
+    separator = __split_inner(parent, idx, separator, right, sibling);
+    right = sibling;
+  }
+
+  struct node* root = __node_new(false);
+
+  root->keys[0] = separator;
+  root->children[0] = tree->root;
+  root->children[1] = right;
+  root->count = 1;
+
+  tree->root = root;
+  tree->height++;
+
+  Ensure(tree->height <= MAX_HEIGHT);
+  return true;
+}
+
+bool
+BPTree_get(BPTree_T tree, int64_t key, Object_T* p_value__)
+{
+  Require(tree);
+  Require(p_value__);
+
+  const struct node* leaf = __descend(tree, key, NULL, NULL);
+  const unsigned idx = __lower_bound(tree, leaf, key);
+
+  if (idx < leaf->count && leaf->keys[idx] == key) {
+    *p_value__ = leaf->values[idx];
+    return true;
+  }
+
+  return false;
+}
+
+bool
+BPTree_remove(BPTree_T tree, int64_t key, Object_T* p_value__)
+{
+  Require(tree);
+
+  step_t path[MAX_HEIGHT];
+  size_t depth;
+  struct node* node = __descend(tree, key, path, &depth);
+  const unsigned idx = __lower_bound(tree, node, key);
+
+  if (idx >= node->count || node->keys[idx] != key)
+  { return false; }
+
+  if (p_value__ != NULL)
+  { *p_value__ = node->values[idx]; }
+
+  const size_t after = node->count - idx - 1;
+
+  memmove(&node->keys[idx], &node->keys[idx + 1], after * sizeof (int64_t));
+  memmove(&node->values[idx], &node->values[idx + 1], after * sizeof (Object_T));
+
+  node->count--;
+  node->keys[node->count] = NO_KEY;
+  tree->length--;
+
+  while (depth > 0 && node->count < MIN_KEYS) {
+    depth--;
+    __rebalance(path[depth].node, path[depth].idx);
+    node = path[depth].node;
+  }
+
+  if (!tree->root->is_leaf && tree->root->count == 0) {
+    struct node* root = tree->root;
+
+    tree->root = root->children[0];
+    tree->height--;
+    FREE_ALIGNED(root);
+  }
+
+  return true;
+}
+
+size_t
+BPTree_length(BPTree_T tree)
+{
+  Require(tree);
+  return tree->length;
+}
+
+size_t
+BPTree_height(BPTree_T tree)
+{
+  Require(tree);
+  return tree->height;
+}
+
+size_t
+BPTree_range(BPTree_T tree, int64_t low, int64_t high, visit_FN visit_fn, void* arg)
+{
+  Require(tree);
+  Require(visit_fn);
+
+  const struct node* leaf = __descend(tree, low, NULL, NULL);
+  unsigned idx = __lower_bound(tree, leaf, low);
+  size_t visited = 0;
+
+  while (leaf != NULL) {
+    for (; idx < leaf->count; ++idx) {
+      if (leaf->keys[idx] > high)
+      { return visited; }
+
+      visited++;
+
+      if (!visit_fn(leaf->keys[idx], leaf->values[idx], arg))
+      { return visited; }
+    }
+
+    leaf = leaf->next;
+    idx = 0;
+  }
+
+  return visited;
+}
+
+size_t
+BPTree_scan(BPTree_T tree, int64_t from, int64_t* keys__, Object_T* values__, size_t n)
+{
+  Require(tree);
+  Require((keys__ && values__) || n == 0);
+
+  const struct node* leaf = __descend(tree, from, NULL, NULL);
+  size_t idx = __lower_bound(tree, leaf, from);
+  size_t copied = 0;
+
+  while (leaf != NULL && copied < n) {
+    const size_t available = leaf->count - idx;
+    const size_t length = (available < n - copied) ? available : n - copied;
+
+    memcpy(&keys__[copied], &leaf->keys[idx], length * sizeof (int64_t));
+    memcpy(&values__[copied], &leaf->values[idx], length * sizeof (Object_T));
+
+    copied += length;
+    leaf = leaf->next;
+    idx = 0;
+  }
+
+  return copied;
+}
+
+void
+BPTree_destroy(BPTree_T* p_tree, free_data_FN free_data_fn)
+{
+  Require(p_tree);
+
+  if (*p_tree == NULL)
+  { return; }
+
+  __free_node((*p_tree)->root, free_data_fn);
+  FREE(*p_tree);
+}
+
+void
+BPTree_free(BPTree_T* p_tree)
+{
+  BPTree_destroy(p_tree, NULL);
+}
@@ -5,37 +5,6 @@
 #include "lang/memory.h"
 #include "logger/log.h"
 
-/* __________________________________________________________________________ */
-/*                                                                     Local  */
-
-/* Delete given `p_node` from `p_circlist`. */
-static void
-__delete_node(CircList_T* p_circlist, node_t* p_node)
-{
-  if (p_node == NEXT(p_node)) {
-    /* Delete the only node in the list. */
-    *p_circlist = NULL;
-
-  } else {
-    node_t* node_iter;
-    for (node_iter = NEXT(*p_circlist); node_iter != *p_circlist
-         && NEXT(node_iter) != p_node; ) {
-
-      node_iter = NEXT(node_iter);
-    }
-
-    Ensure(NEXT(node_iter) == p_node);
-
-    NEXT(node_iter) = NEXT(p_node);
-    if (p_node == *p_circlist) {
-      /* Deleting the last node in the list, so update `p_circlist`. */
-      *p_circlist = node_iter;
-    }
-  }
-
-  List__free_node(&p_node);
-}
-
 /* __________________________________________________________________________ */
 
 CircList_T
@@ -51,7 +20,7 @@ CircList_is_empty(CircList_T circlist)
   return circlist == NULL;
 }
 
-/* Every time insert after current first element. First element remains fist. */
+/* Every time insert after the last element, so it becomes the first. */
 void
 CircList_insert(CircList_T* p_circlist, Object_T data)
 {
@@ -61,24 +30,32 @@ CircList_insert(CircList_T* p_circlist, Object_T data)
   List__allocate_node(&new_node, data);
 
   if (CircList_is_empty(*p_circlist)) {
+    List__allocate_header(p_circlist);
+
     /* Point to itself - circular list with one element. */
     NEXT(new_node) = new_node;
-    *p_circlist = new_node;
+    TAIL(*p_circlist) = new_node;
 
   } else {
 
-    NEXT(new_node) = NEXT(*p_circlist);
-    NEXT(*p_circlist) = new_node;
+    NEXT(new_node) = HEAD(*p_circlist);
+    NEXT(TAIL(*p_circlist)) = new_node;
   }
+
+  HEAD(*p_circlist) = new_node;
+  LENGTH(*p_circlist)++;
 }
 
 void
 CircList_append(CircList_T* p_circlist, Object_T data)
 {
   CircList_insert(p_circlist, data);
-  *p_circlist = NEXT(*p_circlist);
+
+  TAIL(*p_circlist) = HEAD(*p_circlist);
+  HEAD(*p_circlist) = NEXT(HEAD(*p_circlist));
 }
 
+/* The first node follows the last one, so there is nothing to search. */
 bool
 CircList_delete(CircList_T* p_circlist, Object_T* p_data__)
 {
@@ -87,8 +64,19 @@ CircList_delete(CircList_T* p_circlist, Object_T* p_data__)
     return false;
   }
 
-  *p_data__ = DATA(NEXT(*p_circlist));
-  __delete_node(p_circlist, *p_circlist /* Fist node in practice. */);
+  node_t* p_node = HEAD(*p_circlist);
+  *p_data__ = DATA(p_node);
+
+  if (--LENGTH(*p_circlist) == 0) {
+    /* Delete the only node in the list. */
+    List__free_header(p_circlist);
+
+  } else {
+    HEAD(*p_circlist) = NEXT(p_node);
+    NEXT(TAIL(*p_circlist)) = HEAD(*p_circlist);
+  }
+
+  List__free_node(&p_node);
 
   return true;
 }
@@ -96,21 +84,15 @@ CircList_delete(CircList_T* p_circlist, Object_T* p_data__)
 bool
 CircList_traverse(CircList_T circlist, bool (*apply_fn)(Object_T))
 {
-  node_t* tmp;
-  if (CircList_is_empty(circlist)) {
-    return true;
-  }
+  node_t* curr_node = NULL;
 
-  tmp = circlist;
-  do {
-    /* Start from the bottom. */
-    tmp = NEXT(tmp);
+  while ((curr_node = CircList_iterator(circlist, curr_node)) != NULL) {
 
-    if (!(*apply_fn)(DATA(tmp))) {
+    if (!(*apply_fn)(DATA(curr_node))) {
       Log_error("Can't apply function.");
       return false;
     }
-  } while (tmp != circlist) ;
+  }
 
   return true;
 }
@@ -123,40 +105,36 @@ CircList_nth(CircList_T circlist, int idx)
   }
 
   if (idx == -1) {
-    return circlist;
+    return TAIL(circlist);
   }
 
-  node_t* iter = circlist;
-  do {
-    iter = NEXT(iter);
-    --idx;
+  if (idx < 1 || (size_t)idx > LENGTH(circlist)) {
+    return NULL;
+  }
 
-  } while (idx > 0 && iter != circlist);
+  node_t* iter = HEAD(circlist);
+  while (--idx > 0) {
+    iter = NEXT(iter);
+  }
 
-  return (idx != 0) ? NULL : iter;
+  return iter;
 }
 
 node_t*
 CircList_iterator(CircList_T circlist, node_t* last_return)
 {
   if (last_return == NULL) {
-    return (circlist) ? NEXT(circlist) : NULL;
+    return (circlist) ? HEAD(circlist) : NULL;
   }
 
   /* Do we reach the beginning? */
-  return (last_return == circlist) ? NULL : NEXT(last_return);
+  return (last_return == TAIL(circlist)) ? NULL : NEXT(last_return);
 }
 
 size_t
 CircList_length(CircList_T circlist)
 {
-  size_t accum = 0;
-  node_t* curr_node = NULL;
-
-  while ((curr_node = CircList_iterator(circlist, curr_node)) != NULL)
-  { ++accum; }
-
-  return accum;
+  return CircList_is_empty(circlist) ? 0 : LENGTH(circlist);
 }
 
 void
@@ -164,17 +142,23 @@ CircList_destroy(CircList_T* p_circlist, free_data_FN free_data_fn)
 {
   Require(p_circlist);
 
-  /* First iteration will initialize it. */
-  CircList_T next_tmp = NULL;
-  for ( ; *p_circlist != next_tmp; *p_circlist = next_tmp) {
-    next_tmp = NEXT(*p_circlist);
+  if (CircList_is_empty(*p_circlist))
+  { return; }
+
+  node_t* next_tmp;
+  node_t* p_node = HEAD(*p_circlist);
+
+  for (size_t n = LENGTH(*p_circlist); n > 0; --n, p_node = next_tmp) {
+    next_tmp = NEXT(p_node);
 
     if (free_data_fn != NULL) {
-      free_data_fn(DATA(*p_circlist));
+      free_data_fn(DATA(p_node));
     }
 
-    FREE(*p_circlist);
+    List__free_node(&p_node);
   }
+
+  List__free_header(p_circlist);
 }
 
 void
@@ -0,0 +1,468 @@
+/**
+ * @file     double_list-unrolled.c
+ * @brief    Unrolled double linked list.
+ *
+ * Compiled instead of `double_list.c` when `LIST_UNROLLED_MODE` is defined
+ * (`--enable-unrolled-lists`). Elements are kept in double linked chunks of
+ * `CHUNK_ITEMS`, see `list-unrolled.c`.
+ *
+ * A `doublenode_t*` is the address of an element slot in its chunk. A chunk
+ * is split when an element is inserted into a full one and when a cut or a
+ * paste falls inside it; functions that take `doublenode_t**` update the
+ * pointers of elements they move. A chunk left under half full by a delete
+ * takes elements of the next one.
+ *
+ * ATTENTION: Elements move inside their chunk when the list is changed, so
+ *            other node pointers are valid until the next change.
+ */
+#include "data_structs/double_list.h"
+
+#if defined(LIST_UNROLLED_MODE)
+
+#include <stdint.h>      /* uintptr_t                   */
+#include <string.h>      /* memcpy, memmove             */
+#include "lang/assert.h"
+#include "lang/memory.h"
+#include "logger/log.h"
+
+/* Four cache lines. */
+#define CHUNK_SIZE   256
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+struct double_node {
+  Object_T datapointer;
+};
+
+typedef struct chunk {
+  struct chunk* prev;
+  struct chunk* next;
+  size_t count;
+  doublenode_t items[];
+} chunk_t;
+
+#define CHUNK_ITEMS  ((CHUNK_SIZE - sizeof (chunk_t)) / sizeof (doublenode_t))
+
+#define CHUNK(p_node)  ((chunk_t*)((uintptr_t)(p_node) & ~(uintptr_t)(CHUNK_SIZE - 1)))
+#define INDEX(p_node)  ((size_t)((p_node) - CHUNK(p_node)->items))
+#define DATA(p_node)   ((p_node)->datapointer)
+
+static chunk_t*
+__allocate_chunk(void)
+{
+  chunk_t* p_chunk = ALLOC_ALIGNED(CHUNK_SIZE, CHUNK_SIZE);
+
+  p_chunk->prev = NULL;
+  p_chunk->next = NULL;
+  p_chunk->count = 0;
+
+  return p_chunk;
+}
+
+static void
+__free_chunk(chunk_t* p_chunk)
+{
+  FREE_ALIGNED(p_chunk);
+}
+
+/* Moves elements from `at` to a new chunk linked after `p_chunk`. */
+static chunk_t*
+__split(chunk_t* p_chunk, size_t at)
+{
+  chunk_t* p_new = __allocate_chunk();
+
+  p_new->count = p_chunk->count - at;
+  memcpy(p_new->items, &p_chunk->items[at], p_new->count * sizeof (doublenode_t));
+  p_chunk->count = at;
+
+  p_new->prev = p_chunk;
+  p_new->next = p_chunk->next;
+
+  if (p_chunk->next != NULL)
+  { p_chunk->next->prev = p_new; }
+
+  p_chunk->next = p_new;
+
+  return p_new;
+}
+
+/* Follows an element moved by `__split(from, at)`. */
+static void
+__remap(doublenode_t** pp_node, chunk_t* from, size_t at, chunk_t* to)
+{
+  if (*pp_node != NULL && CHUNK(*pp_node) == from && INDEX(*pp_node) >= at)
+  { *pp_node = &to->items[INDEX(*pp_node) - at]; }
+}
+
+/* Chunk under half full takes the elements of the next one, see `list-unrolled.c`. */
+static void
+__refill(chunk_t* p_chunk)
+{
+  chunk_t* next = p_chunk->next;
+
+  if (p_chunk->count + next->count <= CHUNK_ITEMS) {
+    memcpy(&p_chunk->items[p_chunk->count], next->items, next->count * sizeof (doublenode_t));
+    p_chunk->count += next->count;
+    p_chunk->next = next->next;
+
+    if (next->next != NULL)
+    { next->next->prev = p_chunk; }
+
+    __free_chunk(next);
+    return;
+  }
+
+  p_chunk->items[p_chunk->count++] = next->items[0];
+
+  next->count--;
+  memmove(&next->items[0], &next->items[1], next->count * sizeof (doublenode_t));
+}
+
+static chunk_t*
+__last_chunk(chunk_t* p_chunk)
+{
+  while (p_chunk->next != NULL) {
+    p_chunk = p_chunk->next;
+  }
+
+  return p_chunk;
+}
+
+/* __________________________________________________________________________ */
+
+DoubleList_T
+DoubleList_new(void)
+{
+  DoubleList_T list = NULL;
+  return list;
+}
+
+bool
+DoubleList_is_empty(DoubleList_T list)
+{
+  return list == NULL;
+}
+
+void
+DoubleList_insert(DoubleList_T* p_list, Object_T data)
+{
+  Require(p_list);
+
+  if (DoubleList_is_empty(*p_list)) {
+    chunk_t* p_chunk = __allocate_chunk();
+
+    DATA(&p_chunk->items[0]) = data;
+    p_chunk->count = 1;
+
+    *p_list = &p_chunk->items[0];
+    return;
+  }
+
+  chunk_t* p_chunk = CHUNK(*p_list);
+  size_t idx = INDEX(*p_list);
+
+  if (p_chunk->count == CHUNK_ITEMS) {
+    chunk_t* p_half = __split(p_chunk, CHUNK_ITEMS / 2);
+
+    if (idx >= CHUNK_ITEMS / 2) {
+      p_chunk = p_half;
+      idx -= CHUNK_ITEMS / 2;
+    }
+  }
+
+  memmove(&p_chunk->items[idx + 1], &p_chunk->items[idx],
+          (p_chunk->count - idx) * sizeof (doublenode_t));
+
+  DATA(&p_chunk->items[idx]) = data;
+  p_chunk->count++;
+
+  *p_list = &p_chunk->items[idx];
+}
+
+void
+DoubleList_append(DoubleList_T* p_list, Object_T data)
+{
+  Require(p_list);
+
+  if (DoubleList_is_empty(*p_list)) {
+    DoubleList_insert(p_list, data);
+    return;
+  }
+
+  chunk_t* last = __last_chunk(CHUNK(*p_list));
+
+  if (last->count == CHUNK_ITEMS) {
+    last->next = __allocate_chunk();
+    last->next->prev = last;
+    last = last->next;
+  }
+
+  DATA(&last->items[last->count++]) = data;
+}
+
+size_t
+DoubleList_length(DoubleList_T list)
+{
+  if (DoubleList_is_empty(list))
+  { return 0; }
+
+  chunk_t* p_chunk = CHUNK(list);
+  size_t n = p_chunk->count - INDEX(list);
+
+  for (p_chunk = p_chunk->next; p_chunk != NULL; p_chunk = p_chunk->next)
+  { n += p_chunk->count; }
+
+  return n;
+}
+
+doublenode_t*
+DoubleList_nth(DoubleList_T list, int idx)
+{
+  Require(idx != 0);
+
+  if (DoubleList_is_empty(list)) {
+    return NULL;
+  }
+
+  chunk_t* p_chunk = CHUNK(list);
+
+  if (idx > 0) {
+    size_t skip = INDEX(list) + (size_t)(idx - 1);
+
+    while (p_chunk != NULL && skip >= p_chunk->count) {
+      skip -= p_chunk->count;
+      p_chunk = p_chunk->next;
+    }
+
+    return (p_chunk != NULL) ? &p_chunk->items[skip] : NULL;
+  }
+
+  /* For negative index we start from the end. */
+  size_t back = (size_t)(-(idx + 1));
+
+  for (p_chunk = __last_chunk(p_chunk); p_chunk != NULL && back >= p_chunk->count; ) {
+    back -= p_chunk->count;
+    p_chunk = p_chunk->prev;
+  }
+
+  return (p_chunk != NULL) ? &p_chunk->items[p_chunk->count - 1 - back] : NULL;
+}
+
+bool
+DoubleList_delete_head(DoubleList_T* p_list, Object_T* p_data__)
+{
+  if (DoubleList_is_empty(*p_list)) {
+    Log_debug("Can't delete from empty double list.");
+    return false;
+  }
+
+  chunk_t* p_chunk = CHUNK(*p_list);
+  const size_t idx = INDEX(*p_list);
+
+  *p_data__ = DATA(*p_list);
+
+  p_chunk->count--;
+  memmove(&p_chunk->items[idx], &p_chunk->items[idx + 1],
+          (p_chunk->count - idx) * sizeof (doublenode_t));
+
+  if (p_chunk->count < CHUNK_ITEMS / 2 && p_chunk->next != NULL)
+  { __refill(p_chunk); }
+
+  /* Continue with the next or if there is no next with the previous. */
+  if (idx < p_chunk->count)
+  { return true; }
+
+  chunk_t* prev = p_chunk->prev;
+  chunk_t* next = p_chunk->next;
+
+  if (next != NULL)
+  { *p_list = &next->items[0]; }
+  else if (idx > 0)
+  { *p_list = &p_chunk->items[idx - 1]; }
+  else
+  { *p_list = (prev != NULL) ? &prev->items[prev->count - 1] : NULL; }
+
+  if (p_chunk->count == 0) {
+    if (prev != NULL)
+    { prev->next = next; }
+
+    if (next != NULL)
+    { next->prev = prev; }
+
+    __free_chunk(p_chunk);
+  }
+
+  return true;
+}
+
+bool
+DoubleList_traverse(DoubleList_T list, bool (*apply_fn)(Object_T))
+{
+  Require(apply_fn);
+
+  if (DoubleList_is_empty(list))
+  { return true; }
+
+  size_t i = INDEX(list);
+
+  for (chunk_t* p_chunk = CHUNK(list); p_chunk; p_chunk = p_chunk->next, i = 0) {
+    for (; i < p_chunk->count; ++i) {
+
+      if (!(*apply_fn)(DATA(&p_chunk->items[i]))) {
+        Log_error("Can't apply function.");
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Range is split off to whole chunks that are unlinked. */
+void
+DoubleList_cut(DoubleList_T* p_list, doublenode_t** pp_start, doublenode_t** pp_end)
+{
+  Require(p_list);
+  Require(pp_start && *pp_start);
+  Require(pp_end && *pp_end);
+
+  const bool cut_head = (*p_list == *pp_start);
+
+  chunk_t* p_chunk = CHUNK(*pp_start);
+  size_t at = INDEX(*pp_start);
+
+  if (at > 0) {
+    chunk_t* p_new = __split(p_chunk, at);
+
+    __remap(p_list, p_chunk, at, p_new);
+    __remap(pp_end, p_chunk, at, p_new);
+    *pp_start = &p_new->items[0];
+  }
+
+  p_chunk = CHUNK(*pp_end);
+  at = INDEX(*pp_end) + 1;
+
+  if (at < p_chunk->count)
+  { __remap(p_list, p_chunk, at, __split(p_chunk, at)); }
+
+  chunk_t* first = CHUNK(*pp_start);
+  chunk_t* last = CHUNK(*pp_end);
+
+  if (first->prev != NULL)
+  { first->prev->next = last->next; }
+
+  if (last->next != NULL)
+  { last->next->prev = first->prev; }
+
+  if (cut_head)
+  { *p_list = (last->next != NULL) ? &last->next->items[0] : NULL; }
+
+  first->prev = last->next = NULL;
+}
+
+/* If `p_target` is the last node in a list then we splay two lists. */
+void
+DoubleList_paste(DoubleList_T* p_target, DoubleList_T* p_source)
+{
+  Require(p_target);
+  Require(p_source);
+
+  if (DoubleList_is_empty(*p_source)) {
+    return;
+  }
+
+  if (DoubleList_is_empty(*p_target)) {
+    *p_target = *p_source;
+    *p_source = NULL;
+    return;
+  }
+
+  /* Source should start a chunk that has no previous one. */
+  chunk_t* first = CHUNK(*p_source);
+  const size_t at = INDEX(*p_source);
+
+  if (at > 0) {
+    first = __split(first, at);
+    *p_source = &first->items[0];
+  }
+
+  if (first->prev != NULL) {
+    first->prev->next = NULL;
+    first->prev = NULL;
+  }
+
+  chunk_t* last = __last_chunk(first);
+
+  /* Target should end its chunk. */
+  chunk_t* target = CHUNK(*p_target);
+  const size_t after = INDEX(*p_target) + 1;
+
+  if (after < target->count)
+  { __split(target, after); }
+
+  last->next = target->next;
+  if (target->next != NULL)
+  { target->next->prev = last; }
+
+  first->prev = target;
+  target->next = first;
+
+  *p_source = NULL;
+}
+
+void
+DoubleList_destroy(DoubleList_T* p_list, free_data_FN free_data_fn)
+{
+  Require(p_list);
+
+  if (DoubleList_is_empty(*p_list))
+  { return; }
+
+  chunk_t* p_chunk = CHUNK(*p_list);
+  const size_t from = INDEX(*p_list);
+
+  /* Elements before the given one stay. */
+  if (free_data_fn != NULL) {
+    for (size_t i = from; i < p_chunk->count; ++i) {
+      free_data_fn(DATA(&p_chunk->items[i]));
+    }
+  }
+
+  chunk_t* next_tmp = p_chunk->next;
+
+  if (from > 0) {
+    p_chunk->count = from;
+    p_chunk->next = NULL;
+
+  } else {
+    if (p_chunk->prev != NULL)
+    { p_chunk->prev->next = NULL; }
+
+    __free_chunk(p_chunk);
+  }
+
+  for (p_chunk = next_tmp; p_chunk != NULL; p_chunk = next_tmp) {
+    next_tmp = p_chunk->next;
+
+    if (free_data_fn != NULL) {
+      for (size_t i = 0; i < p_chunk->count; ++i) {
+        free_data_fn(DATA(&p_chunk->items[i]));
+      }
+    }
+
+    __free_chunk(p_chunk);
+  }
+
+  *p_list = NULL;
+}
+
+void
+DoubleList_free(DoubleList_T* p_list)
+{
+  DoubleList_destroy(p_list, NULL);
+}
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* LIST_UNROLLED_MODE */
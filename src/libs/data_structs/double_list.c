@@ -1,5 +1,8 @@
 #include "data_structs/double_list.h"
 
+/* See `double_list-unrolled.c` */
+#if !defined(LIST_UNROLLED_MODE)
+
 #include "lang/assert.h"
 #include "lang/memory.h"
 #include "logger/log.h"
@@ -277,3 +280,7 @@ DoubleList_free(DoubleList_T* p_list)
 {
   DoubleList_destroy(p_list, NULL);
 }
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* LIST_UNROLLED_MODE */
@@ -15,6 +15,13 @@ struct graph_descriptor {
   List_T* edge_list;
 };
 
+/* Edges are allocated with `ALLOC`. */
+static void
+__free_edge(void* p_edgedata)
+{
+  FREE(p_edgedata);
+}
+
 static bool
 __equal_vertex(Object_T p_edge1, Object_T p_edge2)
 {
@@ -81,8 +88,8 @@ __edge_append(List_T* p_list, vertex vertex_number, int16_t weight)
 void
 Graph_add_edge(Graph_T graph, vertex vertex1, vertex vertex2, int16_t weight)
 {
-  Require(vertex1 >= graph->number_of_vertices);
-  Require(vertex2 >= graph->number_of_vertices);
+  Require(vertex1 < graph->number_of_vertices);
+  Require(vertex2 < graph->number_of_vertices);
 
   Require(weight > 0);
   Require(weight < UNUSED_WEIGHT);
@@ -100,8 +107,8 @@ Graph_add_edge(Graph_T graph, vertex vertex1, vertex vertex2, int16_t weight)
 bool
 Graph_delete_edge(Graph_T graph, vertex vertex1, vertex vertex2)
 {
-  Require(vertex1 >= graph->number_of_vertices);
-  Require(vertex2 >= graph->number_of_vertices);
+  Require(vertex1 < graph->number_of_vertices);
+  Require(vertex2 < graph->number_of_vertices);
 
   edge_t* p_ignored__; /* Stored results are ignored. */
 
@@ -132,8 +139,8 @@ Graph_delete_edge(Graph_T graph, vertex vertex1, vertex vertex2)
 bool
 Graph_is_adjacent(Graph_T graph, vertex vertex1, vertex vertex2)
 {
-  Require(vertex1 >= graph->number_of_vertices);
-  Require(vertex2 >= graph->number_of_vertices);
+  Require(vertex1 < graph->number_of_vertices);
+  Require(vertex2 < graph->number_of_vertices);
 
   edge_t* p_ignored__;
   edge_data data;
@@ -161,11 +168,17 @@ Graph_size(Graph_T graph, size_t* p_vertex_cnt__, size_t* p_edge_cnt__)
   *p_edge_cnt__ = edges;
 }
 
+graph_type_et
+Graph_type(Graph_T graph)
+{
+  return graph->type;
+}
+
 edge_t*
 Graph_edge_iterator(Graph_T graph, vertex vertex_number,
                     edge_t* p_last_return__)
 {
-  Require(vertex_number >= graph->number_of_vertices);
+  Require(vertex_number < graph->number_of_vertices);
 
   return List_iterator(graph->edge_list[vertex_number], p_last_return__);
 }
@@ -176,12 +189,13 @@ Graph_destroy(Graph_T* p_graph, free_data_FN free_data_fn)
   for (size_t i = 0; i < (*p_graph)->number_of_vertices; ++i)
   { List_destroy(& (*p_graph)->edge_list[i], free_data_fn); }
 
-  FREE((*p_graph)->edge_list);
-  FREE(p_graph);
+  /* Allocated with `malloc`, see `Graph_new`. */
+  free((*p_graph)->edge_list);
+  FREE(*p_graph);
 }
 
 void
 Graph_free(Graph_T* p_graph)
 {
-  Graph_destroy(p_graph, free);
+  Graph_destroy(p_graph, __free_edge);
 }
@@ -0,0 +1,268 @@
+/**
+ * @file    graph_csr.c
+ * @brief   Immutable graph in compressed sparse row form.
+ *
+ * Both constructors collect directed edges first and then place them with
+ * two counting sorts: by target and then, stable, by source. So edges of
+ * every vertex come out sorted without comparing them.
+ */
+#include "data_structs/graph_csr.h"
+
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+struct graph_csr {
+  graph_type_et type;
+  size_t number_of_vertices;
+  size_t number_of_edges;    /* Directed, mirrors included. */
+  size_t* offsets;           /* `number_of_vertices + 1` of them. */
+  vertex* targets;
+  int16_t* weights;
+};
+
+/* ______________________________________________________________________________ */
+/*                                                                         Local  */
+
+/* Places `n` directed edges. */
+static CSRGraph_T
+__build(size_t number_of_vertices, graph_type_et type, const csr_edge_t* edges, size_t n)
+{
+  CSRGraph_T graph;
+  NEW(graph);
+
+  graph->type = type;
+  graph->number_of_vertices = number_of_vertices;
+  graph->number_of_edges = n;
+
+  graph->offsets = CALLOC(number_of_vertices + 1, sizeof (size_t));
+  graph->targets = ALLOC((n > 0 ? n : 1) * sizeof (vertex));
+  graph->weights = ALLOC((n > 0 ? n : 1) * sizeof (int16_t));
+
+  size_t* cursor = CALLOC(number_of_vertices + 1, sizeof (size_t));
+  size_t* by_target = ALLOC((n > 0 ? n : 1) * sizeof (size_t));
+
+  /* Indexes of edges ordered by target. */
+  for (size_t i = 0; i < n; ++i) {
+    Require(edges[i].from < number_of_vertices);
+    Require(edges[i].to < number_of_vertices);
+
+    cursor[edges[i].to + 1]++;
+    graph->offsets[edges[i].from + 1]++;
+  }
+
+  for (size_t v = 0; v < number_of_vertices; ++v) {
+    cursor[v + 1] += cursor[v];
+    graph->offsets[v + 1] += graph->offsets[v];
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    by_target[cursor[edges[i].to]++] = i;
+  }
+
+  /* In this order to the rows of their sources. */
+  for (size_t v = 0; v < number_of_vertices; ++v) {
+    cursor[v] = graph->offsets[v];
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    const csr_edge_t* p_edge = &edges[by_target[i]];
+    const size_t slot = cursor[p_edge->from]++;
+
+    graph->targets[slot] = p_edge->to;
+    graph->weights[slot] = p_edge->weight;
+  }
+
+  FREE(by_target);
+  FREE(cursor);
+
+  return graph;
+}
+
+/* Index of the first edge of `vertex1` to `vertex2` or `offsets[vertex1 + 1]`. */
+static size_t
+__find(CSRGraph_T graph, vertex vertex1, vertex vertex2)
+{
+  const size_t end = graph->offsets[vertex1 + 1];
+  size_t low = graph->offsets[vertex1];
+  size_t high = end;
+
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+
+    if (graph->targets[middle] < vertex2)
+    { low = middle + 1; }
+    else
+    { high = middle; }
+  }
+
+  return (low < end && graph->targets[low] == vertex2) ? low : end;
+}
+
+/* ______________________________________________________________________________ */
+
+CSRGraph_T
+CSRGraph_from_graph(Graph_T graph)
+{
+  size_t number_of_vertices;
+  size_t number_of_edges;
+
+  Graph_size(graph, &number_of_vertices, &number_of_edges);
+
+  /* Mirrors are already in `graph`. */
+  if (Graph_type(graph) == UNDIRECTED)
+  { number_of_edges *= 2; }
+
+  csr_edge_t* edges = ALLOC((number_of_edges > 0 ? number_of_edges : 1) * sizeof (csr_edge_t));
+  size_t n = 0;
+
+  for (vertex v = 0; v < number_of_vertices; ++v) {
+    edge_t* p_edge = NULL;
+
+    while ((p_edge = Graph_edge_iterator(graph, v, p_edge)) != NULL) {
+      const edge_data* p_data = (const edge_data*)DATA(p_edge);
+
+      edges[n].from = v;
+      edges[n].to = p_data->vertex_number;
+      edges[n].weight = p_data->weight;
+      n++;
+    }
+  }
+
+  Ensure(n == number_of_edges);
+
+  CSRGraph_T csr = __build(number_of_vertices, Graph_type(graph), edges, n);
+  FREE(edges);
+
+  return csr;
+}
+
+CSRGraph_T
+CSRGraph_from_edges(size_t number_of_vertices, graph_type_et type,
+                    const csr_edge_t* edges, size_t n)
+{
+  Require(edges || n == 0);
+
+  if (type == DIRECTED)
+  { return __build(number_of_vertices, type, edges, n); }
+
+  /* Add mirrors. */
+  csr_edge_t* both = ALLOC((n > 0 ? 2 * n : 1) * sizeof (csr_edge_t));
+
+  for (size_t i = 0; i < n; ++i) {
+    both[2 * i] = edges[i];
+
+    both[2 * i + 1].from = edges[i].to;
+    both[2 * i + 1].to = edges[i].from;
+    both[2 * i + 1].weight = edges[i].weight;
+  }
+
+  CSRGraph_T csr = __build(number_of_vertices, type, both, 2 * n);
+  FREE(both);
+
+  return csr;
+}
+
+/* Targets of every vertex stay sorted: sources are visited in order. */
+CSRGraph_T
+CSRGraph_transpose(CSRGraph_T graph)
+{
+  const size_t number_of_vertices = graph->number_of_vertices;
+  const size_t n = graph->number_of_edges;
+
+  CSRGraph_T reverse;
+  NEW(reverse);
+
+  reverse->type = graph->type;
+  reverse->number_of_vertices = number_of_vertices;
+  reverse->number_of_edges = n;
+
+  reverse->offsets = CALLOC(number_of_vertices + 1, sizeof (size_t));
+  reverse->targets = ALLOC((n > 0 ? n : 1) * sizeof (vertex));
+  reverse->weights = ALLOC((n > 0 ? n : 1) * sizeof (int16_t));
+
+  for (size_t i = 0; i < n; ++i) {
+    reverse->offsets[graph->targets[i] + 1]++;
+  }
+
+  for (size_t v = 0; v < number_of_vertices; ++v) {
+    reverse->offsets[v + 1] += reverse->offsets[v];
+  }
+
+  size_t* cursor = ALLOC((number_of_vertices > 0 ? number_of_vertices : 1) * sizeof (size_t));
+
+  for (size_t v = 0; v < number_of_vertices; ++v) {
+    cursor[v] = reverse->offsets[v];
+  }
+
+  for (vertex v = 0; v < number_of_vertices; ++v) {
+    for (size_t i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+      const size_t slot = cursor[graph->targets[i]]++;
+
+      reverse->targets[slot] = v;
+      reverse->weights[slot] = graph->weights[i];
+    }
+  }
+
+  FREE(cursor);
+
+  return reverse;
+}
+
+graph_type_et
+CSRGraph_type(CSRGraph_T graph)
+{
+  return graph->type;
+}
+
+void
+CSRGraph_size(CSRGraph_T graph, size_t* p_vertex_cnt__, size_t* p_edge_cnt__)
+{
+  *p_vertex_cnt__ = graph->number_of_vertices;
+  *p_edge_cnt__ = (graph->type == UNDIRECTED) ? graph->number_of_edges / 2
+                                              : graph->number_of_edges;
+}
+
+size_t
+CSRGraph_edges(CSRGraph_T graph, vertex vertex_number,
+               const vertex** pp_targets__, const int16_t** pp_weights__)
+{
+  Require(vertex_number < graph->number_of_vertices);
+
+  const size_t first = graph->offsets[vertex_number];
+
+  *pp_targets__ = &graph->targets[first];
+  *pp_weights__ = &graph->weights[first];
+
+  return graph->offsets[vertex_number + 1] - first;
+}
+
+bool
+CSRGraph_is_adjacent(CSRGraph_T graph, vertex vertex1, vertex vertex2)
+{
+  Require(vertex1 < graph->number_of_vertices);
+  Require(vertex2 < graph->number_of_vertices);
+
+  return __find(graph, vertex1, vertex2) != graph->offsets[vertex1 + 1];
+}
+
+int16_t
+CSRGraph_weight(CSRGraph_T graph, vertex vertex1, vertex vertex2)
+{
+  Require(vertex1 < graph->number_of_vertices);
+  Require(vertex2 < graph->number_of_vertices);
+
+  const size_t slot = __find(graph, vertex1, vertex2);
+
+  return (slot != graph->offsets[vertex1 + 1]) ? graph->weights[slot] : UNUSED_WEIGHT;
+}
+
+void
+CSRGraph_free(CSRGraph_T* p_graph)
+{
+  Require(p_graph && *p_graph);
+
+  FREE((*p_graph)->offsets);
+  FREE((*p_graph)->targets);
+  FREE((*p_graph)->weights);
+  FREE(*p_graph);
+}
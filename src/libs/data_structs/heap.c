@@ -1,113 +1,217 @@
+/**
+ * @file    heap.c
+ * @brief   Min heap in an array, `HEAP_ARITY` children per node.
+ *
+ * Children of `i` are `HEAP_ARITY * i + 1` ... `HEAP_ARITY * i + HEAP_ARITY`.
+ * The array is shifted so that the children of every node start on a cache
+ * line boundary: with four children of pointer size a sift down reads one
+ * line per level and the tree is half as deep as a binary one.
+ *
+ * Sifts move a hole down or up and write the sifted element once at the end.
+ * Storage grows twice when full.
+ *
+ * An indexed heap also keeps the handle of the element in every slot and the
+ * slot of every handle, in two flat arrays. Handles are never freed, only
+ * reused: `handles` holds all handles given out so far, these after the last
+ * element are free and the next insert takes the first of them. Delete moves
+ * a handle to the next generation, so a stale one does not match any more.
+ */
 #include "data_structs/heap.h"
 
+#include <string.h>      /* memcpy */
+#include "lang/assert.h"
 #include "lang/memory.h"
 #include "logger/log.h"
 
-const size_t k_resize_step = 128;
+#define CACHE_LINE  64
+
+/* Slots before `storage`, so that `storage + 1` starts a cache line. */
+#define SHIFT       (CACHE_LINE / sizeof (Object_T) - 1)
+
+#define PARENT(idx)       (((idx) - 1) / HEAP_ARITY)
+#define FIRST_CHILD(idx)  (HEAP_ARITY * (idx) + 1)
+
+#define NEXT_GENERATION(handle)  ((handle) + ((heap_handle_t)1 << HEAP_HANDLE_BITS))
+
+static const size_t k_initial_size = 128;
 
 struct heap {
   Object_T* storage;
   size_t nextelement_idx;  /* In this index will be placed next element. */
   size_t size;             /* Current size of the `storage`. */
+  Object_T* block;         /* Allocated, `storage` is in it. */
+
+  /* Indexed heap only, otherwise NULL. */
+  heap_handle_t* handles;    /* Slot -> handle. */
+  size_t* positions;         /* Handle ID -> slot. */
+  size_t handle_count;       /* Handles given out so far. */
 };
 
 /* ______________________________________________________________________________ */
 /*                                                                         Local  */
 
-/*
- * `heap` is a heap except for element. Find the correct place for element by
- * swapping it with its parent if necessary. If a swap is made, `heap` is a heap
- * except for the parents position, so call `__siftup` recursively.
- */
+/* Moves elements to a new aligned block of `size` slots. */
 static void
-__siftup(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn)
+__resize(Heap_T heap, size_t size)
 {
-  /* We reach root. */
-  if (elm_idx == 0) {
-    return;
-  }
+  Object_T* block = ALLOC_ALIGNED(CACHE_LINE, (SHIFT + size) * sizeof (Object_T));
 
-  /* Calculate parent position. */
-  size_t parent_idx = (elm_idx - 1) / 2;
-  int cmp_result = cmp_fn(heap->storage[elm_idx], heap->storage[parent_idx]);
-
-  if (cmp_result >= 0) {
-    return;
+  if (heap->block != NULL) {
+    memcpy(block + SHIFT, heap->storage, heap->nextelement_idx * sizeof (Object_T));
+    FREE_ALIGNED(heap->block);
   }
 
-  Object_T tmpvalue;
+  heap->block = block;
+  heap->storage = block + SHIFT;
+  heap->size = size;
 
-  /* Switch with parent. */
-  tmpvalue = heap->storage[elm_idx];
-  heap->storage[elm_idx] = heap->storage[parent_idx];
-  heap->storage[parent_idx] = tmpvalue;
+  if (heap->handles != NULL) {
+    RESIZE(heap->handles, size * sizeof (heap_handle_t));
+    RESIZE(heap->positions, size * sizeof (size_t));
+  }
+}
 
-  /* Do the same with the parent. */
-  __siftup(heap, parent_idx, cmp_fn);
+/* Puts `data` of `handle` in the slot `idx`. */
+static inline void
+__put(Heap_T heap, size_t idx, Object_T data, heap_handle_t handle, const bool indexed)
+{
+  heap->storage[idx] = data;
 
-  return;
+  if (indexed) {
+    heap->handles[idx] = handle;
+    heap->positions[HEAP_HANDLE_ID(handle)] = idx;
+  }
 }
 
 /*
- * `heap` is a heap except for parent. Find the correct place for parent by
- * swapping it with the smaller of its children. If a swap is made, `heap` is a
- * heap except for the child's position, so call `__siftdown` recursively.
+ * `heap` is a heap except for element. Move parents down while they are
+ * greater than element and put element in the place of the last moved one.
+ * Inlined twice, so plain heaps do not test for handles on every move.
  */
-static void
-__siftdown(Heap_T heap, size_t parent_idx, cmp_data_FN cmp_fn)
+static inline void
+__siftup_with(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn, const bool indexed)
 {
-  size_t leftchild = 2 * parent_idx + 1;
-  size_t rightchild = leftchild + 1;
+  Object_T* storage = heap->storage;
+  Object_T data = storage[elm_idx];
+  const heap_handle_t handle = indexed ? heap->handles[elm_idx] : 0;
 
-  /* No children. */
-  if (leftchild >= heap->nextelement_idx)
-  { return; }
+  while (elm_idx > 0) {
+    const size_t parent_idx = PARENT(elm_idx);
 
-  Object_T tmpvalue;
+    if (cmp_fn(data, storage[parent_idx]) >= 0)
+    { break; }
 
-  /* No right child. */
-  int left_cmp = cmp_fn(heap->storage[parent_idx], heap->storage[leftchild]);
+    __put(heap, elm_idx, storage[parent_idx], indexed ? heap->handles[parent_idx] : 0, indexed);
+    elm_idx = parent_idx;
+  }
 
-  if (rightchild >= heap->nextelement_idx) {
+  __put(heap, elm_idx, data, handle, indexed);
+}
 
-    if (left_cmp > 0) {
-      tmpvalue = heap->storage[parent_idx];
-      heap->storage[parent_idx] = heap->storage[leftchild];
-      heap->storage[leftchild] = tmpvalue;
+/*
+ * `heap` is a heap except for parent. Move the smallest child up while it is
+ * smaller than parent and put parent in the place of the last moved one.
+ */
+static inline void
+__siftdown_with(Heap_T heap, size_t parent_idx, cmp_data_FN cmp_fn, const bool indexed)
+{
+  Object_T* storage = heap->storage;
+  const size_t count = heap->nextelement_idx;
+  Object_T data = storage[parent_idx];
+  const heap_handle_t handle = indexed ? heap->handles[parent_idx] : 0;
+
+  for (size_t child = FIRST_CHILD(parent_idx); child < count; child = FIRST_CHILD(parent_idx)) {
+    const size_t end = (count - child > HEAP_ARITY) ? child + HEAP_ARITY : count;
+    size_t smallest = child;
+
+    for (size_t i = child + 1; i < end; ++i) {
+      if (cmp_fn(storage[i], storage[smallest]) < 0)
+      { smallest = i; }
     }
-    return;
-  }
-
-  /* Two children. Swap with the smaller child. */
-  int right_cmp = cmp_fn(heap->storage[parent_idx], heap->storage[rightchild]);
 
-  if (left_cmp > 0 || right_cmp > 0) {
-    int left_right_cmp = cmp_fn(heap->storage[leftchild], heap->storage[rightchild]);
+    if (cmp_fn(storage[smallest], data) >= 0)
+    { break; }
 
-    size_t swapelement = (left_right_cmp < 0) ? leftchild : rightchild;
+    __put(heap, parent_idx, storage[smallest], indexed ? heap->handles[smallest] : 0, indexed);
+    parent_idx = smallest;
+  }
 
-    tmpvalue = heap->storage[parent_idx];
-    heap->storage[parent_idx] = heap->storage[swapelement];
-    heap->storage[swapelement] = tmpvalue;
+  __put(heap, parent_idx, data, handle, indexed);
+}
 
-    __siftdown(heap, swapelement, cmp_fn);
-  }
+static void
+__siftup(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn)
+{
+  if (heap->handles != NULL)
+  { __siftup_with(heap, elm_idx, cmp_fn, true); }
+  else
+  { __siftup_with(heap, elm_idx, cmp_fn, false); }
+}
 
-  return;
+static void
+__siftdown(Heap_T heap, size_t parent_idx, cmp_data_FN cmp_fn)
+{
+  if (heap->handles != NULL)
+  { __siftdown_with(heap, parent_idx, cmp_fn, true); }
+  else
+  { __siftdown_with(heap, parent_idx, cmp_fn, false); }
 }
 
 /* ______________________________________________________________________________ */
 
 Heap_T
-Heap_new()
+Heap_new(void)
 {
   Heap_T heap;
   NEW(heap);
 
-  heap->storage = ALLOC(k_resize_step * sizeof(Object_T));
+  heap->block = NULL;
+  heap->nextelement_idx = 0;
+  heap->handles = NULL;
+  heap->positions = NULL;
+  heap->handle_count = 0;
+
+  __resize(heap, k_initial_size);
+
+  return heap;
+}
+
+Heap_T
+Heap_new_indexed(void)
+{
+  Heap_T heap = Heap_new();
+
+  heap->handles = ALLOC(heap->size * sizeof (heap_handle_t));
+  heap->positions = ALLOC(heap->size * sizeof (size_t));
 
+  return heap;
+}
+
+/* Floyd: sift down every parent, the last one first. */
+Heap_T
+Heap_build(Object_T* array, size_t n, cmp_data_FN cmp_fn)
+{
+  Require(array || n == 0);
+
+  Heap_T heap;
+  NEW(heap);
+
+  heap->block = NULL;
   heap->nextelement_idx = 0;
-  heap->size = k_resize_step;
+  heap->handles = NULL;
+  heap->positions = NULL;
+  heap->handle_count = 0;
+
+  __resize(heap, (n > k_initial_size) ? n : k_initial_size);
+
+  if (n > 0) {
+    memcpy(heap->storage, array, n * sizeof (Object_T));
+    heap->nextelement_idx = n;
+  }
+
+  for (size_t parent_idx = (n > 1) ? PARENT(n - 1) + 1 : 0; parent_idx > 0; ) {
+    __siftdown(heap, --parent_idx, cmp_fn);
+  }
 
   return heap;
 }
@@ -118,34 +222,78 @@ Heap_is_empty(Heap_T heap)
   return heap->nextelement_idx == 0;
 }
 
+size_t
+Heap_length(Heap_T heap)
+{
+  return heap->nextelement_idx;
+}
+
 /*
  * The data is inserted in the heap by placing it at the end and using
- * `__siftupf` to find its proper position.
+ * `__siftup` to find its proper position.
  */
 void
 Heap_insert(Heap_T heap, Object_T data, cmp_data_FN cmp_fn)
 {
   /* Not enough space in the array, so more must be allocated. */
-  if (heap->nextelement_idx == heap->size) {
+  if (heap->nextelement_idx == heap->size)
+  { __resize(heap, 2 * heap->size); }
+
+  const size_t elm_idx = heap->nextelement_idx;
 
-    Object_T* newstorage =
-      RESIZE(heap->storage,
-             (heap->size + k_resize_step) * sizeof(*newstorage));
+  /* No free handle after the last element, make a new one. */
+  if (heap->handles != NULL && elm_idx == heap->handle_count) {
+    Require(heap->handle_count == HEAP_HANDLE_ID(heap->handle_count));
 
-    heap->storage = newstorage;
-    heap->size += k_resize_step;
+    heap->handles[elm_idx] = heap->handle_count;
+    heap->positions[heap->handle_count++] = elm_idx;
   }
 
   /* Add at the end then move to the proper place. */
-  heap->storage[heap->nextelement_idx] = data;
-  __siftup(heap, heap->nextelement_idx, cmp_fn);
-
+  heap->storage[elm_idx] = data;
   heap->nextelement_idx++;
+
+  __siftup(heap, elm_idx, cmp_fn);
+}
+
+heap_handle_t
+Heap_insert_handle(Heap_T heap, Object_T data, cmp_data_FN cmp_fn)
+{
+  Require(heap->handles);
+
+  /* Handle that will be used by `Heap_insert`. */
+  const size_t elm_idx = heap->nextelement_idx;
+  const heap_handle_t handle = (elm_idx < heap->handle_count) ? heap->handles[elm_idx]
+                                                              : heap->handle_count;
+
+  Heap_insert(heap, data, cmp_fn);
+
+  return handle;
+}
+
+bool
+Heap_has_handle(Heap_T heap, heap_handle_t handle)
+{
+  Require(heap->handles);
+
+  const size_t id = HEAP_HANDLE_ID(handle);
+
+  return id < heap->handle_count
+         && heap->positions[id] < heap->nextelement_idx
+         && heap->handles[heap->positions[id]] == handle;
+}
+
+Object_T
+Heap_handle_data(Heap_T heap, heap_handle_t handle)
+{
+  Require(Heap_has_handle(heap, handle));
+
+  return heap->storage[heap->positions[HEAP_HANDLE_ID(handle)]];
 }
 
 /*
- * The data is deleted by placing the last element in its place and using
- * `__siftdown` to find its proper position.
+ * The data is deleted by placing the last element in its place and sifting
+ * it up or down to its proper position.
  */
 bool
 Heap_delete(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn, Object_T* p_data__)
@@ -157,13 +305,85 @@ Heap_delete(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn, Object_T* p_data__)
 
   *p_data__ = heap->storage[elm_idx];
 
-  heap->nextelement_idx--;
+  const size_t last = --heap->nextelement_idx;
+  const heap_handle_t handle = (heap->handles != NULL) ? NEXT_GENERATION(heap->handles[elm_idx]) : 0;
 
   /* The easiest case is if delete the last element in the heap storage. */
-  if (elm_idx != heap->nextelement_idx) {
-    heap->storage[elm_idx] = heap->storage[heap->nextelement_idx];
-    __siftdown(heap, elm_idx, cmp_fn);
+  if (elm_idx == last) {
+    if (heap->handles != NULL)
+    { heap->handles[last] = handle; }
+
+    return true;
   }
 
+  heap->storage[elm_idx] = heap->storage[last];
+
+  /* Handle of the deleted element is the first free one. */
+  if (heap->handles != NULL) {
+    const heap_handle_t moved = heap->handles[last];
+
+    heap->handles[elm_idx] = moved;
+    heap->positions[HEAP_HANDLE_ID(moved)] = elm_idx;
+
+    heap->handles[last] = handle;
+    heap->positions[HEAP_HANDLE_ID(handle)] = last;
+  }
+
+  /* Last element could be smaller than parent of deleted one. */
+  if (elm_idx > 0 && cmp_fn(heap->storage[elm_idx], heap->storage[PARENT(elm_idx)]) < 0)
+  { __siftup(heap, elm_idx, cmp_fn); }
+  else
+  { __siftdown(heap, elm_idx, cmp_fn); }
+
   return true;
 }
+
+void
+Heap_decrease_key(Heap_T heap, heap_handle_t handle, Object_T data, cmp_data_FN cmp_fn)
+{
+  Require(Heap_has_handle(heap, handle));
+
+  const size_t elm_idx = heap->positions[HEAP_HANDLE_ID(handle)];
+
+  Require(cmp_fn(data, heap->storage[elm_idx]) <= 0);
+
+  heap->storage[elm_idx] = data;
+  __siftup(heap, elm_idx, cmp_fn);
+}
+
+bool
+Heap_remove_handle(Heap_T heap, heap_handle_t handle, cmp_data_FN cmp_fn, Object_T* p_data__)
+{
+  if (!Heap_has_handle(heap, handle)) {
+    Log_debug("Handle %zu is not in the heap.", handle);
+    return false;
+  }
+
+  return Heap_delete(heap, heap->positions[HEAP_HANDLE_ID(handle)], cmp_fn, p_data__);
+}
+
+void
+Heap_destroy(Heap_T* p_heap, free_data_FN free_data_fn)
+{
+  Require(p_heap && *p_heap);
+
+  if (free_data_fn != NULL) {
+    for (size_t i = 0; i < (*p_heap)->nextelement_idx; ++i) {
+      free_data_fn((*p_heap)->storage[i]);
+    }
+  }
+
+  if ((*p_heap)->handles != NULL) {
+    FREE((*p_heap)->handles);
+    FREE((*p_heap)->positions);
+  }
+
+  FREE_ALIGNED((*p_heap)->block);
+  FREE(*p_heap);
+}
+
+void
+Heap_free(Heap_T* p_heap)
+{
+  Heap_destroy(p_heap, NULL);
+}
@@ -1,16 +1,26 @@
 /**
  * @file    binary_tree.h
  * @brief   Binary tree ADT interface.
+ *
+ * Traversals do not recurse, so deep and degenerate trees are fine. Nodes
+ * are visited with an explicit stack (a queue for `LEVEL_ORDER`) that grows
+ * with the height (width) of the tree.
  */
 #if !defined(DATA_STRUCTS_BINARY_TREE_H)
 #define DATA_STRUCTS_BINARY_TREE_H
 
+#include <stddef.h>     /* size_t */
 #include "lang/extend.h"
 
 typedef struct tree_node btnode_t;
 typedef btnode_t* BinTree_T;
 
-typedef enum { PRE_ORDER, IN_ORDER, POST_ORDER } order_et;
+typedef enum { PRE_ORDER, IN_ORDER, POST_ORDER, LEVEL_ORDER } order_et;
+
+/*
+ * Called with `n` elements in traverse order, returns `false` to stop.
+ */
+typedef bool (*apply_batch_FN)(void* arg, const Object_T* items, size_t n);
 
 /**
  * Initialize an empty tree.
@@ -28,13 +38,60 @@ extern bool BinTree_is_empty(BinTree_T btree);
 extern void BinTree_make_root(BinTree_T* p_btree, Object_T data, BinTree_T left, BinTree_T right);
 
 /**
- * Traverse a tree in preorder, postorder, or inorder using DFS.
+ * Return data stored in the root.
+ */
+extern Object_T BinTree_data(BinTree_T btree);
+
+/**
+ * Return left subtree, could be empty.
+ */
+extern BinTree_T BinTree_left(BinTree_T btree);
+
+/**
+ * Return right subtree, could be empty.
+ */
+extern BinTree_T BinTree_right(BinTree_T btree);
+
+/**
+ * @brief    Traverse a tree in preorder, inorder, postorder (DFS) or level
+ *           order (BFS).
+ *
+ * Stops and returns `false` when `apply_fn` returns `false`.
  */
 extern bool BinTree_traverse(BinTree_T btree, bool (*apply_fn)(Object_T), order_et order);
 
+/**
+ * @brief    Traverse like `BinTree_traverse` but pass elements in arrays.
+ *
+ * One call of `apply_batch_fn` gets up to a few hundred elements, so the
+ * cost of the call is shared and the elements could be processed as a
+ * loop. Stops and returns `false` when `apply_batch_fn` returns `false`.
+ */
+extern bool BinTree_traverse_batch(BinTree_T btree, apply_batch_FN apply_batch_fn, void* arg,
+                                   order_et order);
+
+/**
+ * @brief    Number of nodes.
+ */
+extern size_t BinTree_size(BinTree_T btree);
+
+/**
+ * @brief    Move all nodes to one array in van Emde Boas order.
+ *
+ * The tree is cut at half of its height; the top part is laid out first and
+ * then every bottom subtree, each recursively in the same way. A path from
+ * the root then crosses few cache lines whatever their size, which speeds up
+ * repeated traversals and searches. Data and shape do not change, nodes do:
+ * old subtree pointers are no longer valid.
+ *
+ * The tree could be extended with `BinTree_make_root` after that, but its
+ * subtrees are not destroyed on their own.
+ */
+extern void BinTree_compact(BinTree_T* p_btree);
+
 /*
- * Delete an entire tree (uses a postorder traversal), calling
- * `free_data_fn` with the data stored at each node.
+ * Delete an entire tree calling `free_data_fn` with the data stored at
+ * each node.
  */
 extern void BinTree_destroy(BinTree_T* p_btree, free_data_FN free_data_fn);
 
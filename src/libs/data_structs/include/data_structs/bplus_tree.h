@@ -0,0 +1,89 @@
+/**
+ * @file    bplus_tree.h
+ * @brief   Ordered map from 64-bit integer keys to elements.
+ *
+ * B+-tree: elements are kept in leaves, inner nodes only have keys to find
+ * the leaf. A node is a few cache lines and holds tens of keys, so a tree of
+ * ten million keys has five levels and a lookup touches five nodes. Keys in
+ * a node are compared all at once, with AVX2 when the processor has it.
+ *
+ * Leaves are linked in key order, so ranges are read without going back up
+ * the tree. Sorted keys could be loaded directly into full leaves, which is
+ * many times faster than putting them one by one.
+ */
+#if !defined(DATA_STRUCTS_BPLUS_TREE_H)
+#define DATA_STRUCTS_BPLUS_TREE_H
+
+#include <stddef.h>     /* size_t  */
+#include <stdint.h>     /* int64_t */
+#include "lang/extend.h"
+
+typedef struct bplus_tree* BPTree_T;
+
+/**
+ * Create an empty tree.
+ */
+extern BPTree_T BPTree_new(void);
+
+/**
+ * @brief    Create a tree of `n` elements with strictly increasing `keys`.
+ *
+ * Leaves are filled up, so it uses less memory than putting the elements.
+ */
+extern BPTree_T BPTree_load(const int64_t* keys, const Object_T* values, size_t n);
+
+/**
+ * Put `value` under `key`. Return `true` if the key is new, otherwise
+ * replace its value and return `false`.
+ */
+extern bool BPTree_put(BPTree_T tree, int64_t key, Object_T value);
+
+/**
+ * Set `p_value__` to the value of `key` and return `true`, or return `false`
+ * if it is not there.
+ */
+extern bool BPTree_get(BPTree_T tree, int64_t key, Object_T* p_value__);
+
+/**
+ * Remove `key` and return `true`, or return `false` if it is not there.
+ * If `p_value__` is not NULL it is set to the removed value.
+ */
+extern bool BPTree_remove(BPTree_T tree, int64_t key, Object_T* p_value__);
+
+/**
+ * Return number of elements.
+ */
+extern size_t BPTree_length(BPTree_T tree);
+
+/**
+ * Return number of levels, 1 if the root is a leaf.
+ */
+extern size_t BPTree_height(BPTree_T tree);
+
+/**
+ * @brief    Call `visit_fn` for keys from `low` to `high`, inclusive.
+ *
+ * Keys come in increasing order. Return how many elements were visited.
+ */
+extern size_t BPTree_range(BPTree_T tree, int64_t low, int64_t high, visit_FN visit_fn,
+                           void* arg);
+
+/**
+ * @brief    Copy at most `n` elements with keys from `from` on.
+ *
+ * Return how many were copied. Continue with the last key plus one.
+ */
+extern size_t BPTree_scan(BPTree_T tree, int64_t from, int64_t* keys__, Object_T* values__,
+                          size_t n);
+
+/**
+ * Free elements with `free_data_fn` and then the tree.
+ */
+extern void BPTree_destroy(BPTree_T* p_tree, free_data_FN free_data_fn);
+
+/**
+ * Free the tree but not its elements.
+ */
+extern void BPTree_free(BPTree_T* p_tree);
+
+#endif  /* DATA_STRUCTS_BPLUS_TREE_H */
@@ -27,7 +27,7 @@ extern void CircList_insert(CircList_T* p_circlist, Object_T data);
 
 /**
  * Append a new node containing data, as the last item in `p_circlist`
- * Update `p_circlist` to point to the new last node. Expand counter clockwise.
+ * and make it the new last node. Expand counter clockwise.
  */
 extern void CircList_append(CircList_T* p_circlist, Object_T data);
 
@@ -63,6 +63,8 @@ extern node_t* CircList_iterator(CircList_T circlist, node_t* last_return);
 
 /**
  * @brief    Number of list elements.
+ *
+ * Kept in the list header, so it takes constant time.
  */
 extern size_t CircList_length(CircList_T circlist);
 
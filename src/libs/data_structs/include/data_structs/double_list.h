@@ -1,6 +1,10 @@
 /**
  * @file    double_list.h
  * @brief   Double linked List ADT interface.
+ *
+ * With `--enable-unrolled-lists` every list node keeps several elements and
+ * `doublenode_t*` points to the element in it. Such pointers are valid until
+ * the list is changed, except the ones passed by reference - they are updated.
  */
 #if !defined(DATA_STRUCTS_DOUBLE_LIST_H)
 #define DATA_STRUCTS_DOUBLE_LIST_H
@@ -31,6 +31,12 @@ extern Graph_T Graph_new(size_t number_of_vertices, graph_type_et type);
 extern void Graph_add_edge(Graph_T graph, vertex vertex1, vertex vertex2,
                            int16_t weight);
 
+/**
+ * Delete the edge between `vertex1` and `vertex2` and its mirror if the graph
+ * is undirected. Return `false` if there is no such edge.
+ */
+extern bool Graph_delete_edge(Graph_T graph, vertex vertex1, vertex vertex2);
+
 /**
  * Return TRUE if there is an edge from vertexl to vertex2.
  */
@@ -42,6 +48,11 @@ extern bool Graph_is_adjacent(Graph_T graph, vertex vertex1, vertex vertex2);
  */
 extern void Graph_size(Graph_T graph, size_t* p_vertex_cnt__, size_t* p_edge_cnt__);
 
+/**
+ * Return whether the graph is directed or not.
+ */
+extern graph_type_et Graph_type(Graph_T graph);
+
 /**
  * Return all the edges out of `vertex_number` in turn. To start
  * `p_last_return__` should be NULL. In subsequent calls, it should be what
@@ -0,0 +1,89 @@
+/**
+ * @file    graph_csr.h
+ * @brief   Immutable graph in compressed sparse row form.
+ *
+ * Edges of all vertices are in one array, sorted by source and then by
+ * target. Edges out of vertex `v` are `targets[offsets[v]] ...
+ * targets[offsets[v + 1] - 1]` with weights at the same indexes in
+ * `weights`. There is nothing to follow while edges are traversed and a
+ * target is found with binary search.
+ *
+ * Build it from a `Graph_T` or from an array of edges when the graph does
+ * not change anymore. Both take O(V + E) time.
+ */
+#if !defined(DATA_STRUCTS_GRAPH_CSR_H)
+#define DATA_STRUCTS_GRAPH_CSR_H
+
+#include <stdbool.h>     /* bool    */
+#include <stddef.h>      /* size_t  */
+#include <stdint.h>      /* int16_t */
+#include "graph_rep.h"
+#include "graph_adj_list.h"
+
+typedef struct graph_csr* CSRGraph_T;
+
+/* Edge given to `CSRGraph_from_edges`. */
+typedef struct {
+  vertex from;
+  vertex to;
+  int16_t weight;
+} csr_edge_t;
+
+/**
+ * @brief    Copy edges of `graph`.
+ *
+ * `graph` is not changed and could be freed after that.
+ */
+extern CSRGraph_T CSRGraph_from_graph(Graph_T graph);
+
+/**
+ * @brief    Make a graph of `number_of_vertices` from `n` edges.
+ *
+ * If the graph is undirected, every edge is placed also from `to` to `from`
+ * (mirror), same as `Graph_add_edge` does.
+ */
+extern CSRGraph_T CSRGraph_from_edges(size_t number_of_vertices, graph_type_et type,
+                                      const csr_edge_t* edges, size_t n);
+
+/**
+ * @brief    Same graph with every edge reversed.
+ *
+ * Edges into a vertex are then edges out of it. For undirected graph it is
+ * a copy.
+ */
+extern CSRGraph_T CSRGraph_transpose(CSRGraph_T graph);
+
+/**
+ * Return whether the graph is directed or not.
+ */
+extern graph_type_et CSRGraph_type(CSRGraph_T graph);
+
+/**
+ * Return the number of vertices in `p_vertex_cnt__` and the number of
+ * edges in `p_edge_cnt__`.
+ */
+extern void CSRGraph_size(CSRGraph_T graph, size_t* p_vertex_cnt__, size_t* p_edge_cnt__);
+
+/**
+ * @brief    Edges out of `vertex_number`.
+ *
+ * Return their number and pass back arrays of their targets, sorted, and
+ * weights. Arrays are valid until the graph is freed.
+ */
+extern size_t CSRGraph_edges(CSRGraph_T graph, vertex vertex_number,
+                             const vertex** pp_targets__, const int16_t** pp_weights__);
+
+/**
+ * Return TRUE if there is an edge from vertexl to vertex2.
+ */
+extern bool CSRGraph_is_adjacent(CSRGraph_T graph, vertex vertex1, vertex vertex2);
+
+/**
+ * Return weight of the edge from vertexl to vertex2 or `UNUSED_WEIGHT` if
+ * there is no such edge.
+ */
+extern int16_t CSRGraph_weight(CSRGraph_T graph, vertex vertex1, vertex vertex2);
+
+extern void CSRGraph_free(CSRGraph_T* p_graph);
+
+#endif  /* DATA_STRUCTS_GRAPH_CSR_H */
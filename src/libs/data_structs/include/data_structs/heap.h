@@ -1,25 +1,65 @@
 /**
  * @file    heap.h
  * @brief   Heap ADT interface.
+ *
+ * Minimum is at index 0. Every node has `HEAP_ARITY` children, four by
+ * default; compile with `-DHEAP_ARITY=2` for a binary heap.
+ *
+ * Elements move while the heap changes, so their index is not known to the
+ * caller. An indexed heap (`Heap_new_indexed`) gives a handle for every
+ * inserted element, which finds it until it is deleted. A handle keeps the
+ * generation of its slot, so a handle of a deleted element is not in the heap
+ * even when its slot is given to another element.
  */
 #if !defined(DATA_STRUCTS_HEAP_H)
 #define DATA_STRUCTS_HEAP_H
 
+#include <limits.h>
 #include <stddef.h>
 #include "lang/extend.h"
 
+#if !defined(HEAP_ARITY)
+#  define HEAP_ARITY  4
+#endif
+
 typedef struct heap* Heap_T;
 
+/* Stable name of an element in an indexed heap. */
+typedef size_t heap_handle_t;
+
+/* Low half of a handle is its slot, high half counts reuses of the slot. */
+#define HEAP_HANDLE_BITS        (sizeof (heap_handle_t) * CHAR_BIT / 2)
+#define HEAP_HANDLE_ID(handle)  ((handle) & (((heap_handle_t)1 << HEAP_HANDLE_BITS) - 1))
+
 /**
  * Initialize a heap by allocating the array.
  */
 extern Heap_T Heap_new(void);
 
+/**
+ * Initialize a heap that gives handles to its elements, see
+ * `Heap_insert_handle`.
+ */
+extern Heap_T Heap_new_indexed(void);
+
+/**
+ * @brief    Make a heap of `n` elements of `array` in linear time.
+ *
+ * Elements are copied, `array` is not changed. `cmp_fn` is as for
+ * `Heap_insert`. The heap is not indexed.
+ */
+extern Heap_T Heap_build(Object_T* array, size_t n, cmp_data_FN cmp_fn);
+
 /**
  * Return true if heap is an empty.
  */
 extern bool Heap_is_empty(Heap_T heap);
 
+/**
+ * Number of elements in the heap.
+ */
+extern size_t Heap_length(Heap_T heap);
+
 /**
  * @brief    Insert data into heap.
  *
@@ -29,6 +69,41 @@ extern bool Heap_is_empty(Heap_T heap);
  */
 extern void Heap_insert(Heap_T heap, Object_T data, cmp_data_FN cmp_fn);
 
+/**
+ * @brief    Insert data into an indexed heap and return its handle.
+ *
+ * Could be used instead of `Heap_insert` only with an indexed heap.
+ */
+extern heap_handle_t Heap_insert_handle(Heap_T heap, Object_T data, cmp_data_FN cmp_fn);
+
+/**
+ * Return true if element with `handle` is in the indexed heap.
+ */
+extern bool Heap_has_handle(Heap_T heap, heap_handle_t handle);
+
+/**
+ * Return data of element with `handle`. It is checked runtime error if it is
+ * not in the heap.
+ */
+extern Object_T Heap_handle_data(Heap_T heap, heap_handle_t handle);
+
+/**
+ * @brief    Replace data of element with `handle` with smaller or equal one.
+ *
+ * `data` could be the same object whose key was decreased. Takes logarithmic
+ * time. It is checked runtime error if `data` is greater.
+ */
+extern void Heap_decrease_key(Heap_T heap, heap_handle_t handle, Object_T data,
+                              cmp_data_FN cmp_fn);
+
+/**
+ * @brief    Delete element with `handle` from indexed heap.
+ *
+ * Store its data in `p_data__`. Return `false` if it is not in the heap.
+ */
+extern bool Heap_remove_handle(Heap_T heap, heap_handle_t handle, cmp_data_FN cmp_fn,
+                               Object_T* p_data__);
+
 /**
  * @breif    Delete element from heap.
  *
@@ -40,5 +115,12 @@ extern void Heap_insert(Heap_T heap, Object_T data, cmp_data_FN cmp_fn);
 extern bool Heap_delete(Heap_T heap, size_t elm_idx, cmp_data_FN cmp_fn,
                         Object_T* p_data__);
 
+/**
+ * @brief    Free the heap and with `free_data_fn` every element in it.
+ */
+extern void Heap_destroy(Heap_T* p_heap, free_data_FN free_data_fn);
+
+extern void Heap_free(Heap_T* p_heap);
+
 
 #endif  /* DATA_STRUCTS_HEAP_H */
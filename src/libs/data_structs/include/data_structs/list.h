@@ -1,6 +1,11 @@
 /**
  * @file    list.h
  * @brief   Linked List ADT interface.
+ *
+ * With `--enable-unrolled-lists` every list node keeps several elements and
+ * `node_t*` points to the element in it. Such pointers (from `List_iterator`
+ * and `List_find_key`) are valid until the list is changed. Use only `DATA`
+ * with them.
  */
 #if !defined(DATA_STRUCTS_LIST_H)
 #define DATA_STRUCTS_LIST_H
@@ -26,6 +31,7 @@ extern void List_insert(List_T* p_list, Object_T data);
 
 /**
  * Append a new node containing data as the last item in *p_list.
+ * Takes constant time, the last node is kept in the list header.
  */
 extern void List_append(List_T* p_list, Object_T data);
 
@@ -58,10 +64,12 @@ extern bool List_traverse(List_T list, bool (*apply_fn)(Object_T));
  * value that was returned last. Note that if `lastreturn` is NULL, start
  * at the beginning of the given list.
  */
-extern List_T List_iterator(List_T list, node_t* last_return);
+extern node_t* List_iterator(List_T list, node_t* last_return);
 
 /**
  * @brief    Number of list elements.
+ *
+ * Kept in the list header, so it takes constant time.
  */
 extern size_t List_length(List_T list);
 
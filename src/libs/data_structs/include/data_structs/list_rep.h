@@ -5,6 +5,7 @@
 #if !defined(DATA_STRUCTS_LIST_REP_H)
 #define DATA_STRUCTS_LIST_REP_H
 
+#include <stddef.h>     /* size_t */
 #include "lang/extend.h"
 
 struct node {
@@ -20,11 +21,32 @@ typedef struct node node_t;
  * you mean list as a whole and `note_t*` respectively when you deal with a
  * pointer to a node. `node_t` also represents some part of the list - from it to
  * the end.
+ *
+ * A list is a header that keeps its first and last node and how many
+ * elements there are, so appending and counting do not walk the list. The
+ * header is allocated with the first element and freed with the last one - an
+ * empty list is NULL.
  */
-typedef node_t* List_T;
-typedef node_t* CircList_T;
+struct list {
+  node_t* head;
+  node_t* tail;
+  size_t length;
+};
+
+typedef struct list* List_T;
+
+/* `head` is always the next node of `tail`. */
+typedef struct list* CircList_T;
+
+#define HEAD(list)   ((list)->head)
+#define TAIL(list)   ((list)->tail)
+#define LENGTH(list) ((list)->length)
 
-#define DATA(p_node) ((p_node)->datapointer)
+/*
+ * Data is the first member, so `DATA` works also for the element slots that
+ * unrolled lists hand out as `node_t*` (see `list-unrolled.c`).
+ */
+#define DATA(p_node) (*(Object_T*)(p_node))
 #define NEXT(p_node) ((p_node)->next)
 
 /* __________________________________________________________________________ */
@@ -34,4 +56,8 @@ extern void List__allocate_node(node_t** pp_node, Object_T data);
 
 extern void List__free_node(node_t** PP_nod);
 
+extern void List__allocate_header(struct list** pp_list);
+
+extern void List__free_header(struct list** pp_list);
+
 #endif  /* DATA_STRUCTS_LIST_REP_H */
@@ -1,10 +1,16 @@
 /**
  * @file    lstack.h
  * @brief   Stack ADT interface using list for implementation.
+ *
+ * Nodes are allocated in chunks and reused, so a push or pop does not call
+ * the allocator most of the time and a node does not move while it is in the
+ * stack. Spare nodes are given back when the stack gets empty and has many
+ * more of them than it recently needed.
  */
 #if !defined(DATA_STRUCTS_LSTACK_H)
 #define DATA_STRUCTS_LSTACK_H
 
+#include <stddef.h>     /* size_t */
 #include "lang/extend.h"
 
 typedef struct stack* LStack_T;
@@ -19,6 +25,14 @@ extern LStack_T LStack_new(void);
  */
 extern bool LStack_is_empty(LStack_T stack);
 
+/**
+ * @brief    Make room for `n` elements.
+ *
+ * Pushes up to `n` elements do not allocate and the room is kept when the
+ * stack shrinks. `LStack_reserve(stack, 0)` lets it shrink fully.
+ */
+extern void LStack_reserve(LStack_T stack, size_t n);
+
 /**
  * @brief    Push data onto stack.
  */
@@ -0,0 +1,79 @@
+/**
+ * @file    mpmc_queue.h
+ * @brief   Bounded lock-free queue for many producers and consumers.
+ *
+ * Elements are kept in a ring of `capacity` slots, rounded up to a power of
+ * two, so nothing is allocated after `MPMCQueue_new`. Every slot has a
+ * sequence number that tells whether it could be filled or emptied in the
+ * current round, so threads agree only on the position they take. Adding to
+ * a full queue or removing from an empty one does not wait but fails.
+ *
+ * Bulk operations take as many consecutive slots as are ready, up to the
+ * requested number, with one atomic operation.
+ *
+ * Elements removed by one consumer are in the order they were added by each
+ * producer.
+ */
+#if !defined(DATA_STRUCTS_MPMC_QUEUE_H)
+#define DATA_STRUCTS_MPMC_QUEUE_H
+
+#include <stddef.h>     /* size_t */
+#include "lang/extend.h"
+
+typedef struct mpmc_queue* MPMCQueue_T;
+
+/**
+ * Create an empty queue of at least `capacity` elements.
+ */
+extern MPMCQueue_T MPMCQueue_new(size_t capacity);
+
+/**
+ * Return number of elements the queue could hold.
+ */
+extern size_t MPMCQueue_capacity(MPMCQueue_T queue);
+
+/**
+ * @brief    Number of elements.
+ *
+ * If other threads change the queue it is already old when it returns.
+ */
+extern size_t MPMCQueue_length(MPMCQueue_T queue);
+
+/**
+ * Add `data` and return `true`, or return `false` if the queue is full.
+ */
+extern bool MPMCQueue_add(MPMCQueue_T queue, Object_T data);
+
+/**
+ * Remove the first element to `p_data__` and return `true`, or return
+ * `false` if the queue is empty.
+ */
+extern bool MPMCQueue_remove(MPMCQueue_T queue, Object_T* p_data__);
+
+/**
+ * @brief    Add first elements of `items`, at most `n`.
+ *
+ * Return how many were added, less than `n` if the queue got full.
+ */
+extern size_t MPMCQueue_add_bulk(MPMCQueue_T queue, const Object_T* items, size_t n);
+
+/**
+ * @brief    Remove at most `n` elements to `items__`.
+ *
+ * Return how many were removed, less than `n` if the queue got empty.
+ */
+extern size_t MPMCQueue_remove_bulk(MPMCQueue_T queue, Object_T* items__, size_t n);
+
+/**
+ * @brief    Free elements with `free_data_fn` and then the queue.
+ *
+ * No other thread should use the queue.
+ */
+extern void MPMCQueue_destroy(MPMCQueue_T* p_queue, free_data_FN free_data_fn);
+
+/**
+ * Free the queue but not its elements.
+ */
+extern void MPMCQueue_free(MPMCQueue_T* p_queue);
+
+#endif  /* DATA_STRUCTS_MPMC_QUEUE_H */
@@ -0,0 +1,154 @@
+/**
+ * @file    ord_tree.h
+ * @brief   Ordered map from 64-bit integer keys to elements with order
+ *          statistics, split and join.
+ *
+ * Balanced search tree, height-balanced as `h_bl_tree.c` or red-black as
+ * `rb_tree.c` of the book (chapter 3), chosen when the tree is created.
+ * Every node knows the size of its subtree, so the i-th key, the rank of a
+ * key and the number of keys in a range are found in O(log n).
+ *
+ * All updates are made from one operation: join of two trees and a key
+ * between them, which is the only one that knows the balance scheme. A tree
+ * is split at a key and two trees are joined in O(log n). Union,
+ * intersection and difference of two trees split one tree at the root key
+ * of the other and work on both halves independently, so the halves could
+ * run on different threads, see `fork_FN`.
+ *
+ * Nodes of trees given to a bulk operation are moved to the result, nothing
+ * is copied or allocated.
+ */
+#if !defined(DATA_STRUCTS_ORD_TREE_H)
+#define DATA_STRUCTS_ORD_TREE_H
+
+#include <stddef.h>     /* size_t  */
+#include <stdint.h>     /* int64_t */
+#include "lang/extend.h"
+
+typedef struct ord_tree* OrdTree_T;
+
+typedef enum { HEIGHT_BALANCED, RED_BLACK } balance_et;
+
+/*
+ * Calls both functions, maybe in parallel, and returns when both are done,
+ * e.g. `ForkJoin_join` of the algorithms library.
+ */
+typedef void (*fork_FN)(void (*first_fn)(void*), void* first_arg,
+                        void (*second_fn)(void*), void* second_arg);
+
+/**
+ * Create an empty tree.
+ */
+extern OrdTree_T OrdTree_new(balance_et balance);
+
+/**
+ * @brief    Create a tree of `n` elements with strictly increasing `keys`.
+ *
+ * Takes O(n), `values` could be NULL.
+ */
+extern OrdTree_T OrdTree_load(balance_et balance, const int64_t* keys, const Object_T* values,
+                              size_t n);
+
+/**
+ * Put `value` under `key`. Return `true` if the key is new, otherwise
+ * replace its value and return `false`.
+ */
+extern bool OrdTree_put(OrdTree_T tree, int64_t key, Object_T value);
+
+/**
+ * Set `p_value__` to the value of `key` and return `true`, or return `false`
+ * if it is not there.
+ */
+extern bool OrdTree_get(OrdTree_T tree, int64_t key, Object_T* p_value__);
+
+/**
+ * Remove `key` and return `true`, or return `false` if it is not there.
+ * If `p_value__` is not NULL it is set to the removed value.
+ */
+extern bool OrdTree_remove(OrdTree_T tree, int64_t key, Object_T* p_value__);
+
+/**
+ * Return number of elements.
+ */
+extern size_t OrdTree_length(OrdTree_T tree);
+
+/**
+ * Return number of levels, 0 for empty tree. Red-black tree is walked, so
+ * it takes O(n).
+ */
+extern size_t OrdTree_height(OrdTree_T tree);
+
+/* ____________________________________________________________________________ */
+/*                                                            Order statistics  */
+
+/**
+ * Return number of keys less than `key`.
+ */
+extern size_t OrdTree_rank(OrdTree_T tree, int64_t key);
+
+/**
+ * Set `p_key__` and `p_value__` to the element with `index` keys less than
+ * its key and return `true`, or return `false` if `index` is not less than
+ * the length. Pointers could be NULL.
+ */
+extern bool OrdTree_select(OrdTree_T tree, size_t index, int64_t* p_key__, Object_T* p_value__);
+
+/**
+ * Return number of keys from `low` to `high`, inclusive.
+ */
+extern size_t OrdTree_count(OrdTree_T tree, int64_t low, int64_t high);
+
+/* ____________________________________________________________________________ */
+/*                                                                 Split, join  */
+
+/**
+ * Move elements with keys from `key` on to a new tree and return it.
+ */
+extern OrdTree_T OrdTree_split(OrdTree_T tree, int64_t key);
+
+/**
+ * Move all elements of `*p_other` to `tree` and free it. Its keys must be
+ * greater than keys of `tree`, both trees must have the same balance.
+ */
+extern void OrdTree_join(OrdTree_T tree, OrdTree_T* p_other);
+
+/* ____________________________________________________________________________ */
+/*                                                                        Sets  */
+
+/*
+ * Result is left in `tree` and `*p_other` is freed, both must have the same
+ * balance. For keys in both trees the element of `tree` is kept. Elements
+ * that are dropped are not freed.
+ *
+ * With `fork_fn` halves of big trees are done by it, otherwise one after the
+ * other in the calling thread.
+ */
+
+/**
+ * Keys in any of the trees.
+ */
+extern void OrdTree_union(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn);
+
+/**
+ * Keys in both trees.
+ */
+extern void OrdTree_intersection(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn);
+
+/**
+ * Keys of `tree` not in `*p_other`.
+ */
+extern void OrdTree_difference(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn);
+
+/* ____________________________________________________________________________ */
+
+/**
+ * Free elements with `free_data_fn` and then the tree.
+ */
+extern void OrdTree_destroy(OrdTree_T* p_tree, free_data_FN free_data_fn);
+
+/**
+ * Free the tree but not its elements.
+ */
+extern void OrdTree_free(OrdTree_T* p_tree);
+
+#endif  /* DATA_STRUCTS_ORD_TREE_H */
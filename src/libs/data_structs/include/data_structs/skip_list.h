@@ -0,0 +1,75 @@
+/**
+ * @file    skip_list.h
+ * @brief   Ordered map from 64-bit integer keys to elements, shared by
+ *          threads without locks.
+ *
+ * Every key is one node with its tower of next pointers. A key is on level
+ * `i` with probability 2^-i, so a search skips most of the keys on the way
+ * down. Threads change links with compare and swap: a removed node is first
+ * marked on every level and then unlinked by whoever passes it.
+ *
+ * Nodes are freed only when no thread could still read them (epoch based
+ * reclamation), so operations never read freed memory and never wait for
+ * each other.
+ */
+#if !defined(DATA_STRUCTS_SKIP_LIST_H)
+#define DATA_STRUCTS_SKIP_LIST_H
+
+#include <stddef.h>     /* size_t  */
+#include <stdint.h>     /* int64_t */
+#include "lang/extend.h"
+
+typedef struct skip_list* SkipList_T;
+
+/**
+ * Create an empty skip list.
+ */
+extern SkipList_T SkipList_new(void);
+
+/**
+ * Put `value` under `key`. Return `true` if the key is new, otherwise
+ * replace its value and return `false`.
+ */
+extern bool SkipList_put(SkipList_T list, int64_t key, Object_T value);
+
+/**
+ * Set `p_value__` to the value of `key` and return `true`, or return `false`
+ * if it is not there.
+ */
+extern bool SkipList_get(SkipList_T list, int64_t key, Object_T* p_value__);
+
+/**
+ * Remove `key` and return `true`, or return `false` if it is not there.
+ * If `p_value__` is not NULL it is set to the removed value.
+ */
+extern bool SkipList_remove(SkipList_T list, int64_t key, Object_T* p_value__);
+
+/**
+ * @brief    Number of elements.
+ *
+ * If other threads change the list it is already old when it returns.
+ */
+extern size_t SkipList_length(SkipList_T list);
+
+/**
+ * @brief    Call `visit_fn` for keys from `low` to `high`, inclusive.
+ *
+ * Keys come in increasing order. Keys put or removed meanwhile by other
+ * threads could be seen or not. Return how many elements were visited.
+ */
+extern size_t SkipList_range(SkipList_T list, int64_t low, int64_t high, visit_FN visit_fn,
+                             void* arg);
+
+/**
+ * @brief    Free elements with `free_data_fn` and then the list.
+ *
+ * No other thread should use the list.
+ */
+extern void SkipList_destroy(SkipList_T* p_list, free_data_FN free_data_fn);
+
+/**
+ * Free the list but not its elements.
+ */
+extern void SkipList_free(SkipList_T* p_list);
+
+#endif  /* DATA_STRUCTS_SKIP_LIST_H */
@@ -1,26 +1,44 @@
 /**
  * @file    sparse_matrix.h
  * @brief   Sparse matrix ADT interface.
+ *
+ * Elements are kept in an open addressed hash table keyed by (row, column),
+ * so put, get and clear take O(1) expected time whatever the shape of the
+ * matrix is.
+ *
+ * For arithmetic, export the matrix to compressed rows (CSR) or compressed
+ * columns (CSC) of doubles: indexes and values of a row (column) are next
+ * to each other and sorted by column (row).
  */
 #if !defined(DATA_STRUCTS_SPARSE_MATRIX_H)
 #define DATA_STRUCTS_SPARSE_MATRIX_H
 
+#include <stddef.h>    /* size_t */
 #include "lang/extend.h"
 
-typedef struct matrix_node mnode_t;
+typedef struct matrix* Matrix_T;
 
-typedef mnode_t* Matrix_T;
+typedef struct compressed_matrix* CompressedMatrix_T;
+
+/* How elements of `CompressedMatrix_T` are grouped. */
+typedef enum { BY_ROWS, BY_COLUMNS } compressed_order_et;
+
+/* Gives number stored in an element. */
+typedef double (*to_double_FN)(Object_T);
 
 /**
- * Create a matrix by allocating the matrix header node [-1, -1].
+ * Create an empty matrix.
  */
 extern Matrix_T Matrix_new(void);
 
+/**
+ * Make room for `nonzeros` elements, so they are put without growing.
+ */
+extern void Matrix_reserve(Matrix_T* p_matrix, size_t nonzeros);
+
 /**
  * p_matrix[row][col] = value;
- *   This is done by locating correct position in the column list
- *   and the row list and inserting the new node (containing value)
- *   in the correct position in each of those lists.
+ *   Replaces the value if the element is there already.
  */
 extern void Matrix_put(Matrix_T* p_matrix, int row, int col, Object_T value);
 
@@ -30,9 +48,62 @@ extern void Matrix_put(Matrix_T* p_matrix, int row, int col, Object_T value);
 extern bool Matrix_get(Matrix_T* p_matirx, int row, int col, Object_T* p_value__);
 
 /**
- * Free the space used by p_matrix[row][col]. This assumes the
- * application has already freed the space used by the DATA field!
+ * Remove p_matrix[row][col]. This assumes the application has already freed
+ * the space used by the DATA field!
  */
 extern bool Matrix_clear(Matrix_T* p_matrix, int row, int col);
 
+/**
+ * Return number of elements.
+ */
+extern size_t Matrix_length(Matrix_T matrix);
+
+/**
+ * @brief    Copy to compressed rows or columns.
+ *
+ * Matrix has as many rows (columns) as the highest row (column) of an
+ * element plus one. `to_double_fn` gives values.
+ */
+extern CompressedMatrix_T Matrix_compress(Matrix_T matrix, compressed_order_et order,
+                                          to_double_FN to_double_fn);
+
+/**
+ * Free elements with `free_data_fn` and then the matrix.
+ */
+extern void Matrix_destroy(Matrix_T* p_matrix, free_data_FN free_data_fn);
+
+/**
+ * Free the matrix but not its elements.
+ */
+extern void Matrix_free(Matrix_T* p_matrix);
+
+/* __________________________________________________________________________ */
+/*                                                         Compressed matrix  */
+
+/**
+ * Return number of rows, columns and elements.
+ */
+extern void CompressedMatrix_size(CompressedMatrix_T matrix, size_t* p_rows__,
+                                  size_t* p_cols__, size_t* p_nonzeros__);
+
+/**
+ * @brief    Elements of row `idx` (BY_ROWS) or of column `idx` (BY_COLUMNS).
+ *
+ * Return their number and pass back arrays of their columns (rows), sorted,
+ * and values. Arrays are valid until the matrix is freed.
+ */
+extern size_t CompressedMatrix_line(CompressedMatrix_T matrix, size_t idx,
+                                    const int** pp_indexes__, const double** pp_values__);
+
+/**
+ * @brief    y = A * x
+ *
+ * `x` has as many elements as the matrix has columns and `y__` as it has
+ * rows. Rows are multiplied four elements at a time, with AVX2 gathers and
+ * FMA when the processor has them.
+ */
+extern void CompressedMatrix_multiply(CompressedMatrix_T matrix, const double* x, double* y__);
+
+extern void CompressedMatrix_free(CompressedMatrix_T* p_matrix);
+
 #endif  /* DATA_STRUCTS_SPARSE_MATRIX_H */
@@ -0,0 +1,69 @@
+/**
+ * @file    ws_deque.h
+ * @brief   Work-stealing deque (Chase and Lev).
+ *
+ * Stack of the thread that owns it, which other threads could take from the
+ * other end. The owner pushes and pops at the top, like `Stack_T`, without
+ * locks or waiting; thieves take the oldest element from the bottom with
+ * one compare and swap. The owner and a thief compete only for the last
+ * element.
+ *
+ * Elements are kept in an array that doubles when full. Arrays that were
+ * replaced are kept until the deque is freed because a thief could still
+ * read them, so memory used is at most twice the largest array.
+ */
+#if !defined(DATA_STRUCTS_WS_DEQUE_H)
+#define DATA_STRUCTS_WS_DEQUE_H
+
+#include <stddef.h>     /* size_t */
+#include "lang/extend.h"
+
+typedef struct ws_deque* WSDeque_T;
+
+/**
+ * Create an empty deque for at least `initial_size` elements.
+ */
+extern WSDeque_T WSDeque_new(unsigned initial_size);
+
+/**
+ * @brief    Number of elements.
+ *
+ * If thieves take elements it is already old when it returns.
+ */
+extern size_t WSDeque_length(WSDeque_T deque);
+
+/**
+ * @brief    Push `data` on top. Only the owner.
+ *
+ * If there is no more room, the array is doubled.
+ */
+extern void WSDeque_push(WSDeque_T deque, Object_T data);
+
+/**
+ * @brief    Pop the top element to `p_data__`. Only the owner.
+ *
+ * Return `false` if the deque is empty or a thief took the last element.
+ */
+extern bool WSDeque_pop(WSDeque_T deque, Object_T* p_data__);
+
+/**
+ * @brief    Take the bottom element to `p_data__`. Any thread.
+ *
+ * Return `false` if the deque is empty or another thread took the element
+ * first; then it is worth trying again or elsewhere.
+ */
+extern bool WSDeque_steal(WSDeque_T deque, Object_T* p_data__);
+
+/**
+ * @brief    Free elements with `free_data_fn` and then the deque.
+ *
+ * No other thread should use the deque.
+ */
+extern void WSDeque_destroy(WSDeque_T* p_deque, free_data_FN free_data_fn);
+
+/**
+ * Free the deque but not its elements.
+ */
+extern void WSDeque_free(WSDeque_T* p_deque);
+
+#endif  /* DATA_STRUCTS_WS_DEQUE_H */
@@ -0,0 +1,341 @@
+/**
+ * @file     list-unrolled.c
+ * @brief    Unrolled linked list.
+ *
+ * Compiled instead of `list.c` when `LIST_UNROLLED_MODE` is defined
+ * (`--enable-unrolled-lists`). Elements are kept in chunks of
+ * `CHUNK_ITEMS`, so there is one allocation per chunk and a traversal reads
+ * consecutive memory.
+ *
+ * A `node_t*` is the address of an element slot in its chunk. Chunks are
+ * aligned to their size, so the chunk of a slot is found by masking the
+ * address. The list header points to the first slot of the first chunk and
+ * to the slot of the last element. A chunk left under half full by a delete
+ * takes elements of the next one, so deletes don't leave sparse chunks.
+ *
+ * ATTENTION: Elements move inside their chunk when the list is changed, so
+ *            node pointers are valid until the next insert or delete.
+ */
+#include "data_structs/list.h"
+
+#if defined(LIST_UNROLLED_MODE)
+
+#include <stdint.h>      /* uintptr_t            */
+#include <string.h>      /* memcpy, memmove      */
+#include "lang/assert.h"
+#include "lang/memory.h"
+#include "logger/log.h"
+
+/* Four cache lines. */
+#define CHUNK_SIZE   256
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+typedef struct chunk {
+  struct chunk* next;
+  size_t count;
+  Object_T items[];
+} chunk_t;
+
+#define CHUNK_ITEMS  ((CHUNK_SIZE - sizeof (chunk_t)) / sizeof (Object_T))
+
+#define CHUNK(p_node)  ((chunk_t*)((uintptr_t)(p_node) & ~(uintptr_t)(CHUNK_SIZE - 1)))
+#define INDEX(p_node)  ((size_t)((Object_T*)(p_node) - CHUNK(p_node)->items))
+#define SLOT(p_chunk, idx)  ((node_t*)&(p_chunk)->items[idx])
+
+static chunk_t*
+__allocate_chunk(void)
+{
+  chunk_t* p_chunk = ALLOC_ALIGNED(CHUNK_SIZE, CHUNK_SIZE);
+
+  p_chunk->next = NULL;
+  p_chunk->count = 0;
+
+  return p_chunk;
+}
+
+static void
+__free_chunk(chunk_t* p_chunk)
+{
+  FREE_ALIGNED(p_chunk);
+}
+
+/* Chunk before `p_chunk` or NULL if it is the first. */
+static chunk_t*
+__prev_chunk(List_T list, chunk_t* p_chunk)
+{
+  chunk_t* iter = CHUNK(HEAD(list));
+
+  if (iter == p_chunk)
+  { return NULL; }
+
+  while (iter->next != p_chunk) {
+    iter = iter->next;
+  }
+
+  return iter;
+}
+
+/*
+ * Chunk under half full takes the elements of the next one, or only the first
+ * of them if they don't fit. So every chunk but the last stays half full.
+ */
+static void
+__refill(List_T list, chunk_t* p_chunk)
+{
+  chunk_t* next = p_chunk->next;
+
+  if (p_chunk->count + next->count <= CHUNK_ITEMS) {
+    memcpy(&p_chunk->items[p_chunk->count], next->items, next->count * sizeof (Object_T));
+    p_chunk->count += next->count;
+    p_chunk->next = next->next;
+
+    if (CHUNK(TAIL(list)) == next)
+    { TAIL(list) = SLOT(p_chunk, p_chunk->count - 1); }
+
+    __free_chunk(next);
+    return;
+  }
+
+  p_chunk->items[p_chunk->count++] = next->items[0];
+
+  next->count--;
+  memmove(&next->items[0], &next->items[1], next->count * sizeof (Object_T));
+
+  if (CHUNK(TAIL(list)) == next)
+  { TAIL(list) = SLOT(next, next->count - 1); }
+}
+
+/* __________________________________________________________________________ */
+
+List_T
+List_new(void)
+{
+  List_T list = NULL;
+  return list;
+}
+
+bool
+List_is_empty(List_T list)
+{
+  return list == NULL;
+}
+
+void
+List_insert(List_T* p_list, Object_T data)
+{
+  Require(p_list);
+
+  chunk_t* p_chunk = NULL;
+
+  if (List_is_empty(*p_list))
+  { List__allocate_header(p_list); }
+  else
+  { p_chunk = CHUNK(HEAD(*p_list)); }
+
+  if (p_chunk == NULL || p_chunk->count == CHUNK_ITEMS) {
+    chunk_t* first = __allocate_chunk();
+
+    first->next = p_chunk;
+    p_chunk = first;
+  }
+
+  memmove(&p_chunk->items[1], &p_chunk->items[0], p_chunk->count * sizeof (Object_T));
+  p_chunk->items[0] = data;
+  p_chunk->count++;
+
+  HEAD(*p_list) = SLOT(p_chunk, 0);
+
+  /* Last element moved too. */
+  if (TAIL(*p_list) == NULL || CHUNK(TAIL(*p_list)) == p_chunk)
+  { TAIL(*p_list) = SLOT(p_chunk, p_chunk->count - 1); }
+
+  LENGTH(*p_list)++;
+}
+
+void
+List_append(List_T* p_list, Object_T data)
+{
+  Require(p_list);
+
+  if (List_is_empty(*p_list)) {
+    List_insert(p_list, data);
+    return;
+  }
+
+  chunk_t* last = CHUNK(TAIL(*p_list));
+
+  if (last->count == CHUNK_ITEMS) {
+    last->next = __allocate_chunk();
+    last = last->next;
+  }
+
+  last->items[last->count] = data;
+
+  TAIL(*p_list) = SLOT(last, last->count++);
+  LENGTH(*p_list)++;
+}
+
+void
+List_delete_node(List_T* p_list, node_t* p_node)
+{
+  Require(p_list && *p_list);
+  Require(p_node);
+
+  chunk_t* p_chunk = CHUNK(p_node);
+  const size_t idx = INDEX(p_node);
+
+  Ensure(idx < p_chunk->count);
+
+  p_chunk->count--;
+  memmove(&p_chunk->items[idx], &p_chunk->items[idx + 1],
+          (p_chunk->count - idx) * sizeof (Object_T));
+
+  if (--LENGTH(*p_list) == 0) {
+    __free_chunk(p_chunk);
+    List__free_header(p_list);
+    return;
+  }
+
+  if (p_chunk->count < CHUNK_ITEMS / 2 && p_chunk->next != NULL)
+  { __refill(*p_list, p_chunk); }
+
+  const bool last = (CHUNK(TAIL(*p_list)) == p_chunk);
+
+  if (p_chunk->count > 0) {
+    if (last)
+    { TAIL(*p_list) = SLOT(p_chunk, p_chunk->count - 1); }
+
+    return;
+  }
+
+  chunk_t* prev = __prev_chunk(*p_list, p_chunk);
+
+  if (prev == NULL)
+  { HEAD(*p_list) = SLOT(p_chunk->next, 0); }
+  else
+  { prev->next = p_chunk->next; }
+
+  if (last)
+  { TAIL(*p_list) = SLOT(prev, prev->count - 1); }
+
+  __free_chunk(p_chunk);
+}
+
+bool
+List_delete_head(List_T* p_list, Object_T* p_data__)
+{
+  if (List_is_empty(*p_list)) {
+    Log_debug("Can't delete from empty list.");
+    return false;
+  }
+
+  *p_data__ = DATA(HEAD(*p_list));
+  List_delete_node(p_list, HEAD(*p_list));
+
+  return true;
+}
+
+bool
+List_traverse(List_T list, bool (*apply_fn)(Object_T))
+{
+  Require(apply_fn);
+
+  for (chunk_t* p_chunk = list ? CHUNK(HEAD(list)) : NULL; p_chunk; p_chunk = p_chunk->next) {
+    for (size_t i = 0; i < p_chunk->count; ++i) {
+
+      if (!(*apply_fn)(p_chunk->items[i])) {
+        Log_error("Can't apply function.");
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+node_t*
+List_iterator(List_T list, node_t* last_return)
+{
+  if (last_return == NULL)
+  { return List_is_empty(list) ? NULL : HEAD(list); }
+
+  chunk_t* p_chunk = CHUNK(last_return);
+  const size_t next = INDEX(last_return) + 1;
+
+  if (next < p_chunk->count)
+  { return SLOT(p_chunk, next); }
+
+  return (p_chunk->next != NULL) ? SLOT(p_chunk->next, 0) : NULL;
+}
+
+size_t
+List_length(List_T list)
+{
+  return List_is_empty(list) ? 0 : LENGTH(list);
+}
+
+bool
+List_find_key(List_T list, equal_data_FN equal_fn, Object_T key, node_t** pp_keynode__)
+{
+  Require(list);
+  Require(equal_fn);
+  Require(key);
+
+  for (chunk_t* p_chunk = CHUNK(HEAD(list)); p_chunk; p_chunk = p_chunk->next) {
+    for (size_t i = 0; i < p_chunk->count; ++i) {
+
+      if (equal_fn(key, p_chunk->items[i])) {
+        *pp_keynode__ = SLOT(p_chunk, i);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void
+List_print(const List_T list, print_data_FN print_data_fn)
+{
+  for (chunk_t* p_chunk = list ? CHUNK(HEAD(list)) : NULL; p_chunk; p_chunk = p_chunk->next) {
+    for (size_t i = 0; i < p_chunk->count; ++i) {
+      print_data_fn(p_chunk->items[i]);
+    }
+  }
+}
+
+void
+List_destroy(List_T* p_list, free_data_FN free_data_fn)
+{
+  Require(p_list);
+
+  if (List_is_empty(*p_list))
+  { return; }
+
+  chunk_t* next_tmp;
+  for (chunk_t* p_chunk = CHUNK(HEAD(*p_list)); p_chunk; p_chunk = next_tmp) {
+    next_tmp = p_chunk->next;
+
+    if (free_data_fn != NULL) {
+      for (size_t i = 0; i < p_chunk->count; ++i) {
+        free_data_fn(p_chunk->items[i]);
+      }
+    }
+
+    __free_chunk(p_chunk);
+  }
+
+  List__free_header(p_list);
+}
+
+void
+List_free(List_T* p_list)
+{
+  List_destroy(p_list, NULL);
+}
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* LIST_UNROLLED_MODE */
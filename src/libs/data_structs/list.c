@@ -1,5 +1,8 @@
 #include "data_structs/list.h"
 
+/* See `list-unrolled.c` */
+#if !defined(LIST_UNROLLED_MODE)
+
 #include "lang/assert.h"
 #include "lang/memory.h"
 #include "logger/log.h"
@@ -25,48 +28,65 @@ List_insert(List_T* p_list, Object_T data)
   node_t* p_node;
   List__allocate_node(&p_node, data);
 
-  NEXT(p_node) = *p_list;
-  *p_list = p_node;
+  if (List_is_empty(*p_list)) {
+    List__allocate_header(p_list);
+    TAIL(*p_list) = p_node;
+  }
+
+  NEXT(p_node) = HEAD(*p_list);
+  HEAD(*p_list) = p_node;
+  LENGTH(*p_list)++;
 }
 
+/* Tail is kept in the header, no need to search for it. */
 void
 List_append(List_T* p_list, Object_T data)
 {
+  Require(p_list);
+
   node_t* p_node;
   List__allocate_node(&p_node, data);
 
   if (List_is_empty(*p_list)) {
-    *p_list = p_node;
+    List__allocate_header(p_list);
+    HEAD(*p_list) = p_node;
 
   } else {
-    node_t* iter_node;
-    for (iter_node = *p_list; NEXT(iter_node) != NULL; ) {
-      iter_node = NEXT(iter_node);
-    }
-
-    NEXT(iter_node) = p_node;
+    NEXT(TAIL(*p_list)) = p_node;
   }
+
+  TAIL(*p_list) = p_node;
+  LENGTH(*p_list)++;
 }
 
 /* Delete given `p_node` from `p_list`. */
 void
 List_delete_node(List_T* p_list, node_t* p_node)
 {
-  if (*p_list == p_node) {
-    *p_list = NEXT(*p_list);  /* Continue with the next. */
+  Require(p_list && *p_list);
+
+  node_t* prev_node = NULL;
+
+  if (HEAD(*p_list) == p_node) {
+    HEAD(*p_list) = NEXT(p_node);  /* Continue with the next. */
 
   } else {
-    node_t* iter_node;
-    for (iter_node = *p_list; iter_node != NULL && NEXT(iter_node) != p_node; ) {
-      iter_node = NEXT(iter_node);
+    for (prev_node = HEAD(*p_list); prev_node != NULL && NEXT(prev_node) != p_node; ) {
+      prev_node = NEXT(prev_node);
     }
 
-    Ensure(iter_node);
+    Ensure(prev_node);
 
-    NEXT(iter_node) = NEXT(p_node);
+    NEXT(prev_node) = NEXT(p_node);
   }
 
+  if (TAIL(*p_list) == p_node)
+  { TAIL(*p_list) = prev_node; }
+
   List__free_node(&p_node);
+
+  if (--LENGTH(*p_list) == 0)
+  { List__free_header(p_list); }
 }
 
 /* Instead return pointer to pointer it is more convenient to pass out param. */
@@ -78,44 +98,42 @@ List_delete_head(List_T* p_list, Object_T* p_data__)
     return false;
   }
 
-  *p_data__ = DATA(*p_list);
-  List_delete_node(p_list, *p_list /* Fist node in practice. */);
+  *p_data__ = DATA(HEAD(*p_list));
+  List_delete_node(p_list, HEAD(*p_list));
 
   return true;
 }
 
-/* Iterate tail recursively. */
 bool
 List_traverse(List_T list, bool (*apply_fn)(Object_T))
 {
   Require(apply_fn);
 
-  if (List_is_empty(list))
-  { return true; }
-
-  if (!(*apply_fn)(DATA(list))) {
-    Log_error("Can't apply function.");
-    return false;
+  node_t* curr_node = NULL;
+  while ((curr_node = List_iterator(list, curr_node)) != NULL) {
 
-  } else {
-    return List_traverse(NEXT(list), apply_fn);
+    if (!(*apply_fn)(DATA(curr_node))) {
+      Log_error("Can't apply function.");
+      return false;
+    }
   }
+
+  return true;
 }
 
-List_T
+node_t*
 List_iterator(List_T list, node_t* last_return)
 {
-  return (last_return == NULL) ? list : NEXT(last_return);
+  if (last_return == NULL)
+  { return List_is_empty(list) ? NULL : HEAD(list); }
+
+  return NEXT(last_return);
 }
 
 size_t
 List_length(List_T list)
 {
-  size_t n;
-  for (n = 0; list != NULL; list = NEXT(list))
-  { n++; }
-
-  return n;
+  return List_is_empty(list) ? 0 : LENGTH(list);
 }
 
 /* Searching same as `key` and if found, `pp_keynode__` is instance of it in the list. */
@@ -151,17 +169,21 @@ List_destroy(List_T* p_list, free_data_FN free_data_fn)
 {
   Require(p_list);
 
-  /* First iteration will initialize it. */
-  List_T next_tmp;
-  for ( ; *p_list != NULL; *p_list = next_tmp) {
-    next_tmp = NEXT(*p_list);
+  if (List_is_empty(*p_list))
+  { return; }
+
+  node_t* next_tmp;
+  for (node_t* p_node = HEAD(*p_list); p_node != NULL; p_node = next_tmp) {
+    next_tmp = NEXT(p_node);
 
     if (free_data_fn != NULL) {
-      free_data_fn(DATA(*p_list));
+      free_data_fn(DATA(p_node));
     }
 
-    FREE(*p_list);
+    List__free_node(&p_node);
   }
+
+  List__free_header(p_list);
 }
 
 void
@@ -169,3 +191,7 @@ List_free(List_T* p_list)
 {
   List_destroy(p_list, NULL);
 }
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* LIST_UNROLLED_MODE */
@@ -20,3 +20,23 @@ List__free_node(node_t** pp_node)
 {
   FREE(*pp_node);
 }
+
+/* Header of a list with no elements yet. */
+void
+List__allocate_header(struct list** pp_list)
+{
+  struct list* p_list;
+  NEW(p_list);
+
+  *pp_list = p_list;
+
+  HEAD(p_list) = NULL;
+  TAIL(p_list) = NULL;
+  LENGTH(p_list) = 0;
+}
+
+void
+List__free_header(struct list** pp_list)
+{
+  FREE(*pp_list);
+}
@@ -1,5 +1,17 @@
+/**
+ * @file     list_stack.c
+ * @brief    Stack of linked nodes that are reused.
+ *
+ * Nodes are cut from chunks and popped nodes go to `spare`, so pushes and
+ * pops only move pointers and a node keeps its address while it is in the
+ * stack. Chunks double up to `MAX_CHUNK` nodes.
+ *
+ * Nodes of a chunk could be anywhere in the stack, so chunks are freed only
+ * when the stack gets empty: if there are more than twice as many nodes as
+ * the stack had at most since it was last empty (or as reserved), all go
+ * and a chunk of that size is made instead.
+ */
 #include "data_structs/list_stack.h"
-#include "data_structs/list.h"
 
 #include "lang/memory.h"
 #include "lang/assert.h"
@@ -8,11 +20,74 @@
 /* __________________________________________________________________________ */
 /*                                                                     Local  */
 
+#define FIRST_CHUNK  32
+#define MAX_CHUNK    4096
+
+struct node {
+  Object_T data;
+  struct node* next;
+};
+
+struct chunk {
+  struct chunk* next;
+  struct node nodes[];
+};
+
 struct stack {
-  int count;
-  List_T storage;
+  size_t count;
+  struct node* top;
+  struct node* spare;      /* Free nodes, linked with `next`. */
+  struct chunk* chunks;
+  size_t capacity;         /* Nodes in all chunks.            */
+  size_t reserved;
+  size_t peak;             /* Most elements since last empty. */
 };
 
+static void
+__add_chunk(LStack_T stack, size_t size)
+{
+  struct chunk* chunk = ALLOC(sizeof (struct chunk) + size * sizeof (struct node));
+
+  chunk->next = stack->chunks;
+  stack->chunks = chunk;
+
+  for (size_t i = size; i-- > 0;) {
+    chunk->nodes[i].next = stack->spare;
+    stack->spare = &chunk->nodes[i];
+  }
+
+  stack->capacity += size;
+}
+
+static void
+__free_chunks(LStack_T stack)
+{
+  struct chunk* next_tmp;
+
+  for (struct chunk* chunk = stack->chunks; chunk != NULL; chunk = next_tmp) {
+    next_tmp = chunk->next;
+    FREE(chunk);
+  }
+
+  stack->chunks = NULL;
+  stack->spare = NULL;
+  stack->capacity = 0;
+}
+
+/* Called when the stack gets empty, see the file comment. */
+static void
+__shrink(LStack_T stack)
+{
+  const size_t keep = (stack->peak > stack->reserved) ? stack->peak : stack->reserved;
+  stack->peak = 0;
+
+  if (stack->capacity <= FIRST_CHUNK || stack->capacity <= 2 * keep)
+  { return; }
+
+  __free_chunks(stack);
+  __add_chunk(stack, (keep > FIRST_CHUNK) ? keep : FIRST_CHUNK);
+}
+
 /* __________________________________________________________________________ */
 
 LStack_T
@@ -22,7 +97,12 @@ LStack_new(void)
   NEW(stack);
 
   stack->count = 0;
-  stack->storage = List_new();
+  stack->top = NULL;
+  stack->spare = NULL;
+  stack->chunks = NULL;
+  stack->capacity = 0;
+  stack->reserved = 0;
+  stack->peak = 0;
 
   return stack;
 }
@@ -34,13 +114,36 @@ LStack_is_empty(LStack_T stack)
   return stack->count == 0;
 }
 
+void
+LStack_reserve(LStack_T stack, size_t n)
+{
+  Require(stack);
+
+  if (stack->capacity < n)
+  { __add_chunk(stack, n - stack->capacity); }
+
+  stack->reserved = n;
+}
+
 void
 LStack_push(LStack_T stack, Object_T data)
 {
   Require(stack);
 
-  List_insert(&stack->storage, data);
-  stack->count++;
+  if (stack->spare == NULL) {
+    const size_t size = (stack->capacity < FIRST_CHUNK) ? FIRST_CHUNK : stack->capacity;
+    __add_chunk(stack, (size < MAX_CHUNK) ? size : MAX_CHUNK);
+  }
+
+  struct node* node = stack->spare;
+  stack->spare = node->next;
+
+  node->data = data;
+  node->next = stack->top;
+  stack->top = node;
+
+  if (++stack->count > stack->peak)
+  { stack->peak = stack->count; }
 }
 
 bool
@@ -52,18 +155,28 @@ LStack_pop(LStack_T stack, Object_T* p_data__)
     return false;
   }
 
-  List_delete_head(&stack->storage, p_data__);
-  stack->count--;
+  struct node* node = stack->top;
+  stack->top = node->next;
+  *p_data__ = node->data;
+
+  node->next = stack->spare;
+  stack->spare = node;
+
+  if (--stack->count == 0)
+  { __shrink(stack); }
+
   return true;
 }
 
 bool
 LStack_peel(LStack_T stack, Object_T* p_data__)
 {
-  if (!LStack_pop(stack, p_data__))
+  Require(stack);
+
+  if (stack->count == 0)
   { return false; }
 
-  LStack_push(stack, *p_data__);
+  *p_data__ = stack->top->data;
   return true;
 }
 
@@ -73,10 +186,16 @@ LStack_destroy(LStack_T stack, free_data_FN free_data_fn)
   if (!LStack_is_empty(stack)) {
     Log_warn("LStack is not empty.");
 
-    List_destroy(&stack->storage, free_data_fn);
+    for (struct node* node = stack->top; node != NULL; node = node->next) {
+      if (free_data_fn != NULL)
+      { free_data_fn(node->data); }
+    }
+
     stack->count = 0;
   }
 
+  __free_chunks(stack);
+
   FREE(stack);
   stack = NULL;
 }
@@ -0,0 +1,220 @@
+/**
+ * @file     mpmc_queue.c
+ * @brief    Bounded lock-free queue, after Dmitry Vyukov's MPMC queue.
+ *
+ * `tail` and `head` are positions that only grow, a position maps to slot
+ * `position & mask`. Slot of position `p` has sequence:
+ *
+ *   p                   - empty, could be filled by who takes `p` from `tail`
+ *   p + 1               - filled, could be emptied by who takes `p` from `head`
+ *   p + capacity        - emptied, ready for the next round
+ *
+ * A thread checks sequences of the slots it wants, takes the positions with
+ * compare and swap and only then writes or reads them. Sequence is stored
+ * with release after that, so the next owner sees the element.
+ */
+#include "data_structs/mpmc_queue.h"
+
+#include <stdatomic.h>   /* atomic_* */
+#include <stdint.h>      /* intptr_t */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+#define CACHE_LINE  64
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct slot {
+  _Atomic size_t sequence;
+  Object_T datapointer;
+};
+
+/*
+ * Producers and consumers do not share cache lines. Slots follow in the same
+ * block, its size is a multiple of the line.
+ */
+struct mpmc_queue {
+  _Alignas(CACHE_LINE) _Atomic size_t tail;
+  _Alignas(CACHE_LINE) _Atomic size_t head;
+  _Alignas(CACHE_LINE) size_t mask;
+  struct slot* slots;
+};
+
+/*
+ * Take at most `n` positions from `p_counter` whose slots have sequence
+ * `position + ready`. Return their number, first one in `p_first__`.
+ */
+static size_t
+__claim(MPMCQueue_T queue, _Atomic size_t* p_counter, size_t ready, size_t n,
+        size_t* p_first__)
+{
+  if (n == 0)
+  { return 0; }
+
+  const size_t mask = queue->mask;
+  size_t first = atomic_load_explicit(p_counter, memory_order_relaxed);
+
+  for (;;) {
+    size_t count = 0;
+
+    while (count < n) {
+      const size_t position = first + count;
+      const size_t sequence = atomic_load_explicit(&queue->slots[position & mask].sequence,
+                                                   memory_order_acquire);
+      if (sequence != position + ready)
+      { break; }
+
+      count++;
+    }
+
+    if (count == 0) {
+      const size_t sequence = atomic_load_explicit(&queue->slots[first & mask].sequence,
+                                                   memory_order_acquire);
+
+      /* Previous round is not done with the slot: full or empty. */
+      if ((intptr_t)(sequence - (first + ready)) < 0)
+      { return 0; }
+
+      /* Someone else took it. */
+      first = atomic_load_explicit(p_counter, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(p_counter, &first, first + count,
+                                              memory_order_relaxed, memory_order_relaxed)) {
+      *p_first__ = first;
+      return count;
+    }
+  }
+}
+
+/* ______________________________________________________________________________ */
+
+MPMCQueue_T
+MPMCQueue_new(size_t capacity)
+{
+  Require(capacity > 0);
+
+  size_t slots = 4;
+
+  while (slots < capacity) {
+    slots *= 2;
+  }
+
+  MPMCQueue_T queue = ALLOC_ALIGNED(CACHE_LINE, sizeof (*queue) + slots * sizeof (struct slot));
+
+  queue->slots = (struct slot*)(void*)(queue + 1);
+
+  queue->mask = slots - 1;
+  atomic_init(&queue->tail, 0);
+  atomic_init(&queue->head, 0);
+
+  for (size_t i = 0; i < slots; ++i) {
+    atomic_init(&queue->slots[i].sequence, i);
+    queue->slots[i].datapointer = NULL;
+  }
+
+  return queue;
+}
+
+size_t
+MPMCQueue_capacity(MPMCQueue_T queue)
+{
+  Require(queue);
+  return queue->mask + 1;
+}
+
+size_t
+MPMCQueue_length(MPMCQueue_T queue)
+{
+  Require(queue);
+
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+  /* `head` could pass `tail` read before it. */
+  if ((intptr_t)(tail - head) <= 0)
+  { return 0; }
+
+  return (tail - head > queue->mask + 1) ? queue->mask + 1 : tail - head;
+}
+
+bool
+MPMCQueue_add(MPMCQueue_T queue, Object_T data)
+{
+  return MPMCQueue_add_bulk(queue, &data, 1) == 1;
+}
+
+bool
+MPMCQueue_remove(MPMCQueue_T queue, Object_T* p_data__)
+{
+  return MPMCQueue_remove_bulk(queue, p_data__, 1) == 1;
+}
+
+size_t
+MPMCQueue_add_bulk(MPMCQueue_T queue, const Object_T* items, size_t n)
+{
+  Require(queue);
+  Require(items || n == 0);
+
+  size_t first;
+  const size_t count = __claim(queue, &queue->tail, 0, n, &first);
+
+  for (size_t i = 0; i < count; ++i) {
+    struct slot* p_slot = &queue->slots[(first + i) & queue->mask];
+
+    p_slot->datapointer = items[i];
+    atomic_store_explicit(&p_slot->sequence, first + i + 1, memory_order_release);
+  }
+
+  return count;
+}
+
+size_t
+MPMCQueue_remove_bulk(MPMCQueue_T queue, Object_T* items__, size_t n)
+{
+  Require(queue);
+  Require(items__ || n == 0);
+
+  size_t first;
+  const size_t count = __claim(queue, &queue->head, 1, n, &first);
+
+  for (size_t i = 0; i < count; ++i) {
+    struct slot* p_slot = &queue->slots[(first + i) & queue->mask];
+
+    items__[i] = p_slot->datapointer;
+    atomic_store_explicit(&p_slot->sequence, first + i + queue->mask + 1,
+                          memory_order_release);
+  }
+
+  return count;
+}
+
+void
+MPMCQueue_destroy(MPMCQueue_T* p_queue, free_data_FN free_data_fn)
+{
+  Require(p_queue);
+
+  MPMCQueue_T queue = *p_queue;
+
+  if (queue == NULL)
+  { return; }
+
+  Object_T stale_out;
+
+  while (MPMCQueue_remove(queue, &stale_out)) {
+    if (free_data_fn != NULL)
+    { free_data_fn(stale_out); }
+  }
+
+  FREE_ALIGNED(queue);
+
+  *p_queue = NULL;
+}
+
+void
+MPMCQueue_free(MPMCQueue_T* p_queue)
+{
+  MPMCQueue_destroy(p_queue, NULL);
+}
@@ -0,0 +1,806 @@
+/**
+ * @file     ord_tree.c
+ * @brief    Join based balanced tree with subtree sizes.
+ *
+ * `__join(left, node, right)` makes one balanced tree of two balanced trees
+ * and a node with a key between them. If their heights are about the same
+ * `node` becomes the root, otherwise it goes down the side of the taller
+ * tree to a subtree as high as the other one and rebalances back up, so it
+ * takes O(difference of heights). Only `__join` knows the balance scheme,
+ * everything else is written with it:
+ *
+ *   put, remove      join the changed subtree back on the way up
+ *   split            joins subtrees on either side of the path down
+ *   union & co.      split one tree at the root of the other, do the halves,
+ *                    join the results with the root
+ *
+ * Subtrees taken out of a red-black tree could have a red root, which a
+ * join of red-black trees allows. `rank` of a node is its height, or the
+ * number of black nodes down to a leaf for red-black trees, the node
+ * included. See G. Blelloch, D. Ferizovic, Y. Sun, "Just Join for Parallel
+ * Ordered Sets" (2016).
+ */
+#include "data_structs/ord_tree.h"
+
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+/* Bulk operations on fewer nodes are not forked. */
+#define GRAIN  (1 << 12)
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct node {
+  struct node* left;
+  struct node* right;
+  int64_t key;
+  Object_T value;
+  size_t size;      /* Nodes in the subtree. */
+  unsigned rank;
+  bool red;
+};
+
+struct ord_tree {
+  struct node* root;
+  balance_et balance;
+};
+
+static inline size_t
+__size(const struct node* node)
+{
+  return (node != NULL) ? node->size : 0;
+}
+
+static inline unsigned
+__rank(const struct node* node)
+{
+  return (node != NULL) ? node->rank : 0;
+}
+
+static inline bool
+__red(const struct node* node)
+{
+  return node != NULL && node->red;
+}
+
+static void
+__update(struct node* node, balance_et balance)
+{
+  node->size = __size(node->left) + __size(node->right) + 1;
+
+  if (balance == RED_BLACK) {
+    node->rank = __rank(node->left) + !node->red;
+
+  } else {
+    const unsigned left = __rank(node->left);
+    const unsigned right = __rank(node->right);
+
+    node->rank = ((left > right) ? left : right) + 1;
+  }
+}
+
+static struct node*
+__rotate_left(struct node* node, balance_et balance)
+{
+  struct node* right = node->right;
+
+  node->right = right->left;
+  right->left = node;
+
+  __update(node, balance);
+  __update(right, balance);
+
+  return right;
+}
+
+static struct node*
+__rotate_right(struct node* node, balance_et balance)
+{
+  struct node* left = node->left;
+
+  node->left = left->right;
+  left->right = node;
+
+  __update(node, balance);
+  __update(left, balance);
+
+  return left;
+}
+
+static struct node*
+__link(struct node* left, struct node* node, struct node* right, balance_et balance)
+{
+  node->left = left;
+  node->right = right;
+  __update(node, balance);
+
+  return node;
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                        Joins  */
+
+/* `left` is higher by more than one. */
+static struct node*
+__join_right_hb(struct node* left, struct node* node, struct node* right)
+{
+  struct node* inner = left->right;
+
+  if (__rank(inner) <= __rank(right) + 1) {
+    left->right = __link(inner, node, right, HEIGHT_BALANCED);
+
+    if (left->right->rank > __rank(left->left) + 1) {
+      left->right = __rotate_right(left->right, HEIGHT_BALANCED);
+      return __rotate_left(left, HEIGHT_BALANCED);
+    }
+
+    __update(left, HEIGHT_BALANCED);
+    return left;
+  }
+
+  left->right = __join_right_hb(inner, node, right);
+  __update(left, HEIGHT_BALANCED);
+
+  if (left->right->rank > __rank(left->left) + 1)
+  { return __rotate_left(left, HEIGHT_BALANCED); }
+
+  return left;
+}
+
+static struct node*
+__join_left_hb(struct node* left, struct node* node, struct node* right)
+{
+  struct node* inner = right->left;
+
+  if (__rank(inner) <= __rank(left) + 1) {
+    right->left = __link(left, node, inner, HEIGHT_BALANCED);
+
+    if (right->left->rank > __rank(right->right) + 1) {
+      right->left = __rotate_left(right->left, HEIGHT_BALANCED);
+      return __rotate_right(right, HEIGHT_BALANCED);
+    }
+
+    __update(right, HEIGHT_BALANCED);
+    return right;
+  }
+
+  right->left = __join_left_hb(left, node, inner);
+  __update(right, HEIGHT_BALANCED);
+
+  if (right->left->rank > __rank(right->right) + 1)
+  { return __rotate_right(right, HEIGHT_BALANCED); }
+
+  return right;
+}
+
+/* `left` has more black nodes on the way down, or the same and a red root. */
+static struct node*
+__join_right_rb(struct node* left, struct node* node, struct node* right)
+{
+  if (!__red(left) && __rank(left) == __rank(right)) {
+    node->red = true;
+    return __link(left, node, right, RED_BLACK);
+  }
+
+  left->right = __join_right_rb(left->right, node, right);
+  __update(left, RED_BLACK);
+
+  /* Two red nodes in a row below a black one. */
+  if (!left->red && __red(left->right) && __red(left->right->right)) {
+    left->right->right->red = false;
+    __update(left->right->right, RED_BLACK);
+
+    return __rotate_left(left, RED_BLACK);
+  }
+
+  return left;
+}
+
+static struct node*
+__join_left_rb(struct node* left, struct node* node, struct node* right)
+{
+  if (!__red(right) && __rank(right) == __rank(left)) {
+    node->red = true;
+    return __link(left, node, right, RED_BLACK);
+  }
+
+  right->left = __join_left_rb(left, node, right->left);
+  __update(right, RED_BLACK);
+
+  if (!right->red && __red(right->left) && __red(right->left->left)) {
+    right->left->left->red = false;
+    __update(right->left->left, RED_BLACK);
+
+    return __rotate_right(right, RED_BLACK);
+  }
+
+  return right;
+}
+
+/* Keys of `left` are less than key of `node` and keys of `right` greater. */
+static struct node*
+__join(struct node* left, struct node* node, struct node* right, balance_et balance)
+{
+  if (balance == HEIGHT_BALANCED) {
+    if (__rank(left) > __rank(right) + 1)
+    { return __join_right_hb(left, node, right); }
+
+    if (__rank(right) > __rank(left) + 1)
+    { return __join_left_hb(left, node, right); }
+
+    return __link(left, node, right, HEIGHT_BALANCED);
+  }
+
+  struct node* root;
+
+  if (__rank(left) > __rank(right)) {
+    root = __join_right_rb(left, node, right);
+
+    if (root->red && __red(root->right))
+    { root->red = false; }
+
+  } else if (__rank(right) > __rank(left)) {
+    root = __join_left_rb(left, node, right);
+
+    if (root->red && __red(root->left))
+    { root->red = false; }
+
+  } else {
+    node->red = !__red(left) && !__red(right);
+    root = __link(left, node, right, RED_BLACK);
+  }
+
+  __update(root, RED_BLACK);
+  return root;
+}
+
+/* Removes the node with the greatest key, which is set to `*p_last__`. */
+static struct node*
+__split_last(struct node* root, balance_et balance, struct node** p_last__)
+{
+  if (root->right == NULL) {
+    *p_last__ = root;
+    return root->left;
+  }
+
+  struct node* rest = __split_last(root->right, balance, p_last__);
+  return __join(root->left, root, rest, balance);
+}
+
+/* Keys of `left` are less than keys of `right`. */
+static struct node*
+__join2(struct node* left, struct node* right, balance_et balance)
+{
+  if (left == NULL)
+  { return right; }
+
+  struct node* last;
+  left = __split_last(left, balance, &last);
+
+  return __join(left, last, right, balance);
+}
+
+/*
+ * Moves nodes with keys less than `key` to `*p_left__` and greater to
+ * `*p_right__`. Returns node of `key` or NULL.
+ */
+static struct node*
+__split(struct node* root, int64_t key, balance_et balance, struct node** p_left__,
+        struct node** p_right__)
+{
+  if (root == NULL) {
+    *p_left__ = *p_right__ = NULL;
+    return NULL;
+  }
+
+  struct node* left = root->left;
+  struct node* right = root->right;
+  struct node* rest;
+  struct node* found;
+
+  if (key == root->key) {
+    *p_left__ = left;
+    *p_right__ = right;
+    return root;
+  }
+
+  if (key < root->key) {
+    found = __split(left, key, balance, p_left__, &rest);
+    *p_right__ = __join(rest, root, right, balance);
+
+  } else {
+    found = __split(right, key, balance, &rest, p_right__);
+    *p_left__ = __join(left, root, rest, balance);
+  }
+
+  return found;
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                      Updates  */
+
+static struct node*
+__node_new(int64_t key, Object_T value)
+{
+  struct node* node;
+  NEW(node);
+
+  node->left = node->right = NULL;
+  node->key = key;
+  node->value = value;
+  node->size = 1;
+  node->rank = 1;
+  node->red = false;
+
+  return node;
+}
+
+static void
+__free_nodes(struct node* node, free_data_FN free_data_fn)
+{
+  while (node != NULL) {
+    struct node* right = node->right;
+
+    __free_nodes(node->left, free_data_fn);
+
+    if (free_data_fn != NULL)
+    { free_data_fn(node->value); }
+
+    FREE(node);
+    node = right;
+  }
+}
+
+/* `node` is not in the tree. */
+static struct node*
+__insert(struct node* root, struct node* node, balance_et balance)
+{
+  if (root == NULL)
+  { return __join(NULL, node, NULL, balance); }
+
+  if (node->key < root->key)
+  { return __join(__insert(root->left, node, balance), root, root->right, balance); }
+
+  return __join(root->left, root, __insert(root->right, node, balance), balance);
+}
+
+static struct node*
+__remove(struct node* root, int64_t key, balance_et balance, struct node** p_removed__)
+{
+  if (root == NULL)
+  { return NULL; }
+
+  if (key == root->key) {
+    *p_removed__ = root;
+    return __join2(root->left, root->right, balance);
+  }
+
+  if (key < root->key) {
+    struct node* left = __remove(root->left, key, balance, p_removed__);
+    return (*p_removed__ != NULL) ? __join(left, root, root->right, balance) : root;
+  }
+
+  struct node* right = __remove(root->right, key, balance, p_removed__);
+  return (*p_removed__ != NULL) ? __join(root->left, root, right, balance) : root;
+}
+
+/* Red-black trees keep black nodes on the way down only. */
+static size_t
+__height(const struct node* node)
+{
+  if (node == NULL)
+  { return 0; }
+
+  const size_t left = __height(node->left);
+  const size_t right = __height(node->right);
+
+  return ((left > right) ? left : right) + 1;
+}
+
+/* Balanced tree of sorted keys, nodes deeper than `full` levels are red. */
+static struct node*
+__load(const int64_t* keys, const Object_T* values, size_t n, balance_et balance,
+       unsigned depth, unsigned full)
+{
+  if (n == 0)
+  { return NULL; }
+
+  const size_t middle = n / 2;
+  struct node* node = __node_new(keys[middle], (values != NULL) ? values[middle] : NULL);
+
+  node->left = __load(keys, values, middle, balance, depth + 1, full);
+  node->right = __load(keys + middle + 1, (values != NULL) ? values + middle + 1 : NULL,
+                       n - middle - 1, balance, depth + 1, full);
+  node->red = (balance == RED_BLACK) && depth >= full;
+  __update(node, balance);
+
+  return node;
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                         Sets  */
+
+typedef struct node* (*set_FN)(struct node* tree, struct node* other, balance_et balance,
+                               fork_FN fork_fn);
+
+typedef struct {
+  set_FN set_fn;
+  struct node* tree;
+  struct node* other;
+  balance_et balance;
+  fork_FN fork_fn;
+  struct node* result;
+} set_task_t;
+
+static void
+__set_task(void* arg)
+{
+  set_task_t* task = arg;
+  task->result = task->set_fn(task->tree, task->other, task->balance, task->fork_fn);
+}
+
+/* Runs `set_fn` on both pairs of subtrees, forked if they are big enough. */
+static void
+__set_halves(set_FN set_fn, set_task_t* left, set_task_t* right)
+{
+  left->set_fn = right->set_fn = set_fn;
+  left->result = right->result = NULL;
+
+  const size_t size = __size(left->tree) + __size(left->other)
+                      + __size(right->tree) + __size(right->other);
+
+  if (left->fork_fn != NULL && size >= GRAIN) {
+    left->fork_fn(__set_task, left, __set_task, right);
+
+  } else {
+    __set_task(left);
+    __set_task(right);
+  }
+}
+
+static struct node*
+__union(struct node* tree, struct node* other, balance_et balance, fork_FN fork_fn)
+{
+  if (tree == NULL)
+  { return other; }
+
+  if (other == NULL)
+  { return tree; }
+
+  struct node* less;
+  struct node* greater;
+  struct node* same = __split(other, tree->key, balance, &less, &greater);
+
+  FREE(same);
+
+  set_task_t left = { NULL, tree->left, less, balance, fork_fn, NULL };
+  set_task_t right = { NULL, tree->right, greater, balance, fork_fn, NULL };
+  __set_halves(__union, &left, &right);
+
+  return __join(left.result, tree, right.result, balance);
+}
+
+static struct node*
+__intersection(struct node* tree, struct node* other, balance_et balance, fork_FN fork_fn)
+{
+  if (tree == NULL || other == NULL) {
+    __free_nodes(tree, NULL);
+    __free_nodes(other, NULL);
+    return NULL;
+  }
+
+  struct node* less;
+  struct node* greater;
+  struct node* same = __split(other, tree->key, balance, &less, &greater);
+
+  set_task_t left = { NULL, tree->left, less, balance, fork_fn, NULL };
+  set_task_t right = { NULL, tree->right, greater, balance, fork_fn, NULL };
+  __set_halves(__intersection, &left, &right);
+
+  if (same != NULL) {
+    FREE(same);
+    return __join(left.result, tree, right.result, balance);
+  }
+
+  FREE(tree);
+  return __join2(left.result, right.result, balance);
+}
+
+static struct node*
+__difference(struct node* tree, struct node* other, balance_et balance, fork_FN fork_fn)
+{
+  if (tree == NULL || other == NULL) {
+    __free_nodes(other, NULL);
+    return tree;
+  }
+
+  struct node* less;
+  struct node* greater;
+  struct node* same = __split(tree, other->key, balance, &less, &greater);
+
+  FREE(same);
+
+  set_task_t left = { NULL, less, other->left, balance, fork_fn, NULL };
+  set_task_t right = { NULL, greater, other->right, balance, fork_fn, NULL };
+  __set_halves(__difference, &left, &right);
+
+  FREE(other);
+  return __join2(left.result, right.result, balance);
+}
+
+static void
+__set(OrdTree_T tree, OrdTree_T* p_other, set_FN set_fn, fork_FN fork_fn)
+{
+  Require(tree);
+  Require(p_other && *p_other);
+  Require(tree->balance == (*p_other)->balance);
+
+  tree->root = set_fn(tree->root, (*p_other)->root, tree->balance, fork_fn);
+
+  (*p_other)->root = NULL;
+  OrdTree_free(p_other);
+}
+
+/* ______________________________________________________________________________ */
+
+OrdTree_T
+OrdTree_new(balance_et balance)
+{
+  OrdTree_T tree;
+  NEW(tree);
+
+  tree->root = NULL;
+  tree->balance = balance;
+
+  return tree;
+}
+
+OrdTree_T
+OrdTree_load(balance_et balance, const int64_t* keys, const Object_T* values, size_t n)
+{
+  Require(keys || n == 0);
+
+  OrdTree_T tree = OrdTree_new(balance);
+  unsigned full = 0;
+
+  /* Levels that are complete. */
+  while (((size_t)2 << full) - 1 <= n) {
+    full++;
+  }
+
+  tree->root = __load(keys, values, n, balance, 0, full);
+
+  return tree;
+}
+
+bool
+OrdTree_put(OrdTree_T tree, int64_t key, Object_T value)
+{
+  Require(tree);
+
+  for (struct node* node = tree->root; node != NULL; ) {
+    if (key == node->key) {
+      node->value = value;
+      return false;
+    }
+
+    node = (key < node->key) ? node->left : node->right;
+  }
+
+  tree->root = __insert(tree->root, __node_new(key, value), tree->balance);
+
+  return true;
+}
+
+bool
+OrdTree_get(OrdTree_T tree, int64_t key, Object_T* p_value__)
+{
+  Require(tree);
+  Require(p_value__);
+
+  for (const struct node* node = tree->root; node != NULL; ) {
+    if (key == node->key) {
+      *p_value__ = node->value;
+      return true;
+    }
+
+    node = (key < node->key) ? node->left : node->right;
+  }
+
+  return false;
+}
+
+bool
+OrdTree_remove(OrdTree_T tree, int64_t key, Object_T* p_value__)
+{
+  Require(tree);
+
+  struct node* removed = NULL;
+  tree->root = __remove(tree->root, key, tree->balance, &removed);
+
+  if (removed == NULL)
+  { return false; }
+
+  if (p_value__ != NULL)
+  { *p_value__ = removed->value; }
+
+  FREE(removed);
+
+  return true;
+}
+
+size_t
+OrdTree_length(OrdTree_T tree)
+{
+  Require(tree);
+  return __size(tree->root);
+}
+
+size_t
+OrdTree_height(OrdTree_T tree)
+{
+  Require(tree);
+
+  if (tree->balance == HEIGHT_BALANCED)
+  { return __rank(tree->root); }
+
+  return __height(tree->root);
+}
+
+size_t
+OrdTree_rank(OrdTree_T tree, int64_t key)
+{
+  Require(tree);
+
+  size_t rank = 0;
+
+  for (const struct node* node = tree->root; node != NULL; ) {
+    if (key <= node->key) {
+      node = node->left;
+
+    } else {
+      rank += __size(node->left) + 1;
+      node = node->right;
+    }
+  }
+
+  return rank;
+}
+
+bool
+OrdTree_select(OrdTree_T tree, size_t index, int64_t* p_key__, Object_T* p_value__)
+{
+  Require(tree);
+
+  const struct node* node = tree->root;
+
+  if (index >= __size(node))
+  { return false; }
+
+  for (;;) {
+    const size_t left = __size(node->left);
+
+    if (index == left)
+    { break; }
+
+    if (index < left) {
+      node = node->left;
+
+    } else {
+      index -= left + 1;
+      node = node->right;
+    }
+  }
+
+  if (p_key__ != NULL)
+  { *p_key__ = node->key; }
+
+  if (p_value__ != NULL)
+  { *p_value__ = node->value; }
+
+  return true;
+}
+
+size_t
+OrdTree_count(OrdTree_T tree, int64_t low, int64_t high)
+{
+  Require(tree);
+
+  if (low > high)
+  { return 0; }
+
+  /* Keys up to `high`, without overflow of `high + 1`. */
+  size_t upto = 0;
+
+  for (const struct node* node = tree->root; node != NULL; ) {
+    if (high < node->key) {
+      node = node->left;
+
+    } else {
+      upto += __size(node->left) + 1;
+      node = node->right;
+    }
+  }
+
+  return upto - OrdTree_rank(tree, low);
+}
+
+OrdTree_T
+OrdTree_split(OrdTree_T tree, int64_t key)
+{
+  Require(tree);
+
+  OrdTree_T greater = OrdTree_new(tree->balance);
+  struct node* same = __split(tree->root, key, tree->balance, &tree->root, &greater->root);
+
+  if (same != NULL) {
+    same->left = same->right = NULL;
+    greater->root = __insert(greater->root, same, tree->balance);
+  }
+
+  return greater;
+}
+
+void
+OrdTree_join(OrdTree_T tree, OrdTree_T* p_other)
+{
+  Require(tree);
+  Require(p_other && *p_other);
+  Require(tree->balance == (*p_other)->balance);
+
+  struct node* right = (*p_other)->root;
+
+#if !defined(NDEBUG)
+  if (tree->root != NULL && right != NULL) {
+    const struct node* last = tree->root;
+    const struct node* first = right;
+
+    while (last->right != NULL) { last = last->right; }
+    while (first->left != NULL) { first = first->left; }
+
+    Require(last->key < first->key);
+  }
+#endif
+
+  tree->root = __join2(tree->root, right, tree->balance);
+
+  (*p_other)->root = NULL;
+  OrdTree_free(p_other);
+}
+
+void
+OrdTree_union(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn)
+{
+  __set(tree, p_other, __union, fork_fn);
+}
+
+void
+OrdTree_intersection(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn)
+{
+  __set(tree, p_other, __intersection, fork_fn);
+}
+
+void
+OrdTree_difference(OrdTree_T tree, OrdTree_T* p_other, fork_FN fork_fn)
+{
+  __set(tree, p_other, __difference, fork_fn);
+}
+
+void
+OrdTree_destroy(OrdTree_T* p_tree, free_data_FN free_data_fn)
+{
+  Require(p_tree);
+
+  if (*p_tree == NULL)
+  { return; }
+
+  __free_nodes((*p_tree)->root, free_data_fn);
+  FREE(*p_tree);
+}
+
+void
+OrdTree_free(OrdTree_T* p_tree)
+{
+  OrdTree_destroy(p_tree, NULL);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file     queue-ring.c
+ * @brief    Queue in a ring buffer.
+ *
+ * Compiled instead of `queue.c` when `QUEUE_RING_MODE` is defined
+ * (`--enable-ring-queue`). Elements are kept in a power of two array;
+ * `head` and `tail` only grow and are masked to index it. Nothing is
+ * allocated per element, the array doubles when it is full.
+ *
+ * For a queue shared by threads see `mpmc_queue.h`.
+ */
+#include "data_structs/queue.h"
+
+#if defined(QUEUE_RING_MODE)
+
+#include <string.h>      /* memcpy */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+#define INITIAL_CAPACITY  16
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct queue {
+  Object_T* items;
+  size_t capacity;        /* Power of two. */
+  size_t head;            /* Next to remove. */
+  size_t tail;            /* Next to add.    */
+};
+
+#define SLOT(p_queue, idx)  ((p_queue)->items[(idx) & ((p_queue)->capacity - 1)])
+
+/* Elements are copied in order to the start of the new array. */
+static void
+__grow(Queue_T queue)
+{
+  const size_t length = queue->tail - queue->head;
+  const size_t first = queue->head & (queue->capacity - 1);
+  const size_t until_end = queue->capacity - first;
+
+  Object_T* items = ALLOC(2 * queue->capacity * sizeof (Object_T));
+
+  if (length <= until_end) {
+    memcpy(items, &queue->items[first], length * sizeof (Object_T));
+  } else {
+    memcpy(items, &queue->items[first], until_end * sizeof (Object_T));
+    memcpy(&items[until_end], queue->items, (length - until_end) * sizeof (Object_T));
+  }
+
+  FREE(queue->items);
+
+  queue->items = items;
+  queue->capacity *= 2;
+  queue->head = 0;
+  queue->tail = length;
+}
+
+/* ______________________________________________________________________________ */
+
+Queue_T
+Queue_new(void)
+{
+  Queue_T queue;
+  NEW(queue);
+
+  queue->items = ALLOC(INITIAL_CAPACITY * sizeof (Object_T));
+  queue->capacity = INITIAL_CAPACITY;
+  queue->head = 0;
+  queue->tail = 0;
+
+  return queue;
+}
+
+bool
+Queue_is_empty(Queue_T queue)
+{
+  Require(queue);
+  return queue->head == queue->tail;
+}
+
+void
+Queue_add(Queue_T queue, Object_T data)
+{
+  Require(queue);
+
+  if (queue->tail - queue->head == queue->capacity)
+  { __grow(queue); }
+
+  SLOT(queue, queue->tail++) = data;
+}
+
+bool
+Queue_remove(Queue_T queue, Object_T* p_data)
+{
+  Require(queue);
+
+  if (Queue_is_empty(queue))
+  { return false; }
+
+  *p_data = SLOT(queue, queue->head++);
+  return true;
+}
+
+size_t
+Queue_length(Queue_T queue)
+{
+  Require(queue);
+  return queue->tail - queue->head;
+}
+
+void
+Queue_destroy(Queue_T queue, free_data_FN free_data_fn)
+{
+  Require(queue);
+
+  Object_T stale_out;
+  while (Queue_remove(queue, &stale_out)) {
+    if (free_data_fn == NULL) {
+      FREE(stale_out);
+
+    } else {
+      free_data_fn(stale_out);
+    }
+  }
+
+  FREE(queue->items);
+  FREE(queue);
+}
+
+void
+Queue_free(Queue_T queue)
+{
+  Queue_destroy(queue, NULL);
+}
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* QUEUE_RING_MODE */
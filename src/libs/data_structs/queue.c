@@ -1,5 +1,8 @@
 #include "data_structs/queue.h"
 
+/* See `queue-ring.c` */
+#if !defined(QUEUE_RING_MODE)
+
 #include "lang/assert.h"
 #include "lang/memory.h"
 
@@ -127,10 +130,6 @@ Queue_destroy(Queue_T queue, free_data_FN free_data_fn)
 {
   Require(queue);
 
-  if (Queue_is_empty(queue)) {
-    return;
-  }
-
   Object_T stale_out;
   while (Queue_remove(queue, &stale_out)) {
     if (free_data_fn == NULL) {
@@ -150,3 +149,7 @@ Queue_free(Queue_T queue)
 {
   Queue_destroy(queue, NULL);
 }
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* QUEUE_RING_MODE */
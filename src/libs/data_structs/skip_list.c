@@ -0,0 +1,396 @@
+/**
+ * @file     skip_list.c
+ * @brief    Lock-free skip list, after Fraser, "Practical lock-freedom" (2004)
+ *           and Herlihy and Shavit, "The Art of Multiprocessor Programming".
+ *
+ * Lowest bit of a next pointer marks its node as removed on that level.
+ * Remove marks the levels top down, the one that marks level 0 removes the
+ * key. Searches unlink marked nodes they pass with compare and swap and
+ * start again if the predecessor changed meanwhile.
+ *
+ * Put links level 0 first, that adds the key, and then the levels above. A
+ * node could be removed while it is still linked up; put stops when it sees
+ * a mark. Node is retired by the last of its putter and remover, after a
+ * search for its key that unlinks it from every level.
+ *
+ * Operations read nodes between `Epoch_enter` and `Epoch_leave`, retired
+ * nodes are freed by `Epoch_retire` when no operation could read them.
+ */
+#include "data_structs/skip_list.h"
+
+#include <stdatomic.h>   /* atomic_*            */
+#include <stdint.h>      /* uintptr_t, uint64_t */
+#include "lang/assert.h"
+#include "lang/epoch.h"
+#include "lang/macros.h"
+#include "lang/memory.h"
+
+#define MAX_LEVEL     32
+#define MARK          ((uintptr_t)1)
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct node {
+  int64_t key;
+  _Atomic(Object_T) value;
+  _Atomic unsigned owners;     /* Putter and remover. */
+  unsigned height;
+  Epoch_Link retired;
+  _Atomic uintptr_t next[];
+};
+
+struct skip_list {
+  struct node* head;           /* Tower of `MAX_LEVEL`, its key is not used. */
+  _Atomic size_t length;
+};
+
+/* Tower heights, per thread. */
+static _Thread_local uint64_t seed;
+
+static void
+__node_free(Epoch_Link* link)
+{
+  struct node* node = CONTAINER_OF(link, struct node, retired);
+  FREE(node);
+}
+
+/* Putter and remover are done with `node`, the last one retires it. */
+static void
+__release(struct node* node)
+{
+  if (atomic_fetch_sub(&node->owners, 1) == 1)
+  { Epoch_retire(&node->retired, __node_free); }
+}
+
+/* Level `i` with probability 2^-i. */
+static unsigned
+__height(void)
+{
+  uint64_t x = seed;
+
+  if (x == 0)
+  { x = ((uint64_t)(uintptr_t)&seed * 0x9E3779B97F4A7C15ULL) | 1; }
+
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  seed = x;
+
+  x *= 0x2545F4914F6CDD1DULL;
+
+  return 1 + (unsigned)__builtin_ctzll(x | (1ULL << (MAX_LEVEL - 1)));
+}
+
+static struct node*
+__node_new(int64_t key, Object_T value, unsigned height)
+{
+  struct node* node = ALLOC(sizeof (struct node) + height * sizeof (_Atomic uintptr_t));
+
+  node->key = key;
+  atomic_init(&node->value, value);
+  atomic_init(&node->owners, 2);
+  node->height = height;
+
+  for (unsigned i = 0; i < height; ++i) {
+    atomic_init(&node->next[i], 0);
+  }
+
+  return node;
+}
+
+static inline struct node*
+__ptr(uintptr_t link)
+{
+  return (struct node*)(link & ~MARK);
+}
+
+static inline bool
+__is_marked(uintptr_t link)
+{
+  return (link & MARK) != 0;
+}
+
+/*
+ * Set `preds__[i]` to the last node before `key` on level `i` and
+ * `succs__[i]` to the next one, unlinking marked nodes on the way. Return
+ * `true` if `succs__[0]` has the key.
+ */
+static bool
+__find(SkipList_T list, int64_t key, struct node** preds__, struct node** succs__)
+{
+  for (;;) {
+    struct node* pred = list->head;
+    bool again = false;
+
+    for (int level = MAX_LEVEL - 1; level >= 0 && !again; --level) {
+      struct node* curr = __ptr(atomic_load(&pred->next[level]));
+
+      while (curr != NULL) {
+        uintptr_t succ = atomic_load(&curr->next[level]);
+
+        if (__is_marked(succ)) {
+          uintptr_t expected = (uintptr_t)curr;
+
+          if (!atomic_compare_exchange_strong(&pred->next[level], &expected, succ & ~MARK)) {
+            again = true;
+            break;
+          }
+
+          curr = __ptr(succ);
+          continue;
+        }
+
+        if (curr->key >= key)
+        { break; }
+
+        pred = curr;
+        curr = __ptr(succ);
+      }
+
+      preds__[level] = pred;
+      succs__[level] = curr;
+    }
+
+    if (!again)
+    { return succs__[0] != NULL && succs__[0]->key == key; }
+  }
+}
+
+/* Last node before `key` on level 0, marked nodes are passed. */
+static struct node*
+__before(SkipList_T list, int64_t key)
+{
+  struct node* pred = list->head;
+
+  for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+    struct node* curr = __ptr(atomic_load_explicit(&pred->next[level], memory_order_acquire));
+
+    while (curr != NULL && curr->key < key) {
+      pred = curr;
+      curr = __ptr(atomic_load_explicit(&curr->next[level], memory_order_acquire));
+    }
+  }
+
+  return pred;
+}
+
+/* Link levels above 0 until done or `node` is removed. */
+static void
+__link_up(SkipList_T list, struct node* node, struct node** preds, struct node** succs)
+{
+  for (unsigned level = 1; level < node->height; ++level) {
+    for (;;) {
+      uintptr_t link = atomic_load(&node->next[level]);
+
+      if (__is_marked(link))
+      { return; }
+
+      /* Fails only if it got marked. */
+      if (__ptr(link) != succs[level]
+          && !atomic_compare_exchange_strong(&node->next[level], &link, (uintptr_t)succs[level]))
+      { return; }
+
+      uintptr_t expected = (uintptr_t)succs[level];
+
+      if (atomic_compare_exchange_strong(&preds[level]->next[level], &expected, (uintptr_t)node))
+      { break; }
+
+      if (!__find(list, node->key, preds, succs) || succs[0] != node)
+      { return; }
+    }
+  }
+}
+
+/* ______________________________________________________________________________ */
+
+SkipList_T
+SkipList_new(void)
+{
+  SkipList_T list;
+  NEW(list);
+
+  list->head = __node_new(0, NULL, MAX_LEVEL);
+  atomic_init(&list->length, 0);
+
+  return list;
+}
+
+bool
+SkipList_put(SkipList_T list, int64_t key, Object_T value)
+{
+  Require(list);
+
+  struct node* preds[MAX_LEVEL];
+  struct node* succs[MAX_LEVEL];
+  struct node* node = NULL;
+  Epoch_enter();
+
+  for (;;) {
+    if (__find(list, key, preds, succs)) {
+      atomic_store(&succs[0]->value, value);
+      Epoch_leave();
+
+      /* Never published. */
+      FREE(node);
+      return false;
+    }
+
+    if (node == NULL)
+    { node = __node_new(key, value, __height()); }
+
+    for (unsigned level = 0; level < node->height; ++level) {
+      atomic_store_explicit(&node->next[level], (uintptr_t)succs[level], memory_order_relaxed);
+    }
+
+    uintptr_t expected = (uintptr_t)succs[0];
+
+    if (atomic_compare_exchange_strong(&preds[0]->next[0], &expected, (uintptr_t)node))
+    { break; }
+  }
+
+  atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+  __link_up(list, node, preds, succs);
+
+  /* Removed while linking, it could be linked on levels the remover did not see. */
+  if (__is_marked(atomic_load(&node->next[0])))
+  { __find(list, key, preds, succs); }
+
+  __release(node);
+  Epoch_leave();
+
+  return true;
+}
+
+bool
+SkipList_get(SkipList_T list, int64_t key, Object_T* p_value__)
+{
+  Require(list);
+  Require(p_value__);
+
+  Epoch_enter();
+  const struct node* pred = __before(list, key);
+  struct node* node = __ptr(atomic_load_explicit(&pred->next[0], memory_order_acquire));
+  bool found = false;
+
+  if (node != NULL && node->key == key && !__is_marked(atomic_load(&node->next[0]))) {
+    *p_value__ = atomic_load_explicit(&node->value, memory_order_acquire);
+    found = true;
+  }
+
+  Epoch_leave();
+  return found;
+}
+
+bool
+SkipList_remove(SkipList_T list, int64_t key, Object_T* p_value__)
+{
+  Require(list);
+
+  struct node* preds[MAX_LEVEL];
+  struct node* succs[MAX_LEVEL];
+  Epoch_enter();
+
+  for (;;) {
+    if (!__find(list, key, preds, succs)) {
+      Epoch_leave();
+      return false;
+    }
+
+    struct node* node = succs[0];
+
+    for (unsigned level = node->height - 1; level > 0; --level) {
+      uintptr_t link = atomic_load(&node->next[level]);
+
+      while (!__is_marked(link)) {
+        atomic_compare_exchange_weak(&node->next[level], &link, link | MARK);
+      }
+    }
+
+    uintptr_t link = atomic_load(&node->next[0]);
+
+    while (!__is_marked(link)) {
+      if (atomic_compare_exchange_weak(&node->next[0], &link, link | MARK)) {
+        if (p_value__ != NULL)
+        { *p_value__ = atomic_load(&node->value); }
+
+        atomic_fetch_sub_explicit(&list->length, 1, memory_order_relaxed);
+
+        __find(list, key, preds, succs);
+        __release(node);
+        Epoch_leave();
+
+        return true;
+      }
+    }
+
+    /* Other thread removed it first, the key could be put again since. */
+  }
+}
+
+size_t
+SkipList_length(SkipList_T list)
+{
+  Require(list);
+  return atomic_load_explicit(&list->length, memory_order_relaxed);
+}
+
+size_t
+SkipList_range(SkipList_T list, int64_t low, int64_t high, visit_FN visit_fn, void* arg)
+{
+  Require(list);
+  Require(visit_fn);
+
+  Epoch_enter();
+  const struct node* pred = __before(list, low);
+  struct node* node = __ptr(atomic_load_explicit(&pred->next[0], memory_order_acquire));
+  size_t visited = 0;
+
+  while (node != NULL && node->key <= high) {
+    const uintptr_t link = atomic_load_explicit(&node->next[0], memory_order_acquire);
+
+    if (!__is_marked(link)) {
+      visited++;
+
+      if (!visit_fn(node->key, atomic_load(&node->value), arg))
+      { break; }
+    }
+
+    node = __ptr(link);
+  }
+
+  Epoch_leave();
+  return visited;
+}
+
+void
+SkipList_destroy(SkipList_T* p_list, free_data_FN free_data_fn)
+{
+  Require(p_list);
+
+  SkipList_T list = *p_list;
+
+  if (list == NULL)
+  { return; }
+
+  /* Removed nodes are unlinked before remove returns, these are live. */
+  struct node* node = list->head;
+
+  while (node != NULL) {
+    struct node* next = __ptr(atomic_load(&node->next[0]));
+
+    if (node != list->head && free_data_fn != NULL)
+    { free_data_fn(node->value); }
+
+    FREE(node);
+    node = next;
+  }
+
+  FREE(*p_list);
+}
+
+void
+SkipList_free(SkipList_T* p_list)
+{
+  SkipList_destroy(p_list, NULL);
+}
@@ -1,271 +1,532 @@
+/**
+ * @file     sparse_matrix.c
+ * @brief    Sparse matrix in an open addressed hash table.
+ *
+ * Row and column are packed in one 64 bit key. Slots hold key and value
+ * together, so a lookup reads one cache line in most cases. Collisions are
+ * resolved with linear probing and removed elements are filled by shifting
+ * the following ones back, so there are no tombstones. The table doubles
+ * when it is three quarters full.
+ *
+ * Compressed form is built with two counting sorts: by the minor index and
+ * then, stable, by the major one. The first copies keys and values out of
+ * the table, so the table is read in order.
+ */
 #include "data_structs/sparse_matrix.h"
 
+#include <stdint.h>      /* uint64_t, UINT64_MAX */
 #include "lang/memory.h"
 #include "lang/assert.h"
-#include "lang/except.h"
 #include "logger/log.h"
 
-struct matrix_node {
-  int row, column;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define X86_KERNELS
+#  include <immintrin.h>
+#  define TARGET_AVX2_FMA  __attribute__((target("avx2,fma")))
+#endif
+
+#define INITIAL_CAPACITY  16
+
+/* Rows and columns are not negative, so the highest bit is never set. */
+#define EMPTY             UINT64_MAX
+
+#define KEY(row, col)     (((uint64_t)(uint32_t)(row) << 32) | (uint32_t)(col))
+#define KEY_ROW(key)      ((int)((key) >> 32))
+#define KEY_COL(key)      ((int)((key) & 0xFFFFFFFFu))
+
+struct slot {
+  uint64_t key;
   Object_T datapointer;
-  Matrix_T nextrow, prevrow;
-  Matrix_T nextcol, prevcol;
 };
 
-#define ROW(p_matrix)     ((p_matrix)->row)
-#define NEXTROW(p_matrix) ((p_matrix)->nextrow)
-#define PREVROW(p_matrix) ((p_matrix)->prevrow)
+struct matrix {
+  struct slot* slots;
+  size_t capacity;        /* Power of two. */
+  unsigned shift;         /* 64 - log2(capacity) */
+  size_t length;
+};
 
-#define DATA(p_matrix)    ((p_matrix)->datapointer)
+struct compressed_matrix {
+  compressed_order_et order;
+  size_t rows;
+  size_t cols;
+  size_t nonzeros;
 
-#define COL(p_matrix)     ((p_matrix)->column)
-#define NEXTCOL(p_matrix) ((p_matrix)->nextcol)
-#define PREVCOL(p_matrix) ((p_matrix)->prevcol)
+  size_t* offsets;        /* Per row or column, plus one. */
+  int* indexes;
+  double* values;
+};
 
 /* ______________________________________________________________________________ */
 /*                                                                         Local  */
 
-typedef enum { CREATE_HEADER, FIND_HEADER } oper_type_et;
+/* Element on its way to the compressed form. */
+struct entry {
+  uint64_t key;
+  double value;
+};
 
-static void
-__allocate_matrix_node(Matrix_T* p_matrix, int row, int col, Object_T data)
+/* Fibonacci hashing, high bits of the product are the best mixed. */
+static inline size_t
+__home(const struct matrix* matrix, uint64_t key)
 {
-  Matrix_T matrix;
-  NEW(matrix);
+  return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> matrix->shift);
+}
 
-  *p_matrix = matrix;
+static struct slot*
+__allocate_slots(size_t capacity)
+{
+  struct slot* slots = ALLOC(capacity * sizeof (struct slot));
 
-  ROW(matrix) = row;
-  COL(matrix) = col;
-  DATA(matrix) = data;
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].key = EMPTY;
+  }
 
-  NEXTROW(matrix) = NULL;
-  PREVROW(matrix) = NULL;
-  NEXTCOL(matrix) = NULL;
-  PREVCOL(matrix) = NULL;
+  return slots;
 }
 
 static void
-__free_matrix_node(mnode_t** pp_mnode)
+__rehash(struct matrix* matrix, size_t capacity)
 {
-  FREE(pp_mnode);
-}
+  struct slot* old_slots = matrix->slots;
+  const size_t old_capacity = matrix->capacity;
 
-/* Find the existing column node <= col. */
-static Matrix_T
-__get_previous_column(Matrix_T* p_matrix_head, int col)
-{
-  mnode_t* p_node;
+  matrix->slots = __allocate_slots(capacity);
+  matrix->capacity = capacity;
+  matrix->shift = 64;
+
+  while (capacity > 1) {
+    matrix->shift--;
+    capacity >>= 1;
+  }
+
+  const size_t mask = matrix->capacity - 1;
+
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_slots[i].key == EMPTY)
+    { continue; }
 
-  for (p_node = *p_matrix_head; COL(p_node) <= col && NEXTCOL(p_node) != NULL; )
-  { p_node = NEXTCOL(p_node); }
+    size_t j = __home(matrix, old_slots[i].key);
 
-  return (COL(p_node) > col) ? PREVCOL(p_node) : p_node;
+    while (matrix->slots[j].key != EMPTY) {
+      j = (j + 1) & mask;
+    }
+
+    matrix->slots[j] = old_slots[i];
+  }
+
+  FREE(old_slots);
 }
 
-static Matrix_T
-__get_previous_row(Matrix_T* p_matrix_head, int row)
+/* Index of the slot with `key` or of the empty slot where it should be. */
+static size_t
+__find(const struct matrix* matrix, uint64_t key)
 {
-  mnode_t* p_node;
+  const size_t mask = matrix->capacity - 1;
+  size_t i = __home(matrix, key);
 
-  for (p_node = *p_matrix_head; ROW(p_node) <= row && NEXTROW(p_node) != NULL; )
-  { p_node = NEXTROW(p_node); }
+  while (matrix->slots[i].key != key && matrix->slots[i].key != EMPTY) {
+    i = (i + 1) & mask;
+  }
 
-  return (ROW(p_node) > row) ? PREVROW(p_node) : p_node;
+  return i;
 }
 
-/*
- * Find a specific column header node. If it doesn't exist, optionally create it
- * depending on `header_oper`. If `header_oper` is FIND_HEADER, return
- * FALSE if it doesn't exist. If `header_oper` is CREATE_HEADER, create the
- * header, add it to the linked list of headers, and return that new node.
- */
-static bool
-__find_col_head(oper_type_et header_oper, Matrix_T* p_matrix, int col, mnode_t** pp_headernode__)
+/* Keeps the load under 3/4. */
+static size_t
+__capacity_for(size_t nonzeros)
 {
-  Matrix_T header;
-  header = __get_previous_column(p_matrix, col);
-
-  if (COL(header) == col) {
-    *pp_headernode__ = header;
-    return true;
+  size_t capacity = INITIAL_CAPACITY;
 
-  } else if (header_oper == FIND_HEADER) {
-    *pp_headernode__ = NULL;
-    return false;
+  while (capacity - capacity / 4 < nonzeros) {
+    capacity *= 2;
+  }
 
-  } else { /* Create header. */
-    Matrix_T newhead;
-    __allocate_matrix_node(&newhead, -1, col, NULL);
+  return capacity;
+}
 
-    NEXTCOL(newhead) = NEXTCOL(header);
+typedef double (*dot_FN)(const double* values, const int* indexes, size_t n, const double* x);
 
-    if (NEXTCOL(header) != NULL) {
-      PREVCOL(NEXTCOL(header)) = newhead;
-    }
+/* Four sums, lane `i` adds elements `k % 4 == i`, the same in both versions. */
+static double
+__dot_scalar(const double* values, const int* indexes, size_t n, const double* x)
+{
+  double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t k = 0;
+
+  for (; k + 4 <= n; k += 4) {
+    s0 += values[k] * x[indexes[k]];
+    s1 += values[k + 1] * x[indexes[k + 1]];
+    s2 += values[k + 2] * x[indexes[k + 2]];
+    s3 += values[k + 3] * x[indexes[k + 3]];
+  }
 
-    PREVCOL(newhead) = header;
-    NEXTCOL(header) = newhead;
-    *pp_headernode__ = newhead;
+  double total = (s0 + s1) + (s2 + s3);
 
-    return true;
+  for (; k < n; ++k) {
+    total += values[k] * x[indexes[k]];
   }
 
-  /* Just in case. */
-  return false;
+  return total;
 }
 
-/*
- * Find a specific row header node. If it doesn't exist, optionally create it
- * depending on `header_oper`. If `header_oper` is FIND_HEADER, return ERROR if
- * it doesn't exist. If `header_oper` is CREATE_HEADER, create the header, add
- * it to the linked list of headers, and return that new node.
- */
-static bool
-__find_row_head(oper_type_et header_oper, Matrix_T* p_matrix, int row, mnode_t** pp_headernode__)
+#if defined(X86_KERNELS)
+/* Products are not rounded before they are added, last bits could differ. */
+TARGET_AVX2_FMA static double
+__dot_avx2(const double* values, const int* indexes, size_t n, const double* x)
 {
-  Matrix_T header;
-  header = __get_previous_row(p_matrix, row);
+  __m256d sum = _mm256_setzero_pd();
+  size_t k = 0;
 
-  if (ROW(header) == row) {
-    *pp_headernode__ = header;
-    return true;
+  for (; k + 4 <= n; k += 4) {
+    const __m128i idx = _mm_loadu_si128((const __m128i*)&indexes[k]);
+    const __m256d xs = _mm256_i32gather_pd(x, idx, 8);
+    const __m256d vs = _mm256_loadu_pd(&values[k]);
 
-  } else if (header_oper == FIND_HEADER) {
-    *pp_headernode__ = NULL;
-    return ERROR;
-
-  } else { /* Create header. */
-    Matrix_T newhead;
-    __allocate_matrix_node(&newhead, row, -1, NULL);
+    sum = _mm256_fmadd_pd(vs, xs, sum);
+  }
 
-    NEXTROW(newhead) = NEXTROW(header);
-    if (NEXTROW(header) != NULL)
-    { PREVROW(NEXTROW(header)) = newhead; }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, sum);
 
-    PREVROW(newhead) = header;
-    NEXTROW(header) = newhead;
-    *pp_headernode__ = newhead;
+  double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
 
-    return true;
+  for (; k < n; ++k) {
+    total += values[k] * x[indexes[k]];
   }
 
-  return false;
+  return total;
 }
+#endif
 
-/* ______________________________________________________________________________ */
-
-Matrix_T
-Matrix_new()
+/* Library is built for any x86 processor, the version is picked at run time. */
+static dot_FN
+__dot(void)
 {
-  Matrix_T new_matrix;
-  __allocate_matrix_node(&new_matrix, -1, -1, NULL);
+#if defined(X86_KERNELS)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  { return __dot_avx2; }
+#endif
 
-  return new_matrix;
+  return __dot_scalar;
 }
 
-void
-Matrix_put(Matrix_T* p_matrix, int row, int col, Object_T value)
-{
-  Require(row >= 0);
-  Require(col >= 0);
+/* ______________________________________________________________________________ */
 
-  Matrix_T colheader, rowheader;
-  Matrix_T colprev, rowprev;
-  Matrix_T newnode;
+Matrix_T
+Matrix_new(void)
+{
+  Matrix_T matrix;
+  NEW(matrix);
 
-  __allocate_matrix_node(&newnode, row, col, value);
+  matrix->slots = NULL;
+  matrix->capacity = 0;
+  matrix->length = 0;
 
-  // *INDENT-OFF*
   TRY
-    __find_col_head(CREATE_HEADER, p_matrix, col, &colheader);
-    __find_row_head(CREATE_HEADER, p_matrix, row, &rowheader);
+    __rehash(matrix, INITIAL_CAPACITY);
 
   CATCH(Memory_Failed)
-    Log_error("Memory allocation failed. Can't put matrix node.");
-    __free_matrix_node(&newnode);
+    Log_error("Memory allocation failed. Can't create matrix.");
+    FREE(matrix);
     RETHROW;
 
   END_TRY;
-  // *INDENT-OFF*
 
-  /*Insert in column list. */
-  colprev = __get_previous_column(&rowheader, col);
+  return matrix;
+}
 
-  if (COL(colprev) == col) {
-     DATA(colprev) = value;
-     __free_matrix_node(&newnode);
+void
+Matrix_reserve(Matrix_T* p_matrix, size_t nonzeros)
+{
+  Require(p_matrix && *p_matrix);
 
-     return;
-  }
+  const size_t capacity = __capacity_for(nonzeros);
 
-  NEXTCOL(newnode) = NEXTCOL(colprev);
-  if (NEXTCOL(newnode) != NULL) {
-    PREVCOL(NEXTCOL(newnode)) = newnode;
-  }
-  PREVCOL(newnode) = colprev;
-  NEXTCOL(colprev) = newnode;
+  if (capacity > (*p_matrix)->capacity)
+  { __rehash(*p_matrix, capacity); }
+}
 
-  /* Insert in row list. */
-  rowprev = __get_previous_row(&colheader, row);
+void
+Matrix_put(Matrix_T* p_matrix, int row, int col, Object_T value)
+{
+  Require(p_matrix && *p_matrix);
+  Require(row >= 0);
+  Require(col >= 0);
+
+  Matrix_T matrix = *p_matrix;
+  const uint64_t key = KEY(row, col);
+  size_t i = __find(matrix, key);
 
-  NEXTROW(newnode) = NEXTROW(rowprev);
-  if (NEXTROW(newnode) != NULL) {
-    PREVROW(NEXTROW(newnode)) = newnode;
+  if (matrix->slots[i].key == key) {
+    matrix->slots[i].datapointer = value;
+    return;
   }
 
-  PREVROW(newnode) = rowprev;
-  NEXTROW(rowprev) = newnode;
+  if (matrix->length + 1 > matrix->capacity - matrix->capacity / 4) {
+    __rehash(matrix, 2 * matrix->capacity);
+    i = __find(matrix, key);
+  }
+
+  matrix->slots[i].key = key;
+  matrix->slots[i].datapointer = value;
+  matrix->length++;
 }
 
 bool
 Matrix_get(Matrix_T* p_matrix, int row, int col, Object_T* p_value__)
 {
+  Require(p_matrix && *p_matrix);
   Require(row >= 0);
   Require(col >= 0);
 
-  Matrix_T colheader;
-  Matrix_T rowprev;
-
-  if (!__find_col_head(FIND_HEADER, p_matrix, col, &colheader)) {
-    return false;
-  }
-
-  rowprev = __get_previous_row(&colheader, row);
+  const uint64_t key = KEY(row, col);
+  const struct slot* p_slot = &(*p_matrix)->slots[__find(*p_matrix, key)];
 
-  if (ROW(rowprev) != row)
-    return false;
+  if (p_slot->key != key)
+  { return false; }
 
-  *p_value__ = DATA(rowprev);
+  *p_value__ = p_slot->datapointer;
   return true;
 }
 
+/* Following elements that may use the slot are moved back. */
 bool
 Matrix_clear(Matrix_T* p_matrix, int row, int col)
 {
+  Require(p_matrix && *p_matrix);
   Require(row >= 0);
   Require(col >= 0);
 
-  mnode_t* element;
-  mnode_t* colheader;
+  Matrix_T matrix = *p_matrix;
+  const size_t mask = matrix->capacity - 1;
+  const uint64_t key = KEY(row, col);
+  size_t hole = __find(matrix, key);
 
-  if (!__find_col_head(FIND_HEADER, p_matrix, col, &colheader)) {
-    return false;
-  }
+  if (matrix->slots[hole].key != key)
+  { return false; }
 
-  element = __get_previous_row(&colheader, row);
-  if (ROW(element) != row)
-    return false;
+  for (size_t i = (hole + 1) & mask; matrix->slots[i].key != EMPTY; i = (i + 1) & mask) {
+    const size_t home = __home(matrix, matrix->slots[i].key);
 
-  NEXTROW(PREVROW(element)) = NEXTROW(element);
-  if (NEXTROW(element) == NULL)
-    PREVROW(NEXTROW(element)) = PREVROW(element);
+    /* Stays if its home is after the hole, up to `i` cyclically. */
+    const bool stays = (hole < i) ? (home > hole && home <= i)
+                                  : (home > hole || home <= i);
 
-  NEXTCOL(PREVCOL(element)) = NEXTCOL(element);
-  if (NEXTCOL(element) != NULL)
-    PREVCOL(NEXTCOL(element)) = PREVCOL(element);
+    if (!stays) {
+      matrix->slots[hole] = matrix->slots[i];
+      hole = i;
+    }
+  }
 
-  __free_matrix_node(&element);
+  matrix->slots[hole].key = EMPTY;
+  matrix->length--;
 
   return true;
 }
+
+size_t
+Matrix_length(Matrix_T matrix)
+{
+  Require(matrix);
+  return matrix->length;
+}
+
+CompressedMatrix_T
+Matrix_compress(Matrix_T matrix, compressed_order_et order, to_double_FN to_double_fn)
+{
+  Require(matrix);
+  Require(to_double_fn);
+
+  const struct slot* slots = matrix->slots;
+  const bool by_rows = (order == BY_ROWS);
+  const size_t n = matrix->length;
+
+  CompressedMatrix_T compressed;
+  NEW(compressed);
+
+  compressed->order = order;
+  compressed->nonzeros = n;
+  compressed->rows = compressed->cols = 0;
+
+  for (size_t i = 0; i < matrix->capacity; ++i) {
+    if (slots[i].key == EMPTY)
+    { continue; }
+
+    if ((size_t)KEY_ROW(slots[i].key) + 1 > compressed->rows)
+    { compressed->rows = (size_t)KEY_ROW(slots[i].key) + 1; }
+
+    if ((size_t)KEY_COL(slots[i].key) + 1 > compressed->cols)
+    { compressed->cols = (size_t)KEY_COL(slots[i].key) + 1; }
+  }
+
+  const size_t lines = by_rows ? compressed->rows : compressed->cols;
+  const size_t others = by_rows ? compressed->cols : compressed->rows;
+
+  compressed->offsets = CALLOC(lines + 1, sizeof (size_t));
+  compressed->indexes = ALLOC((n > 0 ? n : 1) * sizeof (int));
+  compressed->values = ALLOC((n > 0 ? n : 1) * sizeof (double));
+
+  size_t* cursor = CALLOC(others + 1, sizeof (size_t));
+  struct entry* by_minor = ALLOC((n > 0 ? n : 1) * sizeof (struct entry));
+
+  for (size_t i = 0; i < matrix->capacity; ++i) {
+    if (slots[i].key == EMPTY)
+    { continue; }
+
+    const int major = by_rows ? KEY_ROW(slots[i].key) : KEY_COL(slots[i].key);
+    const int minor = by_rows ? KEY_COL(slots[i].key) : KEY_ROW(slots[i].key);
+
+    compressed->offsets[major + 1]++;
+    cursor[minor + 1]++;
+  }
+
+  for (size_t i = 0; i < lines; ++i) {
+    compressed->offsets[i + 1] += compressed->offsets[i];
+  }
+
+  for (size_t i = 0; i < others; ++i) {
+    cursor[i + 1] += cursor[i];
+  }
+
+  /* Elements ordered by the minor index, slots are read once in order. */
+  for (size_t i = 0; i < matrix->capacity; ++i) {
+    if (slots[i].key == EMPTY)
+    { continue; }
+
+    const int minor = by_rows ? KEY_COL(slots[i].key) : KEY_ROW(slots[i].key);
+    struct entry* p_entry = &by_minor[cursor[minor]++];
+
+    p_entry->key = slots[i].key;
+    p_entry->value = to_double_fn(slots[i].datapointer);
+  }
+
+  FREE(cursor);
+  cursor = ALLOC((lines > 0 ? lines : 1) * sizeof (size_t));
+
+  for (size_t i = 0; i < lines; ++i) {
+    cursor[i] = compressed->offsets[i];
+  }
+
+  /* In this order to their rows (columns). */
+  for (size_t k = 0; k < n; ++k) {
+    const uint64_t key = by_minor[k].key;
+
+    const int major = by_rows ? KEY_ROW(key) : KEY_COL(key);
+    const size_t at = cursor[major]++;
+
+    compressed->indexes[at] = by_rows ? KEY_COL(key) : KEY_ROW(key);
+    compressed->values[at] = by_minor[k].value;
+  }
+
+  FREE(by_minor);
+  FREE(cursor);
+
+  return compressed;
+}
+
+void
+Matrix_destroy(Matrix_T* p_matrix, free_data_FN free_data_fn)
+{
+  Require(p_matrix);
+
+  Matrix_T matrix = *p_matrix;
+
+  if (matrix == NULL)
+  { return; }
+
+  if (free_data_fn != NULL) {
+    for (size_t i = 0; i < matrix->capacity; ++i) {
+      if (matrix->slots[i].key != EMPTY)
+      { free_data_fn(matrix->slots[i].datapointer); }
+    }
+  }
+
+  FREE(matrix->slots);
+  FREE(*p_matrix);
+}
+
+void
+Matrix_free(Matrix_T* p_matrix)
+{
+  Matrix_destroy(p_matrix, NULL);
+}
+
+/* ______________________________________________________________________________ */
+/*                                                             Compressed matrix  */
+
+void
+CompressedMatrix_size(CompressedMatrix_T matrix, size_t* p_rows__, size_t* p_cols__,
+                      size_t* p_nonzeros__)
+{
+  Require(matrix);
+
+  *p_rows__ = matrix->rows;
+  *p_cols__ = matrix->cols;
+  *p_nonzeros__ = matrix->nonzeros;
+}
+
+size_t
+CompressedMatrix_line(CompressedMatrix_T matrix, size_t idx, const int** pp_indexes__,
+                      const double** pp_values__)
+{
+  Require(matrix);
+  Require(idx < ((matrix->order == BY_ROWS) ? matrix->rows : matrix->cols));
+
+  const size_t first = matrix->offsets[idx];
+
+  *pp_indexes__ = &matrix->indexes[first];
+  *pp_values__ = &matrix->values[first];
+
+  return matrix->offsets[idx + 1] - first;
+}
+
+void
+CompressedMatrix_multiply(CompressedMatrix_T matrix, const double* x, double* y__)
+{
+  Require(matrix);
+  Require(x || matrix->cols == 0);
+  Require(y__ || matrix->rows == 0);
+
+  const size_t* offsets = matrix->offsets;
+
+  if (matrix->order == BY_ROWS) {
+    const dot_FN dot_fn = __dot();
+
+    for (size_t row = 0; row < matrix->rows; ++row) {
+      y__[row] = dot_fn(&matrix->values[offsets[row]], &matrix->indexes[offsets[row]],
+                        offsets[row + 1] - offsets[row], x);
+    }
+
+    return;
+  }
+
+  /* Columns are scattered into `y__`. */
+  for (size_t row = 0; row < matrix->rows; ++row) {
+    y__[row] = 0.0;
+  }
+
+  for (size_t col = 0; col < matrix->cols; ++col) {
+    const double x_col = x[col];
+
+    for (size_t k = offsets[col]; k < offsets[col + 1]; ++k) {
+      y__[matrix->indexes[k]] += matrix->values[k] * x_col;
+    }
+  }
+}
+
+void
+CompressedMatrix_free(CompressedMatrix_T* p_matrix)
+{
+  Require(p_matrix);
+
+  if (*p_matrix == NULL)
+  { return; }
+
+  FREE((*p_matrix)->values);
+  FREE((*p_matrix)->indexes);
+  FREE((*p_matrix)->offsets);
+  FREE(*p_matrix);
+}
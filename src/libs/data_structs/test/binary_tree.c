@@ -1,21 +1,232 @@
 #include "data_structs/binary_tree.h"
 
+#include <stdint.h>
 #include <greatest.h>
 #include "test_data.h"
 
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+#define NUMBER(e)   ((size_t)(uintptr_t)(e) - 1)
+
 TEST create_add_delete(void)
 {
   BinTree_T btree = BinTree_new();
   BinTree_make_root(&btree, Test_elm(1), NULL, NULL);
 
+  BinTree_destroy(&btree, free_elm_fn);
+  PASS();
+}
+
+/*
+ *          3
+ *        /   \
+ *       1     5
+ *      / \   / \
+ *     0   2 4   6
+ *                \
+ *                 7
+ */
+static BinTree_T
+__sample(void)
+{
+  BinTree_T leaves[4] = { NULL, NULL, NULL, NULL };
+  BinTree_T seven = NULL;
+  BinTree_T one = NULL, five = NULL, three = NULL;
+
+  BinTree_make_root(&leaves[0], ELEMENT(0), NULL, NULL);
+  BinTree_make_root(&leaves[1], ELEMENT(2), NULL, NULL);
+  BinTree_make_root(&leaves[2], ELEMENT(4), NULL, NULL);
+  BinTree_make_root(&seven, ELEMENT(7), NULL, NULL);
+  BinTree_make_root(&leaves[3], ELEMENT(6), NULL, seven);
+
+  BinTree_make_root(&one, ELEMENT(1), leaves[0], leaves[1]);
+  BinTree_make_root(&five, ELEMENT(5), leaves[2], leaves[3]);
+  BinTree_make_root(&three, ELEMENT(3), one, five);
+
+  return three;
+}
+
+static size_t visited[16];
+static size_t visits;
+
+static bool
+__visit(Object_T data)
+{
+  visited[visits++] = NUMBER(data);
+  return visits < 16;
+}
+
+static bool
+__visit_batch(void* arg, const Object_T* items, size_t n)
+{
+  size_t* p_calls = arg;
+  (*p_calls)++;
+
+  for (size_t i = 0; i < n; ++i) {
+    __visit(items[i]);
+  }
+
+  return true;
+}
+
+/* Checks all orders, one by one and in batches. */
+static bool
+__check_orders(BinTree_T btree)
+{
+  static const size_t expected[4][8] = {
+    { 3, 1, 0, 2, 5, 4, 6, 7 },      /* PRE_ORDER   */
+    { 0, 1, 2, 3, 4, 5, 6, 7 },      /* IN_ORDER    */
+    { 0, 2, 1, 4, 7, 6, 5, 3 },      /* POST_ORDER  */
+    { 3, 1, 5, 0, 2, 4, 6, 7 }       /* LEVEL_ORDER */
+  };
+  static const order_et orders[4] = { PRE_ORDER, IN_ORDER, POST_ORDER, LEVEL_ORDER };
+
+  for (int o = 0; o < 4; ++o) {
+    visits = 0;
+
+    if (!BinTree_traverse(btree, __visit, orders[o]) || visits != 8)
+    { return false; }
+
+    for (size_t i = 0; i < 8; ++i) {
+      if (visited[i] != expected[o][i])
+      { return false; }
+    }
+
+    size_t calls = 0;
+    visits = 0;
+
+    if (!BinTree_traverse_batch(btree, __visit_batch, &calls, orders[o]) || calls != 1)
+    { return false; }
+
+    for (size_t i = 0; i < 8; ++i) {
+      if (visited[i] != expected[o][i])
+      { return false; }
+    }
+  }
+
+  return true;
+}
+
+TEST orders(void)
+{
+  BinTree_T btree = __sample();
+
+  ASSERT_EQ(8, BinTree_size(btree));
+  ASSERT_EQ(3, NUMBER(BinTree_data(btree)));
+  ASSERT_EQ(1, NUMBER(BinTree_data(BinTree_left(btree))));
+  ASSERT_EQ(5, NUMBER(BinTree_data(BinTree_right(btree))));
+  ASSERT(__check_orders(btree));
+
+  /* Empty tree. */
+  BinTree_T empty = BinTree_new();
+  visits = 0;
+  ASSERT(BinTree_traverse(empty, __visit, LEVEL_ORDER));
+  ASSERT_EQ(0, visits);
+  ASSERT_EQ(0, BinTree_size(empty));
+
+  BinTree_free(&btree);
+  ASSERT_EQ(NULL, btree);
+  PASS();
+}
+
+static bool
+__stop_at_three(Object_T data)
+{
+  visited[visits++] = NUMBER(data);
+  return NUMBER(data) != 3;
+}
+
+TEST stop(void)
+{
+  BinTree_T btree = __sample();
+
+  visits = 0;
+  ASSERT_FALSE(BinTree_traverse(btree, __stop_at_three, IN_ORDER));
+  ASSERT_EQ(4, visits);
+
   BinTree_free(&btree);
   PASS();
 }
 
+TEST compact(void)
+{
+  BinTree_T btree = __sample();
+
+  BinTree_compact(&btree);
+  ASSERT_EQ(8, BinTree_size(btree));
+  ASSERT(__check_orders(btree));
+
+  /* Again, and with a new root on top of a compacted tree. */
+  BinTree_compact(&btree);
+  ASSERT(__check_orders(btree));
+
+  BinTree_T bigger = NULL;
+  BinTree_make_root(&bigger, ELEMENT(8), btree, NULL);
+  ASSERT_EQ(9, BinTree_size(bigger));
+
+  BinTree_compact(&bigger);
+  ASSERT(__check_orders(BinTree_left(bigger)));
+
+  BinTree_T top = NULL;
+  BinTree_make_root(&top, ELEMENT(9), NULL, bigger);
+  ASSERT_EQ(10, BinTree_size(top));
+
+  BinTree_free(&top);
+  ASSERT_EQ(NULL, top);
+  PASS();
+}
+
+static size_t counted;
+
+static bool
+__count(Object_T data)
+{
+  (void)data;
+  counted++;
+  return true;
+}
+
+/* Recursion would overflow the stack. */
+TEST degenerate(void)
+{
+  const size_t n = 1000000;
+  BinTree_T chain = NULL;
+
+  for (size_t i = 0; i < n; ++i) {
+    BinTree_T node = NULL;
+
+    if (i % 2 == 0) {
+      BinTree_make_root(&node, ELEMENT(i), chain, NULL);
+    } else {
+      BinTree_make_root(&node, ELEMENT(i), NULL, chain);
+    }
+
+    chain = node;
+  }
+
+  static const order_et orders[4] = { PRE_ORDER, IN_ORDER, POST_ORDER, LEVEL_ORDER };
+
+  for (int o = 0; o < 4; ++o) {
+    counted = 0;
+    ASSERT(BinTree_traverse(chain, __count, orders[o]));
+    ASSERT_EQ(n, counted);
+  }
+
+  BinTree_compact(&chain);
+  ASSERT_EQ(n, BinTree_size(chain));
+  ASSERT_EQ(n - 1, NUMBER(BinTree_data(chain)));
+
+  BinTree_free(&chain);
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(create_add_delete);
+  RUN_TEST(orders);
+  RUN_TEST(stop);
+  RUN_TEST(compact);
+  RUN_TEST(degenerate);
   GREATEST_MAIN_END();
 }
@@ -0,0 +1,285 @@
+#include "data_structs/bplus_tree.h"
+
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/memory.h"
+
+#define KEYS  20000
+
+static bool present[KEYS];
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t
+__rand(void)
+{
+  seed ^= seed >> 12;
+  seed ^= seed << 25;
+  seed ^= seed >> 27;
+
+  return seed * 0x2545F4914F6CDD1DULL;
+}
+
+static Object_T
+__value(int64_t key)
+{
+  return (Object_T)(intptr_t)(2 * key + 1);
+}
+
+typedef struct {
+  int64_t previous;
+  size_t count;
+  bool in_order;
+} walk_t;
+
+static bool
+__walk(int64_t key, Object_T value, void* arg)
+{
+  walk_t* walk = arg;
+
+  walk->in_order = walk->in_order && (walk->count == 0 || key > walk->previous)
+                   && value == __value(key);
+  walk->previous = key;
+  walk->count++;
+
+  return true;
+}
+
+/* Same keys as `present`, in order, with their values. */
+static bool
+__same(BPTree_T tree)
+{
+  size_t expected = 0;
+
+  for (size_t k = 0; k < KEYS; ++k) {
+    Object_T value = NULL;
+
+    if (BPTree_get(tree, (int64_t)k, &value) != present[k])
+    { return false; }
+
+    if (present[k] && value != __value((int64_t)k))
+    { return false; }
+
+    expected += present[k];
+  }
+
+  walk_t walk = { 0, 0, true };
+  BPTree_range(tree, INT64_MIN, INT64_MAX, __walk, &walk);
+
+  return walk.in_order && walk.count == expected && BPTree_length(tree) == expected;
+}
+
+/* ______________________________________________________________________________ */
+
+TEST put_get_remove(void)
+{
+  BPTree_T tree = BPTree_new();
+  ASSERT_EQ(0, BPTree_length(tree));
+  ASSERT_EQ(1, BPTree_height(tree));
+
+  for (size_t i = 0; i < 100000; ++i) {
+    const int64_t key = (int64_t)(__rand() % KEYS);
+
+    /* Grows to about two thirds and then shrinks to nothing. */
+    if (__rand() % 3 != 0 && i < 60000) {
+      ASSERT_EQ(!present[key], BPTree_put(tree, key, __value(key)));
+      present[key] = true;
+
+    } else {
+      Object_T value = NULL;
+
+      ASSERT_EQ(present[key], BPTree_remove(tree, key, &value));
+
+      if (present[key])
+      { ASSERT_EQ(__value(key), value); }
+
+      present[key] = false;
+    }
+
+    if (i % 10000 == 0)
+    { ASSERT(__same(tree)); }
+  }
+
+  ASSERT(__same(tree));
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    BPTree_remove(tree, key, NULL);
+    present[key] = false;
+  }
+
+  ASSERT(__same(tree));
+  ASSERT_EQ(1, BPTree_height(tree));
+
+  BPTree_free(&tree);
+  ASSERT_EQ(NULL, tree);
+  PASS();
+}
+
+TEST sequential(void)
+{
+  BPTree_T tree = BPTree_new();
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    ASSERT(BPTree_put(tree, key, __value(key)));
+    present[key] = true;
+  }
+
+  ASSERT(__same(tree));
+  ASSERT(BPTree_height(tree) >= 3);
+
+  /* Replaces. */
+  ASSERT_FALSE(BPTree_put(tree, 7, __value(7)));
+
+  for (int64_t key = KEYS - 1; key >= 0; key -= 2) {
+    ASSERT(BPTree_remove(tree, key, NULL));
+    present[key] = false;
+  }
+
+  ASSERT(__same(tree));
+
+  BPTree_free(&tree);
+  PASS();
+}
+
+TEST extremes(void)
+{
+  BPTree_T tree = BPTree_new();
+  Object_T value = NULL;
+
+  ASSERT_FALSE(BPTree_get(tree, INT64_MAX, &value));
+
+  for (int64_t key = 0; key < 100; ++key) {
+    BPTree_put(tree, INT64_MAX - key, __value(1));
+    BPTree_put(tree, INT64_MIN + key, __value(2));
+  }
+
+  ASSERT_EQ(200, BPTree_length(tree));
+  ASSERT(BPTree_get(tree, INT64_MAX, &value));
+  ASSERT_EQ(__value(1), value);
+  ASSERT(BPTree_get(tree, INT64_MIN, &value));
+  ASSERT_EQ(__value(2), value);
+  ASSERT_FALSE(BPTree_get(tree, 0, &value));
+
+  ASSERT(BPTree_remove(tree, INT64_MAX, NULL));
+  ASSERT_FALSE(BPTree_get(tree, INT64_MAX, &value));
+  ASSERT(BPTree_get(tree, INT64_MAX - 1, &value));
+
+  BPTree_free(&tree);
+  PASS();
+}
+
+TEST load(void)
+{
+  static int64_t keys[KEYS];
+  static Object_T values[KEYS];
+
+  for (size_t n = 0; n < KEYS; n = 3 * n + 1) {
+    for (size_t k = 0; k < KEYS; ++k) {
+      present[k] = false;
+    }
+
+    /* Even keys, so puts land between them. */
+    for (size_t i = 0; i < n; ++i) {
+      keys[i] = (int64_t)(2 * i);
+      values[i] = __value(keys[i]);
+      present[2 * i] = true;
+    }
+
+    BPTree_T tree = BPTree_load(keys, values, n);
+    ASSERT(__same(tree));
+
+    for (size_t i = 0; i < n; ++i) {
+      BPTree_put(tree, (int64_t)(2 * i + 1), __value((int64_t)(2 * i + 1)));
+      present[2 * i + 1] = true;
+    }
+
+    ASSERT(__same(tree));
+
+    for (size_t i = 0; i < 2 * n; i += 3) {
+      BPTree_remove(tree, (int64_t)i, NULL);
+      present[i] = false;
+    }
+
+    ASSERT(__same(tree));
+    BPTree_free(&tree);
+  }
+
+  PASS();
+}
+
+TEST range_scan(void)
+{
+  static int64_t keys[KEYS];
+  static Object_T values[KEYS];
+
+  for (size_t i = 0; i < KEYS; ++i) {
+    keys[i] = (int64_t)(10 * i);
+    values[i] = __value(keys[i]);
+  }
+
+  BPTree_T tree = BPTree_load(keys, values, KEYS);
+  walk_t walk = { 0, 0, true };
+
+  /* From 1000 to 5000, inclusive. */
+  ASSERT_EQ(401, BPTree_range(tree, 995, 5000, __walk, &walk));
+  ASSERT(walk.in_order);
+  ASSERT_EQ(5000, walk.previous);
+  ASSERT_EQ(0, BPTree_range(tree, 11, 19, __walk, &walk));
+
+  int64_t scanned[100];
+  Object_T found[100];
+  int64_t from = 1;
+  size_t total = 0;
+  size_t copied;
+
+  while ((copied = BPTree_scan(tree, from, scanned, found, 100)) > 0) {
+    for (size_t i = 0; i < copied; ++i) {
+      ASSERT_EQ(10 * (int64_t)(total + i + 1), scanned[i]);
+      ASSERT_EQ(__value(scanned[i]), found[i]);
+    }
+
+    total += copied;
+    from = scanned[copied - 1] + 1;
+  }
+
+  ASSERT_EQ(KEYS - 1, total);
+
+  BPTree_free(&tree);
+  PASS();
+}
+
+static void
+__free_int(void* p_i)
+{
+  FREE(p_i);
+}
+
+TEST destroy(void)
+{
+  BPTree_T tree = BPTree_new();
+
+  for (int64_t key = 0; key < 1000; ++key) {
+    int64_t* p_key;
+    NEW(p_key);
+    *p_key = key;
+
+    BPTree_put(tree, key * 7919 % 1000, (Object_T)p_key);
+  }
+
+  BPTree_destroy(&tree, __free_int);
+  ASSERT_EQ(NULL, tree);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(put_get_remove);
+  RUN_TEST(sequential);
+  RUN_TEST(extremes);
+  RUN_TEST(load);
+  RUN_TEST(range_scan);
+  RUN_TEST(destroy);
+  GREATEST_MAIN_END();
+}
@@ -119,6 +119,42 @@ TEST append_nth(void)
   PASS();
 }
 
+TEST header(void)
+{
+  CircList_T circlist = CircList_new();
+
+  CircList_append(&circlist, Test_elm(1));
+  ASSERT_EQ(HEAD(circlist), TAIL(circlist));
+  ASSERT_EQ(HEAD(circlist), NEXT(TAIL(circlist)));
+
+  CircList_append(&circlist, Test_elm(2));
+  CircList_insert(&circlist, Test_elm(0));
+
+  ASSERT_EQ(0, Test_value(HEAD(circlist)));
+  ASSERT_EQ(2, Test_value(TAIL(circlist)));
+  ASSERT_EQ(HEAD(circlist), NEXT(TAIL(circlist)));
+  ASSERT_EQ(3, LENGTH(circlist));
+  ASSERT_EQ(NULL, CircList_nth(circlist, 4));
+
+  /* The first one goes. */
+  Data_T deleted;
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT(CircList_delete(&circlist, (Object_T*) &deleted));
+    ASSERT_EQ(i, deleted->value);
+    FREE(deleted);
+
+    if (i < 2)
+    { ASSERT_EQ(HEAD(circlist), NEXT(TAIL(circlist))); }
+  }
+
+  ASSERT_EQ(NULL, circlist);
+  ASSERT_EQ(0, CircList_length(circlist));
+  ASSERT_FALSE(CircList_delete(&circlist, (Object_T*) &deleted));
+
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
@@ -129,5 +165,6 @@ int main(int argc, char** argv)
   RUN_TEST(traverse);
   RUN_TEST(insert_nth);
   RUN_TEST(append_nth);
+  RUN_TEST(header);
   GREATEST_MAIN_END();
 }
@@ -1,5 +1,6 @@
 #include "data_structs/double_list.h"
 
+#include <stdint.h>
 #include <greatest.h>
 #include "test_data.h"
 
@@ -151,6 +152,137 @@ TEST cut_paste(void)
   PASS();
 }
 
+static int next_value;
+
+static bool
+__in_order(Object_T data)
+{
+  return VALUE(data) == next_value++;
+}
+
+/* Cut and paste inside and across nodes of unrolled lists. */
+TEST cut_paste_many(void)
+{
+  enum { COUNT = 1000 };
+
+  DoubleList_T list = DoubleList_new();
+
+  for (int i = 1; i <= COUNT; ++i) {
+    DoubleList_append(&list, Test_elm(i));
+  }
+
+  ASSERT_EQ(COUNT, DoubleList_length(list));
+  ASSERT_EQ(COUNT, Test_value(DoubleList_nth(list, -1)));
+  ASSERT_EQ(COUNT - 99, Test_value(DoubleList_nth(list, -100)));
+
+  /* [1 .. 299] [300 .. 700] [701 .. 1000] */
+  doublenode_t* start = DoubleList_nth(list, 300);
+  doublenode_t* end = DoubleList_nth(list, 700);
+
+  DoubleList_cut(&list, &start, &end);
+
+  ASSERT_EQ(COUNT - 401, DoubleList_length(list));
+  ASSERT_EQ(401, DoubleList_length(start));
+  ASSERT_EQ(300, Test_value(start));
+  ASSERT_EQ(700, Test_value(end));
+  ASSERT_EQ(701, Test_value(DoubleList_nth(list, 300)));
+
+  /* Back in place. */
+  doublenode_t* target = DoubleList_nth(list, 299);
+  DoubleList_paste(&target, &start);
+
+  ASSERT(DoubleList_is_empty(start));
+  ASSERT_EQ(COUNT, DoubleList_length(list));
+
+  next_value = 1;
+  ASSERT(DoubleList_traverse(list, __in_order));
+
+  /* Insert in the middle of a full node. */
+  doublenode_t* middle = DoubleList_nth(list, 500);
+  DoubleList_insert(&middle, Test_elm(0));
+
+  ASSERT_EQ(0, Test_value(middle));
+  ASSERT_EQ(500, Test_value(DoubleList_nth(middle, 2)));
+  ASSERT_EQ(COUNT + 1, DoubleList_length(list));
+
+  DoubleList_destroy(&list, free_elm_fn);
+  ASSERT(DoubleList_is_empty(list));
+  PASS();
+}
+
+#if defined(LIST_UNROLLED_MODE)
+
+/* Chunks of `double_list-unrolled.c`, aligned to their size. */
+#define CHUNK_SIZE   256
+#define CHUNK_ITEMS  ((CHUNK_SIZE - 3 * sizeof (void*)) / sizeof (Object_T))
+
+static size_t
+__chunks(DoubleList_T list)
+{
+  size_t chunks = 0;
+  uintptr_t last = 0;
+
+  for (int i = 1; i <= (int)DoubleList_length(list); ++i) {
+    const uintptr_t chunk = (uintptr_t)DoubleList_nth(list, i) & ~(uintptr_t)(CHUNK_SIZE - 1);
+
+    if (chunk != last) {
+      chunks++;
+      last = chunk;
+    }
+  }
+
+  return chunks;
+}
+
+/* Deletes the first element and then every second one. */
+static void
+__delete_every_second(DoubleList_T* p_list)
+{
+  const size_t n = DoubleList_length(*p_list);
+  DoubleList_T at = *p_list;
+  Object_T deleted;
+
+  for (size_t i = 0; i < n / 2; ++i) {
+    if (i > 0)
+    { at = DoubleList_nth(at, 2); }
+
+    DoubleList_delete_head(&at, &deleted);
+    FREE(deleted);
+
+    /* Next element took the slot of the first. */
+    if (i == 0)
+    { *p_list = at; }
+  }
+}
+
+/* Every second one out, twice. Sparse chunks are merged. */
+TEST alternating_deletes(void)
+{
+  enum { COUNT = 1000 };
+
+  DoubleList_T list = DoubleList_new();
+
+  for (int i = 1; i <= COUNT; ++i) {
+    DoubleList_append(&list, Test_elm(i));
+  }
+
+  __delete_every_second(&list);
+  __delete_every_second(&list);
+
+  ASSERT_EQ(COUNT / 4, DoubleList_length(list));
+  ASSERT_EQ(4, Test_value(DoubleList_nth(list, 1)));
+  ASSERT_EQ(8, Test_value(DoubleList_nth(list, 2)));
+  ASSERT_EQ(COUNT, Test_value(DoubleList_nth(list, -1)));
+
+  /* All but the last at least half full. */
+  ASSERT(__chunks(list) <= COUNT / 4 / (CHUNK_ITEMS / 2) + 1);
+
+  DoubleList_destroy(&list, free_elm_fn);
+  PASS();
+}
+
+#endif  /* LIST_UNROLLED_MODE */
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
@@ -162,5 +294,9 @@ int main(int argc, char** argv)
   RUN_TEST(insert_nth);
   RUN_TEST(insert_nth_negative);
   RUN_TEST(cut_paste);
+  RUN_TEST(cut_paste_many);
+#if defined(LIST_UNROLLED_MODE)
+  RUN_TEST(alternating_deletes);
+#endif
   GREATEST_MAIN_END();
 }
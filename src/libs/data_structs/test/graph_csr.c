@@ -0,0 +1,157 @@
+#include "data_structs/graph_csr.h"
+
+#include <greatest.h>
+#include "test_data.h"
+
+/*
+ *   0 --5-- 1 --2-- 3
+ *    \      |
+ *     7     1
+ *      \    |
+ *       -- 2       4 (alone)
+ */
+static const csr_edge_t k_edges[] = {
+  { 1, 3, 2 }, { 0, 2, 7 }, { 2, 1, 1 }, { 0, 1, 5 }
+};
+
+#define K_EDGES  (sizeof (k_edges) / sizeof (k_edges[0]))
+
+/* Targets of every vertex are sorted. */
+static bool
+__sorted(CSRGraph_T graph, size_t number_of_vertices)
+{
+  const vertex* targets;
+  const int16_t* weights;
+
+  for (vertex v = 0; v < number_of_vertices; ++v) {
+    const size_t degree = CSRGraph_edges(graph, v, &targets, &weights);
+
+    for (size_t i = 1; i < degree; ++i) {
+      if (targets[i - 1] > targets[i])
+      { return false; }
+    }
+  }
+
+  return true;
+}
+
+TEST from_edges(void)
+{
+  CSRGraph_T graph = CSRGraph_from_edges(5, UNDIRECTED, k_edges, K_EDGES);
+
+  size_t vertices, edges;
+  CSRGraph_size(graph, &vertices, &edges);
+
+  ASSERT_EQ(5, vertices);
+  ASSERT_EQ(K_EDGES, edges);
+  ASSERT(__sorted(graph, vertices));
+
+  const vertex* targets;
+  const int16_t* weights;
+
+  ASSERT_EQ(3, CSRGraph_edges(graph, 1, &targets, &weights));
+  ASSERT_EQ(0, targets[0]);
+  ASSERT_EQ(5, weights[0]);
+  ASSERT_EQ(2, targets[1]);
+  ASSERT_EQ(1, weights[1]);
+  ASSERT_EQ(3, targets[2]);
+  ASSERT_EQ(2, weights[2]);
+
+  ASSERT_EQ(0, CSRGraph_edges(graph, 4, &targets, &weights));
+
+  ASSERT(CSRGraph_is_adjacent(graph, 3, 1));
+  ASSERT(CSRGraph_is_adjacent(graph, 1, 3));
+  ASSERT_FALSE(CSRGraph_is_adjacent(graph, 0, 3));
+  ASSERT_FALSE(CSRGraph_is_adjacent(graph, 4, 0));
+
+  ASSERT_EQ(7, CSRGraph_weight(graph, 2, 0));
+  ASSERT_EQ(UNUSED_WEIGHT, CSRGraph_weight(graph, 2, 3));
+
+  CSRGraph_free(&graph);
+
+  /* Only one direction. */
+  graph = CSRGraph_from_edges(5, DIRECTED, k_edges, K_EDGES);
+  CSRGraph_size(graph, &vertices, &edges);
+
+  ASSERT_EQ(K_EDGES, edges);
+  ASSERT(CSRGraph_is_adjacent(graph, 1, 3));
+  ASSERT_FALSE(CSRGraph_is_adjacent(graph, 3, 1));
+
+  CSRGraph_T reverse = CSRGraph_transpose(graph);
+
+  ASSERT_EQ(DIRECTED, CSRGraph_type(reverse));
+  ASSERT(__sorted(reverse, vertices));
+  ASSERT(CSRGraph_is_adjacent(reverse, 3, 1));
+  ASSERT_FALSE(CSRGraph_is_adjacent(reverse, 1, 3));
+  ASSERT_EQ(7, CSRGraph_weight(reverse, 2, 0));
+
+  CSRGraph_free(&reverse);
+  CSRGraph_free(&graph);
+  PASS();
+}
+
+/* Same edges as the adjacency list graph, in order. */
+TEST from_graph(void)
+{
+  enum { VERTICES = 200 };
+
+  Graph_T list_graph = Graph_new(VERTICES, DIRECTED);
+
+  for (vertex v = 0; v < VERTICES; ++v) {
+    for (vertex step = 1; step < 20; step += 3) {
+      Graph_add_edge(list_graph, v, (v * 7 + step * 13) % VERTICES, (int16_t)(step + 1));
+    }
+  }
+
+  CSRGraph_T graph = CSRGraph_from_graph(list_graph);
+
+  size_t vertices, edges, list_vertices, list_edges;
+  CSRGraph_size(graph, &vertices, &edges);
+  Graph_size(list_graph, &list_vertices, &list_edges);
+
+  ASSERT_EQ(list_vertices, vertices);
+  ASSERT_EQ(list_edges, edges);
+  ASSERT(__sorted(graph, vertices));
+
+  for (vertex v1 = 0; v1 < VERTICES; ++v1) {
+    for (vertex v2 = 0; v2 < VERTICES; ++v2) {
+      ASSERT_EQ(Graph_is_adjacent(list_graph, v1, v2), CSRGraph_is_adjacent(graph, v1, v2));
+    }
+
+    edge_t* p_edge = NULL;
+
+    while ((p_edge = Graph_edge_iterator(list_graph, v1, p_edge)) != NULL) {
+      const edge_data* p_data = (const edge_data*)DATA(p_edge);
+      ASSERT_EQ(p_data->weight, CSRGraph_weight(graph, v1, p_data->vertex_number));
+    }
+  }
+
+  CSRGraph_free(&graph);
+  Graph_free(&list_graph);
+  PASS();
+}
+
+TEST empty(void)
+{
+  CSRGraph_T graph = CSRGraph_from_edges(3, UNDIRECTED, NULL, 0);
+
+  size_t vertices, edges;
+  CSRGraph_size(graph, &vertices, &edges);
+
+  ASSERT_EQ(3, vertices);
+  ASSERT_EQ(0, edges);
+  ASSERT_FALSE(CSRGraph_is_adjacent(graph, 0, 2));
+
+  CSRGraph_free(&graph);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(from_edges);
+  RUN_TEST(from_graph);
+  RUN_TEST(empty);
+  GREATEST_MAIN_END();
+}
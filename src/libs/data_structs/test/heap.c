@@ -18,7 +18,218 @@ TEST create_add_delete(void)
   Heap_delete(heap, 0, cmp_fn, &deleted);
 
   ASSERT_EQ(40, VALUE(deleted));
+  FREE(deleted);
 
+  Heap_destroy(&heap, free_elm_fn);
+  PASS();
+}
+
+/* Pops all elements and checks they come in order. */
+static bool
+__pop_in_order(Heap_T heap, size_t count)
+{
+  Object_T deleted;
+  int last = -1;
+  bool in_order = (Heap_length(heap) == count);
+
+  while (!Heap_is_empty(heap)) {
+    Heap_delete(heap, 0, cmp_fn, &deleted);
+    in_order = in_order && VALUE(deleted) >= last;
+    last = VALUE(deleted);
+
+    FREE(deleted);
+  }
+
+  return in_order && Heap_is_empty(heap);
+}
+
+/* More elements than the initial storage, in a shuffled order. */
+TEST grow(void)
+{
+  enum { COUNT = 1000 };
+
+  Heap_T heap = Heap_new();
+
+  for (int i = 0; i < COUNT; ++i) {
+    Heap_insert(heap, Test_elm((i * 7919) % COUNT), cmp_fn);
+  }
+
+  ASSERT(__pop_in_order(heap, COUNT));
+
+  Heap_free(&heap);
+  PASS();
+}
+
+TEST build(void)
+{
+  enum { COUNT = 1000 };
+
+  Object_T array[COUNT];
+
+  for (int i = 0; i < COUNT; ++i) {
+    array[i] = Test_elm((i * 7919) % 100);
+  }
+
+  Heap_T heap = Heap_build(array, COUNT, cmp_fn);
+  ASSERT(__pop_in_order(heap, COUNT));
+  Heap_free(&heap);
+
+  heap = Heap_build(NULL, 0, cmp_fn);
+  ASSERT(Heap_is_empty(heap));
+
+  Heap_insert(heap, Test_elm(1), cmp_fn);
+  ASSERT(__pop_in_order(heap, 1));
+
+  Heap_free(&heap);
+  PASS();
+}
+
+/* Last element could go up to the place of deleted one. */
+TEST delete_inner(void)
+{
+  enum { COUNT = 2 * HEAP_ARITY + 2 };
+
+  Object_T array[COUNT];
+  Object_T deleted;
+
+  /* Already a heap: `105` is a child of the second child of the root. */
+  array[0] = Test_elm(0);
+  array[1] = Test_elm(110);
+
+  for (int i = 2; i <= HEAP_ARITY; ++i) {
+    array[i] = Test_elm(100);
+  }
+
+  for (int i = HEAP_ARITY + 1; i <= 2 * HEAP_ARITY; ++i) {
+    array[i] = Test_elm(200);
+  }
+
+  array[COUNT - 1] = Test_elm(105);
+
+  Heap_T heap = Heap_build(array, COUNT, cmp_fn);
+
+  /* First child of `110`, `105` takes its place and should go up. */
+  ASSERT(Heap_delete(heap, HEAP_ARITY + 1, cmp_fn, &deleted));
+  ASSERT_EQ(200, VALUE(deleted));
+  FREE(deleted);
+
+  ASSERT_FALSE(Heap_delete(heap, Heap_length(heap), cmp_fn, &deleted));
+
+  ASSERT(__pop_in_order(heap, COUNT - 1));
+
+  Heap_free(&heap);
+  PASS();
+}
+
+/* Dijkstra like: keys go down while the heap is used. */
+TEST decrease_key(void)
+{
+  enum { COUNT = 300 };
+
+  Heap_T heap = Heap_new_indexed();
+  heap_handle_t handles[COUNT];
+
+  for (int i = 0; i < COUNT; ++i) {
+    handles[i] = Heap_insert_handle(heap, Test_elm(1000 + i), cmp_fn);
+  }
+
+  /* Every third key is decreased in place, below all others. */
+  for (int i = 0; i < COUNT; i += 3) {
+    Object_T data = Heap_handle_data(heap, handles[i]);
+    ASSERT_EQ(1000 + i, VALUE(data));
+
+    VALUE(data) = COUNT - i;
+    Heap_decrease_key(heap, handles[i], data, cmp_fn);
+  }
+
+  Object_T deleted;
+
+  ASSERT(Heap_delete(heap, 0, cmp_fn, &deleted));
+  ASSERT_EQ(COUNT - (COUNT - 1) / 3 * 3, VALUE(deleted));
+  ASSERT_FALSE(Heap_has_handle(heap, handles[(COUNT - 1) / 3 * 3]));
+  FREE(deleted);
+
+  for (int i = 1; i < COUNT; ++i) {
+    ASSERT(Heap_has_handle(heap, handles[i]) == (i != (COUNT - 1) / 3 * 3));
+  }
+
+  ASSERT(__pop_in_order(heap, COUNT - 1));
+
+  Heap_free(&heap);
+  PASS();
+}
+
+/* Handles follow their elements through inserts and deletes of others. */
+TEST remove_handle(void)
+{
+  enum { COUNT = 500 };
+
+  Heap_T heap = Heap_new_indexed();
+  heap_handle_t handles[COUNT];
+  Object_T elements[COUNT];
+  Object_T deleted;
+
+  for (int i = 0; i < COUNT; ++i) {
+    elements[i] = Test_elm((i * 7919) % COUNT);
+    handles[i] = Heap_insert_handle(heap, elements[i], cmp_fn);
+  }
+
+  /* Every second one out, by handle. */
+  for (int i = 0; i < COUNT; i += 2) {
+    ASSERT(Heap_remove_handle(heap, handles[i], cmp_fn, &deleted));
+    ASSERT_EQ(elements[i], deleted);
+    ASSERT_FALSE(Heap_remove_handle(heap, handles[i], cmp_fn, &deleted));
+    FREE(deleted);
+  }
+
+  for (int i = 1; i < COUNT; i += 2) {
+    ASSERT_EQ(elements[i], Heap_handle_data(heap, handles[i]));
+  }
+
+  /* Freed handles are given again. */
+  for (int i = 0; i < COUNT; i += 2) {
+    elements[i] = Test_elm(COUNT + i);
+    handles[i] = Heap_insert_handle(heap, elements[i], cmp_fn);
+
+    ASSERT(HEAP_HANDLE_ID(handles[i]) < COUNT);
+  }
+
+  for (int i = 0; i < COUNT; ++i) {
+    ASSERT_EQ(elements[i], Heap_handle_data(heap, handles[i]));
+  }
+
+  ASSERT(__pop_in_order(heap, COUNT));
+
+  Heap_free(&heap);
+  PASS();
+}
+
+/* Slot of a deleted element is given again, its old handle stays out. */
+TEST stale_handle(void)
+{
+  Heap_T heap = Heap_new_indexed();
+  Object_T first = Test_elm(1);
+  Object_T second = Test_elm(2);
+  Object_T deleted;
+
+  const heap_handle_t stale = Heap_insert_handle(heap, first, cmp_fn);
+  ASSERT(Heap_remove_handle(heap, stale, cmp_fn, &deleted));
+  ASSERT_EQ(first, deleted);
+
+  const heap_handle_t handle = Heap_insert_handle(heap, second, cmp_fn);
+
+  ASSERT_EQ(HEAP_HANDLE_ID(stale), HEAP_HANDLE_ID(handle));
+  ASSERT(stale != handle);
+
+  ASSERT_FALSE(Heap_has_handle(heap, stale));
+  ASSERT_FALSE(Heap_remove_handle(heap, stale, cmp_fn, &deleted));
+
+  ASSERT(Heap_has_handle(heap, handle));
+  ASSERT_EQ(second, Heap_handle_data(heap, handle));
+  ASSERT_EQ(1, Heap_length(heap));
+
+  FREE(first);
+  Heap_destroy(&heap, free_elm_fn);
   PASS();
 }
 
@@ -27,5 +238,11 @@ int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(create_add_delete);
+  RUN_TEST(grow);
+  RUN_TEST(build);
+  RUN_TEST(delete_inner);
+  RUN_TEST(decrease_key);
+  RUN_TEST(remove_handle);
+  RUN_TEST(stale_handle);
   GREATEST_MAIN_END();
 }
@@ -1,5 +1,6 @@
 #include "data_structs/list.h"
 
+#include <stdint.h>
 #include <greatest.h>
 #include "test_data.h"
 
@@ -129,6 +130,185 @@ TEST free_non_empty(void)
   PASS();
 }
 
+/* Enough to fill many nodes of unrolled lists. */
+TEST many_elements(void)
+{
+  enum { COUNT = 1000 };
+
+  List_T list = List_new();
+  Data_T deleted;
+
+  for (int i = COUNT / 2; i > 0; --i) {
+    List_insert(&list, Test_elm(i));
+  }
+
+  for (int i = COUNT / 2 + 1; i <= COUNT; ++i) {
+    List_append(&list, Test_elm(i));
+  }
+
+  ASSERT_EQ(COUNT, List_length(list));
+
+  int expected = 1;
+  node_t* p_node = NULL;
+
+  while ((p_node = List_iterator(list, p_node)) != NULL) {
+    ASSERT_EQ(expected++, Test_value(p_node));
+  }
+
+  /* Every second one out. */
+  data_t key;
+
+  for (key.value = 2; key.value <= COUNT; key.value += 2) {
+    ASSERT(List_find_key(list, equal_fn, (Object_T)&key, &p_node));
+
+    deleted = (Data_T)DATA(p_node);
+    List_delete_node(&list, p_node);
+    FREE(deleted);
+  }
+
+  ASSERT_EQ(COUNT / 2, List_length(list));
+
+  ASSERT(List_delete_head(&list, (Object_T*) &deleted));
+  ASSERT_EQ(1, deleted->value);
+  FREE(deleted);
+
+  ASSERT_EQ(3, Test_value(HEAD(list)));
+
+  List_destroy(&list, free_elm_fn);
+  ASSERT(List_is_empty(list));
+  PASS();
+}
+
+/* Header follows the first and the last node and counts them. */
+TEST header(void)
+{
+  enum { COUNT = 100 };
+
+  List_T list = List_new();
+  Data_T deleted;
+
+  List_append(&list, Test_elm(1));
+  ASSERT(list != NULL);
+  ASSERT_EQ(HEAD(list), TAIL(list));
+  ASSERT_EQ(1, LENGTH(list));
+
+  for (int i = 2; i <= COUNT; ++i) {
+    List_append(&list, Test_elm(i));
+
+    ASSERT_EQ(i, Test_value(TAIL(list)));
+    ASSERT_EQ((size_t)i, LENGTH(list));
+  }
+
+  List_insert(&list, Test_elm(0));
+  ASSERT_EQ(0, Test_value(HEAD(list)));
+  ASSERT_EQ(COUNT, Test_value(TAIL(list)));
+  ASSERT_EQ(COUNT + 1, List_length(list));
+
+  /* Deleting the last node moves the tail back. */
+  node_t* p_node = TAIL(list);
+  deleted = (Data_T)DATA(p_node);
+  List_delete_node(&list, p_node);
+  FREE(deleted);
+
+  ASSERT_EQ(COUNT - 1, Test_value(TAIL(list)));
+  ASSERT_EQ(COUNT, List_length(list));
+
+  List_append(&list, Test_elm(42));
+  ASSERT_EQ(42, Test_value(TAIL(list)));
+
+  p_node = NULL;
+  int expected = 0;
+
+  while ((p_node = List_iterator(list, p_node)) != NULL && p_node != TAIL(list)) {
+    ASSERT_EQ(expected++, Test_value(p_node));
+  }
+  ASSERT_EQ(COUNT, expected);
+
+  /* Header goes with the last element. */
+  while (List_delete_head(&list, (Object_T*) &deleted)) {
+    FREE(deleted);
+  }
+
+  ASSERT_EQ(NULL, list);
+  ASSERT_EQ(0, List_length(list));
+
+  List_append(&list, Test_elm(7));
+  ASSERT_EQ(HEAD(list), TAIL(list));
+
+  List_destroy(&list, free_elm_fn);
+  ASSERT_EQ(NULL, list);
+  PASS();
+}
+
+#if defined(LIST_UNROLLED_MODE)
+
+/* Chunks of `list-unrolled.c`, aligned to their size. */
+#define CHUNK_SIZE   256
+#define CHUNK_ITEMS  ((CHUNK_SIZE - 2 * sizeof (void*)) / sizeof (Object_T))
+
+static size_t
+__chunks(List_T list)
+{
+  size_t chunks = 0;
+  uintptr_t last = 0;
+  node_t* p_node = NULL;
+
+  while ((p_node = List_iterator(list, p_node)) != NULL) {
+    const uintptr_t chunk = (uintptr_t)p_node & ~(uintptr_t)(CHUNK_SIZE - 1);
+
+    if (chunk != last) {
+      chunks++;
+      last = chunk;
+    }
+  }
+
+  return chunks;
+}
+
+/* Every second one out, twice. Sparse chunks are merged. */
+TEST alternating_deletes(void)
+{
+  enum { COUNT = 1000 };
+
+  List_T list = List_new();
+  Data_T deleted;
+  node_t* p_node;
+  data_t key;
+
+  for (int i = 1; i <= COUNT; ++i) {
+    List_append(&list, Test_elm(i));
+  }
+
+  for (int step = 2; step <= 4; step *= 2) {
+    for (key.value = step / 2 + 1; key.value <= COUNT; key.value += step) {
+      ASSERT(List_find_key(list, equal_fn, (Object_T)&key, &p_node));
+
+      deleted = (Data_T)DATA(p_node);
+      List_delete_node(&list, p_node);
+      FREE(deleted);
+    }
+  }
+
+  ASSERT_EQ(COUNT / 4, List_length(list));
+  ASSERT_EQ(COUNT - 3, Test_value(TAIL(list)));
+
+  int expected = 1;
+  p_node = NULL;
+
+  while ((p_node = List_iterator(list, p_node)) != NULL) {
+    ASSERT_EQ(expected, Test_value(p_node));
+    expected += 4;
+  }
+
+  /* All but the last at least half full. */
+  ASSERT(__chunks(list) <= COUNT / 4 / (CHUNK_ITEMS / 2) + 1);
+
+  List_destroy(&list, free_elm_fn);
+  PASS();
+}
+
+#endif  /* LIST_UNROLLED_MODE */
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
@@ -141,5 +321,10 @@ int main(int argc, char** argv)
   RUN_TEST(find_key);
   RUN_TEST(length);
   RUN_TEST(free_non_empty);
+  RUN_TEST(many_elements);
+  RUN_TEST(header);
+#if defined(LIST_UNROLLED_MODE)
+  RUN_TEST(alternating_deletes);
+#endif
   GREATEST_MAIN_END();
 }
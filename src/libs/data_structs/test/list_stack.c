@@ -1,5 +1,6 @@
 #include "data_structs/list_stack.h"
 
+#include <stdint.h>
 #include <greatest.h>
 #include "test_data.h"
 
@@ -21,10 +22,74 @@ TEST free_empty(void)
   PASS();
 }
 
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+#define NUMBER(e)   ((size_t)(uintptr_t)(e) - 1)
+
+/* Enough elements for a few chunks, pushed again after it was emptied. */
+TEST order(void)
+{
+  LStack_T stack = LStack_new();
+  Object_T data = NULL;
+
+  for (size_t round = 1; round <= 3; ++round) {
+    const size_t n = 10000 / round;
+
+    for (size_t i = 0; i < n; ++i) {
+      LStack_push(stack, ELEMENT(i));
+    }
+
+    ASSERT(LStack_peel(stack, &data));
+    ASSERT_EQ(n - 1, NUMBER(data));
+
+    for (size_t i = n; i-- > 0;) {
+      ASSERT(LStack_pop(stack, &data));
+      ASSERT_EQ(i, NUMBER(data));
+    }
+
+    ASSERT(LStack_is_empty(stack));
+    ASSERT_FALSE(LStack_pop(stack, &data));
+    ASSERT_FALSE(LStack_peel(stack, &data));
+  }
+
+  LStack_free(stack);
+  PASS();
+}
+
+TEST reserve(void)
+{
+  LStack_T stack = LStack_new();
+  Object_T data = NULL;
+
+  LStack_reserve(stack, 1000);
+
+  /* Pushes and pops around empty. */
+  for (size_t i = 0; i < 5000; ++i) {
+    LStack_push(stack, ELEMENT(i));
+    LStack_push(stack, ELEMENT(i + 1));
+
+    ASSERT(LStack_pop(stack, &data));
+    ASSERT_EQ(i + 1, NUMBER(data));
+    ASSERT(LStack_pop(stack, &data));
+    ASSERT_EQ(i, NUMBER(data));
+  }
+
+  LStack_reserve(stack, 0);
+
+  for (size_t i = 0; i < 3; ++i) {
+    LStack_push(stack, ELEMENT(i));
+  }
+
+  /* Left elements are not allocated. */
+  LStack_destroy(stack, NULL);
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(free_empty);
+  RUN_TEST(order);
+  RUN_TEST(reserve);
   GREATEST_MAIN_END();
 }
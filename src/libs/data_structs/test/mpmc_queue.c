@@ -0,0 +1,225 @@
+#include "data_structs/mpmc_queue.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/memory.h"
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+#define NUMBER(e)   ((size_t)(uintptr_t)(e) - 1)
+
+TEST fifo(void)
+{
+  MPMCQueue_T queue = MPMCQueue_new(5);
+  Object_T data = NULL;
+
+  ASSERT_EQ(8, MPMCQueue_capacity(queue));
+  ASSERT_FALSE(MPMCQueue_remove(queue, &data));
+
+  /* Several rounds over the ring. */
+  for (size_t round = 0; round < 5; ++round) {
+    for (size_t i = 0; i < 8; ++i) {
+      ASSERT(MPMCQueue_add(queue, ELEMENT(i)));
+    }
+
+    ASSERT_FALSE(MPMCQueue_add(queue, ELEMENT(8)));
+    ASSERT_EQ(8, MPMCQueue_length(queue));
+
+    for (size_t i = 0; i < 8; ++i) {
+      ASSERT(MPMCQueue_remove(queue, &data));
+      ASSERT_EQ(i, NUMBER(data));
+    }
+
+    ASSERT_FALSE(MPMCQueue_remove(queue, &data));
+    ASSERT_EQ(0, MPMCQueue_length(queue));
+  }
+
+  MPMCQueue_free(&queue);
+  ASSERT_EQ(NULL, queue);
+  PASS();
+}
+
+TEST bulk(void)
+{
+  MPMCQueue_T queue = MPMCQueue_new(16);
+  Object_T items[20];
+  Object_T out[20];
+
+  for (size_t i = 0; i < 20; ++i) {
+    items[i] = ELEMENT(i);
+  }
+
+  ASSERT_EQ(0, MPMCQueue_add_bulk(queue, items, 0));
+  ASSERT_EQ(10, MPMCQueue_add_bulk(queue, items, 10));
+
+  /* Only six fit. */
+  ASSERT_EQ(6, MPMCQueue_add_bulk(queue, &items[10], 10));
+  ASSERT_EQ(0, MPMCQueue_add_bulk(queue, &items[16], 4));
+
+  ASSERT_EQ(4, MPMCQueue_remove_bulk(queue, out, 4));
+  ASSERT_EQ(4, MPMCQueue_add_bulk(queue, &items[16], 4));
+
+  ASSERT_EQ(16, MPMCQueue_remove_bulk(queue, &out[4], 20));
+  ASSERT_EQ(0, MPMCQueue_remove_bulk(queue, out, 1));
+
+  for (size_t i = 0; i < 20; ++i) {
+    ASSERT_EQ(i, NUMBER(out[i]));
+  }
+
+  MPMCQueue_free(&queue);
+  PASS();
+}
+
+static void
+__free_element(void* data)
+{
+  FREE(data);
+}
+
+TEST destroy(void)
+{
+  MPMCQueue_T queue = MPMCQueue_new(4);
+
+  for (int i = 0; i < 3; ++i) {
+    int* p_i = ALLOC(sizeof (int));
+    MPMCQueue_add(queue, (Object_T)p_i);
+  }
+
+  MPMCQueue_destroy(&queue, __free_element);
+  ASSERT_EQ(NULL, queue);
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+#define THREADS    4
+#define PER_THREAD 100000
+#define BATCH      7
+
+typedef struct {
+  MPMCQueue_T queue;
+  size_t id;
+  _Atomic size_t* removed;
+  atomic_bool* seen;
+  bool ordered;
+} worker_t;
+
+/* Producer `id` adds `id * PER_THREAD ...`, in batches every other one. */
+static void*
+__produce(void* arg)
+{
+  worker_t* worker = arg;
+  Object_T batch[BATCH];
+  size_t i = 0;
+
+  while (i < PER_THREAD) {
+    const size_t n = (worker->id % 2 == 0 || PER_THREAD - i < BATCH) ? 1 : BATCH;
+
+    for (size_t k = 0; k < n; ++k) {
+      batch[k] = ELEMENT(worker->id * PER_THREAD + i + k);
+    }
+
+    i += MPMCQueue_add_bulk(worker->queue, batch, n);
+  }
+
+  return NULL;
+}
+
+/* Elements of one producer come in the order they were added. */
+static void*
+__consume(void* arg)
+{
+  worker_t* worker = arg;
+  Object_T batch[BATCH];
+  size_t last[THREADS];
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    last[t] = SIZE_MAX;
+  }
+
+  worker->ordered = true;
+
+  while (atomic_load(worker->removed) < THREADS * PER_THREAD) {
+    const size_t n = MPMCQueue_remove_bulk(worker->queue, batch, (worker->id % 2) ? BATCH : 1);
+
+    for (size_t k = 0; k < n; ++k) {
+      const size_t number = NUMBER(batch[k]);
+      const size_t producer = number / PER_THREAD;
+
+      if (last[producer] != SIZE_MAX && last[producer] >= number)
+      { worker->ordered = false; }
+
+      last[producer] = number;
+
+      if (atomic_exchange(&worker->seen[number], true))
+      { worker->ordered = false; }
+    }
+
+    atomic_fetch_add(worker->removed, n);
+  }
+
+  return NULL;
+}
+
+TEST threads(void)
+{
+  MPMCQueue_T queue = MPMCQueue_new(64);
+  atomic_bool* seen = ALLOC(THREADS * PER_THREAD * sizeof (atomic_bool));
+  _Atomic size_t removed;
+
+  for (size_t i = 0; i < THREADS * PER_THREAD; ++i) {
+    atomic_init(&seen[i], false);
+  }
+
+  atomic_init(&removed, 0);
+
+  pthread_t producers[THREADS], consumers[THREADS];
+  worker_t workers[2 * THREADS];
+
+  for (size_t t = 0; t < 2 * THREADS; ++t) {
+    workers[t].queue = queue;
+    workers[t].id = t % THREADS;
+    workers[t].removed = &removed;
+    workers[t].seen = seen;
+    workers[t].ordered = true;
+  }
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    pthread_create(&consumers[t], NULL, __consume, &workers[THREADS + t]);
+    pthread_create(&producers[t], NULL, __produce, &workers[t]);
+  }
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    pthread_join(producers[t], NULL);
+    pthread_join(consumers[t], NULL);
+  }
+
+  ASSERT_EQ(THREADS * PER_THREAD, atomic_load(&removed));
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    ASSERT(workers[THREADS + t].ordered);
+  }
+
+  for (size_t i = 0; i < THREADS * PER_THREAD; ++i) {
+    ASSERT(atomic_load(&seen[i]));
+  }
+
+  ASSERT_EQ(0, MPMCQueue_length(queue));
+
+  FREE(seen);
+  MPMCQueue_free(&queue);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(fifo);
+  RUN_TEST(bulk);
+  RUN_TEST(destroy);
+  RUN_TEST(threads);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,352 @@
+#include "data_structs/ord_tree.h"
+
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/macros.h"
+#include "lang/memory.h"
+
+#define KEYS  20000
+
+static bool present[KEYS];
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t
+__rand(void)
+{
+  seed ^= seed >> 12;
+  seed ^= seed << 25;
+  seed ^= seed >> 27;
+
+  return seed * 0x2545F4914F6CDD1DULL;
+}
+
+static Object_T
+__value(int64_t key)
+{
+  return (Object_T)(intptr_t)(2 * key + 1);
+}
+
+static void
+__clear(bool* keys__)
+{
+  for (size_t k = 0; k < KEYS; ++k) {
+    keys__[k] = false;
+  }
+}
+
+/* Levels of a balanced tree of `n` keys are at most `factor / 2` times log2(n + 1). */
+static bool
+__balanced(OrdTree_T tree, size_t factor)
+{
+  size_t levels = 0;
+
+  while (((size_t)1 << levels) <= OrdTree_length(tree)) {
+    levels++;
+  }
+
+  return 2 * OrdTree_height(tree) <= factor * levels + 2;
+}
+
+/* Same keys as `keys`, in order, with their values and ranks. */
+static bool
+__same(OrdTree_T tree, const bool* keys, balance_et balance)
+{
+  size_t expected = 0;
+
+  for (size_t k = 0; k < KEYS; ++k) {
+    Object_T value = NULL;
+
+    if (OrdTree_get(tree, (int64_t)k, &value) != keys[k])
+    { return false; }
+
+    if (keys[k]) {
+      int64_t key = -1;
+
+      if (value != __value((int64_t)k) || OrdTree_rank(tree, (int64_t)k) != expected)
+      { return false; }
+
+      if (!OrdTree_select(tree, expected, &key, &value) || key != (int64_t)k)
+      { return false; }
+
+      expected++;
+    }
+  }
+
+  return OrdTree_length(tree) == expected
+         && !OrdTree_select(tree, expected, NULL, NULL)
+         && __balanced(tree, (balance == RED_BLACK) ? 4 : 3);
+}
+
+/* Calls both, to go through the forking code in one thread. */
+static size_t forks;
+
+static void
+__fork(void (*first_fn)(void*), void* first_arg, void (*second_fn)(void*), void* second_arg)
+{
+  forks++;
+  first_fn(first_arg);
+  second_fn(second_arg);
+}
+
+/* ______________________________________________________________________________ */
+
+TEST put_get_remove(balance_et balance)
+{
+  OrdTree_T tree = OrdTree_new(balance);
+  __clear(present);
+
+  ASSERT_EQ(0, OrdTree_length(tree));
+  ASSERT_EQ(0, OrdTree_height(tree));
+
+  for (size_t i = 0; i < 100000; ++i) {
+    const int64_t key = (int64_t)(__rand() % KEYS);
+
+    /* Grows to about two thirds and then shrinks to nothing. */
+    if (__rand() % 3 != 0 && i < 60000) {
+      ASSERT_EQ(!present[key], OrdTree_put(tree, key, __value(key)));
+      present[key] = true;
+
+    } else {
+      Object_T value = NULL;
+
+      ASSERT_EQ(present[key], OrdTree_remove(tree, key, &value));
+
+      if (present[key])
+      { ASSERT_EQ(__value(key), value); }
+
+      present[key] = false;
+    }
+
+    if (i % 10000 == 0)
+    { ASSERT(__same(tree, present, balance)); }
+  }
+
+  ASSERT(__same(tree, present, balance));
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    OrdTree_remove(tree, key, NULL);
+    present[key] = false;
+  }
+
+  ASSERT(__same(tree, present, balance));
+  ASSERT_EQ(0, OrdTree_height(tree));
+
+  OrdTree_free(&tree);
+  ASSERT_EQ(NULL, tree);
+  PASS();
+}
+
+TEST sequential(balance_et balance)
+{
+  OrdTree_T tree = OrdTree_new(balance);
+  __clear(present);
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    ASSERT(OrdTree_put(tree, key, __value(key)));
+    present[key] = true;
+  }
+
+  ASSERT(__same(tree, present, balance));
+
+  /* Replaces. */
+  ASSERT_FALSE(OrdTree_put(tree, 7, __value(7)));
+
+  for (int64_t key = KEYS - 1; key >= 0; key -= 2) {
+    ASSERT(OrdTree_remove(tree, key, NULL));
+    present[key] = false;
+  }
+
+  ASSERT(__same(tree, present, balance));
+
+  OrdTree_free(&tree);
+  PASS();
+}
+
+TEST order_statistics(balance_et balance)
+{
+  OrdTree_T tree = OrdTree_new(balance);
+
+  /* Multiples of 10 from 0 to 9990. */
+  for (int64_t key = 0; key < 10000; key += 10) {
+    OrdTree_put(tree, key, __value(key));
+  }
+
+  ASSERT_EQ(0, OrdTree_rank(tree, INT64_MIN));
+  ASSERT_EQ(0, OrdTree_rank(tree, 0));
+  ASSERT_EQ(1, OrdTree_rank(tree, 1));
+  ASSERT_EQ(500, OrdTree_rank(tree, 5000));
+  ASSERT_EQ(1000, OrdTree_rank(tree, INT64_MAX));
+
+  int64_t key = 0;
+  ASSERT(OrdTree_select(tree, 0, &key, NULL));
+  ASSERT_EQ(0, key);
+  ASSERT(OrdTree_select(tree, 999, &key, NULL));
+  ASSERT_EQ(9990, key);
+  ASSERT_FALSE(OrdTree_select(tree, 1000, &key, NULL));
+
+  ASSERT_EQ(1000, OrdTree_count(tree, INT64_MIN, INT64_MAX));
+  ASSERT_EQ(11, OrdTree_count(tree, 100, 200));
+  ASSERT_EQ(10, OrdTree_count(tree, 101, 200));
+  ASSERT_EQ(1, OrdTree_count(tree, 100, 100));
+  ASSERT_EQ(0, OrdTree_count(tree, 101, 109));
+  ASSERT_EQ(0, OrdTree_count(tree, 200, 100));
+
+  OrdTree_free(&tree);
+  PASS();
+}
+
+TEST load(balance_et balance)
+{
+  static int64_t keys[KEYS];
+  static Object_T values[KEYS];
+
+  for (size_t n = 0; n < KEYS / 2; n = 3 * n + 1) {
+    __clear(present);
+
+    /* Even keys, so puts land between them. */
+    for (size_t i = 0; i < n; ++i) {
+      keys[i] = (int64_t)(2 * i);
+      values[i] = __value(keys[i]);
+      present[2 * i] = true;
+    }
+
+    OrdTree_T tree = OrdTree_load(balance, keys, values, n);
+    ASSERT(__same(tree, present, balance));
+
+    for (size_t i = 0; i < n; ++i) {
+      OrdTree_put(tree, (int64_t)(2 * i + 1), __value((int64_t)(2 * i + 1)));
+      present[2 * i + 1] = true;
+    }
+
+    ASSERT(__same(tree, present, balance));
+
+    for (size_t i = 0; i < 2 * n; i += 3) {
+      OrdTree_remove(tree, (int64_t)i, NULL);
+      present[i] = false;
+    }
+
+    ASSERT(__same(tree, present, balance));
+    OrdTree_free(&tree);
+  }
+
+  PASS();
+}
+
+TEST split_join(balance_et balance)
+{
+  static bool lower[KEYS];
+  static bool upper[KEYS];
+
+  for (int64_t at = -1; at <= KEYS; at += KEYS / 7) {
+    OrdTree_T tree = OrdTree_new(balance);
+    __clear(lower);
+    __clear(upper);
+    __clear(present);
+
+    for (int64_t key = 0; key < KEYS; key += 1 + (int64_t)(__rand() % 3)) {
+      OrdTree_put(tree, key, __value(key));
+      present[key] = true;
+      ((key < at) ? lower : upper)[key] = true;
+    }
+
+    OrdTree_T greater = OrdTree_split(tree, at);
+    ASSERT(__same(tree, lower, balance));
+    ASSERT(__same(greater, upper, balance));
+
+    OrdTree_join(tree, &greater);
+    ASSERT_EQ(NULL, greater);
+    ASSERT(__same(tree, present, balance));
+
+    OrdTree_free(&tree);
+  }
+
+  PASS();
+}
+
+/* Unbalanced sizes too: the other tree has every `step`-th key of a range. */
+static OrdTree_T
+__set(balance_et balance, bool* keys__, int64_t from, int64_t to, int64_t step)
+{
+  OrdTree_T tree = OrdTree_new(balance);
+  __clear(keys__);
+
+  for (int64_t key = from; key < to; key += step) {
+    OrdTree_put(tree, key, __value(key));
+    keys__[key] = true;
+  }
+
+  return tree;
+}
+
+TEST sets(balance_et balance)
+{
+  static bool first[KEYS];
+  static bool second[KEYS];
+  static const int64_t steps[][2] = { { 2, 3 }, { 1, 97 }, { 5, 1 } };
+
+  for (size_t f = 0; f < 2; ++f) {
+    const fork_FN fork_fn = (f == 0) ? NULL : __fork;
+
+    for (size_t s = 0; s < ARRAY_SIZE(steps); ++s) {
+      OrdTree_T tree = __set(balance, first, 0, KEYS, steps[s][0]);
+      OrdTree_T other = __set(balance, second, KEYS / 4, KEYS, steps[s][1]);
+
+      OrdTree_union(tree, &other, fork_fn);
+      ASSERT_EQ(NULL, other);
+
+      for (size_t k = 0; k < KEYS; ++k) {
+        present[k] = first[k] || second[k];
+      }
+
+      ASSERT(__same(tree, present, balance));
+      OrdTree_free(&tree);
+
+      tree = __set(balance, first, 0, KEYS, steps[s][0]);
+      other = __set(balance, second, KEYS / 4, KEYS, steps[s][1]);
+
+      OrdTree_intersection(tree, &other, fork_fn);
+
+      for (size_t k = 0; k < KEYS; ++k) {
+        present[k] = first[k] && second[k];
+      }
+
+      ASSERT(__same(tree, present, balance));
+      OrdTree_free(&tree);
+
+      tree = __set(balance, first, 0, KEYS, steps[s][0]);
+      other = __set(balance, second, KEYS / 4, KEYS, steps[s][1]);
+
+      OrdTree_difference(tree, &other, fork_fn);
+
+      for (size_t k = 0; k < KEYS; ++k) {
+        present[k] = first[k] && !second[k];
+      }
+
+      ASSERT(__same(tree, present, balance));
+      OrdTree_free(&tree);
+    }
+  }
+
+  ASSERT(forks > 0);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST1(put_get_remove, HEIGHT_BALANCED);
+  RUN_TEST1(put_get_remove, RED_BLACK);
+  RUN_TEST1(sequential, HEIGHT_BALANCED);
+  RUN_TEST1(sequential, RED_BLACK);
+  RUN_TEST1(order_statistics, HEIGHT_BALANCED);
+  RUN_TEST1(order_statistics, RED_BLACK);
+  RUN_TEST1(load, HEIGHT_BALANCED);
+  RUN_TEST1(load, RED_BLACK);
+  RUN_TEST1(split_join, HEIGHT_BALANCED);
+  RUN_TEST1(split_join, RED_BLACK);
+  RUN_TEST1(sets, HEIGHT_BALANCED);
+  RUN_TEST1(sets, RED_BLACK);
+  GREATEST_MAIN_END();
+}
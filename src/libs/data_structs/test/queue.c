@@ -32,11 +32,46 @@ TEST length(void)
   PASS();
 }
 
+/* Head and tail go around the ring a few times while it grows. */
+TEST order(void)
+{
+  Queue_T queue = Queue_new();
+  Object_T data = NULL;
+  int added = 0;
+  int removed = 0;
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 7 * round + 5; ++i) {
+      Queue_add(queue, Test_elm(added++));
+    }
+
+    for (int i = 0; i < 5 * round + 3; ++i) {
+      ASSERT(Queue_remove(queue, &data));
+      ASSERT_EQ(removed++, VALUE(data));
+      FREE(data);
+    }
+
+    ASSERT_EQ((size_t)(added - removed), Queue_length(queue));
+  }
+
+  while (Queue_remove(queue, &data)) {
+    ASSERT_EQ(removed++, VALUE(data));
+    FREE(data);
+  }
+
+  ASSERT_EQ(added, removed);
+  ASSERT(Queue_is_empty(queue));
+
+  Queue_free(queue);
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(new_free);
   RUN_TEST(length);
+  RUN_TEST(order);
   GREATEST_MAIN_END();
 }
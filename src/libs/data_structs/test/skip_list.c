@@ -0,0 +1,329 @@
+#include "data_structs/skip_list.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/memory.h"
+
+#define KEYS  20000
+
+static bool present[KEYS];
+
+static uint64_t
+__rand(uint64_t* p_seed)
+{
+  uint64_t x = *p_seed;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *p_seed = x;
+
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+static Object_T
+__value(int64_t key)
+{
+  return (Object_T)(intptr_t)(2 * key + 1);
+}
+
+typedef struct {
+  int64_t previous;
+  size_t count;
+  bool in_order;
+} walk_t;
+
+static bool
+__walk(int64_t key, Object_T value, void* arg)
+{
+  walk_t* walk = arg;
+
+  walk->in_order = walk->in_order && (walk->count == 0 || key > walk->previous)
+                   && value == __value(key);
+  walk->previous = key;
+  walk->count++;
+
+  return true;
+}
+
+/* Same keys as `present`, in order, with their values. */
+static bool
+__same(SkipList_T list)
+{
+  size_t expected = 0;
+
+  for (size_t k = 0; k < KEYS; ++k) {
+    Object_T value = NULL;
+
+    if (SkipList_get(list, (int64_t)k, &value) != present[k])
+    { return false; }
+
+    if (present[k] && value != __value((int64_t)k))
+    { return false; }
+
+    expected += present[k];
+  }
+
+  walk_t walk = { 0, 0, true };
+  SkipList_range(list, INT64_MIN, INT64_MAX, __walk, &walk);
+
+  return walk.in_order && walk.count == expected && SkipList_length(list) == expected;
+}
+
+/* ______________________________________________________________________________ */
+
+TEST put_get_remove(void)
+{
+  SkipList_T list = SkipList_new();
+  uint64_t seed = 88172645463325252ULL;
+  ASSERT_EQ(0, SkipList_length(list));
+
+  for (size_t i = 0; i < 100000; ++i) {
+    const int64_t key = (int64_t)(__rand(&seed) % KEYS);
+
+    /* Grows to about two thirds and then shrinks to nothing. */
+    if (__rand(&seed) % 3 != 0 && i < 60000) {
+      ASSERT_EQ(!present[key], SkipList_put(list, key, __value(key)));
+      present[key] = true;
+
+    } else {
+      Object_T value = NULL;
+
+      ASSERT_EQ(present[key], SkipList_remove(list, key, &value));
+
+      if (present[key])
+      { ASSERT_EQ(__value(key), value); }
+
+      present[key] = false;
+    }
+
+    if (i % 10000 == 0)
+    { ASSERT(__same(list)); }
+  }
+
+  ASSERT(__same(list));
+
+  for (int64_t key = 0; key < KEYS; ++key) {
+    SkipList_remove(list, key, NULL);
+    present[key] = false;
+  }
+
+  ASSERT(__same(list));
+
+  SkipList_free(&list);
+  ASSERT_EQ(NULL, list);
+  PASS();
+}
+
+TEST extremes(void)
+{
+  SkipList_T list = SkipList_new();
+  Object_T value = NULL;
+
+  ASSERT_FALSE(SkipList_get(list, INT64_MAX, &value));
+  ASSERT_FALSE(SkipList_remove(list, INT64_MIN, &value));
+
+  for (int64_t key = 0; key < 100; ++key) {
+    SkipList_put(list, INT64_MAX - key, __value(1));
+    SkipList_put(list, INT64_MIN + key, __value(2));
+  }
+
+  ASSERT_EQ(200, SkipList_length(list));
+  ASSERT(SkipList_get(list, INT64_MAX, &value));
+  ASSERT_EQ(__value(1), value);
+  ASSERT(SkipList_get(list, INT64_MIN, &value));
+  ASSERT_EQ(__value(2), value);
+  ASSERT_FALSE(SkipList_get(list, 0, &value));
+
+  /* Replaces. */
+  ASSERT_FALSE(SkipList_put(list, INT64_MIN, __value(3)));
+  ASSERT(SkipList_get(list, INT64_MIN, &value));
+  ASSERT_EQ(__value(3), value);
+
+  ASSERT(SkipList_remove(list, INT64_MAX, NULL));
+  ASSERT_FALSE(SkipList_get(list, INT64_MAX, &value));
+  ASSERT(SkipList_get(list, INT64_MAX - 1, &value));
+
+  SkipList_free(&list);
+  PASS();
+}
+
+static bool
+__first_ten(int64_t key, Object_T value, void* arg)
+{
+  walk_t* walk = arg;
+  __walk(key, value, arg);
+
+  return walk->count < 10;
+}
+
+TEST range(void)
+{
+  SkipList_T list = SkipList_new();
+
+  for (int64_t i = KEYS - 1; i >= 0; --i) {
+    SkipList_put(list, 10 * i, __value(10 * i));
+  }
+
+  walk_t walk = { 0, 0, true };
+
+  /* From 1000 to 5000, inclusive. */
+  ASSERT_EQ(401, SkipList_range(list, 995, 5000, __walk, &walk));
+  ASSERT(walk.in_order);
+  ASSERT_EQ(5000, walk.previous);
+  ASSERT_EQ(0, SkipList_range(list, 11, 19, __walk, &walk));
+
+  walk = (walk_t) { 0, 0, true };
+  ASSERT_EQ(10, SkipList_range(list, 0, INT64_MAX, __first_ten, &walk));
+  ASSERT_EQ(90, walk.previous);
+
+  SkipList_free(&list);
+  PASS();
+}
+
+static void
+__free_int(void* p_i)
+{
+  FREE(p_i);
+}
+
+TEST destroy(void)
+{
+  SkipList_T list = SkipList_new();
+
+  for (int64_t key = 0; key < 1000; ++key) {
+    int64_t* p_key;
+    NEW(p_key);
+    *p_key = key;
+
+    SkipList_put(list, key * 7919 % 1000, (Object_T)p_key);
+  }
+
+  SkipList_destroy(&list, __free_int);
+  ASSERT_EQ(NULL, list);
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+#define THREADS     4
+#define OPERATIONS  200000
+
+/* Contended by all threads, after the owned keys. */
+#define SHARED      16
+
+typedef struct {
+  SkipList_T list;
+  size_t id;
+  bool correct;
+} worker_t;
+
+/*
+ * Worker `id` owns keys `k % THREADS == id`, so `present` of them is exact.
+ * Other keys are only read, and shared keys are put and removed by all.
+ */
+static void*
+__work(void* arg)
+{
+  worker_t* worker = arg;
+  uint64_t seed = 88172645463325252ULL + worker->id;
+  Object_T value = NULL;
+
+  for (size_t i = 0; i < OPERATIONS; ++i) {
+    const uint64_t r = __rand(&seed);
+    const int64_t own = (int64_t)((r >> 8) % (KEYS / THREADS) * THREADS + worker->id);
+    const int64_t any = (int64_t)((r >> 24) % (KEYS + SHARED));
+
+    switch (r % 8) {
+    case 0:
+    case 1:
+      if (SkipList_put(worker->list, own, __value(own)) == present[own])
+      { worker->correct = false; }
+
+      present[own] = true;
+      break;
+
+    case 2:
+      if (SkipList_remove(worker->list, own, &value) != present[own]
+          || (present[own] && value != __value(own)))
+      { worker->correct = false; }
+
+      present[own] = false;
+      break;
+
+    case 3:
+      SkipList_put(worker->list, KEYS + (int64_t)(r >> 40) % SHARED,
+                   __value(KEYS + (int64_t)(r >> 40) % SHARED));
+      break;
+
+    case 4:
+      SkipList_remove(worker->list, KEYS + (int64_t)(r >> 40) % SHARED, NULL);
+      break;
+
+    case 5: {
+      walk_t walk = { 0, 0, true };
+      SkipList_range(worker->list, any, any + 64, __walk, &walk);
+
+      if (!walk.in_order)
+      { worker->correct = false; }
+
+      break;
+    }
+
+    default:
+      if (SkipList_get(worker->list, own, &value) != present[own])
+      { worker->correct = false; }
+
+      if (SkipList_get(worker->list, any, &value) && value != __value(any))
+      { worker->correct = false; }
+
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+TEST threads(void)
+{
+  SkipList_T list = SkipList_new();
+  pthread_t threads[THREADS];
+  worker_t workers[THREADS];
+
+  for (size_t k = 0; k < KEYS; ++k) {
+    present[k] = false;
+  }
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    workers[t] = (worker_t) { list, t, true };
+    pthread_create(&threads[t], NULL, __work, &workers[t]);
+  }
+
+  for (size_t t = 0; t < THREADS; ++t) {
+    pthread_join(threads[t], NULL);
+    ASSERT(workers[t].correct);
+  }
+
+  /* Drop shared keys, then the rest is exactly `present`. */
+  for (int64_t key = KEYS; key < KEYS + SHARED; ++key) {
+    SkipList_remove(list, key, NULL);
+  }
+
+  ASSERT(__same(list));
+
+  SkipList_free(&list);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(put_get_remove);
+  RUN_TEST(extremes);
+  RUN_TEST(range);
+  RUN_TEST(destroy);
+  RUN_TEST(threads);
+  GREATEST_MAIN_END();
+}
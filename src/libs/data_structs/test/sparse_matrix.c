@@ -1,5 +1,6 @@
 #include "data_structs/sparse_matrix.h"
 
+#include <stdint.h>
 #include <greatest.h>
 #include "lang/memory.h"
 
@@ -32,6 +33,12 @@ matrix_get_int(Matrix_T* p_matrix, int row, int col, int* p_value__)
      *p_value__ = *p_i;
 }
 
+static void
+__free_int(void* p_i)
+{
+  FREE(p_i);
+}
+
 /* ______________________________________________________________________________ */
 
 TEST simple_test(void)
@@ -46,6 +53,179 @@ TEST simple_test(void)
 
   ASSERT_EQ(value, saved);
 
+  Matrix_destroy(&matrix, __free_int);
+  ASSERT_EQ(NULL, matrix);
+  PASS();
+}
+
+/* Element `idx` of `values` keeps `idx`, its value is in the array. */
+static double
+__value(Object_T data)
+{
+  return *(double*)data;
+}
+
+static uint64_t seed = 42;
+
+static int
+__rand(int limit)
+{
+  seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (int)((seed >> 33) % (uint64_t)limit);
+}
+
+/* Random puts and clears, compared with a dense matrix. */
+TEST put_get_clear(void)
+{
+  enum { ROWS = 60, COLS = 70, ROUNDS = 20000 };
+
+  static double values[ROWS][COLS];
+  static bool used[ROWS][COLS];
+
+  Matrix_T matrix = Matrix_new();
+  size_t length = 0;
+
+  for (int i = 0; i < ROUNDS; ++i) {
+    const int row = __rand(ROWS);
+    const int col = __rand(COLS);
+
+    if (__rand(3) == 0) {
+      ASSERT_EQ(used[row][col], Matrix_clear(&matrix, row, col));
+
+      if (used[row][col])
+      { length--; }
+
+      used[row][col] = false;
+    } else {
+      Matrix_put(&matrix, row, col, (Object_T)&values[row][col]);
+
+      if (!used[row][col])
+      { length++; }
+
+      used[row][col] = true;
+    }
+  }
+
+  ASSERT_EQ(length, Matrix_length(matrix));
+
+  for (int row = 0; row < ROWS; ++row) {
+    for (int col = 0; col < COLS; ++col) {
+      Object_T data = NULL;
+
+      ASSERT_EQ(used[row][col], Matrix_get(&matrix, row, col, &data));
+
+      if (used[row][col])
+      { ASSERT_EQ((Object_T)&values[row][col], data); }
+    }
+  }
+
+  Matrix_free(&matrix);
+  PASS();
+}
+
+/*
+ *  | 1 0 2 |
+ *  | 0 0 0 |
+ *  | 0 3 4 |
+ *  | 5 0 0 |
+ */
+TEST compress(void)
+{
+  static double values[] = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+  static const int positions[][2] = { { 2, 2 }, { 0, 2 }, { 3, 0 }, { 0, 0 }, { 2, 1 } };
+  static const int value_idx[] = { 3, 1, 4, 0, 2 };
+
+  Matrix_T matrix = Matrix_new();
+
+  for (int i = 0; i < 5; ++i) {
+    Matrix_put(&matrix, positions[i][0], positions[i][1], (Object_T)&values[value_idx[i]]);
+  }
+
+  CompressedMatrix_T csr = Matrix_compress(matrix, BY_ROWS, __value);
+  CompressedMatrix_T csc = Matrix_compress(matrix, BY_COLUMNS, __value);
+
+  size_t rows, cols, nonzeros;
+  CompressedMatrix_size(csr, &rows, &cols, &nonzeros);
+
+  ASSERT_EQ(4, rows);
+  ASSERT_EQ(3, cols);
+  ASSERT_EQ(5, nonzeros);
+
+  const int* indexes;
+  const double* line;
+
+  ASSERT_EQ(2, CompressedMatrix_line(csr, 0, &indexes, &line));
+  ASSERT_EQ(0, indexes[0]);
+  ASSERT_EQ(2, indexes[1]);
+  ASSERT_EQ(2.0, line[1]);
+  ASSERT_EQ(0, CompressedMatrix_line(csr, 1, &indexes, &line));
+
+  ASSERT_EQ(2, CompressedMatrix_line(csc, 0, &indexes, &line));
+  ASSERT_EQ(0, indexes[0]);
+  ASSERT_EQ(3, indexes[1]);
+  ASSERT_EQ(5.0, line[1]);
+  ASSERT_EQ(1, CompressedMatrix_line(csc, 1, &indexes, &line));
+  ASSERT_EQ(2, indexes[0]);
+
+  const double x[3] = { 1.0, 10.0, 100.0 };
+  const double expected[4] = { 201.0, 0.0, 430.0, 5.0 };
+  double y[4];
+
+  CompressedMatrix_multiply(csr, x, y);
+  ASSERT_MEM_EQ(expected, y, sizeof (y));
+
+  CompressedMatrix_multiply(csc, x, y);
+  ASSERT_MEM_EQ(expected, y, sizeof (y));
+
+  CompressedMatrix_free(&csc);
+  CompressedMatrix_free(&csr);
+  Matrix_free(&matrix);
+  PASS();
+}
+
+/* Rows longer than one step of four, against a plain loop. */
+TEST multiply(void)
+{
+  enum { ROWS = 300, COLS = 500, NONZEROS = 20000 };
+
+  static double values[NONZEROS];
+  double x[COLS], y[ROWS], y_csc[ROWS], expected[ROWS] = { 0.0 };
+
+  Matrix_T matrix = Matrix_new();
+  Matrix_reserve(&matrix, NONZEROS);
+
+  for (int i = 0; i < COLS; ++i) {
+    x[i] = (double)__rand(1000) / 8.0;
+  }
+
+  for (int i = 0; i < NONZEROS; ++i) {
+    const int row = __rand(ROWS);
+    const int col = __rand(COLS);
+    Object_T old;
+
+    if (Matrix_get(&matrix, row, col, &old))
+    { expected[row] -= *(double*)old * x[col]; }
+
+    values[i] = (double)(__rand(100) - 50) / 4.0;
+    Matrix_put(&matrix, row, col, (Object_T)&values[i]);
+    expected[row] += values[i] * x[col];
+  }
+
+  CompressedMatrix_T csr = Matrix_compress(matrix, BY_ROWS, __value);
+  CompressedMatrix_T csc = Matrix_compress(matrix, BY_COLUMNS, __value);
+
+  CompressedMatrix_multiply(csr, x, y);
+  CompressedMatrix_multiply(csc, x, y_csc);
+
+  /* Values are exact in binary, sums are too. */
+  for (int row = 0; row < ROWS; ++row) {
+    ASSERT_EQ(expected[row], y[row]);
+    ASSERT_EQ(expected[row], y_csc[row]);
+  }
+
+  CompressedMatrix_free(&csc);
+  CompressedMatrix_free(&csr);
+  Matrix_free(&matrix);
   PASS();
 }
 
@@ -54,5 +234,8 @@ int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(simple_test);
+  RUN_TEST(put_get_clear);
+  RUN_TEST(compress);
+  RUN_TEST(multiply);
   GREATEST_MAIN_END();
 }
@@ -0,0 +1,173 @@
+#include "data_structs/ws_deque.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/memory.h"
+
+#define ELEMENT(i)  ((Object_T)(uintptr_t)((i) + 1))
+#define NUMBER(e)   ((size_t)(uintptr_t)(e) - 1)
+
+TEST pop_and_steal(void)
+{
+  WSDeque_T deque = WSDeque_new(1);
+  Object_T data = NULL;
+
+  ASSERT_FALSE(WSDeque_pop(deque, &data));
+  ASSERT_FALSE(WSDeque_steal(deque, &data));
+
+  /* Grows a few times. */
+  for (size_t i = 0; i < 100; ++i) {
+    WSDeque_push(deque, ELEMENT(i));
+  }
+
+  ASSERT_EQ(100, WSDeque_length(deque));
+
+  /* Owner takes the newest, thieves the oldest. */
+  for (size_t i = 0; i < 50; ++i) {
+    ASSERT(WSDeque_pop(deque, &data));
+    ASSERT_EQ(99 - i, NUMBER(data));
+
+    ASSERT(WSDeque_steal(deque, &data));
+    ASSERT_EQ(i, NUMBER(data));
+  }
+
+  ASSERT_EQ(0, WSDeque_length(deque));
+  ASSERT_FALSE(WSDeque_pop(deque, &data));
+  ASSERT_FALSE(WSDeque_steal(deque, &data));
+
+  /* Still works after it was emptied. */
+  WSDeque_push(deque, ELEMENT(7));
+  ASSERT(WSDeque_steal(deque, &data));
+  ASSERT_EQ(7, NUMBER(data));
+
+  WSDeque_free(&deque);
+  ASSERT_EQ(NULL, deque);
+  PASS();
+}
+
+static void
+__free_element(void* data)
+{
+  FREE(data);
+}
+
+TEST destroy(void)
+{
+  WSDeque_T deque = WSDeque_new(2);
+
+  for (int i = 0; i < 5; ++i) {
+    int* p_i = ALLOC(sizeof (int));
+    WSDeque_push(deque, (Object_T)p_i);
+  }
+
+  WSDeque_destroy(&deque, __free_element);
+  ASSERT_EQ(NULL, deque);
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+#define THIEVES   3
+#define ELEMENTS  200000
+
+typedef struct {
+  WSDeque_T deque;
+  atomic_bool* seen;
+  atomic_bool done;
+  _Atomic size_t taken;
+  atomic_bool twice;
+} shared_t;
+
+static void
+__take(shared_t* shared, Object_T data)
+{
+  if (atomic_exchange(&shared->seen[NUMBER(data)], true))
+  { atomic_store(&shared->twice, true); }
+
+  atomic_fetch_add(&shared->taken, 1);
+}
+
+static void*
+__steal(void* arg)
+{
+  shared_t* shared = arg;
+  Object_T data = NULL;
+
+  while (!atomic_load(&shared->done)) {
+    if (WSDeque_steal(shared->deque, &data))
+    { __take(shared, data); }
+  }
+
+  return NULL;
+}
+
+TEST threads(void)
+{
+  shared_t shared;
+  Object_T data = NULL;
+
+  shared.deque = WSDeque_new(4);
+  shared.seen = ALLOC(ELEMENTS * sizeof (atomic_bool));
+  atomic_init(&shared.done, false);
+  atomic_init(&shared.taken, 0);
+  atomic_init(&shared.twice, false);
+
+  for (size_t i = 0; i < ELEMENTS; ++i) {
+    atomic_init(&shared.seen[i], false);
+  }
+
+  pthread_t thieves[THIEVES];
+
+  for (size_t t = 0; t < THIEVES; ++t) {
+    pthread_create(&thieves[t], NULL, __steal, &shared);
+  }
+
+  /* Pushes in growing bursts and pops a part of each. */
+  size_t pushed = 0;
+
+  for (size_t burst = 1; pushed < ELEMENTS; burst = burst % 64 + 1) {
+    for (size_t i = 0; i < burst && pushed < ELEMENTS; ++i) {
+      WSDeque_push(shared.deque, ELEMENT(pushed++));
+    }
+
+    for (size_t i = 0; i < burst / 2; ++i) {
+      if (WSDeque_pop(shared.deque, &data))
+      { __take(&shared, data); }
+    }
+  }
+
+  while (WSDeque_pop(shared.deque, &data)) {
+    __take(&shared, data);
+  }
+
+  /* Thieves finish the steal they are in. */
+  atomic_store(&shared.done, true);
+
+  for (size_t t = 0; t < THIEVES; ++t) {
+    pthread_join(thieves[t], NULL);
+  }
+
+  ASSERT_FALSE(atomic_load(&shared.twice));
+  ASSERT_EQ(ELEMENTS, atomic_load(&shared.taken));
+
+  for (size_t i = 0; i < ELEMENTS; ++i) {
+    ASSERT(atomic_load(&shared.seen[i]));
+  }
+
+  FREE(shared.seen);
+  WSDeque_free(&shared.deque);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(pop_and_steal);
+  RUN_TEST(destroy);
+  RUN_TEST(threads);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,211 @@
+/**
+ * @file     ws_deque.c
+ * @brief    Chase-Lev deque with C11 atomics, after Le, Pop, Cohen and
+ *           Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak
+ *           Memory Models" (2013).
+ *
+ * `top` and `bottom` only grow and are masked to index the ring, the deque
+ * holds `bottom ... top - 1`. The owner moves `top` both ways, thieves move
+ * `bottom` up with compare and swap.
+ *
+ * `pop` first lowers `top` and then reads `bottom`, `steal` reads `bottom`
+ * and then `top`. Both orders are sequentially consistent, so the owner and
+ * a thief can not both miss each other: when they want the same element
+ * both go for `bottom` with compare and swap and only one wins.
+ */
+#include "data_structs/ws_deque.h"
+
+#include <stdatomic.h>   /* atomic_* */
+#include <stdint.h>      /* int64_t  */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+#define CACHE_LINE  64
+
+/* ______________________________________________________________________________ */
+/*                                                                        Locals  */
+
+struct ring {
+  size_t mask;                 /* Size is power of two. */
+  struct ring* previous;       /* Replaced by this one. */
+  _Atomic(Object_T) items[];
+};
+
+/* Owner and thieves do not share cache lines. */
+struct ws_deque {
+  _Alignas(CACHE_LINE) _Atomic int64_t top;
+  _Alignas(CACHE_LINE) _Atomic int64_t bottom;
+  _Alignas(CACHE_LINE) _Atomic(struct ring*) ring;
+};
+
+#define SLOT(p_ring, idx)  (&(p_ring)->items[(size_t)(idx) & (p_ring)->mask])
+
+static struct ring*
+__ring_new(size_t size)
+{
+  struct ring* ring = ALLOC(sizeof (struct ring) + size * sizeof (Object_T));
+
+  ring->mask = size - 1;
+  ring->previous = NULL;
+
+  return ring;
+}
+
+/* Copy `bottom ... top - 1` to a ring twice as big and publish it. */
+static struct ring*
+__grow(WSDeque_T deque, struct ring* old, int64_t bottom, int64_t top)
+{
+  struct ring* ring = __ring_new(2 * (old->mask + 1));
+
+  for (int64_t i = bottom; i < top; ++i) {
+    atomic_store_explicit(SLOT(ring, i),
+                          atomic_load_explicit(SLOT(old, i), memory_order_relaxed),
+                          memory_order_relaxed);
+  }
+
+  ring->previous = old;
+  atomic_store_explicit(&deque->ring, ring, memory_order_release);
+
+  return ring;
+}
+
+/* ______________________________________________________________________________ */
+
+WSDeque_T
+WSDeque_new(unsigned initial_size)
+{
+  Require(initial_size > 0);
+
+  size_t size = 2;
+
+  while (size < initial_size) {
+    size *= 2;
+  }
+
+  WSDeque_T deque = ALLOC_ALIGNED(CACHE_LINE, sizeof (*deque));
+
+  atomic_init(&deque->top, 0);
+  atomic_init(&deque->bottom, 0);
+  atomic_init(&deque->ring, __ring_new(size));
+
+  return deque;
+}
+
+size_t
+WSDeque_length(WSDeque_T deque)
+{
+  Require(deque);
+
+  const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+  const int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+  return (top > bottom) ? (size_t)(top - bottom) : 0;
+}
+
+void
+WSDeque_push(WSDeque_T deque, Object_T data)
+{
+  Require(deque);
+
+  const int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+  const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+  struct ring* ring = atomic_load_explicit(&deque->ring, memory_order_relaxed);
+
+  if (top - bottom > (int64_t)ring->mask)
+  { ring = __grow(deque, ring, bottom, top); }
+
+  atomic_store_explicit(SLOT(ring, top), data, memory_order_relaxed);
+
+  /* Thieves that see the new `top` see the element. */
+  atomic_store_explicit(&deque->top, top + 1, memory_order_release);
+}
+
+bool
+WSDeque_pop(WSDeque_T deque, Object_T* p_data__)
+{
+  Require(deque);
+  Require(p_data__);
+
+  const int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed) - 1;
+  struct ring* ring = atomic_load_explicit(&deque->ring, memory_order_relaxed);
+
+  atomic_store_explicit(&deque->top, top, memory_order_seq_cst);
+  int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_seq_cst);
+
+  if (bottom > top) {
+    atomic_store_explicit(&deque->top, top + 1, memory_order_relaxed);
+    return false;
+  }
+
+  *p_data__ = atomic_load_explicit(SLOT(ring, top), memory_order_relaxed);
+
+  if (bottom < top)
+  { return true; }
+
+  /* The last element, thieves could want it too. */
+  const bool taken = atomic_compare_exchange_strong_explicit(&deque->bottom, &bottom, bottom + 1,
+                                                             memory_order_seq_cst,
+                                                             memory_order_relaxed);
+  atomic_store_explicit(&deque->top, top + 1, memory_order_relaxed);
+
+  return taken;
+}
+
+bool
+WSDeque_steal(WSDeque_T deque, Object_T* p_data__)
+{
+  Require(deque);
+  Require(p_data__);
+
+  int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_seq_cst);
+  const int64_t top = atomic_load_explicit(&deque->top, memory_order_seq_cst);
+
+  if (bottom >= top)
+  { return false; }
+
+  struct ring* ring = atomic_load_explicit(&deque->ring, memory_order_acquire);
+  Object_T data = atomic_load_explicit(SLOT(ring, bottom), memory_order_relaxed);
+
+  /* Owner popped it or another thief stole it. */
+  if (!atomic_compare_exchange_strong_explicit(&deque->bottom, &bottom, bottom + 1,
+                                               memory_order_seq_cst, memory_order_relaxed))
+  { return false; }
+
+  *p_data__ = data;
+  return true;
+}
+
+void
+WSDeque_destroy(WSDeque_T* p_deque, free_data_FN free_data_fn)
+{
+  Require(p_deque);
+
+  WSDeque_T deque = *p_deque;
+
+  if (deque == NULL)
+  { return; }
+
+  Object_T stale_out;
+
+  while (WSDeque_pop(deque, &stale_out)) {
+    if (free_data_fn != NULL)
+    { free_data_fn(stale_out); }
+  }
+
+  struct ring* ring = atomic_load_explicit(&deque->ring, memory_order_relaxed);
+
+  while (ring != NULL) {
+    struct ring* previous = ring->previous;
+    FREE(ring);
+    ring = previous;
+  }
+
+  FREE_ALIGNED(deque);
+  *p_deque = NULL;
+}
+
+void
+WSDeque_free(WSDeque_T* p_deque)
+{
+  WSDeque_destroy(p_deque, NULL);
+}
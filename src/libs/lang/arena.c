@@ -1,22 +1,65 @@
+/**
+ * @file     arena.c
+ * @brief    Arena allocator.
+ *
+ * Chunks of disposed arenas are kept for reuse. Each thread has its own pool
+ * of them, so recycling takes no lock. A thread with a full pool passes the
+ * chunks to a bounded global pool split into shards with their own lock.
+ * Threads take chunks back from their shard when their pool is empty. Pools
+ * of finished threads go to the shards too.
+ */
 #include "lang/arena.h"
 
-#include <stdlib.h>      /* malloc, free */
-#include <string.h>      /* memset       */
+#include <pthread.h>     /* pthread_mutex_*, pthread_key_* */
+#include <stdatomic.h>   /* atomic_fetch_add               */
+#include <stdlib.h>      /* malloc, free                   */
+#include <string.h>      /* memset                         */
 #include "lang/assert.h"
 
 /* Initialize exceptions */
 const Except_T Arena_NewFailed = { "Arena creation failed" };
 const Except_T Arena_Failed = { "Arena allocation failed" };
 
-#define THRESHOLD 10
+/* Free chunks kept by a thread, and by a shard of the global pool. */
+#define THRESHOLD       10
+#define SHARD_THRESHOLD 4
+#define NSHARDS         8
+
+/* First chunk of an arena. Every next one is twice bigger up to `MAX_CHUNK`. */
+#define MIN_CHUNK (10 * 1024)
+#define MAX_CHUNK (1024 * 1024)
 
 /* __________________________________________________________________________ */
 /*                                                                     Local  */
 
+/*
+ * Placed at the beginning of every chunk. Keeps the state of the arena before
+ * the chunk was taken, so chunks form a stack. Large blocks use it too, they
+ * are linked through `prev` and `limit` marks their end.
+ */
+struct chunk {
+  struct chunk* prev;
+  char* avail;
+  char* limit;
+};
+
 struct arena {
-  struct arena* prev;
+  struct chunk* prev;   /* Current chunk. */
   char* avail;
   char* limit;
+
+  struct chunk* large;  /* Blocks allocated outside of chunks. */
+  size_t chunk_size;    /* Size of the next chunk taken from the system. */
+
+  Arena_Stats stats;
+};
+
+/* Arena state when the mark was taken. */
+struct arena_mark {
+  struct chunk* prev;
+  char* avail;
+  struct chunk* large;
+  size_t used;
 };
 
 union align {
@@ -31,13 +74,237 @@ union align {
 };
 
 union header {
-  struct arean* b;
+  struct chunk c;
   union align a;
 };
 
-static Arena_T freechunks;
+/* Chunks ready for reuse, linked through `prev`. `limit` is the end of each. */
+struct pool {
+  struct chunk* freechunks;
+  int nfree;
+};
+
+static _Thread_local struct pool local_pool;
+
+static struct {
+  pthread_mutex_t lock;
+  struct pool pool;
+} shards[NSHARDS];
+
+/* Shard of the thread plus one. Zero until the thread needs the shards. */
+static _Thread_local unsigned local_shard;
+static atomic_uint next_shard;
+
+static pthread_key_t pool_key;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static void
+__fail(const char* file, int line)
+{
+  if (file == NULL)
+  { THROW(Arena_Failed); }
+  else
+  { Except_throw(&Arena_Failed, file, line); }
+}
+
+static struct chunk*
+__pool_take(struct pool* pool)
+{
+  struct chunk* chunk = pool->freechunks;
+
+  if (chunk != NULL) {
+    pool->freechunks = chunk->prev;
+    pool->nfree--;
+  }
+
+  return chunk;
+}
+
+static void
+__pool_put(struct pool* pool, struct chunk* chunk)
+{
+  chunk->prev = pool->freechunks;
+  pool->freechunks = chunk;
+  pool->nfree++;
+}
+
+/* Give chunk to the shard of the thread or to the system if the shard is full. */
+static void
+__shard_put(unsigned shard, struct chunk* chunk)
+{
+  pthread_mutex_lock(&shards[shard].lock);
+
+  if (shards[shard].pool.nfree < SHARD_THRESHOLD) {
+    __pool_put(&shards[shard].pool, chunk);
+    chunk = NULL;
+  }
+
+  pthread_mutex_unlock(&shards[shard].lock);
+
+  free(chunk);
+}
+
+/* Runs when a thread that recycled chunks finishes. */
+static void
+__pool_exit(void* pool)
+{
+  struct chunk* chunk;
+
+  while ((chunk = __pool_take(pool)) != NULL) {
+    __shard_put(local_shard - 1, chunk);
+  }
+}
+
+static void
+__pool_init(void)
+{
+  for (int i = 0; i < NSHARDS; ++i) {
+    pthread_mutex_init(&shards[i].lock, NULL);
+  }
+
+  pthread_key_create(&pool_key, __pool_exit);
+}
+
+/* Slow path, once per thread: pick a shard and register the exit cleanup. */
+static unsigned
+__shard(void)
+{
+  if (local_shard == 0) {
+    pthread_once(&pool_once, __pool_init);
+    pthread_setspecific(pool_key, &local_pool);
+
+    local_shard = atomic_fetch_add(&next_shard, 1) % NSHARDS + 1;
+  }
+
+  return local_shard - 1;
+}
+
+/* Starts from the shard of the thread and looks at the others too. */
+static struct chunk*
+__shard_take(void)
+{
+  const unsigned first = __shard();
+  struct chunk* chunk = NULL;
+
+  for (unsigned i = 0; i < NSHARDS && chunk == NULL; ++i) {
+    const unsigned shard = (first + i) % NSHARDS;
+
+    pthread_mutex_lock(&shards[shard].lock);
+    chunk = __pool_take(&shards[shard].pool);
+    pthread_mutex_unlock(&shards[shard].lock);
+  }
+
+  return chunk;
+}
+
+static void*
+__large_alloc(Arena_T arena, size_t nbytes, const char* file, int line)
+{
+  const size_t size = sizeof (union header) + nbytes;
+  struct chunk* block = malloc(size);
+
+  if (block == NULL)
+  { __fail(file, line); }
+
+  block->prev  = arena->large;
+  block->avail = NULL;
+  block->limit = (char*)block + size;
+
+  arena->large = block;
+
+  arena->stats.large++;
+  arena->stats.reserved += size;
+
+  return (union header*)block + 1;
+}
+
+static void
+__large_free(Arena_T arena)
+{
+  struct chunk* block = arena->large;
+
+  arena->large = block->prev;
+
+  arena->stats.large--;
+  arena->stats.reserved -= (size_t)(block->limit - (char*)block);
+
+  free(block);
+}
+
+static struct chunk*
+__chunk_get(Arena_T arena, size_t nbytes, const char* file, int line)
+{
+  struct chunk* chunk = __pool_take(&local_pool);
+
+  if (chunk == NULL)
+  { chunk = __shard_take(); }
+
+  if (chunk != NULL) {
+
+    if ((size_t)(chunk->limit - (char*)chunk) >= sizeof (union header) + nbytes)
+    { return chunk; }
+
+    free(chunk);
+  }
+
+  /* A chunk holds at least four blocks that are not large. */
+  const size_t size = arena->chunk_size;
+  chunk = malloc(size);
+
+  if (chunk == NULL)
+  { __fail(file, line); }
+
+  chunk->limit = (char*)chunk + size;
+
+  if (arena->chunk_size < MAX_CHUNK)
+  { arena->chunk_size *= 2; }
+
+  return chunk;
+}
+
+static void
+__chunk_push(Arena_T arena, struct chunk* chunk)
+{
+  char* limit = chunk->limit;
+
+  chunk->prev  = arena->prev;
+  chunk->avail = arena->avail;
+  chunk->limit = arena->limit;
+
+  arena->stats.waste += (size_t)(arena->limit - arena->avail);
+
+  arena->prev  = chunk;
+  arena->avail = (char*)((union header*)chunk + 1);
+  arena->limit = limit;
+
+  arena->stats.chunks++;
+  arena->stats.reserved += (size_t)(limit - (char*)chunk);
+}
+
+static void
+__chunk_pop(Arena_T arena)
+{
+  struct chunk* chunk = arena->prev;
+  struct chunk saved = *chunk;
 
-static int nfree;
+  arena->stats.chunks--;
+  arena->stats.reserved -= (size_t)(arena->limit - (char*)chunk);
+  arena->stats.waste -= (size_t)(saved.limit - saved.avail);
+
+  chunk->limit = arena->limit;
+
+  /* Also registers the exit cleanup of the local pool. */
+  const unsigned shard = __shard();
+
+  if (local_pool.nfree < THRESHOLD)
+  { __pool_put(&local_pool, chunk); }
+  else
+  { __shard_put(shard, chunk); }
+
+  arena->prev  = saved.prev;
+  arena->avail = saved.avail;
+  arena->limit = saved.limit;
+}
 
 /* __________________________________________________________________________ */
 
@@ -52,6 +319,11 @@ Arena_new(void)
   arena->prev = NULL;
   arena->limit = arena->avail = NULL;
 
+  arena->large = NULL;
+  arena->chunk_size = MIN_CHUNK;
+
+  memset(&arena->stats, '\0', sizeof (arena->stats));
+
   return arena;
 }
 
@@ -64,41 +336,21 @@ Arena_alloc(Arena_T arena, size_t nbytes, const char* file, int line)
   nbytes = ((nbytes + sizeof (union align) - 1) /
             (sizeof (union align))) * (sizeof (union align));
 
-  /* Current initial state. */
-  long space_left = arena->limit - arena->avail;
-
-  while (space_left > 0 && nbytes > (unsigned long)space_left) {
-    Arena_T ptr;
-    char* limit;
+  if (nbytes > (size_t)(arena->limit - arena->avail)) {
 
-    if ((ptr = freechunks) != NULL) {
-      freechunks = freechunks->prev;
-      nfree--;
-      limit = ptr->limit;
+    /* Does not waste the rest of the current chunk. */
+    if (nbytes > arena->chunk_size / 4) {
+      void* ptr = __large_alloc(arena, nbytes, file, line);
+      arena->stats.used += nbytes;
 
-    } else {
-      size_t m = sizeof (union header) + nbytes + 10 * 1024;
-      ptr = malloc(m);
-
-      if (ptr == NULL) {
-        if (file == NULL)
-        { THROW(Arena_Failed); }
-        else
-        { Except_throw(&Arena_Failed, file, line); }
-      }
-
-      limit = (char*)ptr + m;
+      return ptr;
     }
-    *ptr = *arena;
-
-    arena->avail = (char*)((union header*)ptr + 1);
-    arena->limit = limit;
-    arena->prev  = ptr;
 
-    space_left = arena->limit - arena->avail;
+    __chunk_push(arena, __chunk_get(arena, nbytes, file, line));
   }
 
   arena->avail += nbytes;
+  arena->stats.used += nbytes;
 
   return arena->avail - nbytes;
 }
@@ -130,22 +382,69 @@ Arena_free(Arena_T arena)
 {
   Require(arena);
 
+  while (arena->large) {
+    __large_free(arena);
+  }
+
   while (arena->prev) {
-    struct arena tmp = *arena->prev;
+    __chunk_pop(arena);
+  }
 
-    if (nfree < THRESHOLD) {
-      arena->prev->prev = freechunks;
-      freechunks = arena->prev;
-      nfree++;
-      freechunks->limit = arena->limit;
+  arena->stats.used = 0;
 
-    } else {
-      free(arena->prev);
-    }
+  Ensure(arena->limit == NULL);
+  Ensure(arena->avail == NULL);
+  Ensure(arena->stats.reserved == 0);
+}
+
+Arena_Mark
+Arena_mark(Arena_T arena)
+{
+  Require(arena);
+
+  const struct arena_mark state = {
+    .prev  = arena->prev,
+    .avail = arena->avail,
+    .large = arena->large,
+    .used  = arena->stats.used
+  };
+
+  Arena_Mark mark = Arena_alloc(arena, sizeof (*mark), __FILE__, __LINE__);
+  *mark = state;
+
+  return mark;
+}
 
-    *arena = tmp;
+void
+Arena_release(Arena_T arena, Arena_Mark mark)
+{
+  Require(arena);
+  Require(mark);
+
+  /* The mark itself is released too. */
+  const struct arena_mark state = *mark;
+
+  while (arena->large != state.large) {
+    Require(arena->large);
+    __large_free(arena);
   }
 
-  Ensure(arena->limit == NULL);
-  Ensure(arena->avail == NULL);
+  while (arena->prev != state.prev) {
+    Require(arena->prev);
+    __chunk_pop(arena);
+  }
+
+  Require(state.avail <= arena->avail);
+
+  arena->avail = state.avail;
+  arena->stats.used = state.used;
+}
+
+void
+Arena_stats(Arena_T arena, Arena_Stats* p_stats__)
+{
+  Require(arena);
+  Require(p_stats__);
+
+  *p_stats__ = arena->stats;
 }
@@ -1,65 +1,506 @@
+/**
+ * @file     atom.c
+ * @brief    Concurrent atom table.
+ *
+ * Table is split into shards by the high bits of the hash. Each shard is a
+ * chained hash table with its own lock that is taken only to insert or
+ * remove. Lookups walk the chains with atomic loads and take no lock; if they
+ * miss because the table changed under them the insert path looks again
+ * under the lock.
+ *
+ * A shard doubles its buckets when the chains get long. The old buckets are
+ * moved to the new table a few at a time by the following inserts, and
+ * lookups check both tables meanwhile. Old bucket arrays are kept until
+ * `Atom_reset` because a reader may still walk them; they are half of the
+ * live table at most.
+ *
+ * Every atom is one block: header followed by the string. Blocks are taken
+ * from the arena of the inserting thread, so no allocation happens under a
+ * lock. Long atoms get their own block from `Memory_*`.
+ *
+ * Atoms are reference counted. An atom that is not used any more is removed
+ * from the table, but a lookup could still read it, so its block is retired
+ * to `Epoch_retire` and reused only after every thread that was looking up
+ * at that moment has finished. Freed blocks go to free lists of the freeing
+ * thread and are reused by its next atoms of the same size.
+ *
+ * Threads keep their arena and free lists in a context. Contexts of
+ * finished threads are adopted by new ones.
+ */
 #include "lang/atom.h"
 
-#include <string.h>      /* memcpy, strlen */
+#include <pthread.h>     /* pthread_mutex_*, pthread_key_* */
+#include <stdatomic.h>   /* atomic_*                       */
+#include <stdbool.h>     /* bool                           */
+#include <stdint.h>      /* uint64_t                       */
+#include <stdlib.h>      /* malloc, free                   */
+#include <string.h>      /* memcpy, memcmp, memset, strlen */
+#include "lang/arena.h"
+#include "lang/epoch.h"
 #include "lang/memory.h"
 #include "lang/macros.h"
 #include "lang/assert.h"
 
+/* Shards count and the bits of the hash that select one. */
+#define SHARD_BITS      4
+#define NSHARDS         (1 << SHARD_BITS)
+
+#define INITIAL_BUCKETS 256
+
+/* Average chain length that starts a resize. */
+#define LOAD_FACTOR     2
+
+/* Old buckets moved to the new table on every insert while resizing. */
+#define MIGRATE_STEP    16
+
+/* Blocks are reused by size classes `BLOCK_ALIGN` apart up to `MAX_SMALL`. */
+#define BLOCK_ALIGN     16
+#define MAX_SMALL       256
+#define NCLASSES        (MAX_SMALL / BLOCK_ALIGN)
+
+#define CACHE_LINE      64
+
 /* __________________________________________________________________________ */
 /*                                                                     Local  */
 
-static struct atom {
-  struct atom* link;
+struct atom {
+  _Atomic(struct atom*) link;
+  uint64_t hash;
   size_t len;
-  char* str;
-}* buckets[2048];
-
-static unsigned long scatter[] = {
-  2078917053, 143302914, 1027100827, 1953210302, 755253631, 2002600785,
-  1405390230, 45248011, 1099951567, 433832350, 2018585307, 438263339,
-  813528929, 1703199216, 618906479, 573714703, 766270699, 275680090,
-  1510320440, 1583583926, 1723401032, 1965443329, 1098183682, 1636505764,
-  980071615, 1011597961, 643279273, 1315461275, 157584038, 1069844923,
-  471560540, 89017443, 1213147837, 1498661368, 2042227746, 1968401469,
-  1353778505, 1300134328, 2013649480, 306246424, 1733966678, 1884751139,
-  744509763, 400011959, 1440466707, 1363416242, 973726663, 59253759,
-  1639096332, 336563455, 1642837685, 1215013716, 154523136, 593537720,
-  704035832, 1134594751, 1605135681, 1347315106, 302572379, 1762719719,
-  269676381, 774132919, 1851737163, 1482824219, 125310639, 1746481261,
-  1303742040, 1479089144, 899131941, 1169907872, 1785335569, 485614972,
-  907175364, 382361684, 885626931, 200158423, 1745777927, 1859353594,
-  259412182, 1237390611, 48433401, 1902249868, 304920680, 202956538,
-  348303940, 1008956512, 1337551289, 1953439621, 208787970, 1640123668,
-  1568675693, 478464352, 266772940, 1272929208, 1961288571, 392083579,
-  871926821, 1117546963, 1871172724, 1771058762, 139971187, 1509024645,
-  109190086, 1047146551, 1891386329, 994817018, 1247304975, 1489680608,
-  706686964, 1506717157, 579587572, 755120366, 1261483377, 884508252,
-  958076904, 1609787317, 1893464764, 148144545, 1415743291, 2102252735,
-  1788268214, 836935336, 433233439, 2055041154, 2109864544, 247038362,
-  299641085, 834307717, 1364585325, 23330161, 457882831, 1504556512,
-  1532354806, 567072918, 404219416, 1276257488, 1561889936, 1651524391,
-  618454448, 121093252, 1010757900, 1198042020, 876213618, 124757630,
-  2082550272, 1834290522, 1734544947, 1828531389, 1982435068, 1002804590,
-  1783300476, 1623219634, 1839739926, 69050267, 1530777140, 1802120822,
-  316088629, 1830418225, 488944891, 1680673954, 1853748387, 946827723,
-  1037746818, 1238619545, 1513900641, 1441966234, 367393385, 928306929,
-  946006977, 985847834, 1049400181, 1956764878, 36406206, 1925613800,
-  2081522508, 2118956479, 1612420674, 1668583807, 1800004220, 1447372094,
-  523904750, 1435821048, 923108080, 216161028, 1504871315, 306401572,
-  2018281851, 1820959944, 2136819798, 359743094, 1354150250, 1843084537,
-  1306570817, 244413420, 934220434, 672987810, 1686379655, 1301613820,
-  1601294739, 484902984, 139978006, 503211273, 294184214, 176384212,
-  281341425, 228223074, 147857043, 1893762099, 1896806882, 1947861263,
-  1193650546, 273227984, 1236198663, 2116758626, 489389012, 593586330,
-  275676551, 360187215, 267062626, 265012701, 719930310, 1621212876,
-  2108097238, 2026501127, 1865626297, 894834024, 552005290, 1404522304,
-  48964196, 5816381, 1889425288, 188942202, 509027654, 36125855,
-  365326415, 790369079, 264348929, 513183458, 536647531, 13672163,
-  313561074, 1730298077, 286900147, 1549759737, 1699573055, 776289160,
-  2143346068, 1975249606, 1136476375, 262925046, 92778659, 1856406685,
-  1884137923, 53392249, 1735424165, 1602280572
+  _Atomic size_t refs;
+  union {                     /* Lookups never read it. */
+    struct atom* next;        /* In free lists. */
+    Epoch_Link retired;
+  };
+  char str[];
+};
+
+struct table {
+  size_t mask;
+  struct table* retired;  /* Tables this one replaced. */
+  _Atomic(struct atom*) buckets[];
+};
+
+static struct shard {
+  _Alignas(CACHE_LINE) pthread_mutex_t lock;
+
+  _Atomic(struct table*) table;
+  _Atomic(struct table*) old;  /* Not NULL while resizing. */
+
+  size_t migrated;             /* Buckets of `old` already moved. */
+  size_t count;
+} shards[NSHARDS];
+
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
+
+struct context {
+  _Alignas(CACHE_LINE) Arena_T arena;
+  struct atom* freelist[NCLASSES];
+
+  atomic_bool owned;           /* Used by a live thread. */
+  struct context* next;        /* In `contexts`, never removed. */
 };
 
+static _Atomic(struct context*) contexts;
+
+static _Thread_local struct context* local_context;
+static pthread_key_t context_key;
+
+static void
+__context_orphan(void* context)
+{
+  struct context* ctx = context;
+  atomic_store_explicit(&ctx->owned, false, memory_order_release);
+
+  local_context = NULL;
+}
+
+static void
+__shards_init(void)
+{
+  for (int i = 0; i < NSHARDS; ++i) {
+    pthread_mutex_init(&shards[i].lock, NULL);
+  }
+
+  pthread_key_create(&context_key, __context_orphan);
+}
+
+/* Slow path, once per thread: adopt a context or create a new one. */
+static struct context*
+__context_attach(void)
+{
+  pthread_once(&shards_once, __shards_init);
+
+  struct context* ctx = atomic_load_explicit(&contexts, memory_order_acquire);
+
+  for (; ctx; ctx = ctx->next) {
+    bool owned = false;
+
+    if (atomic_compare_exchange_strong(&ctx->owned, &owned, true))
+    { break; }
+  }
+
+  if (ctx == NULL) {
+    ctx = ALLOC_ALIGNED(CACHE_LINE, sizeof (*ctx));
+
+    memset(ctx, '\0', sizeof (*ctx));
+    atomic_init(&ctx->owned, true);
+
+    ctx->next = atomic_load_explicit(&contexts, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&contexts, &ctx->next, ctx,
+                                                  memory_order_release,
+                                                  memory_order_relaxed))
+    { }
+  }
+
+  pthread_setspecific(context_key, ctx);
+  local_context = ctx;
+
+  return ctx;
+}
+
+static struct context*
+__context(void)
+{
+  struct context* ctx = local_context;
+  return (ctx != NULL) ? ctx : __context_attach();
+}
+
+static size_t
+__block_size(size_t len)
+{
+  return (sizeof (struct atom) + len + 1 + BLOCK_ALIGN - 1) / BLOCK_ALIGN * BLOCK_ALIGN;
+}
+
+static struct atom*
+__block_alloc(struct context* ctx, size_t len)
+{
+  const size_t size = __block_size(len);
+
+  if (size > MAX_SMALL)
+  { return ALLOC(size); }
+
+  struct atom** p_free = &ctx->freelist[size / BLOCK_ALIGN - 1];
+  struct atom* block = *p_free;
+
+  if (block != NULL) {
+    *p_free = block->next;
+    return block;
+  }
+
+  if (ctx->arena == NULL)
+  { ctx->arena = Arena_new(); }
+
+  return Arena_alloc(ctx->arena, size, __FILE__, __LINE__);
+}
+
+/* No thread could read `block` any more. */
+static void
+__block_free(struct context* ctx, struct atom* block)
+{
+  const size_t size = __block_size(block->len);
+
+  if (size > MAX_SMALL) {
+    FREE(block);
+    return;
+  }
+
+  struct atom** p_free = &ctx->freelist[size / BLOCK_ALIGN - 1];
+
+  block->next = *p_free;
+  *p_free = block;
+}
+
+/* Retired atom could not be read any more. */
+static void
+__block_reuse(Epoch_Link* link)
+{
+  __block_free(__context(), CONTAINER_OF(link, struct atom, retired));
+}
+
+/* MurmurHash64A mixing, eight bytes at a time. */
+static uint64_t
+__hash(const char* str, size_t len)
+{
+  const uint64_t m = 0xC6A4A7935BD1E995ULL;
+  const int r = 47;
+
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ (len * m);
+  uint64_t k;
+
+  for (; len >= sizeof (k); str += sizeof (k), len -= sizeof (k)) {
+    memcpy(&k, str, sizeof (k));
+
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+
+    h ^= k;
+    h *= m;
+  }
+
+  if (len > 0) {
+    k = 0;
+    memcpy(&k, str, len);
+
+    h ^= k;
+    h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+
+  return h;
+}
+
+static struct shard*
+__shard(uint64_t hash)
+{
+  return &shards[hash >> (64 - SHARD_BITS)];
+}
+
+/*
+ * Returns NULL if the system is out of memory. Called with the shard lock
+ * held, so it does not throw.
+ */
+static struct table*
+__table_new(size_t nbuckets)
+{
+  struct table* table = malloc(sizeof (*table) + nbuckets * sizeof (table->buckets[0]));
+
+  if (table == NULL)
+  { return NULL; }
+
+  table->mask = nbuckets - 1;
+  table->retired = NULL;
+
+  for (size_t i = 0; i < nbuckets; ++i) {
+    atomic_init(&table->buckets[i], NULL);
+  }
+
+  return table;
+}
+
+/* Lock-free, could miss an atom that is moved to the new table meanwhile. */
+static struct atom*
+__find(const struct table* table, uint64_t hash, const char* str, size_t len)
+{
+  if (table == NULL)
+  { return NULL; }
+
+  struct atom* p = atomic_load_explicit(&table->buckets[hash & table->mask],
+                                        memory_order_acquire);
+
+  for (; p; p = atomic_load_explicit(&p->link, memory_order_acquire)) {
+
+    if (p->hash == hash && p->len == len && memcmp(p->str, str, len) == 0)
+    { return p; }
+  }
+
+  return NULL;
+}
+
+static struct atom*
+__lookup(struct shard* shard, uint64_t hash, const char* str, size_t len)
+{
+  struct atom* p = __find(atomic_load_explicit(&shard->table, memory_order_acquire),
+                          hash, str, len);
+
+  if (p == NULL)
+  { p = __find(atomic_load_explicit(&shard->old, memory_order_acquire), hash, str, len); }
+
+  return p;
+}
+
+/* Takes a reference unless the atom is being removed. */
+static bool
+__ref(struct atom* atom)
+{
+  size_t refs = atomic_load_explicit(&atom->refs, memory_order_relaxed);
+
+  while (refs > 0) {
+    if (atomic_compare_exchange_weak(&atom->refs, &refs, refs + 1))
+    { return true; }
+  }
+
+  return false;
+}
+
+/* Called with the shard lock held. */
+static void
+__link(struct table* table, struct atom* atom)
+{
+  _Atomic(struct atom*)* bucket = &table->buckets[atom->hash & table->mask];
+
+  atomic_store_explicit(&atom->link, atomic_load_explicit(bucket, memory_order_relaxed),
+                        memory_order_relaxed);
+  atomic_store_explicit(bucket, atom, memory_order_release);
+}
+
+/* Called with the shard lock held. Readers on `atom` still find the rest. */
+static bool
+__unlink(struct table* table, struct atom* atom)
+{
+  if (table == NULL)
+  { return false; }
+
+  _Atomic(struct atom*)* p_link = &table->buckets[atom->hash & table->mask];
+  struct atom* p;
+
+  while ((p = atomic_load_explicit(p_link, memory_order_relaxed)) != NULL) {
+
+    if (p == atom) {
+      atomic_store_explicit(p_link, atomic_load_explicit(&atom->link, memory_order_relaxed),
+                            memory_order_release);
+      return true;
+    }
+
+    p_link = &p->link;
+  }
+
+  return false;
+}
+
+/* Called with the shard lock held. Moves next `MIGRATE_STEP` old buckets. */
+static void
+__migrate(struct shard* shard)
+{
+  struct table* old = atomic_load_explicit(&shard->old, memory_order_relaxed);
+  struct table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+
+  for (int step = 0; step < MIGRATE_STEP && shard->migrated <= old->mask; ++step) {
+    _Atomic(struct atom*)* bucket = &old->buckets[shard->migrated++];
+    struct atom* p = atomic_load_explicit(bucket, memory_order_relaxed);
+
+    while (p != NULL) {
+      struct atom* next = atomic_load_explicit(&p->link, memory_order_relaxed);
+
+      atomic_store_explicit(bucket, next, memory_order_release);
+      __link(table, p);
+
+      p = next;
+    }
+  }
+
+  if (shard->migrated > old->mask) {
+    table->retired = old;
+    atomic_store_explicit(&shard->old, NULL, memory_order_release);
+  }
+}
+
+/* Called with the shard lock held. Starts a resize if chains are long. */
+static void
+__grow(struct shard* shard)
+{
+  struct table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+
+  if (atomic_load_explicit(&shard->old, memory_order_relaxed) != NULL
+      || shard->count < LOAD_FACTOR * (table->mask + 1))
+  { return; }
+
+  /* If out of memory chains just get longer. */
+  struct table* bigger = __table_new(2 * (table->mask + 1));
+
+  if (bigger == NULL)
+  { return; }
+
+  shard->migrated = 0;
+  atomic_store_explicit(&shard->old, table, memory_order_release);
+  atomic_store_explicit(&shard->table, bigger, memory_order_release);
+}
+
+/* Long atoms are not in arenas. Called with no other `Atom_*` running. */
+static void
+__free_long(struct table* table)
+{
+  for (size_t i = 0; table != NULL && i <= table->mask; ++i) {
+    struct atom* p = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+
+    while (p != NULL) {
+      struct atom* next = atomic_load_explicit(&p->link, memory_order_relaxed);
+
+      if (__block_size(p->len) > MAX_SMALL)
+      { FREE(p); }
+
+      p = next;
+    }
+  }
+}
+
+static void
+__chain_stats(const struct table* table, Atom_Stats* p_stats__)
+{
+  for (size_t i = 0; table != NULL && i <= table->mask; ++i) {
+    const struct atom* p = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+    size_t chain = 0;
+
+    for (; p; p = atomic_load_explicit(&p->link, memory_order_relaxed)) {
+      p_stats__->count++;
+      p_stats__->bytes += __block_size(p->len);
+      chain++;
+    }
+
+    if (chain > p_stats__->longest_chain)
+    { p_stats__->longest_chain = chain; }
+  }
+
+  if (table != NULL)
+  { p_stats__->buckets += table->mask + 1; }
+}
+
+#if !defined(NDEBUG)
+/* Called with the shard lock held. */
+static bool
+__holds(const struct table* table, const char* str)
+{
+  for (size_t i = 0; table != NULL && i <= table->mask; ++i) {
+    const struct atom* p = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+
+    for (; p; p = atomic_load_explicit(&p->link, memory_order_relaxed)) {
+      if (p->str == str)
+      { return true; }
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Checked builds only. `str` is looked up by its bytes up to the first '\0'
+ * and must be the found atom itself, so the header before a pointer that is
+ * not an atom is never read. Atoms with a '\0' inside are searched for in
+ * every shard.
+ */
+static bool
+__is_atom(const char* str)
+{
+  pthread_once(&shards_once, __shards_init);
+
+  const size_t len = strlen(str);
+  const uint64_t hash = __hash(str, len);
+  struct shard* shard = __shard(hash);
+
+  pthread_mutex_lock(&shard->lock);
+  const struct atom* p = __lookup(shard, hash, str, len);
+  pthread_mutex_unlock(&shard->lock);
+
+  if (p != NULL && p->str == str)
+  { return true; }
+
+  bool found = false;
+
+  for (int i = 0; i < NSHARDS && !found; ++i) {
+    pthread_mutex_lock(&shards[i].lock);
+    found = __holds(atomic_load_explicit(&shards[i].table, memory_order_relaxed), str)
+            || __holds(atomic_load_explicit(&shards[i].old, memory_order_relaxed), str);
+    pthread_mutex_unlock(&shards[i].lock);
+  }
+
+  return found;
+}
+#endif  /* NDEBUG */
+
 /* __________________________________________________________________________ */
 
 const char*
@@ -68,35 +509,64 @@ Atom_new(const char* str, size_t len)
   Require(str);
   Require(len > 0);
 
-  struct atom* p;
+  const uint64_t hash = __hash(str, len);
+  struct shard* shard = __shard(hash);
+  struct context* ctx = __context();
+
+  Epoch_enter();
+  struct atom* p = __lookup(shard, hash, str, len);
+  const bool found = (p != NULL && __ref(p));
+  Epoch_leave();
+
+  if (found)
+  { return p->str; }
+
+  /* Prepared out of the lock. Given back if other thread inserts it first. */
+  p = __block_alloc(ctx, len);
+  p->hash = hash;
+  p->len = len;
+  atomic_init(&p->refs, 1);
+
+  memcpy(p->str, str, len);
+  p->str[len] = '\0';
+
+  pthread_mutex_lock(&shard->lock);
+
+  /* Atom that is being removed gets a new life. */
+  struct atom* other = __lookup(shard, hash, str, len);
+
+  if (other != NULL) {
+    atomic_fetch_add(&other->refs, 1);
+    pthread_mutex_unlock(&shard->lock);
 
-  unsigned long h;
-  size_t i;
-  for (h = 0, i = 0; i < len; i++)
-  { h = (h << 1) + scatter[(unsigned char)str[i]]; }
+    __block_free(ctx, p);
+    return other->str;
+  }
+
+  struct table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
 
-  h &= ARRAY_SIZE(buckets) - 1;
-  for (p = buckets[h]; p; p = p->link) {
+  if (table == NULL) {
+    table = __table_new(INITIAL_BUCKETS);
 
-    if (len == p->len) {
-      for (i = 0; i < len && p->str[i] == str[i]; )
-      { i++; }
+    if (table == NULL) {
+      pthread_mutex_unlock(&shard->lock);
+      __block_free(ctx, p);
 
-      if (i == len)
-      { return p->str; }
+      THROW(Memory_Failed);
     }
+
+    atomic_store_explicit(&shard->table, table, memory_order_release);
   }
 
-  p = ALLOC(sizeof (*p) + len + 1);
-  p->len = len;
-  p->str = (char*)(p + 1);
+  __link(table, p);
+  shard->count++;
 
-  if (len > 0)
-  { memcpy(p->str, str, len); }
+  if (atomic_load_explicit(&shard->old, memory_order_relaxed) != NULL)
+  { __migrate(shard); }
+  else
+  { __grow(shard); }
 
-  p->str[len] = '\0';
-  p->link = buckets[h];
-  buckets[h] = p;
+  pthread_mutex_unlock(&shard->lock);
 
   return p->str;
 }
@@ -112,15 +582,104 @@ size_t
 Atom_length(const char* str)
 {
   Require(str);
+  Require(__is_atom(str));
 
-  struct atom* p;
+  const struct atom* atom = CONTAINER_OF(str, struct atom, str);
+
+  return atom->len;
+}
+
+void
+Atom_free(const char* str)
+{
+  Require(str);
+  Require(__is_atom(str));
+
+  struct atom* atom = CONTAINER_OF(str, struct atom, str);
+
+  /* Keeps `atom` from reuse if other thread removes it first. */
+  Epoch_enter();
+
+  if (atomic_fetch_sub(&atom->refs, 1) == 1) {
+    struct shard* shard = __shard(atom->hash);
+    bool removed = false;
 
-  for (size_t i = 0; i < ARRAY_SIZE(buckets); i++)
-    for (p = buckets[i]; p; p = p->link)
-      if (p->str == str) {
-        return p->len;
-      }
+    pthread_mutex_lock(&shard->lock);
 
-  Assert(0);
-  return 0;
+    if (atomic_load(&atom->refs) == 0
+        && (__unlink(atomic_load_explicit(&shard->table, memory_order_relaxed), atom)
+            || __unlink(atomic_load_explicit(&shard->old, memory_order_relaxed), atom))) {
+      shard->count--;
+      removed = true;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    if (removed)
+    { Epoch_retire(&atom->retired, __block_reuse); }
+  }
+
+  Epoch_leave();
+}
+
+void
+Atom_reset(void)
+{
+  pthread_once(&shards_once, __shards_init);
+
+  for (int i = 0; i < NSHARDS; ++i) {
+    struct shard* shard = &shards[i];
+    struct table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+    struct table* old = atomic_load_explicit(&shard->old, memory_order_relaxed);
+
+    __free_long(table);
+    __free_long(old);
+
+    /* Table being migrated is not in the retired chain yet. */
+    if (old != NULL) {
+      old->retired = table->retired;
+      table->retired = old;
+    }
+
+    while (table != NULL) {
+      struct table* retired = table->retired;
+      free(table);
+      table = retired;
+    }
+
+    atomic_store_explicit(&shard->table, NULL, memory_order_relaxed);
+    atomic_store_explicit(&shard->old, NULL, memory_order_relaxed);
+    shard->migrated = 0;
+    shard->count = 0;
+  }
+
+  /* Retired atoms come back now, long ones are freed. */
+  Epoch_flush(__block_reuse);
+
+  struct context* ctx = atomic_load_explicit(&contexts, memory_order_acquire);
+
+  for (; ctx; ctx = ctx->next) {
+    memset(ctx->freelist, '\0', sizeof (ctx->freelist));
+
+    if (ctx->arena != NULL)
+    { Arena_free(ctx->arena); }
+  }
+}
+
+void
+Atom_stats(Atom_Stats* p_stats__)
+{
+  Require(p_stats__);
+
+  pthread_once(&shards_once, __shards_init);
+  memset(p_stats__, '\0', sizeof (*p_stats__));
+
+  for (int i = 0; i < NSHARDS; ++i) {
+    struct shard* shard = &shards[i];
+
+    pthread_mutex_lock(&shard->lock);
+    __chain_stats(atomic_load_explicit(&shard->table, memory_order_relaxed), p_stats__);
+    __chain_stats(atomic_load_explicit(&shard->old, memory_order_relaxed), p_stats__);
+    pthread_mutex_unlock(&shard->lock);
+  }
 }
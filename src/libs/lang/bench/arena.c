@@ -0,0 +1,101 @@
+/*
+ * Per-request arenas. Every thread builds and disposes arenas in a loop, so
+ * chunks go through the free chunk pools all the time. Then per-request
+ * scratch rolled back with `Arena_mark`/`Arena_release` on one long lived
+ * arena.
+ *
+ * Usage: arena.run [requests per thread] [max threads]
+ */
+#include "lang/arena.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include "lang/macros.h"
+#include "bench.h"
+
+#define DEFAULT_REQUESTS  (1UL << 14)
+#define DEFAULT_THREADS   8
+
+/* Allocations in one request, sizes of list and tree nodes and some strings. */
+#define REQUEST_ALLOCS    512
+
+static void
+__request(Arena_T arena, uint64_t* p_seed)
+{
+  for (int i = 0; i < REQUEST_ALLOCS; ++i) {
+    const size_t nbytes = 16 + (size_t)(Bench_rand(p_seed) % 112);
+    Bench_use(Arena_alloc(arena, nbytes, __FILE__, __LINE__));
+  }
+}
+
+static void*
+new_dispose(void* arg)
+{
+  const size_t requests = *(size_t*)arg;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+  for (size_t i = 0; i < requests; ++i) {
+    Arena_T arena = Arena_new();
+    __request(arena, &seed);
+    Arena_dispose(&arena);
+  }
+
+  return NULL;
+}
+
+static void*
+mark_release(void* arg)
+{
+  const size_t requests = *(size_t*)arg;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  Arena_T arena = Arena_new();
+
+  for (size_t i = 0; i < requests; ++i) {
+    Arena_Mark mark = Arena_mark(arena);
+    __request(arena, &seed);
+    Arena_release(arena, mark);
+  }
+
+  Arena_dispose(&arena);
+  return NULL;
+}
+
+static void
+run(const char* name, void* (*fn)(void*), size_t requests, size_t nthreads)
+{
+  pthread_t threads[64];
+  char title[64];
+
+  if (nthreads > ARRAY_SIZE(threads))
+  { nthreads = ARRAY_SIZE(threads); }
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_create(&threads[i], NULL, fn, &requests);
+  }
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  snprintf(title, sizeof(title), "arena: %s x%zu", name, nthreads);
+  Bench_report(title, requests * nthreads * REQUEST_ALLOCS, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t requests = Bench_arg(argc, argv, 1, DEFAULT_REQUESTS);
+  const size_t max_threads = Bench_arg(argc, argv, 2, DEFAULT_THREADS);
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    run("new/dispose", new_dispose, requests, nthreads);
+  }
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    run("mark/release", mark_release, requests, nthreads);
+  }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * Interning identifiers. First every thread inserts its own distinct keys,
+ * then all threads look up keys that already exist, in random order. At last
+ * short lived atoms: every thread adds its keys and frees them again, so
+ * blocks go through the free lists. Keys are formatted before the clock
+ * starts.
+ *
+ * Usage: atom.run [keys per thread] [max threads]
+ */
+#include "lang/atom.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include "lang/macros.h"
+#include "lang/memory.h"
+#include "bench.h"
+
+#define DEFAULT_KEYS     (1UL << 18)
+#define DEFAULT_THREADS  8
+
+/* Looks like identifiers and log keys: short, common prefix. */
+#define KEY_FORMAT       "request.header.key_%zu_%zu"
+#define KEY_SIZE         48
+
+/* Distinct short lived keys of a thread. */
+#define CHURN_KEYS       1024
+
+typedef struct {
+  char (*keys)[KEY_SIZE];
+  size_t nkeys;
+  uint64_t seed;
+} job_t;
+
+static char (*__keys(size_t id, size_t nkeys))[KEY_SIZE]
+{
+  char (*keys)[KEY_SIZE] = ALLOC(nkeys * KEY_SIZE);
+
+  for (size_t i = 0; i < nkeys; ++i) {
+    snprintf(keys[i], KEY_SIZE, KEY_FORMAT, id, i);
+  }
+
+  return keys;
+}
+
+static void*
+insert(void* arg)
+{
+  const job_t* job = arg;
+
+  for (size_t i = 0; i < job->nkeys; ++i) {
+    Bench_use(Atom_string(job->keys[i]));
+  }
+
+  return NULL;
+}
+
+static void*
+lookup(void* arg)
+{
+  const job_t* job = arg;
+  uint64_t seed = job->seed;
+
+  for (size_t i = 0; i < job->nkeys; ++i) {
+    Bench_use(Atom_string(job->keys[Bench_rand(&seed) % job->nkeys]));
+  }
+
+  return NULL;
+}
+
+static void*
+churn(void* arg)
+{
+  const job_t* job = arg;
+
+  for (size_t i = 0; i < job->nkeys; ++i) {
+    Atom_free(Atom_string(job->keys[i % CHURN_KEYS]));
+  }
+
+  return NULL;
+}
+
+static void
+run(const char* name, void* (*fn)(void*), job_t* jobs, size_t nthreads)
+{
+  pthread_t threads[64];
+  char title[64];
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_create(&threads[i], NULL, fn, &jobs[i]);
+  }
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  snprintf(title, sizeof(title), "atom: %s x%zu", name, nthreads);
+  Bench_report(title, jobs[0].nkeys * nthreads, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t nkeys = Bench_arg(argc, argv, 1, DEFAULT_KEYS);
+  size_t max_threads = Bench_arg(argc, argv, 2, DEFAULT_THREADS);
+
+  job_t jobs[64];
+  size_t id = 0;
+
+  if (max_threads > ARRAY_SIZE(jobs))
+  { max_threads = ARRAY_SIZE(jobs); }
+
+  /* Every round inserts new keys. */
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+
+    for (size_t i = 0; i < nthreads; ++i) {
+      jobs[i] = (job_t){ .keys = __keys(id++, nkeys), .nkeys = nkeys };
+    }
+
+    run("insert", insert, jobs, nthreads);
+
+    for (size_t i = 0; i < nthreads; ++i) {
+      FREE(jobs[i].keys);
+    }
+  }
+
+  /* All threads look up keys of the first round. */
+  char (*keys)[KEY_SIZE] = __keys(0, nkeys);
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+
+    for (size_t i = 0; i < nthreads; ++i) {
+      jobs[i] = (job_t){ .keys = keys, .nkeys = nkeys, .seed = 0x9E3779B97F4A7C15ULL + i };
+    }
+
+    run("lookup", lookup, jobs, nthreads);
+  }
+
+  FREE(keys);
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+
+    for (size_t i = 0; i < nthreads; ++i) {
+      jobs[i] = (job_t){ .keys = __keys(id++, CHURN_KEYS), .nkeys = nkeys };
+    }
+
+    run("new/free", churn, jobs, nthreads);
+
+    for (size_t i = 0; i < nthreads; ++i) {
+      FREE(jobs[i].keys);
+    }
+  }
+
+  return 0;
+}
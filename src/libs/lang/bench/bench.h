@@ -0,0 +1,69 @@
+/**
+ * @file    bench.h
+ * @brief   Helpers shared by the benchmark programs.
+ *
+ * Every benchmark is a small `main` that times a workload with `Bench_now` and
+ * prints one line per case with `Bench_report`. Workload sizes have defaults and
+ * could be overridden from the command line, see `Bench_arg`.
+ */
+#if !defined(LANG_BENCH_H)
+#define LANG_BENCH_H
+
+#include <stdint.h>    /* uint64_t               */
+#include <stdio.h>     /* printf                 */
+#include <stdlib.h>    /* strtoul                */
+#include <time.h>      /* timespec_get, TIME_UTC */
+
+/* Wall clock in seconds. */
+static inline double
+Bench_now(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* One line per case: name, operations, nanoseconds per operation and Mops/s. */
+static inline void
+Bench_report(const char* name, size_t ops, double seconds)
+{
+  printf("%-36s %12zu ops %10.2f ns/op %10.2f Mops/s\n", name, ops,
+         seconds * 1e9 / (double)ops, (double)ops / seconds * 1e-6);
+}
+
+/* For memory bound cases: name, bytes read and GB/s. */
+static inline void
+Bench_report_bytes(const char* name, size_t bytes, double seconds)
+{
+  printf("%-36s %12zu B   %10.2f GB/s\n", name, bytes, (double)bytes / seconds * 1e-9);
+}
+
+/* Returns `argv[idx]` as a number or `def` if not given. */
+static inline size_t
+Bench_arg(int argc, char** argv, int idx, size_t def)
+{
+  return (argc > idx) ? (size_t)strtoul(argv[idx], NULL, 10) : def;
+}
+
+/* xorshift64*, good enough to shuffle workloads. `*p_state` must be non zero. */
+static inline uint64_t
+Bench_rand(uint64_t* p_state)
+{
+  uint64_t x = *p_state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *p_state = x;
+
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* Keeps the optimizer from dropping a computed value. */
+static inline void
+Bench_use(const void* ptr)
+{
+  __asm__ __volatile__("" : : "r"(ptr) : "memory");
+}
+
+#endif  /* LANG_BENCH_H */
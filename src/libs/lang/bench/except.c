@@ -0,0 +1,97 @@
+/*
+ * Cost of TRY/END_TRY. A call to an empty function, the same call wrapped in
+ * TRY and a TRY that catches what the function throws. Build with and without
+ * `EXCEPT_FAST_MODE` to compare `setjmp` with `__builtin_setjmp`.
+ *
+ * Usage: except.run [iterations]
+ */
+#include "lang/except.h"
+
+#include <stdio.h>
+#include "bench.h"
+
+#define DEFAULT_ITERATIONS  (1UL << 24)
+
+#if defined(EXCEPT_FAST_MODE)
+#  define MODE  "fast"
+#else
+#  define MODE  "setjmp"
+#endif
+
+static const Except_T Bench_Exception = { "Benchmark exception." };
+
+/* Called through a pointer so it is not inlined. */
+static void __nothing(size_t i) { Bench_use((void*)i); }
+static void __throw(size_t i)   { Bench_use((void*)i); THROW(Bench_Exception); }
+
+static void (* volatile nothing)(size_t) = __nothing;
+static void (* volatile thrower)(size_t) = __throw;
+
+static void
+call(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    nothing(i);
+  }
+}
+
+static void
+__try_call(size_t i)
+{
+  TRY
+    nothing(i);
+
+  END_TRY;
+}
+
+static void
+__try_catch(size_t i)
+{
+  TRY
+    thrower(i);
+
+  CATCH(Bench_Exception)
+    Bench_use(&Bench_Exception);
+
+  END_TRY;
+}
+
+static void
+try_call(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    __try_call(i);
+  }
+}
+
+static void
+try_catch(size_t iterations)
+{
+  for (size_t i = 0; i < iterations; ++i) {
+    __try_catch(i);
+  }
+}
+
+static void
+run(const char* name, void (*fn)(size_t), size_t iterations)
+{
+  char title[64];
+
+  const double start = Bench_now();
+  fn(iterations);
+
+  snprintf(title, sizeof(title), "except (%s): %s", MODE, name);
+  Bench_report(title, iterations, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t iterations = Bench_arg(argc, argv, 1, DEFAULT_ITERATIONS);
+
+  run("call", call, iterations);
+  run("TRY/END_TRY", try_call, iterations);
+  run("TRY/CATCH thrown", try_catch, iterations / 8);
+
+  return 0;
+}
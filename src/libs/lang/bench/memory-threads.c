@@ -0,0 +1,178 @@
+/*
+ * Multithreaded NEW/FREE. Producers allocate nodes and hand them over a ring
+ * to consumers that free them, so every free is a cross-thread one. Then each
+ * thread churns its own nodes. Linked with every `Memory_*` back-end, see
+ * `BENCHMARKS` in Makefile.am.
+ *
+ * Usage: memory_threads_<backend>.run [nodes per thread] [max pairs]
+ */
+#include "lang/memory.h"
+
+#include <pthread.h>
+#include <sched.h>       /* sched_yield */
+#include <stdatomic.h>
+#include <stdio.h>
+#include "bench.h"
+
+#if defined(MEMORY_BACKEND_SLAB)
+#  define BACKEND "slab"
+#elif defined(MEMORY_BACKEND_DEV)
+#  define BACKEND "dev"
+#else
+#  define BACKEND "libc"
+#endif
+
+/* See `memory.c` bench why checked version runs less. */
+#if defined(MEMORY_BACKEND_DEV)
+#  define DEFAULT_NODES  (1UL << 13)
+#else
+#  define DEFAULT_NODES  (1UL << 20)
+#endif
+
+#define DEFAULT_PAIRS    4
+#define RING_SIZE        1024
+#define LOCAL_LIVE       256
+#define CACHE_LINE       64
+
+typedef struct { void* data; void* next; } list_node;
+
+/* Single producer, single consumer. */
+typedef struct {
+  _Alignas(CACHE_LINE) _Atomic size_t head;
+  _Alignas(CACHE_LINE) _Atomic size_t tail;
+  _Alignas(CACHE_LINE) list_node* slots[RING_SIZE];
+  size_t nodes;
+} ring_t;
+
+static void*
+producer(void* arg)
+{
+  ring_t* ring = arg;
+
+  for (size_t i = 0; i < ring->nodes; ++i) {
+    list_node* node;
+    NEW(node);
+    node->data = node;
+
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == RING_SIZE) {
+      sched_yield();
+    }
+
+    ring->slots[tail % RING_SIZE] = node;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+  }
+
+  return NULL;
+}
+
+static void*
+consumer(void* arg)
+{
+  ring_t* ring = arg;
+
+  for (size_t i = 0; i < ring->nodes; ++i) {
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (atomic_load_explicit(&ring->tail, memory_order_acquire) == head) {
+      sched_yield();
+    }
+
+    list_node* node = ring->slots[head % RING_SIZE];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    Bench_use(node->data);
+    FREE(node);
+  }
+
+  return NULL;
+}
+
+static void*
+local_churn(void* arg)
+{
+  const size_t nodes = *(size_t*)arg;
+  list_node* live[LOCAL_LIVE] = { NULL };
+
+  for (size_t i = 0; i < nodes; ++i) {
+    list_node** slot = &live[i % LOCAL_LIVE];
+
+    FREE(*slot);
+    NEW(*slot);
+  }
+
+  for (size_t i = 0; i < LOCAL_LIVE; ++i) {
+    FREE(live[i]);
+  }
+
+  return NULL;
+}
+
+static void
+producer_consumer(size_t nodes, size_t pairs)
+{
+  ring_t* rings = ALLOC(pairs * sizeof(*rings));
+  pthread_t* threads = ALLOC(2 * pairs * sizeof(*threads));
+  char name[64];
+
+  for (size_t i = 0; i < pairs; ++i) {
+    atomic_init(&rings[i].head, 0);
+    atomic_init(&rings[i].tail, 0);
+    rings[i].nodes = nodes;
+  }
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < pairs; ++i) {
+    pthread_create(&threads[2 * i], NULL, producer, &rings[i]);
+    pthread_create(&threads[2 * i + 1], NULL, consumer, &rings[i]);
+  }
+
+  for (size_t i = 0; i < 2 * pairs; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  snprintf(name, sizeof(name), BACKEND ": producer/consumer x%zu", pairs);
+  Bench_report(name, 2 * nodes * pairs, Bench_now() - start);
+
+  FREE(threads);
+  FREE(rings);
+}
+
+static void
+local(size_t nodes, size_t nthreads)
+{
+  pthread_t* threads = ALLOC(nthreads * sizeof(*threads));
+  char name[64];
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_create(&threads[i], NULL, local_churn, &nodes);
+  }
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  snprintf(name, sizeof(name), BACKEND ": thread local churn x%zu", nthreads);
+  Bench_report(name, 2 * nodes * nthreads, Bench_now() - start);
+
+  FREE(threads);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t nodes = Bench_arg(argc, argv, 1, DEFAULT_NODES);
+  const size_t max_pairs = Bench_arg(argc, argv, 2, DEFAULT_PAIRS);
+
+  for (size_t pairs = 1; pairs <= max_pairs; pairs *= 2) {
+    producer_consumer(nodes, pairs);
+  }
+
+  for (size_t nthreads = 1; nthreads <= 2 * max_pairs; nthreads *= 2) {
+    local(nodes, nthreads);
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Node churn through NEW/FREE. The same program is linked with every `Memory_*`
+ * back-end, see `BENCHMARKS` in Makefile.am.
+ *
+ * Usage: memory_<backend>.run [operations] [live nodes]
+ */
+#include "lang/memory.h"
+
+#include <stdbool.h>
+#include "bench.h"
+
+#if defined(MEMORY_BACKEND_SLAB)
+#  define BACKEND "slab"
+#elif defined(MEMORY_BACKEND_DEV)
+#  define BACKEND "dev"
+#else
+#  define BACKEND "libc"
+#endif
+
+/*
+ * Checked version keeps every freed block in one list and searches it on each
+ * allocation, so it gets a lighter default workload.
+ */
+#if defined(MEMORY_BACKEND_DEV)
+#  define DEFAULT_OPS  (1UL << 14)
+#else
+#  define DEFAULT_OPS  (1UL << 22)
+#endif
+
+#define DEFAULT_LIVE (1UL << 12)
+
+/* Shapes of the nodes in `data_structs`. */
+typedef struct { void* data; void* next; } list_node;
+typedef struct { void* data; void* next; void* prev; } double_node;
+typedef struct { int row, col; void* data; void* links[4]; } matrix_node;
+
+static const size_t k_node_sizes[] = {
+  sizeof(list_node), sizeof(double_node), sizeof(matrix_node), sizeof(list_node)
+};
+
+/* Allocate `n` list nodes then free them in reverse order like a stack. */
+static void
+lifo(size_t n)
+{
+  list_node** nodes = ALLOC(n * sizeof(*nodes));
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < n; ++i) {
+    NEW(nodes[i]);
+  }
+
+  for (size_t i = n; i-- > 0; ) {
+    FREE(nodes[i]);
+  }
+
+  Bench_report(BACKEND ": lifo list nodes", 2 * n, Bench_now() - start);
+  FREE(nodes);
+}
+
+/* Keep `live` nodes and replace a random one on every step. */
+static void
+churn(size_t ops, size_t live, bool mixed)
+{
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  void** nodes = ALLOC(live * sizeof(*nodes));
+
+  for (size_t i = 0; i < live; ++i) {
+    nodes[i] = ALLOC(sizeof(list_node));
+  }
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < ops; ++i) {
+    const uint64_t r = Bench_rand(&seed);
+    const size_t victim = (size_t)(r % live);
+    const size_t size = mixed ? k_node_sizes[(r >> 32) & 3] : sizeof(list_node);
+
+    FREE(nodes[victim]);
+    nodes[victim] = ALLOC(size);
+    Bench_use(nodes[victim]);
+  }
+
+  Bench_report(mixed ? BACKEND ": churn mixed nodes" : BACKEND ": churn list nodes",
+               2 * ops, Bench_now() - start);
+
+  for (size_t i = 0; i < live; ++i) {
+    FREE(nodes[i]);
+  }
+
+  FREE(nodes);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t ops = Bench_arg(argc, argv, 1, DEFAULT_OPS);
+  const size_t live = Bench_arg(argc, argv, 2, DEFAULT_LIVE);
+
+  lifo(ops / 2);
+  churn(ops, live, false);
+  churn(ops, live, true);
+
+  return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * Node allocation of the book's trees against `node_pool.h`. Book trees take
+ * nodes with a global `get_node` that carves blocks of BLOCKSIZE nodes and
+ * keeps returned ones in a free list, its copy is below. Every allocator runs:
+ *
+ *   fill     get nodes, e.g. a tree is built
+ *   churn    put a random node and get one, e.g. delete and insert
+ *   drain    put all nodes one by one
+ *   dispose  give memory back at once, the book never does
+ *
+ * Then threads get and put nodes of one shared allocator: the book's one
+ * behind a mutex, `malloc` and a pool with a cache per thread.
+ *
+ * Usage: node_pool.run [nodes] [max threads]
+ */
+#define _DEFAULT_SOURCE  /* MAP_HUGETLB, MADV_HUGEPAGE */
+
+#include "lang/node_pool.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>      /* sysconf */
+#include "lang/macros.h"
+#include "bench.h"
+
+#define DEFAULT_NODES    (1UL << 20)
+#define DEFAULT_THREADS  8
+
+/* Nodes each thread holds at most. */
+#define THREAD_LIVE      1024
+
+typedef struct tr_n_t {
+  int key;
+  struct tr_n_t* left;
+  struct tr_n_t* right;
+} tree_node_t;
+
+NODE_POOL(Tree, tree_node_t)
+
+static tree_node_t** nodes;
+
+/* ______________________________________________________________________________ */
+/*                                                                    Book copy  */
+
+#define BLOCKSIZE 256
+
+static tree_node_t* currentblock = NULL;
+static int size_left;
+static tree_node_t* free_list = NULL;
+
+static tree_node_t*
+get_node(void)
+{
+  tree_node_t* tmp;
+
+  if (free_list != NULL) {
+    tmp = free_list;
+    free_list = free_list->left;
+
+  } else {
+    if (currentblock == NULL || size_left == 0) {
+      currentblock = malloc(BLOCKSIZE * sizeof (tree_node_t));
+      size_left = BLOCKSIZE;
+    }
+
+    tmp = currentblock++;
+    size_left -= 1;
+  }
+
+  return tmp;
+}
+
+static void
+return_node(tree_node_t* node)
+{
+  node->left = free_list;
+  free_list = node;
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                     Workloads  */
+
+/* Nodes are touched, as a tree would do. */
+#define WORKLOAD(name, setup, get, put, dispose)                             \
+  static void                                                                \
+  name(size_t n)                                                             \
+  {                                                                          \
+    uint64_t seed = 1;                                                       \
+    setup;                                                                   \
+                                                                             \
+    double start = Bench_now();                                              \
+                                                                             \
+    for (size_t i = 0; i < n; ++i) {                                         \
+      nodes[i] = get;                                                        \
+      nodes[i]->key = (int)i;                                                \
+    }                                                                        \
+                                                                             \
+    Bench_report(#name ": fill", n, Bench_now() - start);                    \
+    start = Bench_now();                                                     \
+                                                                             \
+    for (size_t i = 0; i < n; ++i) {                                         \
+      const size_t j = Bench_rand(&seed) % n;                                \
+      tree_node_t* node = nodes[j];                                          \
+      put;                                                                   \
+      nodes[j] = get;                                                        \
+      nodes[j]->key = (int)i;                                                \
+    }                                                                        \
+                                                                             \
+    Bench_report(#name ": churn", n, Bench_now() - start);                   \
+    start = Bench_now();                                                     \
+                                                                             \
+    for (size_t i = 0; i < n; ++i) {                                         \
+      tree_node_t* node = nodes[i];                                          \
+      put;                                                                   \
+    }                                                                        \
+                                                                             \
+    Bench_report(#name ": drain", n, Bench_now() - start);                   \
+    start = Bench_now();                                                     \
+                                                                             \
+    dispose;                                                                 \
+    Bench_report(#name ": dispose", n, Bench_now() - start);                 \
+  }
+
+/* Blocks of the book are never freed. */
+WORKLOAD(book, (void)0, get_node(), return_node(node), (void)0)
+
+WORKLOAD(libc, (void)0, malloc(sizeof (tree_node_t)), free(node), (void)0)
+
+WORKLOAD(node_pool, TreePool_T pool = TreePool_new(0), TreePool_get(pool),
+         TreePool_put(pool, node), TreePool_free(&pool))
+
+WORKLOAD(node_pool_huge, TreePool_T pool = TreePool_new(NODE_POOL_HUGE), TreePool_get(pool),
+         TreePool_put(pool, node), TreePool_free(&pool))
+
+/* Whole tree is dropped at once instead of the drain. */
+static void
+node_pool_release(size_t n)
+{
+  TreePool_T pool = TreePool_new(0);
+
+  for (size_t i = 0; i < n; ++i) {
+    nodes[i] = TreePool_get(pool);
+    nodes[i]->key = (int)i;
+  }
+
+  const double start = Bench_now();
+  TreePool_release(pool);
+  Bench_report("node_pool: release", n, Bench_now() - start);
+
+  TreePool_free(&pool);
+}
+
+/* ______________________________________________________________________________ */
+/*                                                                       Threads  */
+
+static pthread_mutex_t book_lock = PTHREAD_MUTEX_INITIALIZER;
+static TreePool_T shared;
+
+typedef enum { BOOK, MALLOC, POOL } allocator_et;
+
+typedef struct {
+  allocator_et allocator;
+  size_t ops;
+} worker_t;
+
+static tree_node_t*
+__get(allocator_et allocator, TreeCache_T cache)
+{
+  tree_node_t* node;
+
+  switch (allocator) {
+  case BOOK:
+    pthread_mutex_lock(&book_lock);
+    node = get_node();
+    pthread_mutex_unlock(&book_lock);
+    return node;
+
+  case MALLOC:
+    return malloc(sizeof (tree_node_t));
+
+  case POOL:
+    return TreeCache_get(cache);
+
+  default:
+    return NULL;
+  }
+}
+
+static void
+__put(allocator_et allocator, TreeCache_T cache, tree_node_t* node)
+{
+  switch (allocator) {
+  case BOOK:
+    pthread_mutex_lock(&book_lock);
+    return_node(node);
+    pthread_mutex_unlock(&book_lock);
+    break;
+
+  case MALLOC:
+    free(node);
+    break;
+
+  case POOL:
+    TreeCache_put(cache, node);
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void*
+worker(void* arg)
+{
+  const worker_t* work = arg;
+  TreeCache_T cache = (work->allocator == POOL) ? TreeCache_new(shared) : NULL;
+  tree_node_t* live[THREAD_LIVE];
+  uint64_t seed = (uint64_t)(uintptr_t)arg | 1;
+
+  for (size_t i = 0; i < THREAD_LIVE; ++i) {
+    live[i] = __get(work->allocator, cache);
+  }
+
+  for (size_t i = 0; i < work->ops; ++i) {
+    const size_t j = Bench_rand(&seed) % THREAD_LIVE;
+    __put(work->allocator, cache, live[j]);
+    live[j] = __get(work->allocator, cache);
+    live[j]->key = (int)i;
+  }
+
+  for (size_t i = 0; i < THREAD_LIVE; ++i) {
+    __put(work->allocator, cache, live[i]);
+  }
+
+  if (cache != NULL)
+  { TreeCache_free(&cache); }
+
+  return NULL;
+}
+
+static void
+run(const char* name, allocator_et allocator, size_t ops, size_t nthreads)
+{
+  pthread_t threads[64];
+  worker_t work = { allocator, ops };
+  char title[64];
+
+  if (nthreads > ARRAY_SIZE(threads))
+  { nthreads = ARRAY_SIZE(threads); }
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_create(&threads[i], NULL, worker, &work);
+  }
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  snprintf(title, sizeof (title), "%s: churn x%zu", name, nthreads);
+  Bench_report(title, ops * nthreads, Bench_now() - start);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t n = Bench_arg(argc, argv, 1, DEFAULT_NODES);
+  const long online = sysconf(_SC_NPROCESSORS_ONLN);
+  const size_t max_threads = Bench_arg(argc, argv, 2, (online > 0) ? (size_t)online : DEFAULT_THREADS);
+
+  nodes = malloc(n * sizeof (tree_node_t*));
+
+  book(n);
+  libc(n);
+  node_pool(n);
+  node_pool_huge(n);
+  node_pool_release(n);
+
+  shared = TreePool_new(0);
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    run("book+mutex", BOOK, n, nthreads);
+    run("malloc", MALLOC, n, nthreads);
+    run("node_pool cache", POOL, n, nthreads);
+  }
+
+  TreePool_free(&shared);
+  free(nodes);
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file     epoch.c
+ * @brief    Epoch based reclamation, after Fraser, "Practical lock-freedom"
+ *           (2004).
+ *
+ * Every thread publishes the global epoch it saw when it entered, or zero
+ * when it is out. Global epoch moves on when every thread that is in has
+ * seen it, so objects retired two epochs ago could not be read any more.
+ *
+ * Retired objects wait in `limbo[e % 3]` of the retiring thread, where `e`
+ * is the epoch they were retired in. Threads keep their epoch and limbo in
+ * a context; contexts of finished threads are adopted by new ones.
+ */
+#include "lang/epoch.h"
+
+#include <pthread.h>     /* pthread_once, pthread_key_* */
+#include <stdatomic.h>   /* atomic_*                    */
+#include <stdbool.h>     /* bool                        */
+#include <stdint.h>      /* uint64_t                    */
+#include <string.h>      /* memset                      */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+/* Retired objects between two attempts to advance the global epoch. */
+#define RETIRE_BATCH  64
+
+#define CACHE_LINE    64
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+struct context {
+  _Alignas(CACHE_LINE) _Atomic uint64_t epoch;  /* Zero out of critical sections. */
+  unsigned depth;              /* Nested enters. */
+
+  Epoch_Link* limbo[3];
+  uint64_t limbo_epoch;        /* Global epoch when limbo was last sorted out. */
+  unsigned retired;
+  atomic_flag busy;            /* Limbo is changed, `Epoch_flush` takes it too. */
+
+  atomic_bool owned;           /* Used by a live thread. */
+  struct context* next;        /* In `contexts`, never removed. */
+};
+
+static _Atomic(struct context*) contexts;
+static _Atomic uint64_t global_epoch = 1;
+
+static _Thread_local struct context* local_context;
+static pthread_key_t context_key;
+static pthread_once_t context_once = PTHREAD_ONCE_INIT;
+
+static void
+__context_orphan(void* context)
+{
+  struct context* ctx = context;
+
+  atomic_store_explicit(&ctx->epoch, 0, memory_order_release);
+  ctx->depth = 0;
+  atomic_store_explicit(&ctx->owned, false, memory_order_release);
+
+  local_context = NULL;
+}
+
+static void
+__context_init(void)
+{
+  pthread_key_create(&context_key, __context_orphan);
+}
+
+/* Slow path, once per thread: adopt a context or create a new one. */
+static struct context*
+__context_attach(void)
+{
+  pthread_once(&context_once, __context_init);
+
+  struct context* ctx = atomic_load_explicit(&contexts, memory_order_acquire);
+
+  for (; ctx; ctx = ctx->next) {
+    bool owned = false;
+
+    if (atomic_compare_exchange_strong(&ctx->owned, &owned, true))
+    { break; }
+  }
+
+  if (ctx == NULL) {
+    ctx = ALLOC_ALIGNED(CACHE_LINE, sizeof (*ctx));
+
+    memset(ctx, '\0', sizeof (*ctx));
+    atomic_init(&ctx->epoch, 0);
+    atomic_flag_clear(&ctx->busy);
+    atomic_init(&ctx->owned, true);
+    ctx->limbo_epoch = atomic_load(&global_epoch);
+
+    ctx->next = atomic_load_explicit(&contexts, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&contexts, &ctx->next, ctx,
+                                                  memory_order_release,
+                                                  memory_order_relaxed))
+    { }
+  }
+
+  pthread_setspecific(context_key, ctx);
+  local_context = ctx;
+
+  return ctx;
+}
+
+static struct context*
+__context(void)
+{
+  struct context* ctx = local_context;
+  return (ctx != NULL) ? ctx : __context_attach();
+}
+
+/* Owner takes it only to retire, so it waits only for `Epoch_flush`. */
+static void
+__lock(struct context* ctx)
+{
+  while (atomic_flag_test_and_set_explicit(&ctx->busy, memory_order_acquire))
+  { }
+}
+
+static void
+__unlock(struct context* ctx)
+{
+  atomic_flag_clear_explicit(&ctx->busy, memory_order_release);
+}
+
+/* Global epoch moves on when every thread in a critical section has seen it. */
+static void
+__advance(uint64_t epoch)
+{
+  struct context* ctx = atomic_load_explicit(&contexts, memory_order_acquire);
+
+  for (; ctx; ctx = ctx->next) {
+    const uint64_t e = atomic_load(&ctx->epoch);
+
+    if (e != 0 && e != epoch)
+    { return; }
+  }
+
+  atomic_compare_exchange_strong(&global_epoch, &epoch, epoch + 1);
+}
+
+static void
+__limbo_flush(struct context* ctx, int i)
+{
+  Epoch_Link* link = ctx->limbo[i];
+
+  while (link != NULL) {
+    Epoch_Link* next = link->next;
+    link->free_fn(link);
+    link = next;
+  }
+
+  ctx->limbo[i] = NULL;
+}
+
+/* Free objects retired two epochs ago or earlier. */
+static void
+__collect(struct context* ctx)
+{
+  const uint64_t epoch = atomic_load(&global_epoch);
+
+  if (epoch >= ctx->limbo_epoch + 2) {
+    for (int i = 0; i < 3; ++i) {
+      __limbo_flush(ctx, i);
+    }
+
+  } else if (epoch == ctx->limbo_epoch + 1) {
+    __limbo_flush(ctx, (int)((epoch + 1) % 3));
+  }
+
+  ctx->limbo_epoch = epoch;
+}
+
+/* __________________________________________________________________________ */
+
+void
+Epoch_enter(void)
+{
+  struct context* ctx = __context();
+
+  if (ctx->depth++ == 0)
+  { atomic_store(&ctx->epoch, atomic_load(&global_epoch)); }
+}
+
+void
+Epoch_leave(void)
+{
+  struct context* ctx = local_context;
+
+  if (--ctx->depth == 0)
+  { atomic_store_explicit(&ctx->epoch, 0, memory_order_release); }
+}
+
+void
+Epoch_retire(Epoch_Link* link, epoch_free_FN free_fn)
+{
+  Require(link);
+  Require(free_fn);
+
+  struct context* ctx = __context();
+  link->free_fn = free_fn;
+
+  __lock(ctx);
+  __collect(ctx);
+
+  Epoch_Link** p_limbo = &ctx->limbo[ctx->limbo_epoch % 3];
+  link->next = *p_limbo;
+  *p_limbo = link;
+
+  const uint64_t epoch = ctx->limbo_epoch;
+  __unlock(ctx);
+
+  if (++ctx->retired % RETIRE_BATCH == 0)
+  { __advance(epoch); }
+}
+
+void
+Epoch_flush(epoch_free_FN free_fn)
+{
+  Require(free_fn);
+
+  struct context* ctx = atomic_load_explicit(&contexts, memory_order_acquire);
+
+  for (; ctx; ctx = ctx->next) {
+    __lock(ctx);
+
+    for (int i = 0; i < 3; ++i) {
+      Epoch_Link** p_link = &ctx->limbo[i];
+
+      while (*p_link != NULL) {
+        Epoch_Link* link = *p_link;
+
+        if (link->free_fn == free_fn) {
+          *p_link = link->next;
+          free_fn(link);
+        } else {
+          p_link = &link->next;
+        }
+      }
+    }
+
+    __unlock(ctx);
+  }
+}
@@ -38,8 +38,8 @@ except_backtrace(void)
 
 /* ______________________________________________________________________________ */
 
-/* Initialize exception stack before usage. */
-Except_Frame* Except_stack = NULL;
+/* Initialize exception stack before usage. One per thread. */
+_Thread_local Except_Frame* Except_stack = NULL;
 
 void
 Except_throw(const Except_T* e, const char* file, int line)
@@ -77,5 +77,5 @@ Except_throw(const Except_T* e, const char* file, int line)
   /* Wind exception stack. */
   Except_stack = Except_stack->prev;
 
-  longjmp(p->env, Except_raised);
+  Except_longjmp(p->env);
 }
@@ -4,6 +4,14 @@
  * Memory-management interface and an implementation that uses arena-based
  * algorithms, which allocate memory from an arena and deallocate entire arenas
  * at once.
+ *
+ * Chunks grow geometrically, so an arena that serves many allocations calls
+ * `malloc` only a few times. Blocks too big for a chunk get their own memory.
+ * `Arena_mark` and `Arena_release` roll an arena back to a checkpoint, e.g. to
+ * drop per-request scratch and keep what was allocated before.
+ *
+ * An arena should be used by one thread at a time. Different threads could
+ * create, use and dispose their own arenas in parallel.
  */
 #if !defined(LANG_ARENA_H)
 #define LANG_ARENA_H
@@ -13,6 +21,17 @@
 
 typedef struct arena* Arena_T;
 
+/* Checkpoint in an arena, see `Arena_mark`. */
+typedef struct arena_mark* Arena_Mark;
+
+typedef struct {
+  size_t used;      /* Bytes handed out, alignment included.       */
+  size_t chunks;    /* Chunks held by the arena.                   */
+  size_t large;     /* Blocks allocated outside of chunks.         */
+  size_t reserved;  /* Bytes taken from the system, headers too.   */
+  size_t waste;     /* Unused tails of chunks that were filled up. */
+} Arena_Stats;
+
 /* Checked exceptions */
 extern const Except_T Arena_NewFailed;
 extern const Except_T Arena_Failed;
@@ -56,4 +75,25 @@ extern void   Arena_dispose(Arena_T* p_arena);
  */
 extern void   Arena_free(Arena_T arena);
 
+/**
+ * Returns a checkpoint of the arena. The mark itself lives in the arena and
+ * is released with everything allocated after it.
+ *
+ * @throw  `Arena_Failed` if can't allocates memory.
+ */
+extern Arena_Mark  Arena_mark(Arena_T arena);
+
+/**
+ * Deallocates all of the space allocated in arena after `mark` was taken.
+ * Marks taken after `mark` become invalid. It is a checked runtime error for
+ * `mark` to be null. It is an unchecked runtime error to release a mark twice
+ * or after `Arena_free`.
+ */
+extern void   Arena_release(Arena_T arena, Arena_Mark mark);
+
+/**
+ * Fills `p_stats__` with the current arena usage.
+ */
+extern void   Arena_stats(Arena_T arena, Arena_Stats* p_stats__);
+
 #endif  /* LANG_ARENA_H */
@@ -1,18 +1,62 @@
 /**
- * @file    arena.h
+ * @file    atom.h
  * @brief   Atom definition.
  *
  * Atoms could be used as keys in data structures. Two atoms are
  * identical if they point to the same location.
+ *
+ * Every `Atom_new` or `Atom_string` takes a reference to the atom that is
+ * given back with `Atom_free`. An atom is removed from the table when the
+ * last reference is gone.
+ *
+ * All functions are thread safe except `Atom_reset`.
  */
 #if !defined(LANG_ATOM_H)
 #define LANG_ATOM_H
 
 #include <stddef.h>
 
+typedef struct {
+  size_t count;          /* Atoms in the table.                       */
+  size_t bytes;          /* Memory held by atoms, headers included.   */
+  size_t longest_chain;  /* Atoms in the longest hash chain.          */
+  size_t buckets;        /* Hash buckets, tables being resized too.   */
+} Atom_Stats;
+
+/**
+ * Returns the atom for the `len` bytes of `str`, adding it if needed.
+ *
+ * @throw  `Memory_Failed` or `Arena_Failed` if can't allocate memory.
+ */
 extern const char*  Atom_new   (const char* str, size_t len);
+
+/**
+ * Returns the atom for the null terminated `str`, adding it if needed.
+ */
 extern const char*  Atom_string(const char* str);
 
+/**
+ * Returns the length of an atom in constant time. It is a checked runtime
+ * error for `str` not to be an atom.
+ */
 extern       size_t Atom_length(const char* str);
 
+/**
+ * Gives back a reference taken by `Atom_new` or `Atom_string`. When it was
+ * the last one the atom is removed and its memory is reused later. It is a
+ * checked runtime error for `str` not to be an atom.
+ */
+extern       void   Atom_free  (const char* str);
+
+/**
+ * Removes all atoms and frees their memory whatever references they have.
+ * Must not run together with any other `Atom_*` function.
+ */
+extern       void   Atom_reset (void);
+
+/**
+ * Fills `p_stats__` with the current state of the atom table.
+ */
+extern       void   Atom_stats (Atom_Stats* p_stats__);
+
 #endif  /* LANG_ATOM_H */
@@ -0,0 +1,57 @@
+/**
+ * @file    epoch.h
+ * @brief   Epoch based reclamation of memory shared by threads.
+ *
+ * Lock-free readers could still read an object that other thread has just
+ * removed. A reader marks its reads with `Epoch_enter` and `Epoch_leave`, a
+ * remover gives the object to `Epoch_retire` instead of freeing it. The
+ * object is freed when every thread that was between enter and leave at
+ * that moment has left.
+ *
+ * Retired objects are kept in the retiring thread, they are freed by its
+ * later retires. There is one epoch for the process, so different modules
+ * could be read in one critical section.
+ */
+#if !defined(LANG_EPOCH_H)
+#define LANG_EPOCH_H
+
+typedef struct epoch_link Epoch_Link;
+
+/* Frees the object that holds `link`, e.g. with `CONTAINER_OF`. */
+typedef void (*epoch_free_FN)(Epoch_Link* link);
+
+/* Part of every object that could be retired. */
+struct epoch_link {
+  Epoch_Link* next;
+  epoch_free_FN free_fn;
+};
+
+/**
+ * Objects read from now on are not freed until `Epoch_leave`. Calls could
+ * be nested, the outermost pair counts.
+ */
+extern void Epoch_enter(void);
+
+/**
+ * End of reads started with `Epoch_enter`.
+ */
+extern void Epoch_leave(void);
+
+/**
+ * @brief    Call `free_fn` with `link` when no thread could read its object.
+ *
+ * Object must be unreachable for readers that come later. `free_fn` is
+ * called by some later `Epoch_retire` of the same thread, or of a thread
+ * that took over its state, and must not retire.
+ *
+ * @throw  `Memory_Failed` if can't allocate state of a new thread.
+ */
+extern void Epoch_retire(Epoch_Link* link, epoch_free_FN free_fn);
+
+/**
+ * Free now all retired objects of `free_fn`, of all threads. No thread may
+ * read these objects any more.
+ */
+extern void Epoch_flush(epoch_free_FN free_fn);
+
+#endif  /* LANG_EPOCH_H */
@@ -3,7 +3,17 @@
  * @brief   Exceptions definition.
  *
  * NOTE: TRY/CATCH clauses could be nested.
- * ATTENTION: Not thread safe.
+ *
+ * Every thread has its own exception stack, so exceptions could be used from
+ * any thread. An exception never crosses threads: if it is not caught in the
+ * thread that throws it the program aborts.
+ *
+ * By default TRY saves the context with `setjmp`. Define `EXCEPT_FAST_MODE`
+ * (`--enable-fast-except`) to use `__builtin_setjmp` of GCC and Clang that
+ * saves only the frame and stack pointers and the resume address, the rest
+ * of registers are treated as clobbered by the compiler. Whole program (all
+ * libraries and their users) must be compiled in the same mode, frames of
+ * two modes differ.
  *
  * If the exception is not caught the behavior is as `assertion` failure - logs
  * where is thrown and aborts program. Use exceptions when you need and you can
@@ -14,6 +24,24 @@
 
 #include <setjmp.h>  /* jmp_buf */
 
+#if defined(EXCEPT_FAST_MODE) && (defined(__GNUC__) || defined(__clang__))
+
+/* Frame pointer, resume address and stack pointer. */
+typedef void* Except_Env[5];
+
+/* `__builtin_longjmp` always makes `Except_setjmp` return 1. */
+#define Except_setjmp(env)   __builtin_setjmp(env)
+#define Except_longjmp(env)  __builtin_longjmp(env, 1)
+
+#else
+
+typedef jmp_buf Except_Env;
+
+#define Except_setjmp(env)   setjmp(env)
+#define Except_longjmp(env)  longjmp(env, Except_raised)
+
+#endif  /* EXCEPT_FAST_MODE */
+
 typedef struct Except_T {
   const char* message;
 } Except_T;
@@ -22,18 +50,19 @@ typedef struct Except_Frame Except_Frame;
 
 struct Except_Frame {
   Except_Frame* prev;
-  jmp_buf env;
+  Except_Env env;
   const char* file;
   int line;
   const Except_T* exception;
 };
 
+/* `Except_raised` must be 1, see `Except_longjmp`. */
 enum { Except_entered = 0, Except_raised,
        Except_handled, Except_finalized
      };
 
-/* GLOBAL */
-extern Except_Frame* Except_stack;
+/* Innermost TRY of the calling thread. */
+extern _Thread_local Except_Frame* Except_stack;
 
 /* GLOBAL exceptions types. If the exception is not caught program abort. */
 extern const Except_T Assert_Failed;
@@ -64,12 +93,12 @@ void Except_throw(const Except_T* e, const char* file, int line);
  */
 #define RETURN switch (Except_stack = Except_stack->prev, 0) default: return
 
-#define TRY do {                            \
-    volatile int Except_flag;               \
-    Except_Frame Except_frame;              \
-    Except_frame.prev = Except_stack;       \
-    Except_stack = &Except_frame;           \
-    Except_flag = setjmp(Except_frame.env); \
+#define TRY do {                                   \
+    volatile int Except_flag;                      \
+    Except_Frame Except_frame;                     \
+    Except_frame.prev = Except_stack;              \
+    Except_stack = &Except_frame;                  \
+    Except_flag = Except_setjmp(Except_frame.env); \
     if (Except_flag == Except_entered) {
 
 #define CATCH(e)                                                            \
@@ -6,6 +6,7 @@
 #define LANG_EXTEND_H
 
 #include <stdbool.h> /* bool     */
+#include <stdint.h>  /* int64_t  */
 #include <limits.h>  /* CHAR_BIT */
 
 /**
@@ -60,6 +61,12 @@ typedef void (*free_data_FN)(void*);
  */
 typedef void (*print_data_FN)(Object_T);
 
+/**
+ * Called for every element of a range of ordered map, stops it if returns
+ * `false`.
+ */
+typedef bool (*visit_FN)(int64_t key, Object_T value, void* arg);
+
 /**
  * @brief    Used to indicate if allocation de-allocation succeed.
  *
@@ -73,6 +73,22 @@ extern void* Memory_resize(void* ptr, size_t nbytes, const char* file, int line)
  */
 extern void  Memory_free(void* ptr, const char* file, int line);
 
+/**
+ * Allocates `nbytes` bytes aligned to `align`, e.g. to a cache line, and
+ * returns a pointer to the first byte. It is a checked run-time error for
+ * `align` not to be a power of two. The bytes are uninitialized. The block
+ * can't be resized and must be freed with `Memory_aligned_free`.
+ *
+ * @throw `Memory_Failed` if not succeed.
+ */
+extern void* Memory_aligned_alloc(size_t align, size_t nbytes, const char* file, int line);
+
+/**
+ * De-allocates `ptr`, if `ptr` is non NULL. It is a unchecked run-time error
+ * for `ptr` to be a pointer that was not returned by `Memory_aligned_alloc`.
+ */
+extern void  Memory_aligned_free(void* ptr, const char* file, int line);
+
 #define ALLOC(nbytes)          Memory_alloc((nbytes), __FILE__, __LINE__)
 #define CALLOC(count, nbytes)  Memory_calloc((count), (nbytes), __FILE__, __LINE__)
 
@@ -82,4 +98,7 @@ extern void  Memory_free(void* ptr, const char* file, int line);
 #define RESIZE(ptr, nbytes)  ( (ptr) = Memory_resize((ptr), (nbytes), __FILE__, __LINE__)   )
 #define FREE(ptr)            ( (void)(Memory_free((ptr), __FILE__, __LINE__), (ptr) = NULL) )
 
+#define ALLOC_ALIGNED(align, nbytes)  Memory_aligned_alloc((align), (nbytes), __FILE__, __LINE__)
+#define FREE_ALIGNED(ptr)             ( (void)(Memory_aligned_free((ptr), __FILE__, __LINE__), (ptr) = NULL) )
+
 #endif  /* LANG_MEM_H */
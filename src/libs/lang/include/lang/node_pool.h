@@ -0,0 +1,525 @@
+/**
+ * @file    node_pool.h
+ * @brief   Pool of fixed size nodes for one container, shared by threads.
+ *
+ * Nodes are carved from big chunks and come back to free lists, as
+ * `get_node`/`return_node` of the book's trees do, but a pool belongs to one
+ * container and its chunks are returned to the system.
+ *
+ * Threads do not take nodes from the pool one by one. Each has a cache of
+ * free nodes and moves them to and from the shared depot of the pool in
+ * batches, so the lock of the depot is taken once per `NODE_POOL_BATCH`
+ * operations. The pool has a cache of its own for the thread that made it,
+ * used by `NodePool_get` and `NodePool_put`.
+ *
+ * `NodePool_release` takes back every node at once, e.g. when the container is
+ * emptied, without visiting them. Chunks are kept for the next nodes.
+ *
+ * With `NODE_POOL_HUGE` chunks are 2 MiB huge pages, so a big container needs
+ * fewer TLB entries. They are mapped with `MAP_HUGETLB` if huge pages are
+ * reserved, otherwise transparent huge pages are asked with `madvise`. Both are
+ * Linux extensions, they are used only if the includer made them visible
+ * (e.g. `#define _DEFAULT_SOURCE` before the first include). Otherwise chunks
+ * are only aligned to huge pages.
+ *
+ * `NODE_POOL(Name, type)` declares typed wrappers, see below.
+ */
+#if !defined(LANG_NODE_POOL_H)
+#define LANG_NODE_POOL_H
+
+#include <pthread.h>     /* pthread_mutex_*           */
+#include <stdalign.h>    /* alignof                   */
+#include <stdbool.h>     /* bool                      */
+#include <stddef.h>      /* size_t, max_align_t       */
+#include <sys/mman.h>    /* mmap, munmap, madvise     */
+#include "lang/assert.h"
+#include "lang/memory.h"
+
+/* Nodes moved between a cache and the depot at once. */
+#define NODE_POOL_BATCH  32
+
+/* Flags of `NodePool_new`. */
+#define NODE_POOL_HUGE   1u
+
+#define NODE_POOL_CHUNK       (64 * 1024)
+#define NODE_POOL_HUGE_CHUNK  (2 * 1024 * 1024)
+
+typedef struct node_pool* NodePool_T;
+typedef struct node_cache* NodeCache_T;
+
+typedef struct {
+  size_t chunks;     /* Chunks taken from the system.          */
+  size_t huge;       /* Chunks mapped on huge pages.           */
+  size_t reserved;   /* Bytes of chunks, headers too.          */
+  size_t nodes;      /* Nodes carved since the last release.   */
+} NodePool_Stats;
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+/* Placed at the beginning of every chunk. */
+struct node_chunk {
+  struct node_chunk* next;
+  size_t size;
+  bool mapped;
+};
+
+/* Free nodes are linked through their first bytes. */
+struct node_free {
+  struct node_free* next;
+};
+
+struct node_cache {
+  struct node_pool* pool;
+  struct node_free* free;
+  size_t length;
+
+  /* Caches of the pool, emptied by `NodePool_release`. */
+  struct node_cache* prev;
+  struct node_cache* next;
+};
+
+struct node_pool {
+  size_t node_size;
+  size_t offset;         /* First node after the chunk header. */
+  size_t chunk_size;
+  unsigned flags;
+
+  pthread_mutex_t lock;  /* Guards the depot. */
+
+  /* Depot */
+  struct node_free* free;
+  struct node_chunk* chunks;   /* In use, current first.   */
+  struct node_chunk* spare;    /* Left by `NodePool_release`. */
+  char* avail;
+  char* limit;
+
+  NodePool_Stats stats;
+
+  struct node_cache local;   /* First of the caches. */
+};
+
+/* Called without the lock, it could throw. */
+static inline struct node_chunk*
+__node_pool_chunk(NodePool_T pool)
+{
+  const bool huge = (pool->flags & NODE_POOL_HUGE) != 0;
+  struct node_chunk* chunk = NULL;
+
+#if defined(MAP_ANONYMOUS) && defined(MAP_HUGETLB)
+  if (huge) {
+    void* pages = mmap(NULL, pool->chunk_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    if (pages != MAP_FAILED) {
+      chunk = pages;
+      chunk->mapped = true;
+    }
+  }
+#endif
+
+  if (chunk == NULL) {
+    chunk = ALLOC_ALIGNED(huge ? NODE_POOL_HUGE_CHUNK : alignof (max_align_t), pool->chunk_size);
+
+#if defined(MADV_HUGEPAGE)
+    if (huge)
+    { madvise(chunk, pool->chunk_size, MADV_HUGEPAGE); }
+#endif
+
+    chunk->mapped = false;
+  }
+
+  chunk->size = pool->chunk_size;
+  return chunk;
+}
+
+static inline void
+__node_pool_unmap(struct node_chunk* chunk)
+{
+  while (chunk != NULL) {
+    struct node_chunk* next = chunk->next;
+
+#if defined(MAP_ANONYMOUS) && defined(MAP_HUGETLB)
+    if (chunk->mapped) {
+      munmap(chunk, chunk->size);
+      chunk = next;
+      continue;
+    }
+#endif
+
+    FREE_ALIGNED(chunk);
+    chunk = next;
+  }
+}
+
+/* Moves up to `NODE_POOL_BATCH` free nodes from the depot to `cache`. */
+static inline void
+__node_pool_refill(NodeCache_T cache)
+{
+  NodePool_T pool = cache->pool;
+
+  pthread_mutex_lock(&pool->lock);
+
+  while (cache->length < NODE_POOL_BATCH && pool->free != NULL) {
+    struct node_free* node = pool->free;
+    pool->free = node->next;
+
+    node->next = cache->free;
+    cache->free = node;
+    cache->length++;
+  }
+
+  while (cache->length < NODE_POOL_BATCH) {
+    if (pool->avail == pool->limit) {
+      struct node_chunk* chunk = pool->spare;
+
+      if (chunk != NULL) {
+        pool->spare = chunk->next;
+
+      } else {
+        pthread_mutex_unlock(&pool->lock);
+        chunk = __node_pool_chunk(pool);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->stats.chunks++;
+        pool->stats.huge += chunk->mapped;
+        pool->stats.reserved += chunk->size;
+
+        /* Other thread added a chunk meanwhile, this one is kept for later. */
+        if (pool->avail != pool->limit) {
+          chunk->next = pool->spare;
+          pool->spare = chunk;
+          continue;
+        }
+      }
+
+      chunk->next = pool->chunks;
+      pool->chunks = chunk;
+
+      pool->avail = (char*)chunk + pool->offset;
+      pool->limit = pool->avail
+                    + (chunk->size - pool->offset) / pool->node_size * pool->node_size;
+    }
+
+    struct node_free* node = (struct node_free*)(void*)pool->avail;
+    pool->avail += pool->node_size;
+    pool->stats.nodes++;
+
+    node->next = cache->free;
+    cache->free = node;
+    cache->length++;
+  }
+
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/* Moves the first `count` free nodes of `cache` to the depot. */
+static inline void
+__node_pool_flush(NodeCache_T cache, size_t count)
+{
+  NodePool_T pool = cache->pool;
+  struct node_free* first = cache->free;
+  struct node_free* last = first;
+
+  for (size_t i = 1; i < count; ++i) {
+    last = last->next;
+  }
+
+  cache->free = last->next;
+  cache->length -= count;
+
+  pthread_mutex_lock(&pool->lock);
+
+  last->next = pool->free;
+  pool->free = first;
+
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+/* __________________________________________________________________________ */
+/*                                                                    Pool  */
+
+/**
+ * Create a pool of nodes of `node_size` bytes aligned to `align`, which must
+ * be a power of two not bigger than `max_align_t` alignment. `flags` is 0 or
+ * `NODE_POOL_HUGE`.
+ *
+ * @throw `Memory_Failed` if there is no memory.
+ */
+static inline NodePool_T
+NodePool_new(size_t node_size, size_t align, unsigned flags)
+{
+  Require(node_size > 0);
+  Require(align > 0 && (align & (align - 1)) == 0 && align <= alignof (max_align_t));
+
+  NodePool_T pool;
+  NEW(pool);
+
+  if (align < alignof (struct node_free))
+  { align = alignof (struct node_free); }
+
+  if (node_size < sizeof (struct node_free))
+  { node_size = sizeof (struct node_free); }
+
+  pool->node_size = (node_size + align - 1) & ~(align - 1);
+  pool->offset = (sizeof (struct node_chunk) + alignof (max_align_t) - 1)
+                 & ~(alignof (max_align_t) - 1);
+  pool->flags = flags;
+
+  pool->chunk_size = (flags & NODE_POOL_HUGE) ? NODE_POOL_HUGE_CHUNK : NODE_POOL_CHUNK;
+
+  /* At least a few batches in a chunk for big nodes. */
+  while (pool->chunk_size < pool->offset + 4 * NODE_POOL_BATCH * pool->node_size) {
+    pool->chunk_size *= 2;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+
+  pool->free = NULL;
+  pool->chunks = NULL;
+  pool->spare = NULL;
+  pool->avail = NULL;
+  pool->limit = NULL;
+
+  pool->stats = (NodePool_Stats) { 0, 0, 0, 0 };
+
+  pool->local = (struct node_cache) { pool, NULL, 0, NULL, NULL };
+
+  return pool;
+}
+
+/**
+ * Return the pool memory to the system. Nodes and caches of the pool must not
+ * be used any more, caches should be freed first.
+ */
+static inline void
+NodePool_free(NodePool_T* p_pool)
+{
+  Require(p_pool != NULL && *p_pool != NULL);
+
+  NodePool_T pool = *p_pool;
+
+  __node_pool_unmap(pool->chunks);
+  __node_pool_unmap(pool->spare);
+  pthread_mutex_destroy(&pool->lock);
+
+  FREE(*p_pool);
+}
+
+/**
+ * Take back all nodes of the pool, got by any thread. Chunks are kept for next
+ * nodes, free nodes in caches are dropped too. Other threads must not use the
+ * pool meanwhile and nodes got before must not be put back.
+ */
+static inline void
+NodePool_release(NodePool_T pool)
+{
+  Require(pool != NULL);
+
+  pthread_mutex_lock(&pool->lock);
+
+  struct node_chunk* chunk = pool->chunks;
+
+  while (chunk != NULL) {
+    struct node_chunk* next = chunk->next;
+    chunk->next = pool->spare;
+    pool->spare = chunk;
+    chunk = next;
+  }
+
+  pool->chunks = NULL;
+  pool->free = NULL;
+  pool->avail = pool->limit = NULL;
+  pool->stats.nodes = 0;
+
+  for (struct node_cache* cache = &pool->local; cache != NULL; cache = cache->next) {
+    cache->free = NULL;
+    cache->length = 0;
+  }
+
+  pthread_mutex_unlock(&pool->lock);
+}
+
+static inline void
+NodePool_stats(NodePool_T pool, NodePool_Stats* p_stats__)
+{
+  Require(pool != NULL && p_stats__ != NULL);
+
+  pthread_mutex_lock(&pool->lock);
+  *p_stats__ = pool->stats;
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/* __________________________________________________________________________ */
+/*                                                                  Caches  */
+
+/**
+ * Create a cache of free nodes of `pool` for the calling thread. It must be
+ * used by one thread at a time.
+ *
+ * @throw `Memory_Failed` if there is no memory.
+ */
+static inline NodeCache_T
+NodeCache_new(NodePool_T pool)
+{
+  Require(pool != NULL);
+
+  NodeCache_T cache;
+  NEW(cache);
+
+  pthread_mutex_lock(&pool->lock);
+
+  *cache = (struct node_cache) { pool, NULL, 0, &pool->local, pool->local.next };
+
+  if (pool->local.next != NULL)
+  { pool->local.next->prev = cache; }
+
+  pool->local.next = cache;
+
+  pthread_mutex_unlock(&pool->lock);
+
+  return cache;
+}
+
+/**
+ * Return a node of the pool, its bytes are not initialized.
+ *
+ * @throw `Memory_Failed` if there is no memory.
+ */
+static inline void*
+NodeCache_get(NodeCache_T cache)
+{
+  if (cache->free == NULL)
+  { __node_pool_refill(cache); }
+
+  struct node_free* node = cache->free;
+  cache->free = node->next;
+  cache->length--;
+
+  return node;
+}
+
+/**
+ * Give back `node`. It could be got from any cache of the same pool.
+ */
+static inline void
+NodeCache_put(NodeCache_T cache, void* node)
+{
+  Require(node != NULL);
+
+  struct node_free* free_node = node;
+  free_node->next = cache->free;
+  cache->free = free_node;
+
+  if (++cache->length == 2 * NODE_POOL_BATCH)
+  { __node_pool_flush(cache, NODE_POOL_BATCH); }
+}
+
+/**
+ * Give free nodes of the cache back to the pool and free the cache.
+ */
+static inline void
+NodeCache_free(NodeCache_T* p_cache)
+{
+  Require(p_cache != NULL && *p_cache != NULL);
+
+  NodeCache_T cache = *p_cache;
+  NodePool_T pool = cache->pool;
+
+  if (cache->length > 0)
+  { __node_pool_flush(cache, cache->length); }
+
+  pthread_mutex_lock(&pool->lock);
+
+  cache->prev->next = cache->next;
+
+  if (cache->next != NULL)
+  { cache->next->prev = cache->prev; }
+
+  pthread_mutex_unlock(&pool->lock);
+
+  FREE(*p_cache);
+}
+
+/**
+ * Same as `NodeCache_get`/`NodeCache_put` with the cache of the pool, only for
+ * the thread that created the pool.
+ */
+static inline void*
+NodePool_get(NodePool_T pool)
+{
+  return NodeCache_get(&pool->local);
+}
+
+static inline void
+NodePool_put(NodePool_T pool, void* node)
+{
+  NodeCache_put(&pool->local, node);
+}
+
+/* __________________________________________________________________________ */
+/*                                                             Typed pools  */
+
+/*
+ * Declares `Name##Pool_T` and `Name##Cache_T` with the functions above taking
+ * and returning `type*`, e.g.
+ *
+ *   NODE_POOL(Tree, tree_node_t)
+ *
+ *   TreePool_T pool = TreePool_new(0);
+ *   tree_node_t* node = TreePool_get(pool);
+ */
+#define NODE_POOL(Name, type)                                                 \
+  typedef struct Name##_pool* Name##Pool_T;                                   \
+  typedef struct Name##_cache* Name##Cache_T;                                 \
+                                                                              \
+  static inline Name##Pool_T                                                  \
+  Name##Pool_new(unsigned flags)                                              \
+  { return (Name##Pool_T)NodePool_new(sizeof (type), alignof (type), flags); } \
+                                                                              \
+  static inline void                                                          \
+  Name##Pool_free(Name##Pool_T* p_pool)                                       \
+  {                                                                           \
+    NodePool_T pool = (NodePool_T)*p_pool;                                    \
+    NodePool_free(&pool);                                                     \
+    *p_pool = NULL;                                                           \
+  }                                                                           \
+                                                                              \
+  static inline void                                                          \
+  Name##Pool_release(Name##Pool_T pool)                                       \
+  { NodePool_release((NodePool_T)pool); }                                     \
+                                                                              \
+  static inline void                                                          \
+  Name##Pool_stats(Name##Pool_T pool, NodePool_Stats* p_stats__)              \
+  { NodePool_stats((NodePool_T)pool, p_stats__); }                            \
+                                                                              \
+  static inline type*                                                         \
+  Name##Pool_get(Name##Pool_T pool)                                           \
+  { return NodePool_get((NodePool_T)pool); }                                  \
+                                                                              \
+  static inline void                                                          \
+  Name##Pool_put(Name##Pool_T pool, type* node)                               \
+  { NodePool_put((NodePool_T)pool, node); }                                   \
+                                                                              \
+  static inline Name##Cache_T                                                 \
+  Name##Cache_new(Name##Pool_T pool)                                          \
+  { return (Name##Cache_T)NodeCache_new((NodePool_T)pool); }                  \
+                                                                              \
+  static inline void                                                          \
+  Name##Cache_free(Name##Cache_T* p_cache)                                    \
+  {                                                                           \
+    NodeCache_T cache = (NodeCache_T)*p_cache;                                \
+    NodeCache_free(&cache);                                                   \
+    *p_cache = NULL;                                                          \
+  }                                                                           \
+                                                                              \
+  static inline type*                                                         \
+  Name##Cache_get(Name##Cache_T cache)                                        \
+  { return NodeCache_get((NodeCache_T)cache); }                               \
+                                                                              \
+  static inline void                                                          \
+  Name##Cache_put(Name##Cache_T cache, type* node)                            \
+  { NodeCache_put((NodeCache_T)cache, node); }
+
+#endif  /* LANG_NODE_POOL_H */
@@ -0,0 +1,26 @@
+/**
+ * @file     memory-backend.h
+ * @brief    Selects which `Memory_*` implementation is compiled.
+ *
+ * Exactly one of `memory.c` (libc), `memory-dev.c` (checked) and
+ * `memory-slab.c` (size-class slabs) defines the `Memory_*` functions. By
+ * default the build mode decides: `NDEBUG` builds use libc and debug builds
+ * use the checked version. `--enable-memslab` defines `MEMSLAB_MODE` and
+ * overrides both. Benchmarks and tests that compare back-ends define one of
+ * `MEMORY_BACKEND_*` explicitly.
+ */
+#if !defined(LANG_MEMORY_BACKEND_H)
+#define LANG_MEMORY_BACKEND_H
+
+#if !defined(MEMORY_BACKEND_LIBC) && !defined(MEMORY_BACKEND_DEV) \
+    && !defined(MEMORY_BACKEND_SLAB)
+#  if defined(MEMSLAB_MODE)
+#    define MEMORY_BACKEND_SLAB
+#  elif defined(NDEBUG)
+#    define MEMORY_BACKEND_LIBC
+#  else
+#    define MEMORY_BACKEND_DEV
+#  endif
+#endif
+
+#endif  /* LANG_MEMORY_BACKEND_H */
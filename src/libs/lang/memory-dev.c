@@ -4,11 +4,18 @@
  *
  * Memory allocated through NEW etc. should be freed using FREE macro
  * otherwise strange error message will be raised.
+ *
+ * Descriptor table is shared by all threads and guarded by one mutex, so the
+ * checked build runs multithreaded programs too - slowly.
  */
-#if !defined(NDEBUG)
+#include "memory-backend.h"
+
+#if defined(MEMORY_BACKEND_DEV)
 
 #include "lang/memory.h"
 
+#include <pthread.h>     /* pthread_mutex_*               */
+#include <stdint.h>      /* SIZE_MAX                      */
 #include <stdlib.h>      /* malloc, calloc, realloc, free */
 #include <string.h>      /* memset                        */
 #include "lang/assert.h"
@@ -45,11 +52,15 @@ static struct descriptor {
   size_t size;
   const char* file;
   int line;
+  int aligned;            /* From `Memory_aligned_alloc`. */
 }* htab[TOTAL_BUCKETS];
 
 /* Initialization - points to itself because we build cyclic list. */
 static struct descriptor freelist = { .free = &freelist };
 
+/* Guards `htab`, `freelist` and the descriptors pool. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
 typedef struct descriptor* Descriptor_T;
 
 static Descriptor_T
@@ -86,6 +97,7 @@ __dalloc(void* ptr, size_t size, const char* file, int line)
   avail->size = size;
   avail->file = file;
   avail->line = line;
+  avail->aligned = 0;
 
   avail->free = avail->link = NULL;
 
@@ -94,13 +106,10 @@ __dalloc(void* ptr, size_t size, const char* file, int line)
   return avail++;
 }
 
-/* __________________________________________________________________________ */
-
-void*
-Memory_alloc(size_t nbytes, const char* file, int line)
+/* Called with `lock` held. Returns NULL if the system is out of memory. */
+static void*
+__alloc(size_t nbytes, const char* file, int line)
 {
-  Require(nbytes > 0);
-
   /* Note that the number of bytes are multiple of the align size */
   nbytes = ((nbytes + sizeof (union align) - 1) / (sizeof (union align))) *
            (sizeof (union align));
@@ -121,14 +130,9 @@ Memory_alloc(size_t nbytes, const char* file, int line)
         htab[h] = desc;
 
         return ptr;
-
-      } else {
-
-        if (file == NULL)
-        { THROW(Memory_Failed); }
-        else
-        { Except_throw(&Memory_Failed, file, line); }
       }
+
+      return NULL;
     }
 
     /* If no suitable chunk was found in the `freelist` circle. */
@@ -143,10 +147,7 @@ Memory_alloc(size_t nbytes, const char* file, int line)
           ptr = NULL;
         }
 
-        if (file == NULL)
-        { THROW(Memory_Failed); }
-        else
-        { Except_throw(&Memory_Failed, file, line); }
+        return NULL;
       }
 
       Ensure(new_desc);
@@ -161,6 +162,27 @@ Memory_alloc(size_t nbytes, const char* file, int line)
   return NULL;
 }
 
+/* __________________________________________________________________________ */
+
+void*
+Memory_alloc(size_t nbytes, const char* file, int line)
+{
+  Require(nbytes > 0);
+
+  pthread_mutex_lock(&lock);
+  void* ptr = __alloc(nbytes, file, line);
+  pthread_mutex_unlock(&lock);
+
+  if (ptr == NULL) {
+    if (file == NULL)
+    { THROW(Memory_Failed); }
+    else
+    { Except_throw(&Memory_Failed, file, line); }
+  }
+
+  return ptr;
+}
+
 void*
 Memory_calloc(size_t count, size_t nbytes, const char* file, int line)
 {
@@ -181,16 +203,22 @@ Memory_resize(void* ptr, size_t nbytes, const char* file, int line)
 
   Descriptor_T desc = NULL;
 
+  pthread_mutex_lock(&lock);
+
   if (((unsigned long)ptr) % (sizeof (union align)) != 0
-      || (desc = __find(ptr)) == NULL || desc->free) {
+      || (desc = __find(ptr)) == NULL || desc->free || desc->aligned) {
 
+    pthread_mutex_unlock(&lock);
     Except_throw(&Assert_Failed, file, line);
   }
 
   Ensure(desc);
+  const size_t size = desc->size;
+
+  pthread_mutex_unlock(&lock);
 
   void* newptr = Memory_alloc(nbytes, file, line);
-  memcpy(newptr, ptr, nbytes < desc->size ? nbytes : desc->size);
+  memcpy(newptr, ptr, nbytes < size ? nbytes : size);
 
   Memory_free(ptr, file, line);
 
@@ -203,9 +231,12 @@ Memory_free(void* ptr, const char* file, int line)
   if (ptr) {
     Descriptor_T desc = NULL;
 
+    pthread_mutex_lock(&lock);
+
     if (((unsigned long)ptr) % (sizeof (union align)) != 0
-        || (desc = __find(ptr)) == NULL || desc->free) {
+        || (desc = __find(ptr)) == NULL || desc->free || desc->aligned) {
 
+      pthread_mutex_unlock(&lock);
       Except_throw(&Assert_Failed, file, line);
     }
 
@@ -213,9 +244,82 @@ Memory_free(void* ptr, const char* file, int line)
 
     desc->free = freelist.free;
     freelist.free = desc;
+
+    pthread_mutex_unlock(&lock);
+  }
+}
+
+/* Block is given back to the system, its descriptor stays freed. */
+void*
+Memory_aligned_alloc(size_t align, size_t nbytes, const char* file, int line)
+{
+  Require(align > 0 && (align & (align - 1)) == 0);
+  Require(nbytes > 0);
+
+  void* ptr = (nbytes <= SIZE_MAX - (align - 1))
+              ? aligned_alloc(align, (nbytes + align - 1) & ~(align - 1))
+              : NULL;
+
+  if (ptr != NULL) {
+    pthread_mutex_lock(&lock);
+
+    Descriptor_T desc = __find(ptr);
+
+    /* Same address could come back after a free. */
+    if (desc != NULL) {
+      desc->free = NULL;
+      desc->size = nbytes;
+      desc->file = file;
+      desc->line = line;
+
+    } else if ((desc = __dalloc(ptr, nbytes, file, line)) != NULL) {
+      desc->aligned = 1;
+
+      unsigned h = hash(ptr, htab);
+      desc->link = htab[h];
+      htab[h] = desc;
+
+    } else {
+      free(ptr);
+      ptr = NULL;
+    }
+
+    pthread_mutex_unlock(&lock);
+  }
+
+  if (ptr == NULL) {
+    if (file == NULL)
+    { THROW(Memory_Failed); }
+    else
+    { Except_throw(&Memory_Failed, file, line); }
+  }
+
+  return ptr;
+}
+
+void
+Memory_aligned_free(void* ptr, const char* file, int line)
+{
+  if (ptr) {
+    Descriptor_T desc = NULL;
+
+    pthread_mutex_lock(&lock);
+
+    if ((desc = __find(ptr)) == NULL || desc->free || !desc->aligned) {
+      pthread_mutex_unlock(&lock);
+      Except_throw(&Assert_Failed, file, line);
+    }
+
+    Ensure(desc);
+
+    /* Marked freed but not in `freelist`, the system has the block now. */
+    desc->free = desc;
+
+    pthread_mutex_unlock(&lock);
+    free(ptr);
   }
 }
 
 #else
 typedef int ISO_C_forbids_an_empty_translation_unit;
-#endif  /* NDEBUG */
+#endif  /* MEMORY_BACKEND_DEV */
@@ -0,0 +1,445 @@
+/**
+ * @file     memory-slab.c
+ * @brief    Size-class slab allocator. Enable it with `--enable-memslab`.
+ *
+ * Requests up to `MAX_SMALL` bytes are rounded up to one of the size classes.
+ * Every class carves blocks out of page-sized slabs and keeps the freed ones
+ * in a free list threaded through the blocks themselves, so `NEW`/`FREE` of a
+ * list or tree node cost a few pointer moves instead of a `malloc`/`free` call.
+ * Bigger requests get their own slab aligned region straight from libc.
+ *
+ * Each block lives inside a `SLAB_SIZE` aligned region that starts with a
+ * header, so `Memory_free` finds the owner class by masking the pointer.
+ *
+ * Thread safe. Every thread has its own heap: slabs, free lists (magazines)
+ * and spare pages, so the fast path takes no lock. A slab belongs to the heap
+ * that carved it. A block freed by another thread is pushed to the lock-free
+ * `remote` stack of the owner heap, and the owner takes them all back when its
+ * magazine of that class runs empty. Heaps of finished threads are adopted by
+ * new threads.
+ *
+ * ATTENTION: Slabs are never given back to the system.
+ */
+#include "memory-backend.h"
+
+#if defined(MEMORY_BACKEND_SLAB)
+
+#include "lang/memory.h"
+
+#include <pthread.h>     /* pthread_once, pthread_key_create */
+#include <stdatomic.h>   /* atomic_*                         */
+#include <stdint.h>      /* uintptr_t, SIZE_MAX              */
+#include <stdlib.h>      /* aligned_alloc, calloc, free      */
+#include <string.h>      /* memcpy, memset                   */
+#include "lang/assert.h"
+#include "lang/macros.h"
+
+union align {
+  int i;
+  long l;
+  long* lp;
+  void* p;
+  void (*fp)(void);
+  float f;
+  double d;
+  long double ld;
+};
+
+#define ALIGN_SIZE       (sizeof (union align))
+
+#define SLAB_SIZE        4096
+#define SLABS_PER_CHUNK  16
+#define SLAB_MAGIC       0x51AB51ABu
+
+/* Requests bigger than that are not served from slabs. */
+#define MAX_SMALL        (64 * ALIGN_SIZE)
+
+#define SLAB_OF(ptr) ((union slab_header*)((uintptr_t)(ptr) & ~(uintptr_t)(SLAB_SIZE - 1)))
+
+/* Initialize GLOBAL. Could be thrown from anywhere. */
+const Except_T Memory_Failed = { "Allocation failed" };
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+/* Size of every class in `ALIGN_SIZE` units. */
+static const unsigned k_class_units[] = {
+  1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64
+};
+
+#define NCLASSES    ARRAY_SIZE(k_class_units)
+#define LARGE_CLASS NCLASSES
+
+/* Maps request size in `ALIGN_SIZE` units to the smallest class that fits. */
+static const unsigned char k_unit_class[] = {
+  0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  8,  9,  9, 10, 10, 11, 11,
+  12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15,
+  16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17,
+  18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19
+};
+
+_Static_assert(sizeof (k_unit_class) == MAX_SMALL / ALIGN_SIZE + 1,
+               "Every small request size needs a class.");
+
+struct heap;
+
+/* Placed at the beginning of every slab and of every large block. */
+union slab_header {
+  struct {
+    unsigned magic;
+    unsigned sclass;     /* Index in `k_class_units` or `LARGE_CLASS`. */
+    size_t size;         /* Usable bytes of a large block. */
+    struct heap* owner;  /* Heap that carved the slab. */
+  } s;
+  union align a;
+};
+
+#define HEADER_SIZE (sizeof (union slab_header))
+
+/* Freed blocks are linked through their first word. */
+struct free_block {
+  struct free_block* next;
+};
+
+struct size_class {
+  struct free_block* freelist;  /* Magazine of freed blocks. */
+  char* avail;                  /* Bump pointer into the newest slab. */
+  char* limit;
+};
+
+/* Only `remote` is touched by threads other than the owner. */
+struct heap {
+  struct size_class classes[NCLASSES];
+
+  /* Pages carved from the last chunk but not yet given to a class. */
+  char* spare_pages;
+  int nspare;
+
+  _Atomic(struct free_block*) remote;
+
+  struct heap* next_orphan;
+};
+
+static _Thread_local struct heap* local_heap;
+
+/* Heaps of finished threads waiting for a new owner. */
+static struct heap* orphans;
+static pthread_mutex_t orphans_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_key_t heap_key;
+static pthread_once_t heap_key_once = PTHREAD_ONCE_INIT;
+
+static void
+__fail(const char* file, int line)
+{
+  if (file == NULL)
+  { THROW(Memory_Failed); }
+  else
+  { Except_throw(&Memory_Failed, file, line); }
+}
+
+static size_t
+__class_size(unsigned sclass)
+{
+  return k_class_units[sclass] * ALIGN_SIZE;
+}
+
+/* Runs when a thread that used the allocator finishes. */
+static void
+__heap_orphan(void* heap)
+{
+  local_heap = NULL;
+
+  pthread_mutex_lock(&orphans_lock);
+  ((struct heap*)heap)->next_orphan = orphans;
+  orphans = heap;
+  pthread_mutex_unlock(&orphans_lock);
+}
+
+static void
+__heap_key_create(void)
+{
+  pthread_key_create(&heap_key, __heap_orphan);
+}
+
+/* Slow path, once per thread: adopt an orphaned heap or create a new one. */
+static struct heap*
+__heap_attach(void)
+{
+  pthread_once(&heap_key_once, __heap_key_create);
+
+  pthread_mutex_lock(&orphans_lock);
+  struct heap* heap = orphans;
+  if (heap != NULL) {
+    orphans = heap->next_orphan;
+  }
+  pthread_mutex_unlock(&orphans_lock);
+
+  if (heap == NULL) {
+    heap = calloc(1, sizeof(*heap));
+
+    if (heap == NULL)
+    { return NULL; }
+
+    atomic_init(&heap->remote, NULL);
+  }
+
+  pthread_setspecific(heap_key, heap);
+  local_heap = heap;
+
+  return heap;
+}
+
+/* Move every block freed by other threads back to its magazine. */
+static void
+__heap_drain(struct heap* heap)
+{
+  struct free_block* block = atomic_exchange_explicit(&heap->remote, NULL,
+                                                      memory_order_acquire);
+
+  while (block != NULL) {
+    struct free_block* next = block->next;
+    struct size_class* c = &heap->classes[SLAB_OF(block)->s.sclass];
+
+    block->next = c->freelist;
+    c->freelist = block;
+
+    block = next;
+  }
+}
+
+/* Lock-free push; many threads could return blocks to the same heap. */
+static void
+__heap_return(struct heap* heap, struct free_block* block)
+{
+  struct free_block* head = atomic_load_explicit(&heap->remote, memory_order_relaxed);
+
+  do {
+    block->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(&heap->remote, &head, block,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+static union slab_header*
+__page_alloc(struct heap* heap)
+{
+  if (heap->nspare == 0) {
+    heap->spare_pages = aligned_alloc(SLAB_SIZE, SLABS_PER_CHUNK * SLAB_SIZE);
+
+    if (heap->spare_pages == NULL)
+    { return NULL; }
+
+    heap->nspare = SLABS_PER_CHUNK;
+  }
+
+  union slab_header* page = (union slab_header*)(void*)heap->spare_pages;
+  heap->spare_pages += SLAB_SIZE;
+  heap->nspare--;
+
+  return page;
+}
+
+/* Returns NULL if the system is out of memory. */
+static void*
+__small_alloc(unsigned sclass)
+{
+  struct heap* heap = local_heap;
+
+  if (heap == NULL && (heap = __heap_attach()) == NULL)
+  { return NULL; }
+
+  struct size_class* c = &heap->classes[sclass];
+  const size_t size = __class_size(sclass);
+
+  if (c->freelist == NULL
+      && atomic_load_explicit(&heap->remote, memory_order_relaxed) != NULL) {
+    __heap_drain(heap);
+  }
+
+  if (c->freelist != NULL) {
+    struct free_block* block = c->freelist;
+    c->freelist = block->next;
+
+    return block;
+  }
+
+  if (c->avail == NULL || (size_t)(c->limit - c->avail) < size) {
+    union slab_header* page = __page_alloc(heap);
+
+    if (page == NULL)
+    { return NULL; }
+
+    page->s.magic = SLAB_MAGIC;
+    page->s.sclass = sclass;
+    page->s.size = size;
+    page->s.owner = heap;
+
+    c->avail = (char*)page + HEADER_SIZE;
+    c->limit = (char*)page + SLAB_SIZE;
+  }
+
+  c->avail += size;
+  return c->avail - size;
+}
+
+static void*
+__large_alloc(size_t nbytes)
+{
+  const size_t total = ((HEADER_SIZE + nbytes + SLAB_SIZE - 1) / SLAB_SIZE) * SLAB_SIZE;
+
+  union slab_header* block = aligned_alloc(SLAB_SIZE, total);
+
+  if (block == NULL)
+  { return NULL; }
+
+  block->s.magic = SLAB_MAGIC;
+  block->s.sclass = LARGE_CLASS;
+  block->s.size = total - HEADER_SIZE;
+  block->s.owner = NULL;
+
+  return block + 1;
+}
+
+static unsigned
+__size_class(size_t nbytes)
+{
+  return (nbytes > MAX_SMALL) ? LARGE_CLASS
+                              : k_unit_class[(nbytes + ALIGN_SIZE - 1) / ALIGN_SIZE];
+}
+
+static void*
+__alloc(size_t nbytes)
+{
+  const unsigned sclass = __size_class(nbytes);
+
+  return (sclass == LARGE_CLASS) ? __large_alloc(nbytes) : __small_alloc(sclass);
+}
+
+/* Usable size of the block that holds `ptr`. */
+static size_t
+__block_size(const union slab_header* header)
+{
+  return (header->s.sclass == LARGE_CLASS) ? header->s.size
+                                           : __class_size(header->s.sclass);
+}
+
+/* __________________________________________________________________________ */
+
+void*
+Memory_alloc(size_t nbytes, const char* file, int line)
+{
+  Require(nbytes > 0);
+
+  void* ptr = __alloc(nbytes);
+
+  if (ptr == NULL)
+  { __fail(file, line); }
+
+  return ptr;
+}
+
+void*
+Memory_calloc(size_t count, size_t nbytes, const char* file, int line)
+{
+  Require(count > 0);
+  Require(nbytes > 0);
+
+  if (nbytes > SIZE_MAX / count)
+  { __fail(file, line); }
+
+  void* ptr = Memory_alloc(count * nbytes, file, line);
+  memset(ptr, '\0', count * nbytes);
+
+  return ptr;
+}
+
+void*
+Memory_resize(void* ptr, size_t nbytes, const char* file, int line)
+{
+  Require(ptr);
+  Require(nbytes > 0);
+
+  const union slab_header* header = SLAB_OF(ptr);
+  Require(header->s.magic == SLAB_MAGIC);
+
+  const size_t old_size = __block_size(header);
+
+  /* Nothing to move if the block keeps its class. */
+  if (nbytes <= old_size && __size_class(nbytes) == header->s.sclass) {
+    return ptr;
+  }
+
+  void* newptr = __alloc(nbytes);
+
+  if (newptr == NULL) {
+    Memory_free(ptr, file, line);
+    __fail(file, line);
+  }
+
+  memcpy(newptr, ptr, nbytes < old_size ? nbytes : old_size);
+  Memory_free(ptr, file, line);
+
+  return newptr;
+}
+
+void
+Memory_free(void* ptr, const char* file, int line)
+{
+  /* Used only in the dev version */
+  UNUSED(file);
+  UNUSED(line);
+
+  if (ptr == NULL)
+  { return; }
+
+  union slab_header* header = SLAB_OF(ptr);
+  Require(header->s.magic == SLAB_MAGIC);
+
+  if (header->s.sclass == LARGE_CLASS) {
+    free(header);
+    return;
+  }
+
+  struct heap* owner = header->s.owner;
+  struct free_block* block = ptr;
+
+  if (owner == local_heap) {
+    block->next = owner->classes[header->s.sclass].freelist;
+    owner->classes[header->s.sclass].freelist = block;
+
+  } else {
+    __heap_return(owner, block);
+  }
+}
+
+/* Aligned blocks come straight from libc, there is no slab header. */
+void*
+Memory_aligned_alloc(size_t align, size_t nbytes, const char* file, int line)
+{
+  Require(align > 0 && (align & (align - 1)) == 0);
+  Require(nbytes > 0);
+
+  if (nbytes > SIZE_MAX - (align - 1))
+  { __fail(file, line); }
+
+  void* ptr = aligned_alloc(align, (nbytes + align - 1) & ~(align - 1));
+
+  if (ptr == NULL)
+  { __fail(file, line); }
+
+  return ptr;
+}
+
+void
+Memory_aligned_free(void* ptr, const char* file, int line)
+{
+  UNUSED(file);
+  UNUSED(line);
+
+  free(ptr);
+}
+
+#else
+typedef int ISO_C_forbids_an_empty_translation_unit;
+#endif  /* MEMORY_BACKEND_SLAB */
@@ -1,14 +1,17 @@
 /**
- * @file     memory-dev.c
+ * @file     memory.c
  * @brief    Production version.
  *
  * Nothing special just good practices and an exception
  * `Memory_Failed` is thrown if problem occurs.
  */
-#if defined(NDEBUG)
+#include "memory-backend.h"
+
+#if defined(MEMORY_BACKEND_LIBC)
 
 #include "lang/memory.h"
 
+#include <stdint.h>       /* SIZE_MAX                      */
 #include <stdlib.h>       /* malloc, calloc, realloc, free */
 #include "lang/assert.h"
 #include "lang/macros.h"
@@ -85,6 +88,33 @@ Memory_free(void* ptr, const char* file, int line)
   }
 }
 
+void*
+Memory_aligned_alloc(size_t align, size_t nbytes, const char* file, int line)
+{
+  Require(align > 0 && (align & (align - 1)) == 0);
+  Require(nbytes > 0);
+
+  /* Size must be a multiple of the alignment. */
+  void* ptr = (nbytes <= SIZE_MAX - (align - 1))
+              ? aligned_alloc(align, (nbytes + align - 1) & ~(align - 1))
+              : NULL;
+
+  if (ptr == NULL) {
+    if (file == NULL)
+    { THROW(Memory_Failed); }
+    else
+    { Except_throw(&Memory_Failed, file, line); }
+  }
+
+  return ptr;
+}
+
+void
+Memory_aligned_free(void* ptr, const char* file, int line)
+{
+  Memory_free(ptr, file, line);
+}
+
 #else
 typedef int ISO_C_forbids_an_empty_translation_unit;
-#endif  /* NDEBUG */
+#endif  /* MEMORY_BACKEND_LIBC */
@@ -0,0 +1,217 @@
+#include "lang/arena.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <greatest.h>
+
+TEST alloc_from_new_arena(void)
+{
+  Arena_T arena = Arena_new();
+
+  int* numbers = Arena_alloc(arena, 4 * sizeof(int), __FILE__, __LINE__);
+  ASSERT(numbers != NULL);
+
+  for (int i = 0; i < 4; ++i) {
+    numbers[i] = i;
+  }
+
+  ASSERT_EQ(3, numbers[3]);
+
+  Arena_dispose(&arena);
+  ASSERT_EQ(NULL, arena);
+  PASS();
+}
+
+TEST calloc_clears(void)
+{
+  Arena_T arena = Arena_new();
+
+  long* numbers = Arena_calloc(arena, 32, sizeof(long), __FILE__, __LINE__);
+
+  for (int i = 0; i < 32; ++i) {
+    ASSERT_EQ(0, numbers[i]);
+  }
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+TEST chunks_grow(void)
+{
+  Arena_T arena = Arena_new();
+  Arena_Stats stats;
+
+  /* 1 MiB in small blocks. */
+  for (int i = 0; i < 16 * 1024; ++i) {
+    char* block = Arena_alloc(arena, 64, __FILE__, __LINE__);
+    memset(block, 'a', 64);
+  }
+
+  Arena_stats(arena, &stats);
+
+  ASSERT_EQ(1024 * 1024, stats.used);
+  ASSERT_EQ(0, stats.large);
+  ASSERT(stats.chunks < 10);
+  ASSERT(stats.reserved >= stats.used + stats.waste);
+
+  Arena_free(arena);
+  Arena_stats(arena, &stats);
+
+  ASSERT_EQ(0, stats.used);
+  ASSERT_EQ(0, stats.chunks);
+  ASSERT_EQ(0, stats.reserved);
+  ASSERT_EQ(0, stats.waste);
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+TEST large_block(void)
+{
+  Arena_T arena = Arena_new();
+  Arena_Stats stats;
+
+  char* small = Arena_alloc(arena, 16, __FILE__, __LINE__);
+  char* large = Arena_alloc(arena, 100 * 1024, __FILE__, __LINE__);
+
+  memset(large, 'b', 100 * 1024);
+
+  Arena_stats(arena, &stats);
+  ASSERT_EQ(1, stats.chunks);
+  ASSERT_EQ(1, stats.large);
+
+  /* Current chunk is still used after the large block. */
+  char* next = Arena_alloc(arena, 16, __FILE__, __LINE__);
+  ASSERT_EQ(small + 16, next);
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+TEST mark_release(void)
+{
+  Arena_T arena = Arena_new();
+  Arena_Stats before, after;
+
+  int* keep = Arena_alloc(arena, sizeof(int), __FILE__, __LINE__);
+  *keep = 42;
+
+  Arena_stats(arena, &before);
+  Arena_Mark mark = Arena_mark(arena);
+
+  for (int i = 0; i < 1000; ++i) {
+    Arena_alloc(arena, 100 + (size_t)i, __FILE__, __LINE__);
+  }
+
+  Arena_alloc(arena, 1024 * 1024, __FILE__, __LINE__);
+
+  Arena_release(arena, mark);
+  Arena_stats(arena, &after);
+
+  ASSERT_EQ(42, *keep);
+  ASSERT_EQ(before.used, after.used);
+  ASSERT_EQ(before.chunks, after.chunks);
+  ASSERT_EQ(before.large, after.large);
+  ASSERT_EQ(before.waste, after.waste);
+
+  /* Space after the mark is given again. */
+  Arena_Mark again = Arena_mark(arena);
+  ASSERT_EQ((void*)mark, (void*)again);
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+TEST nested_marks(void)
+{
+  Arena_T arena = Arena_new();
+  Arena_Stats stats;
+
+  Arena_Mark outer = Arena_mark(arena);
+  Arena_alloc(arena, 5000, __FILE__, __LINE__);
+
+  Arena_Mark inner = Arena_mark(arena);
+  Arena_alloc(arena, 5000, __FILE__, __LINE__);
+
+  Arena_release(arena, inner);
+  Arena_stats(arena, &stats);
+  ASSERT(stats.used > 5000);
+
+  Arena_release(arena, outer);
+  Arena_stats(arena, &stats);
+  ASSERT_EQ(0, stats.used);
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+TEST aligned_blocks(void)
+{
+  Arena_T arena = Arena_new();
+
+  for (size_t nbytes = 1; nbytes < 5000; nbytes += 13) {
+    void* ptr = Arena_alloc(arena, nbytes, __FILE__, __LINE__);
+    ASSERT_EQ(0, (uintptr_t)ptr % sizeof(long double));
+  }
+
+  Arena_dispose(&arena);
+  PASS();
+}
+
+static void*
+requests(void* arg)
+{
+  int* p_failed = arg;
+
+  for (int i = 0; i < 200; ++i) {
+    Arena_T arena = Arena_new();
+
+    for (int j = 0; j < 2000; ++j) {
+      int* number = Arena_alloc(arena, 24, __FILE__, __LINE__);
+      *number = j;
+
+      if (*number != j)
+      { *p_failed = 1; }
+    }
+
+    Arena_dispose(&arena);
+  }
+
+  return NULL;
+}
+
+/* Chunks recycled by every thread go through local and shared pools. */
+TEST arenas_in_threads(void)
+{
+  enum { NTHREADS = 8 };
+
+  pthread_t threads[NTHREADS];
+  int failed[NTHREADS] = { 0 };
+
+  for (int i = 0; i < NTHREADS; ++i) {
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, requests, &failed[i]));
+  }
+
+  for (int i = 0; i < NTHREADS; ++i) {
+    ASSERT_EQ(0, pthread_join(threads[i], NULL));
+    ASSERT_EQ(0, failed[i]);
+  }
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(alloc_from_new_arena);
+  RUN_TEST(calloc_clears);
+  RUN_TEST(chunks_grow);
+  RUN_TEST(large_block);
+  RUN_TEST(mark_release);
+  RUN_TEST(nested_marks);
+  RUN_TEST(aligned_blocks);
+  RUN_TEST(arenas_in_threads);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,269 @@
+#include "lang/atom.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <greatest.h>
+#include "lang/assert.h"
+
+TEST same_string_same_atom(void)
+{
+  const char* first = Atom_string("identifier");
+  char buffer[] = "identifier";
+
+  ASSERT_EQ(first, Atom_string(buffer));
+  ASSERT_EQ(first, Atom_new("identifier_suffix", 10));
+  ASSERT_STR_EQ("identifier", first);
+
+  PASS();
+}
+
+TEST different_strings(void)
+{
+  const char* a = Atom_string("key_a");
+  const char* b = Atom_string("key_b");
+
+  ASSERT(a != b);
+  ASSERT(Atom_string("key") != a);
+
+  PASS();
+}
+
+TEST length(void)
+{
+  const char* atom = Atom_new("abc\0def", 7);
+
+  ASSERT_EQ(7, Atom_length(atom));
+  ASSERT_EQ(3, Atom_length(Atom_string("xyz")));
+
+  PASS();
+}
+
+#if !defined(NDEBUG)
+/* Same bytes as an atom, or bytes before it, are not the atom. */
+TEST not_an_atom(void)
+{
+  const char* atom = Atom_new("abc\0def", 7);
+  char copy[] = "abc\0def";
+  volatile int failed = 0;
+
+  ASSERT_EQ(7, Atom_length(atom));
+
+  TRY
+    Atom_length(copy);
+  CATCH(Precondition_Failed)
+    failed++;
+  END_TRY;
+
+  TRY
+    Atom_free(atom + 1);
+  CATCH(Precondition_Failed)
+    failed++;
+  END_TRY;
+
+  ASSERT_EQ(2, failed);
+  ASSERT_EQ(7, Atom_length(atom));
+
+  PASS();
+}
+#endif  /* NDEBUG */
+
+/* Enough atoms to resize every shard a few times. */
+TEST many_atoms(void)
+{
+  enum { COUNT = 100000 };
+
+  static const char* atoms[COUNT];
+  char buffer[32];
+
+  for (int i = 0; i < COUNT; ++i) {
+    snprintf(buffer, sizeof(buffer), "atom_%d", i);
+    atoms[i] = Atom_string(buffer);
+  }
+
+  for (int i = 0; i < COUNT; ++i) {
+    snprintf(buffer, sizeof(buffer), "atom_%d", i);
+    ASSERT_EQ(atoms[i], Atom_string(buffer));
+    ASSERT_EQ(strlen(buffer), Atom_length(atoms[i]));
+  }
+
+  PASS();
+}
+
+TEST references(void)
+{
+  const char* atom = Atom_string("counted");
+
+  ASSERT_EQ(atom, Atom_string("counted"));
+  Atom_free(atom);
+
+  /* One reference is left. */
+  ASSERT_EQ(atom, Atom_string("counted"));
+  Atom_free(atom);
+  Atom_free(atom);
+
+  PASS();
+}
+
+TEST free_removes(void)
+{
+  Atom_Stats before, after;
+
+  Atom_stats(&before);
+  const char* atom = Atom_string("short_lived");
+
+  Atom_stats(&after);
+  ASSERT_EQ(before.count + 1, after.count);
+  ASSERT(after.bytes > before.bytes);
+
+  Atom_free(atom);
+
+  Atom_stats(&after);
+  ASSERT_EQ(before.count, after.count);
+  ASSERT_EQ(before.bytes, after.bytes);
+
+  PASS();
+}
+
+TEST stats(void)
+{
+  Atom_Stats stats;
+
+  Atom_string("stats");
+  Atom_stats(&stats);
+
+  ASSERT(stats.count > 0);
+  ASSERT(stats.bytes >= stats.count * 6);
+  ASSERT(stats.longest_chain >= 1);
+  ASSERT(stats.buckets > 0);
+
+  PASS();
+}
+
+TEST reset(void)
+{
+  Atom_Stats stats;
+
+  Atom_string("before_reset");
+  Atom_reset();
+  Atom_stats(&stats);
+
+  ASSERT_EQ(0, stats.count);
+  ASSERT_EQ(0, stats.bytes);
+  ASSERT_EQ(0, stats.buckets);
+
+  /* Table is usable again. */
+  const char* atom = Atom_string("after_reset");
+  ASSERT_EQ(atom, Atom_string("after_reset"));
+  ASSERT_STR_EQ("after_reset", atom);
+
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+enum { NTHREADS = 4, PER_THREAD = 20000 };
+
+static const char* shared[NTHREADS][PER_THREAD];
+
+/* Every thread interns the same strings. */
+static void*
+intern(void* arg)
+{
+  const char** atoms = arg;
+  char buffer[32];
+
+  for (int i = 0; i < PER_THREAD; ++i) {
+    snprintf(buffer, sizeof(buffer), "shared_%d", i);
+    atoms[i] = Atom_string(buffer);
+  }
+
+  return NULL;
+}
+
+TEST threads_agree(void)
+{
+  pthread_t threads[NTHREADS];
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    ASSERT_EQ(0, pthread_create(&threads[t], NULL, intern, shared[t]));
+  }
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    ASSERT_EQ(0, pthread_join(threads[t], NULL));
+  }
+
+  for (int i = 0; i < PER_THREAD; ++i) {
+    for (int t = 1; t < NTHREADS; ++t) {
+      ASSERT_EQ(shared[0][i], shared[t][i]);
+    }
+  }
+
+  PASS();
+}
+
+/* Threads add and remove the same atoms all the time. */
+static void*
+churn(void* arg)
+{
+  int* p_failed = arg;
+  char buffer[32];
+
+  for (int i = 0; i < PER_THREAD; ++i) {
+    snprintf(buffer, sizeof(buffer), "churn_%d", i % 64);
+
+    const char* atom = Atom_string(buffer);
+
+    if (strcmp(atom, buffer) != 0 || atom != Atom_string(buffer))
+    { *p_failed = 1; }
+
+    Atom_free(atom);
+    Atom_free(atom);
+  }
+
+  return NULL;
+}
+
+TEST threads_churn(void)
+{
+  pthread_t threads[NTHREADS];
+  int failed[NTHREADS] = { 0 };
+  Atom_Stats before, after;
+
+  Atom_stats(&before);
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    ASSERT_EQ(0, pthread_create(&threads[t], NULL, churn, &failed[t]));
+  }
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    ASSERT_EQ(0, pthread_join(threads[t], NULL));
+    ASSERT_EQ(0, failed[t]);
+  }
+
+  Atom_stats(&after);
+  ASSERT_EQ(before.count, after.count);
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(same_string_same_atom);
+  RUN_TEST(different_strings);
+  RUN_TEST(length);
+#if !defined(NDEBUG)
+  RUN_TEST(not_an_atom);
+#endif
+  RUN_TEST(many_atoms);
+  RUN_TEST(references);
+  RUN_TEST(free_removes);
+  RUN_TEST(stats);
+  RUN_TEST(threads_agree);
+  RUN_TEST(threads_churn);
+  RUN_TEST(reset);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,171 @@
+#include "lang/epoch.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <greatest.h>
+#include "lang/macros.h"
+
+#define OBJECTS  1000
+
+typedef struct {
+  int freed;
+  Epoch_Link link;
+} object_t;
+
+static object_t first[OBJECTS];
+static object_t second[OBJECTS];
+
+static int freed;
+
+static void
+__free(Epoch_Link* link)
+{
+  CONTAINER_OF(link, object_t, link)->freed++;
+  freed++;
+}
+
+/* Other free function, to tell objects apart in `Epoch_flush`. */
+static void
+__free_other(Epoch_Link* link)
+{
+  CONTAINER_OF(link, object_t, link)->freed++;
+}
+
+static void
+__retire(object_t* objects, epoch_free_FN free_fn)
+{
+  for (int i = 0; i < OBJECTS; ++i) {
+    objects[i].freed = 0;
+    Epoch_retire(&objects[i].link, free_fn);
+  }
+}
+
+static bool
+__all_freed(const object_t* objects, int times)
+{
+  for (int i = 0; i < OBJECTS; ++i) {
+    if (objects[i].freed != times)
+    { return false; }
+  }
+
+  return true;
+}
+
+static atomic_int entered;
+static atomic_int done;
+
+static void*
+reader(void* arg)
+{
+  (void)arg;
+
+  Epoch_enter();
+  atomic_store(&entered, 1);
+
+  while (!atomic_load(&done)) {
+    sched_yield();
+  }
+
+  Epoch_leave();
+  return NULL;
+}
+
+/* __________________________________________________________________________ */
+
+TEST freed_once_out_of_reads(void)
+{
+  freed = 0;
+  __retire(first, __free);
+  __retire(second, __free);
+
+  /* Later retires free earlier ones. */
+  ASSERT(__all_freed(first, 1));
+  ASSERT(freed >= OBJECTS);
+
+  Epoch_flush(__free);
+  ASSERT(__all_freed(second, 1));
+
+  PASS();
+}
+
+TEST kept_while_other_thread_reads(void)
+{
+  pthread_t thread;
+
+  atomic_store(&entered, 0);
+  atomic_store(&done, 0);
+  ASSERT_EQ(0, pthread_create(&thread, NULL, reader, NULL));
+
+  while (!atomic_load(&entered)) {
+    sched_yield();
+  }
+
+  freed = 0;
+  __retire(first, __free);
+  ASSERT_EQ(0, freed);
+
+  atomic_store(&done, 1);
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+
+  __retire(second, __free);
+  ASSERT(__all_freed(first, 1));
+
+  Epoch_flush(__free);
+  ASSERT(__all_freed(second, 1));
+
+  PASS();
+}
+
+TEST nested_reads(void)
+{
+  Epoch_enter();
+  Epoch_enter();
+  Epoch_leave();
+
+  /* Still in, own retires are kept too. */
+  freed = 0;
+  __retire(first, __free);
+  ASSERT_EQ(0, freed);
+
+  Epoch_leave();
+
+  __retire(second, __free);
+  ASSERT(__all_freed(first, 1));
+
+  Epoch_flush(__free);
+  PASS();
+}
+
+TEST flush_frees_one_kind(void)
+{
+  Epoch_enter();
+
+  freed = 0;
+  __retire(first, __free);
+  __retire(second, __free_other);
+
+  Epoch_flush(__free_other);
+  ASSERT(__all_freed(second, 1));
+  ASSERT_EQ(0, freed);
+
+  Epoch_leave();
+
+  Epoch_flush(__free);
+  ASSERT(__all_freed(first, 1));
+  ASSERT(__all_freed(second, 1));
+
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(freed_once_out_of_reads);
+  RUN_TEST(kept_while_other_thread_reads);
+  RUN_TEST(nested_reads);
+  RUN_TEST(flush_frees_one_kind);
+  GREATEST_MAIN_END();
+}
@@ -1,5 +1,6 @@
 #include "lang/except.h"
 
+#include <pthread.h>
 #include <greatest.h>
 
 const Except_T UnitTest_Exception = { "Exception in unit test." };
@@ -44,10 +45,116 @@ TEST throw_catch(void)
   PASS();
 }
 
+static volatile int finalized = 0;
+
+/* Does not catch, exception goes to the enclosing TRY. */
+static void
+__finally_only(void)
+{
+  TRY
+    throw_excpetion();
+
+  CATCH(Unknown_Exception)
+    finalized = -1;
+
+  FINALLY
+    finalized = 1;
+
+  END_TRY;
+}
+
+TEST nested_rethrow(void)
+{
+  volatile int caught = 0;
+
+  TRY
+    __finally_only();
+
+  CATCH(UnitTest_Exception)
+    caught = 1;
+
+  END_TRY;
+
+  ASSERT_EQ(1, finalized);
+  ASSERT_EQ(1, caught);
+  ASSERT_EQ(NULL, Except_stack);
+
+  PASS();
+}
+
+static int
+__return_from_try(void)
+{
+  TRY
+    RETURN 42;
+
+  END_TRY;
+
+  return 0;
+}
+
+TEST return_in_try(void)
+{
+  ASSERT_EQ(42, __return_from_try());
+  ASSERT_EQ(NULL, Except_stack);
+
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+static void
+__catch_one(int* p_caught)
+{
+  TRY
+    throw_excpetion();
+
+  CATCH(UnitTest_Exception)
+    (*p_caught)++;
+
+  END_TRY;
+}
+
+/* Every thread throws and catches on its own exception stack. */
+static void*
+catcher(void* arg)
+{
+  for (int i = 0; i < 10000; ++i) {
+    __catch_one(arg);
+  }
+
+  return NULL;
+}
+
+TEST threads_own_stacks(void)
+{
+  enum { NTHREADS = 4 };
+
+  pthread_t threads[NTHREADS];
+  int caught[NTHREADS] = { 0 };
+
+  for (int i = 0; i < NTHREADS; ++i) {
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, catcher, &caught[i]));
+  }
+
+  for (int i = 0; i < NTHREADS; ++i) {
+    ASSERT_EQ(0, pthread_join(threads[i], NULL));
+    ASSERT_EQ(10000, caught[i]);
+  }
+
+  ASSERT_EQ(NULL, Except_stack);
+
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(throw_catch);
+  RUN_TEST(nested_rethrow);
+  RUN_TEST(return_in_try);
+  RUN_TEST(threads_own_stacks);
   GREATEST_MAIN_END();
 }
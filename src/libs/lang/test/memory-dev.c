@@ -1,6 +1,8 @@
 #include "lang/memory.h"
 
+#include <stdint.h>
 #include <greatest.h>
+#include "lang/assert.h"
 
 typedef struct {
   int a;
@@ -19,10 +21,42 @@ TEST allocate_macro(void)
   PASS();
 }
 
+TEST allocate_aligned(void)
+{
+  void* ptr = ALLOC_ALIGNED(64, 100);
+  ASSERT_EQ(0, (uintptr_t)ptr % 64);
+
+  FREE_ALIGNED(ptr);
+  ASSERT_EQ(NULL, ptr);
+
+  PASS();
+}
+
+/* Aligned block can't be freed with FREE. */
+TEST free_aligned_with_free(void)
+{
+  void* ptr = ALLOC_ALIGNED(64, 100);
+  void* volatile same = ptr;
+  volatile int failed = 0;
+
+  TRY
+    FREE(ptr);
+  CATCH(Assert_Failed)
+    failed = 1;
+  END_TRY;
+
+  ASSERT_EQ(1, failed);
+
+  FREE_ALIGNED(same);
+  PASS();
+}
+
 GREATEST_MAIN_DEFS();
 int main(int argc, char** argv)
 {
   GREATEST_MAIN_BEGIN();
   RUN_TEST(allocate_macro);
+  RUN_TEST(allocate_aligned);
+  RUN_TEST(free_aligned_with_free);
   GREATEST_MAIN_END();
 }
@@ -0,0 +1,285 @@
+#include "lang/memory.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <greatest.h>
+
+typedef struct {
+  void* data;
+  void* next;
+} node_t;
+
+TEST reuse_freed_block(void)
+{
+  node_t* first;
+  node_t* second;
+
+  NEW(first);
+  void* address = first;
+  FREE(first);
+
+  /* Free list is LIFO, the next node of the same class takes the same place. */
+  NEW(second);
+  ASSERT_EQ(address, (void*)second);
+
+  FREE(second);
+  PASS();
+}
+
+TEST classes_do_not_overlap(void)
+{
+  char* small = ALLOC(16);
+  char* medium = ALLOC(48);
+  char* big = ALLOC(1024);
+
+  memset(small, 'a', 16);
+  memset(medium, 'b', 48);
+  memset(big, 'c', 1024);
+
+  ASSERT_EQ('a', small[15]);
+  ASSERT_EQ('b', medium[0]);
+  ASSERT_EQ('b', medium[47]);
+  ASSERT_EQ('c', big[0]);
+
+  FREE(small);
+  FREE(medium);
+  FREE(big);
+  PASS();
+}
+
+TEST aligned_blocks(void)
+{
+  for (size_t nbytes = 1; nbytes < 2000; nbytes += 7) {
+    void* ptr = ALLOC(nbytes);
+    ASSERT_EQ(0, (uintptr_t)ptr % sizeof(long double));
+    FREE(ptr);
+  }
+
+  PASS();
+}
+
+TEST cache_line_aligned(void)
+{
+  for (size_t nbytes = 1; nbytes < 2000; nbytes += 77) {
+    char* ptr = ALLOC_ALIGNED(64, nbytes);
+    ASSERT_EQ(0, (uintptr_t)ptr % 64);
+
+    ptr[nbytes - 1] = 'a';
+    FREE_ALIGNED(ptr);
+  }
+
+  PASS();
+}
+
+TEST large_block(void)
+{
+  const size_t nbytes = 3 * 4096 + 100;
+  unsigned char* block = ALLOC(nbytes);
+
+  for (size_t i = 0; i < nbytes; ++i) {
+    block[i] = (unsigned char)i;
+  }
+
+  ASSERT_EQ((unsigned char)(nbytes - 1), block[nbytes - 1]);
+
+  FREE(block);
+  PASS();
+}
+
+TEST resize_keeps_content(void)
+{
+  int* numbers = ALLOC(4 * sizeof(int));
+
+  for (int i = 0; i < 4; ++i) {
+    numbers[i] = i;
+  }
+
+  /* Grows from a small class through a large block. */
+  RESIZE(numbers, 8 * sizeof(int));
+  RESIZE(numbers, 2048 * sizeof(int));
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(i, numbers[i]);
+  }
+
+  RESIZE(numbers, 2 * sizeof(int));
+  ASSERT_EQ(1, numbers[1]);
+
+  FREE(numbers);
+  PASS();
+}
+
+TEST calloc_clears(void)
+{
+  node_t* dirty;
+  NEW(dirty);
+  memset(dirty, 0xFF, sizeof(*dirty));
+  FREE(dirty);
+
+  node_t* clean;
+  NEW_0(clean);
+
+  ASSERT_EQ(NULL, clean->data);
+  ASSERT_EQ(NULL, clean->next);
+
+  FREE(clean);
+  PASS();
+}
+
+/* Product that wraps around is not taken for a small block. */
+TEST calloc_overflow(void)
+{
+  volatile int failed = 0;
+
+  TRY
+    CALLOC(SIZE_MAX / 8 + 2, 8);
+
+  CATCH(Memory_Failed)
+    failed = 1;
+
+  END_TRY;
+
+  ASSERT_EQ(1, failed);
+  PASS();
+}
+
+TEST many_nodes(void)
+{
+  enum { COUNT = 10000 };
+  node_t* nodes[COUNT];
+
+  for (int i = 0; i < COUNT; ++i) {
+    NEW(nodes[i]);
+    nodes[i]->next = nodes[i];
+  }
+
+  for (int i = 0; i < COUNT; ++i) {
+    ASSERT_EQ((void*)nodes[i], nodes[i]->next);
+    FREE(nodes[i]);
+  }
+
+  PASS();
+}
+
+TEST free_null(void)
+{
+  void* ptr = NULL;
+  FREE(ptr);
+
+  PASS();
+}
+
+/* __________________________________________________________________________ */
+/*                                                                   Threads  */
+
+enum { BATCH = 512 };
+
+static void*
+free_batch(void* arg)
+{
+  node_t** nodes = arg;
+
+  for (int i = 0; i < BATCH; ++i) {
+    FREE(nodes[i]);
+  }
+
+  return NULL;
+}
+
+static void*
+alloc_batch(void* arg)
+{
+  node_t** nodes = arg;
+
+  for (int i = 0; i < BATCH; ++i) {
+    NEW(nodes[i]);
+  }
+
+  return NULL;
+}
+
+TEST remote_free_comes_back(void)
+{
+  enum { LIMIT = 1 << 16 };
+
+  node_t* nodes[BATCH];
+  void* addresses[BATCH];
+  node_t** taken = ALLOC(LIMIT * sizeof(*taken));
+  pthread_t other;
+
+  for (int i = 0; i < BATCH; ++i) {
+    NEW(nodes[i]);
+    addresses[i] = nodes[i];
+  }
+
+  ASSERT_EQ(0, pthread_create(&other, NULL, free_batch, nodes));
+  ASSERT_EQ(0, pthread_join(other, NULL));
+
+  /* Once the local free list runs dry the owner takes remote blocks back. */
+  int reused = 0;
+  int count = 0;
+
+  while (reused < BATCH && count < LIMIT) {
+    NEW(taken[count]);
+
+    for (int j = 0; j < BATCH; ++j) {
+      if ((void*)taken[count] == addresses[j]) {
+        reused++;
+        break;
+      }
+    }
+
+    count++;
+  }
+
+  ASSERT_EQ(BATCH, reused);
+
+  for (int i = 0; i < count; ++i) {
+    FREE(taken[i]);
+  }
+
+  FREE(taken);
+  PASS();
+}
+
+TEST heap_of_finished_thread(void)
+{
+  node_t* nodes[BATCH];
+  pthread_t other;
+
+  ASSERT_EQ(0, pthread_create(&other, NULL, alloc_batch, nodes));
+  ASSERT_EQ(0, pthread_join(other, NULL));
+
+  for (int i = 0; i < BATCH; ++i) {
+    nodes[i]->data = nodes[i];
+  }
+
+  /* Nodes outlive the thread that allocated them. */
+  free_batch(nodes);
+
+  ASSERT_EQ(0, pthread_create(&other, NULL, alloc_batch, nodes));
+  ASSERT_EQ(0, pthread_join(other, NULL));
+
+  free_batch(nodes);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(reuse_freed_block);
+  RUN_TEST(classes_do_not_overlap);
+  RUN_TEST(aligned_blocks);
+  RUN_TEST(cache_line_aligned);
+  RUN_TEST(large_block);
+  RUN_TEST(resize_keeps_content);
+  RUN_TEST(calloc_clears);
+  RUN_TEST(calloc_overflow);
+  RUN_TEST(many_nodes);
+  RUN_TEST(free_null);
+  RUN_TEST(remote_free_comes_back);
+  RUN_TEST(heap_of_finished_thread);
+  GREATEST_MAIN_END();
+}
@@ -0,0 +1,244 @@
+#define _DEFAULT_SOURCE  /* MAP_HUGETLB, MADV_HUGEPAGE */
+
+#include "lang/node_pool.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <greatest.h>
+#include "lang/except.h"
+
+#define NTHREADS  4
+#define NODES     10000
+
+typedef struct tree_node {
+  int key;
+  struct tree_node* left;
+  struct tree_node* right;
+} tree_node_t;
+
+NODE_POOL(Tree, tree_node_t)
+
+/* Bigger than a batch per chunk allows at the default chunk size. */
+typedef struct {
+  char bytes[3000];
+} page_t;
+
+NODE_POOL(Page, page_t)
+
+TEST put_node_comes_back(void)
+{
+  TreePool_T pool = TreePool_new(0);
+
+  tree_node_t* node = TreePool_get(pool);
+  node->key = 1;
+  TreePool_put(pool, node);
+
+  ASSERT_EQ(node, TreePool_get(pool));
+
+  TreePool_free(&pool);
+  ASSERT_EQ(NULL, pool);
+  PASS();
+}
+
+TEST nodes_are_distinct(void)
+{
+  static tree_node_t* nodes[NODES];
+  TreePool_T pool = TreePool_new(0);
+
+  for (int i = 0; i < NODES; ++i) {
+    nodes[i] = TreePool_get(pool);
+    nodes[i]->key = i;
+    ASSERT_EQ(0, (uintptr_t)nodes[i] % alignof (tree_node_t));
+  }
+
+  for (int i = 0; i < NODES; ++i) {
+    ASSERT_EQ(i, nodes[i]->key);
+  }
+
+  TreePool_free(&pool);
+  PASS();
+}
+
+TEST big_nodes(void)
+{
+  PagePool_T pool = PagePool_new(0);
+  NodePool_Stats stats;
+
+  for (int i = 0; i < 1000; ++i) {
+    page_t* page = PagePool_get(pool);
+    page->bytes[0] = page->bytes[sizeof (page_t) - 1] = 'a';
+  }
+
+  PagePool_stats(pool, &stats);
+  ASSERT_EQ((1000 + NODE_POOL_BATCH - 1) / NODE_POOL_BATCH * NODE_POOL_BATCH, stats.nodes);
+  ASSERT(stats.reserved >= 1000 * sizeof (page_t));
+
+  PagePool_free(&pool);
+  PASS();
+}
+
+/* Allocation of the chunk fails, the pool lock must not stay taken. */
+TEST chunk_fails(void)
+{
+  NodePool_T pool = NodePool_new((size_t)1 << 44, 8, 0);
+  NodePool_Stats stats;
+  volatile int failed = 0;
+
+  TRY
+    NodePool_get(pool);
+  CATCH(Memory_Failed)
+    failed = 1;
+  END_TRY;
+
+  ASSERT_EQ(1, failed);
+
+  NodePool_stats(pool, &stats);
+  ASSERT_EQ(0, stats.chunks);
+  ASSERT_EQ(0, stats.nodes);
+
+  NodePool_free(&pool);
+  PASS();
+}
+
+TEST release_keeps_chunks(void)
+{
+  TreePool_T pool = TreePool_new(0);
+  NodePool_Stats before;
+  NodePool_Stats after;
+
+  for (int i = 0; i < NODES; ++i) {
+    TreePool_get(pool)->key = i;
+  }
+
+  TreePool_stats(pool, &before);
+  TreePool_release(pool);
+
+  TreePool_stats(pool, &after);
+  ASSERT_EQ(0, after.nodes);
+  ASSERT_EQ(before.chunks, after.chunks);
+
+  for (int i = 0; i < NODES; ++i) {
+    TreePool_get(pool)->key = i;
+  }
+
+  TreePool_stats(pool, &after);
+  ASSERT_EQ(before.nodes, after.nodes);
+  ASSERT_EQ(before.chunks, after.chunks);
+
+  TreePool_free(&pool);
+  PASS();
+}
+
+TEST release_drops_cached_nodes(void)
+{
+  TreePool_T pool = TreePool_new(0);
+  TreeCache_T cache = TreeCache_new(pool);
+  NodePool_Stats stats;
+
+  TreeCache_put(cache, TreeCache_get(cache));
+  TreePool_release(pool);
+
+  TreePool_stats(pool, &stats);
+  ASSERT_EQ(0, stats.nodes);
+
+  /* Free nodes of the cache were taken back by the release too. */
+  tree_node_t* node = TreeCache_get(cache);
+
+  TreePool_stats(pool, &stats);
+  ASSERT_EQ(NODE_POOL_BATCH, stats.nodes);
+  ASSERT(node != NULL);
+
+  TreeCache_free(&cache);
+  ASSERT_EQ(NULL, cache);
+
+  TreePool_free(&pool);
+  PASS();
+}
+
+TEST huge_pages(void)
+{
+  TreePool_T pool = TreePool_new(NODE_POOL_HUGE);
+  NodePool_Stats stats;
+
+  tree_node_t* node = TreePool_get(pool);
+  node->key = 1;
+
+  TreePool_stats(pool, &stats);
+  ASSERT_EQ(1, stats.chunks);
+  ASSERT_EQ(NODE_POOL_HUGE_CHUNK, stats.reserved);
+
+  TreePool_free(&pool);
+  PASS();
+}
+
+typedef struct {
+  TreePool_T pool;
+  int id;
+  int failed;
+} worker_t;
+
+/* Nodes are got and put in rounds, no node is given to two threads at once. */
+static void*
+churn(void* arg)
+{
+  worker_t* worker = arg;
+  TreeCache_T cache = TreeCache_new(worker->pool);
+  tree_node_t* nodes[1000];
+
+  for (int round = 0; round < 200; ++round) {
+    const int count = 1 + (round * 37) % 1000;
+
+    for (int i = 0; i < count; ++i) {
+      nodes[i] = TreeCache_get(cache);
+      nodes[i]->key = worker->id;
+    }
+
+    for (int i = 0; i < count; ++i) {
+      worker->failed += (nodes[i]->key != worker->id);
+      TreeCache_put(cache, nodes[i]);
+    }
+  }
+
+  TreeCache_free(&cache);
+  return NULL;
+}
+
+TEST caches_in_threads(void)
+{
+  TreePool_T pool = TreePool_new(0);
+  pthread_t threads[NTHREADS];
+  worker_t workers[NTHREADS];
+  NodePool_Stats stats;
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    workers[t] = (worker_t) { pool, t, 0 };
+    ASSERT_EQ(0, pthread_create(&threads[t], NULL, churn, &workers[t]));
+  }
+
+  for (int t = 0; t < NTHREADS; ++t) {
+    ASSERT_EQ(0, pthread_join(threads[t], NULL));
+    ASSERT_EQ(0, workers[t].failed);
+  }
+
+  /* Nodes put by one thread are got by others instead of new ones. */
+  TreePool_stats(pool, &stats);
+  ASSERT(stats.nodes <= NTHREADS * (1000 + 2 * NODE_POOL_BATCH));
+
+  TreePool_free(&pool);
+  PASS();
+}
+
+GREATEST_MAIN_DEFS();
+int main(int argc, char** argv)
+{
+  GREATEST_MAIN_BEGIN();
+  RUN_TEST(put_node_comes_back);
+  RUN_TEST(nodes_are_distinct);
+  RUN_TEST(big_nodes);
+  RUN_TEST(chunk_fails);
+  RUN_TEST(release_keeps_chunks);
+  RUN_TEST(release_drops_cached_nodes);
+  RUN_TEST(huge_pages);
+  RUN_TEST(caches_in_threads);
+  GREATEST_MAIN_END();
+}
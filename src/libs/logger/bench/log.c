@@ -0,0 +1,160 @@
+/*
+ * Latency of a log call while all threads log. Lines go to `/dev/null`,
+ * first through the logger, then with `fprintf` and `localtime_r` on the
+ * calling thread as `log.h` did before. Every call is timed; the wall time
+ * includes writing all queued records.
+ *
+ * Usage: log.run [lines per thread] [max threads]
+ */
+#define _POSIX_C_SOURCE 200809L  /* localtime_r */
+
+#include "logger/log.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+#define DEFAULT_LINES    (1UL << 18)
+#define DEFAULT_THREADS  8
+
+/* Latency histogram, 10 ns buckets. */
+#define BUCKET_NS        10
+#define NBUCKETS         10000
+
+typedef struct {
+  size_t lines;
+  size_t id;
+  size_t histogram[NBUCKETS];
+} job_t;
+
+static job_t jobs[64];
+
+static FILE* null_stream;
+static pthread_mutex_t stream_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+__async(size_t id, size_t i)
+{
+  Log_error("request %zu of worker %zu done in %d us", i, id, 42);
+}
+
+/* What every call did before. */
+static void
+__sync(size_t id, size_t i)
+{
+  char buffer[64];
+  struct tm tm;
+  const time_t now = time(NULL);
+
+  localtime_r(&now, &tm);
+  strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+
+  pthread_mutex_lock(&stream_lock);
+  fprintf(null_stream, LOG_FMT "request %zu of worker %zu done in %d us\n",
+          buffer, ERROR_TAG, "log.c", __func__, __LINE__, i, id, 42);
+  pthread_mutex_unlock(&stream_lock);
+}
+
+static void (*logger)(size_t, size_t);
+
+static void*
+worker(void* arg)
+{
+  job_t* job = arg;
+
+  for (size_t i = 0; i < job->lines; ++i) {
+    const double start = Bench_now();
+    logger(job->id, i);
+    size_t bucket = (size_t)((Bench_now() - start) * 1e9) / BUCKET_NS;
+
+    job->histogram[bucket < NBUCKETS ? bucket : NBUCKETS - 1]++;
+  }
+
+  return NULL;
+}
+
+/* Latency under which `percent` of calls finished, in ns. */
+static size_t
+__percentile(size_t nthreads, size_t total, double percent)
+{
+  size_t seen = 0;
+
+  for (size_t b = 0; b < NBUCKETS; ++b) {
+    for (size_t t = 0; t < nthreads; ++t) {
+      seen += jobs[t].histogram[b];
+    }
+
+    if ((double)seen >= (double)total * percent / 100.0)
+    { return (b + 1) * BUCKET_NS; }
+  }
+
+  return NBUCKETS * BUCKET_NS;
+}
+
+static void
+run(const char* name, void (*fn)(size_t, size_t), size_t lines, size_t nthreads)
+{
+  pthread_t threads[64];
+  char title[64];
+
+  logger = fn;
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    memset(&jobs[i], '\0', sizeof(jobs[i]));
+    jobs[i].lines = lines;
+    jobs[i].id = i;
+  }
+
+  const double start = Bench_now();
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_create(&threads[i], NULL, worker, &jobs[i]);
+  }
+
+  for (size_t i = 0; i < nthreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  Log_flush();
+  fflush(null_stream);
+
+  snprintf(title, sizeof(title), "log: %s x%zu", name, nthreads);
+  Bench_report(title, lines * nthreads, Bench_now() - start);
+
+  printf("%-36s p50 %zu ns, p99 %zu ns, p99.9 %zu ns\n", "",
+         __percentile(nthreads, lines * nthreads, 50.0),
+         __percentile(nthreads, lines * nthreads, 99.0),
+         __percentile(nthreads, lines * nthreads, 99.9));
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t lines = Bench_arg(argc, argv, 1, DEFAULT_LINES);
+  size_t max_threads = Bench_arg(argc, argv, 2, DEFAULT_THREADS);
+
+  if (max_threads > 64)
+  { max_threads = 64; }
+
+  null_stream = fopen("/dev/null", "w");
+
+  if (null_stream == NULL)
+  { return 1; }
+
+  Log_output(null_stream, null_stream);
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    run("async", __async, lines, nthreads);
+  }
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    run("fprintf", __sync, lines, nthreads);
+  }
+
+  Log_output(stdout, stderr);
+  fclose(null_stream);
+
+  return 0;
+}
@@ -1,12 +1,23 @@
 /**
  * @file     log.h
  * @brief    Logs with different levels
+ *
+ * Logging is asynchronous. The calling thread formats only the message into
+ * a fixed-size record of its own ring buffer, together with time, level and
+ * source location. A background thread takes records of all threads in time
+ * order, formats the lines and writes them in batches. Messages longer than
+ * `LOG_MESSAGE_SIZE` are truncated.
+ *
+ * When a ring buffer is full the caller waits for the background thread.
+ * Records are written at exit; call `Log_flush` before writing to the same
+ * streams directly or before `abort`.
+ *
+ * Levels above `LOG_LEVEL` are removed at compile time.
  */
 #if !defined(LOGGER_LOG_H)
 #define LOGGER_LOG_H
 
-#include <stdio.h>     /* fprintf, stdout */
-#include <string.h>    /* strrchr         */
+#include <stdio.h>     /* fprintf, stdout, FILE */
 
 #define NO_LOG         0x00
 #define ERROR_LEVEL    0x01
@@ -36,10 +47,37 @@
 #  define COLOR_RESET
 #endif
 
-/* Forward declaration */
+/* Longest message that is kept, terminating zero included. */
+#define LOG_MESSAGE_SIZE  192
+
+/**
+ * Returns current local time as "YYYY-MM-DD hh:mm:ss". The string is per
+ * thread and valid until the next call from the same thread.
+ */
 char* time_now(void);
 
-#define __FILE    strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__
+/**
+ * Queues a record, see `Log_*` macros. `file` and `func` must be static
+ * strings, only pointers are kept.
+ */
+void Log_write(int level, const char* file, const char* func, int line,
+               const char* fmt, ...)
+#if defined(__GNUC__)
+__attribute__((format(printf, 5, 6)))
+#endif
+;
+
+/**
+ * Writes all records queued so far and flushes the streams.
+ */
+void Log_flush(void);
+
+/**
+ * Sets where lines are written: errors to `err`, other levels to `out`.
+ * Default are `stderr` and `stdout`. Records queued so far are written to
+ * the old streams.
+ */
+void Log_output(FILE* out, FILE* err);
 
 #ifdef LOG_COLOR
 #  define LOG_FMT     "%s | %-16s | %-15s | %s:%d | "
@@ -58,52 +96,29 @@ char* time_now(void);
 /* __________________________________________________________________________ */
 /*                                                                Categories  */
 
-#define _log_debug(msg, ...) do {                                   \
+#define Log_debug(...) do {                                         \
     if (LOG_LEVEL >= DEBUG_LEVEL)                                   \
-      fprintf(stdout, LOG_FMT msg "%s",                             \
-              time_now(), DEBUG_TAG,                                \
-              __FILE, __func__, __LINE__, __VA_ARGS__); } while (0)
+      Log_write(DEBUG_LEVEL, __FILE__, __func__, __LINE__,          \
+                __VA_ARGS__); } while (0)
 
-#define Log_debug(...) do {                      \
-    if (LOG_LEVEL >= DEBUG_LEVEL)                \
-      _log_debug(__VA_ARGS__, "\n"); } while (0)
-
-#define _log_error(msg, ...) do {                                   \
+#define Log_error(...) do {                                         \
     if (LOG_LEVEL >= ERROR_LEVEL)                                   \
-      fprintf(stderr, LOG_FMT msg "%s",                             \
-              time_now(), ERROR_TAG,                                \
-              __FILE, __func__, __LINE__, __VA_ARGS__); } while (0)
-
-#define Log_error(...) do {                       \
-    if (LOG_LEVEL >= ERROR_LEVEL)                 \
-      _log_error(__VA_ARGS__, "\n"); } while (0)
+      Log_write(ERROR_LEVEL, __FILE__, __func__, __LINE__,          \
+                __VA_ARGS__); } while (0)
 
+#define Log_error_if(condition, ...) do {                           \
+    if (condition)                                                  \
+      Log_error(__VA_ARGS__); } while (0)
 
-#define Log_error_if(condition, ...) do {          \
-    if (condition)                                 \
-      if (LOG_LEVEL >= ERROR_LEVEL)                \
-        _log_error(__VA_ARGS__, "\n"); } while (0)
-
-
-#define _log_warn(msg, ...) do {                                    \
+#define Log_warn(...) do {                                          \
     if (LOG_LEVEL >= WARN_LEVEL)                                    \
-      fprintf(stdout, LOG_FMT msg "%s",                             \
-              time_now(), WARN_TAG,                                 \
-              __FILE, __func__, __LINE__, __VA_ARGS__); } while (0)
+      Log_write(WARN_LEVEL, __FILE__, __func__, __LINE__,           \
+                __VA_ARGS__); } while (0)
 
-#define Log_warn(...) do {                      \
-    if (LOG_LEVEL >= WARN_LEVEL)                \
-      _log_warn(__VA_ARGS__, "\n"); } while (0)
-
-#define _log_info(msg, ...) do {                                    \
+#define Log_info(...) do {                                          \
     if (LOG_LEVEL >= INFO_LEVEL)                                    \
-      fprintf(stdout, LOG_FMT msg "%s",                             \
-              time_now(), INFO_TAG,                                 \
-              __FILE, __func__, __LINE__, __VA_ARGS__); } while (0)
-
-#define Log_info(...) do {                      \
-    if (LOG_LEVEL >= INFO_LEVEL)                \
-      _log_info(__VA_ARGS__, "\n"); } while (0)
+      Log_write(INFO_LEVEL, __FILE__, __func__, __LINE__,           \
+                __VA_ARGS__); } while (0)
 
 /* __________________________________________________________________________ */
 /*                                                             Debug session  */
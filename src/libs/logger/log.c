@@ -1,17 +1,447 @@
+/**
+ * @file     log.c
+ * @brief    Asynchronous logger.
+ *
+ * Every thread owns a ring buffer of fixed-size records. Only that thread
+ * writes to it and only the flush thread reads from it, so neither side
+ * takes a lock. The flush thread merges the rings by time, formats the lines
+ * and flushes the streams once per batch. It sleeps while there is nothing
+ * to do and is woken up when a ring is half full or an error is logged.
+ * Otherwise records wait at most `FLUSH_INTERVAL`.
+ *
+ * Time is taken by the caller but converted to local time by the flush
+ * thread once per second.
+ *
+ * Rings of finished threads are adopted by new ones.
+ */
+#define _POSIX_C_SOURCE 200809L  /* localtime_r */
+
 #include "logger/log.h"
 
-#include <time.h>
+#include <pthread.h>     /* pthread_*                 */
+#include <sched.h>       /* sched_yield               */
+#include <stdarg.h>      /* va_list                   */
+#include <stdatomic.h>   /* atomic_*                  */
+#include <stdbool.h>     /* bool                      */
+#include <stdlib.h>      /* aligned_alloc, atexit     */
+#include <string.h>      /* strrchr, memset           */
+#include <time.h>        /* timespec_get, localtime_r */
+
+/* Records in one ring, power of two. */
+#define RING_SIZE       512
+
+/* How long the flush thread sleeps if not woken up, in nanoseconds. */
+#define FLUSH_INTERVAL  10000000L
+
+#define CACHE_LINE      64
+
+/* __________________________________________________________________________ */
+/*                                                                     Local  */
+
+/* Binary record, formatted by the flush thread. */
+struct record {
+  _Alignas(CACHE_LINE) struct timespec time;
+  const char* file;
+  const char* func;
+  int line;
+  int level;
+  char message[LOG_MESSAGE_SIZE];
+};
+
+struct ring {
+  _Alignas(CACHE_LINE) _Atomic size_t head;  /* Next record to format.     */
+  size_t limit;                              /* Flush thread only.         */
+
+  _Alignas(CACHE_LINE) _Atomic size_t tail;  /* Next record to fill.       */
+  size_t cached_head;                        /* Owner only, could be old.  */
+
+  atomic_bool owned;                         /* Used by a live thread.     */
+  struct ring* next;                         /* In `rings`, never removed. */
+
+  struct record records[RING_SIZE];
+};
+
+static _Atomic(struct ring*) rings;
+
+static _Thread_local struct ring* local_ring;
+static pthread_key_t ring_key;
+
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+
+/* Held while records are formatted, by the flush thread or `Log_flush`. */
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* out_stream;
+static FILE* err_stream;
+
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+static bool wake_pending;
+static atomic_bool sleeping;
+
+static pthread_t flush_thread;
+static atomic_bool started;
+static atomic_bool stopping;
+
+/* Local time of the last formatted record. Flush thread only. */
+static time_t cached_second = -1;
+static char cached_time[32];
+
+static void
+__wake(void)
+{
+  pthread_mutex_lock(&wake_lock);
+  wake_pending = true;
+  pthread_cond_signal(&wake_cond);
+  pthread_mutex_unlock(&wake_lock);
+}
+
+static const char*
+__timestamp(time_t second)
+{
+  if (second != cached_second) {
+    struct tm tm;
+
+    localtime_r(&second, &tm);
+    strftime(cached_time, sizeof (cached_time), "%Y-%m-%d %H:%M:%S", &tm);
+    cached_second = second;
+  }
+
+  return cached_time;
+}
+
+/* Called with `flush_lock` held. */
+static void
+__print(const struct record* record)
+{
+  const char* file = strrchr(record->file, '/');
+  const char* tag;
+  FILE* stream = out_stream;
+
+  switch (record->level) {
+  case ERROR_LEVEL:
+    tag = ERROR_TAG;
+    stream = err_stream;
+    break;
+
+  case WARN_LEVEL:
+    tag = WARN_TAG;
+    break;
+
+  case INFO_LEVEL:
+    tag = INFO_TAG;
+    break;
+
+  default:
+    tag = DEBUG_TAG;
+  }
+
+  fprintf(stream, LOG_FMT "%s\n", __timestamp(record->time.tv_sec), tag,
+          (file != NULL) ? file + 1 : record->file, record->func, record->line,
+          record->message);
+}
+
+static bool
+__before(const struct timespec* a, const struct timespec* b)
+{
+  return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/*
+ * Called with `flush_lock` held. Formats records queued so far, oldest
+ * first, and returns how many.
+ */
+static size_t
+__drain(void)
+{
+  struct ring* first = atomic_load_explicit(&rings, memory_order_acquire);
+  size_t count = 0;
+
+  for (struct ring* ring = first; ring; ring = ring->next) {
+    ring->limit = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  }
+
+  for (;;) {
+    struct ring* oldest = NULL;
+    const struct record* record = NULL;
+
+    for (struct ring* ring = first; ring; ring = ring->next) {
+      const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+      if (head == ring->limit)
+      { continue; }
+
+      const struct record* candidate = &ring->records[head % RING_SIZE];
+
+      if (record == NULL || __before(&candidate->time, &record->time)) {
+        oldest = ring;
+        record = candidate;
+      }
+    }
+
+    if (oldest == NULL)
+    { break; }
+
+    __print(record);
+    count++;
+
+    /* Slot could be filled again. */
+    atomic_store_explicit(&oldest->head,
+                          atomic_load_explicit(&oldest->head, memory_order_relaxed) + 1,
+                          memory_order_release);
+  }
+
+  if (count > 0) {
+    fflush(out_stream);
+    fflush(err_stream);
+  }
+
+  return count;
+}
+
+static void*
+__flush_loop(void* arg)
+{
+  (void)arg;
+
+  struct timespec deadline;
+
+  for (;;) {
+    const bool stop = atomic_load(&stopping);
+
+    pthread_mutex_lock(&flush_lock);
+    const size_t count = __drain();
+    pthread_mutex_unlock(&flush_lock);
+
+    if (stop)
+    { break; }
+
+    if (count > 0)
+    { continue; }
+
+    timespec_get(&deadline, TIME_UTC);
+    deadline.tv_nsec += FLUSH_INTERVAL;
+
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&wake_lock);
+
+    if (!wake_pending) {
+      atomic_store_explicit(&sleeping, true, memory_order_relaxed);
+      pthread_cond_timedwait(&wake_cond, &wake_lock, &deadline);
+      atomic_store_explicit(&sleeping, false, memory_order_relaxed);
+    }
+
+    wake_pending = false;
+    pthread_mutex_unlock(&wake_lock);
+  }
+
+  return NULL;
+}
+
+/* Writes what is left. Later records are written by the callers. */
+static void
+__log_exit(void)
+{
+  atomic_store(&stopping, true);
+
+  if (atomic_load(&started)) {
+    __wake();
+    pthread_join(flush_thread, NULL);
+  }
+
+  Log_flush();
+}
+
+static void
+__ring_orphan(void* ring)
+{
+  atomic_store_explicit(&((struct ring*)ring)->owned, false, memory_order_release);
+  local_ring = NULL;
+}
+
+static void
+__log_init(void)
+{
+  pthread_key_create(&ring_key, __ring_orphan);
+
+  pthread_mutex_lock(&flush_lock);
+
+  if (out_stream == NULL) {
+    out_stream = stdout;
+    err_stream = stderr;
+  }
+
+  pthread_mutex_unlock(&flush_lock);
+
+  if (pthread_create(&flush_thread, NULL, __flush_loop, NULL) == 0)
+  { atomic_store(&started, true); }
+  else
+  { atomic_store(&stopping, true); }
+
+  atexit(__log_exit);
+}
+
+/* Slow path, once per thread: adopt a ring or create a new one. */
+static struct ring*
+__ring_attach(void)
+{
+  pthread_once(&log_once, __log_init);
+
+  struct ring* ring = atomic_load_explicit(&rings, memory_order_acquire);
+
+  for (; ring; ring = ring->next) {
+    bool owned = false;
+
+    if (atomic_compare_exchange_strong(&ring->owned, &owned, true))
+    { break; }
+  }
+
+  if (ring == NULL) {
+    ring = aligned_alloc(CACHE_LINE, sizeof (*ring));
+
+    /* Caller writes the record itself. */
+    if (ring == NULL)
+    { return NULL; }
+
+    memset(ring, '\0', sizeof (*ring));
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->owned, true);
+
+    ring->next = atomic_load_explicit(&rings, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&rings, &ring->next, ring,
+                                                  memory_order_release,
+                                                  memory_order_relaxed))
+    { }
+  }
+
+  pthread_setspecific(ring_key, ring);
+  local_ring = ring;
+
+  return ring;
+}
+
+/* Waits for a free slot. Returns its index. */
+static size_t
+__reserve(struct ring* ring)
+{
+  const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  if (tail - ring->cached_head < RING_SIZE)
+  { return tail; }
+
+  ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  while (tail - ring->cached_head == RING_SIZE) {
+
+    if (atomic_load(&stopping))
+    { Log_flush(); }
+    else
+    { __wake(); sched_yield(); }
+
+    ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  }
+
+  return tail;
+}
+
+static void
+__fill(struct record* record, int level, const char* file, const char* func, int line,
+       const char* fmt, va_list ap)
+{
+  timespec_get(&record->time, TIME_UTC);
+
+  record->file = file;
+  record->func = func;
+  record->line = line;
+  record->level = level;
+
+  vsnprintf(record->message, LOG_MESSAGE_SIZE, fmt, ap);
+}
+
+/* __________________________________________________________________________ */
 
 char*
 time_now(void)
 {
-  time_t rawtime;
-  time(&rawtime);
+  static _Thread_local time_t second = -1;
+  static _Thread_local char buffer[64];
 
-  struct tm* timeinfo = localtime(&rawtime);
+  const time_t now = time(NULL);
 
-  static char buffer[64];
-  strftime(buffer, 64, "%Y-%m-%d %H:%M:%S", timeinfo);
+  if (now != second) {
+    struct tm tm;
+
+    localtime_r(&now, &tm);
+    strftime(buffer, sizeof (buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    second = now;
+  }
 
   return buffer;
 }
+
+void
+Log_write(int level, const char* file, const char* func, int line, const char* fmt, ...)
+{
+  struct ring* ring = local_ring;
+  va_list ap;
+
+  if (ring == NULL)
+  { ring = __ring_attach(); }
+
+  if (ring == NULL) {
+    struct record record;
+
+    va_start(ap, fmt);
+    __fill(&record, level, file, func, line, fmt, ap);
+    va_end(ap);
+
+    pthread_mutex_lock(&flush_lock);
+    __print(&record);
+    pthread_mutex_unlock(&flush_lock);
+
+    return;
+  }
+
+  const size_t tail = __reserve(ring);
+
+  va_start(ap, fmt);
+  __fill(&ring->records[tail % RING_SIZE], level, file, func, line, fmt, ap);
+  va_end(ap);
+
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+  if (atomic_load_explicit(&stopping, memory_order_relaxed))
+  { Log_flush(); }
+  else if (tail + 1 - ring->cached_head == RING_SIZE / 2
+           || (level == ERROR_LEVEL && atomic_load_explicit(&sleeping, memory_order_relaxed)))
+  { __wake(); }
+}
+
+void
+Log_flush(void)
+{
+  pthread_mutex_lock(&flush_lock);
+
+  if (out_stream != NULL)
+  { __drain(); }
+
+  pthread_mutex_unlock(&flush_lock);
+}
+
+void
+Log_output(FILE* out, FILE* err)
+{
+  pthread_mutex_lock(&flush_lock);
+
+  if (out_stream != NULL)
+  { __drain(); }
+
+  out_stream = out;
+  err_stream = err;
+
+  pthread_mutex_unlock(&flush_lock);
+}